@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+// Key-press-to-audible latency harness: issues volume steps, pauses and
+// seeks to a Player playing into a ProbeSink, and measures when each change
+// is first heard by comparing the output with a reference decode.
+
+#include <mpg123.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/player.hpp"
+#include "../src/audio/probe_sink.hpp"
+#include "../src/util/latency_histogram.hpp"
+
+namespace {
+
+enum class Command : uint8_t { VOLUME, PAUSE, SEEK, COUNT };
+
+constexpr auto COMMANDS = static_cast<size_t>(Command::COUNT);
+constexpr std::array<const char *, COMMANDS> COMMAND_NAMES{"volume", "pause",
+                                                           "seek"};
+constexpr auto SETTLE_TIME = std::chrono::milliseconds(2500);
+constexpr auto MIN_WARMUP_MS = 1500;
+constexpr auto MAX_WARMUP_MS = 3000;
+constexpr auto SEEK_SECONDS = 4;
+constexpr auto VOLUME_STEP = 0.25F;
+
+/// Decodes a whole file at unity gain, as the Player's decoder does
+auto decode_reference(const std::string &path) -> std::vector<int16_t> {
+  mpg123_init();
+  mpg123_handle *handle = mpg123_new(nullptr, nullptr);
+  if (handle == nullptr || mpg123_open(handle, path.c_str()) != MPG123_OK) {
+    mpg123_delete(handle);
+    throw std::runtime_error("Cannot decode " + path);
+  }
+  std::vector<int16_t> samples;
+  std::array<unsigned char, 8192> buffer{};
+  size_t done = 0;
+  int result = MPG123_OK;
+  while ((result = mpg123_read(handle, buffer.data(), buffer.size(),
+                               &done)) == MPG123_OK ||
+         result == MPG123_NEW_FORMAT) {
+    const auto *decoded = reinterpret_cast<const int16_t *>(buffer.data());
+    samples.insert(samples.end(), decoded, decoded + (done / 2));
+  }
+  mpg123_close(handle);
+  mpg123_delete(handle);
+  return samples;
+}
+
+auto format_ms(std::chrono::nanoseconds value) -> std::string {
+  std::array<char, 32> text{};
+  std::snprintf(text.data(), text.size(), "%.1f",
+                std::chrono::duration<double, std::milli>(value).count());
+  return text.data();
+}
+
+void print_row(const char *name, const char *what,
+               const LatencyHistogram &histogram) {
+  static constexpr auto P50 = 50.0;
+  static constexpr auto P99 = 99.0;
+  std::array<char, 128> line{};
+  std::snprintf(line.data(), line.size(), "%-7s %-9s %6llu %9s %9s %9s\n",
+                name, what, static_cast<unsigned long long>(histogram.count()),
+                format_ms(histogram.percentile(P50)).c_str(),
+                format_ms(histogram.percentile(P99)).c_str(),
+                format_ms(histogram.max()).c_str());
+  std::cout << line.data();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " <song.mp3> [--trials N] [--seed N]\n";
+    return 1;
+  }
+  const std::string path = argv[1];
+  unsigned trials = 10;
+  uint64_t seed = 1;
+  try {
+    for (int i = 2; i + 1 < argc; i += 2) {
+      const std::string option = argv[i];
+      if (option == "--trials") {
+        trials = static_cast<unsigned>(std::stoul(argv[i + 1]));
+      } else if (option == "--seed") {
+        seed = std::stoull(argv[i + 1]);
+      } else {
+        std::cerr << "Unknown option: " << option << '\n';
+        return 1;
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid option value: " << e.what() << '\n';
+    return 1;
+  }
+
+  try {
+    const auto reference = decode_reference(path);
+    auto sink = std::make_unique<ProbeSink>(Clock::steady());
+    auto *probe = sink.get();
+    Player player(std::move(sink));
+
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<int> warmup(MIN_WARMUP_MS, MAX_WARMUP_MS);
+    std::array<LatencyHistogram, COMMANDS> returned;
+    std::array<LatencyHistogram, COMMANDS> audible;
+    std::array<unsigned, COMMANDS> missed{};
+
+    for (unsigned trial = 0; trial < trials * COMMANDS; ++trial) {
+      const auto command = static_cast<Command>(trial % COMMANDS);
+      player.set_volume(1.0F);
+      player.load_song(path);
+      player.resume();
+      std::this_thread::sleep_for(std::chrono::milliseconds(warmup(random)));
+
+      const auto start = std::chrono::steady_clock::now();
+      switch (command) {
+      case Command::VOLUME:
+        player.adjust_volume(-VOLUME_STEP);
+        break;
+      case Command::PAUSE:
+        player.pause();
+        break;
+      default:
+        player.seek_relative(SEEK_SECONDS);
+        break;
+      }
+      const auto index = static_cast<size_t>(command);
+      returned.at(index).record(std::chrono::steady_clock::now() - start);
+
+      std::this_thread::sleep_for(SETTLE_TIME);
+      const auto change = probe->first_change(reference, start);
+      if (change) {
+        audible.at(index).record(*change - start);
+      } else {
+        ++missed.at(index);
+      }
+    }
+    player.pause();
+
+    std::cout << "command what      count   p50[ms]   p99[ms]   max[ms]\n";
+    for (size_t i = 0; i < COMMANDS; ++i) {
+      print_row(COMMAND_NAMES.at(i), "returned", returned.at(i));
+      print_row(COMMAND_NAMES.at(i), "audible", audible.at(i));
+      if (missed.at(i) > 0) {
+        std::cout << "        " << missed.at(i) << " change(s) not heard\n";
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "[ERROR] " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
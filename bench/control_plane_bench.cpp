@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+// Control-plane load generator: many concurrent clients send a random mix of
+// pause/resume/seek/next/volume commands to one Player while it plays into a
+// real-time NullSink. Reports command-completion latency percentiles and
+// audio underruns.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/null_sink.hpp"
+#include "../src/audio/player.hpp"
+#include "../src/audio/playlist.hpp"
+#include "../src/util/latency_histogram.hpp"
+
+namespace {
+
+enum class Command : uint8_t { PAUSE, RESUME, SEEK, NEXT, VOLUME, COUNT };
+
+constexpr auto COMMANDS = static_cast<size_t>(Command::COUNT);
+constexpr std::array<const char *, COMMANDS> COMMAND_NAMES{
+    "pause", "resume", "seek", "next", "volume"};
+
+struct Options {
+  std::string source;
+  unsigned clients{8};
+  std::chrono::seconds duration{30};
+  std::chrono::milliseconds think_time{50};
+  uint64_t seed{1};
+  std::array<unsigned, COMMANDS> mix{20, 20, 25, 10, 25};
+};
+
+using Histograms = std::array<LatencyHistogram, COMMANDS>;
+
+auto parse_mix(const std::string &text, std::array<unsigned, COMMANDS> &mix)
+    -> bool {
+  std::istringstream stream(text);
+  std::string weight;
+  size_t index = 0;
+  while (std::getline(stream, weight, ',')) {
+    if (index == COMMANDS) {
+      return false;
+    }
+    mix.at(index++) = static_cast<unsigned>(std::stoul(weight));
+  }
+  return index == COMMANDS;
+}
+
+auto parse_options(int argc, char *argv[], Options &options) -> bool {
+  if (argc < 2) {
+    return false;
+  }
+  options.source = argv[1];
+  for (int i = 2; i < argc; ++i) {
+    const std::string option = argv[i];
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (option == "--clients") {
+      options.clients = static_cast<unsigned>(std::stoul(value));
+    } else if (option == "--seconds") {
+      options.duration = std::chrono::seconds(std::stoul(value));
+    } else if (option == "--think-ms") {
+      options.think_time = std::chrono::milliseconds(std::stoul(value));
+    } else if (option == "--seed") {
+      options.seed = std::stoull(value);
+    } else if (option == "--mix") {
+      if (!parse_mix(value, options.mix)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  return options.clients > 0;
+}
+
+/// One client: exponential think times, commands drawn from the mix
+void run_client(Player &player, std::mutex &control, const Options &options,
+                unsigned id, std::chrono::steady_clock::time_point deadline,
+                Histograms &histograms) {
+  std::mt19937_64 random(options.seed + id);
+  std::discrete_distribution<size_t> pick(options.mix.begin(),
+                                          options.mix.end());
+  std::exponential_distribution<double> think(
+      1.0 / std::max<double>(1.0, static_cast<double>(
+                                      options.think_time.count())));
+  std::uniform_int_distribution<int> seek(-10, 10);
+  std::uniform_real_distribution<float> volume(-0.1F, 0.1F);
+
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(
+        std::chrono::duration<double, std::milli>(think(random)));
+    const auto command = static_cast<Command>(pick(random));
+
+    // Commands are serialized like a daemon's command queue; volume is an
+    // atomic and needs no lock. Waiting for the lock counts as latency.
+    const auto start = std::chrono::steady_clock::now();
+    if (command == Command::VOLUME) {
+      player.adjust_volume(volume(random));
+    } else {
+      std::lock_guard<std::mutex> lock(control);
+      switch (command) {
+      case Command::PAUSE:
+        player.pause();
+        break;
+      case Command::RESUME:
+        player.resume();
+        break;
+      case Command::SEEK:
+        player.seek_relative(seek(random));
+        break;
+      case Command::NEXT:
+        player.next_song();
+        break;
+      default:
+        break;
+      }
+    }
+    histograms.at(static_cast<size_t>(command))
+        .record(std::chrono::steady_clock::now() - start);
+  }
+}
+
+auto format_ms(std::chrono::nanoseconds value) -> std::string {
+  std::array<char, 32> text{};
+  std::snprintf(text.data(), text.size(), "%.2f",
+                std::chrono::duration<double, std::milli>(value).count());
+  return text.data();
+}
+
+void print_row(const char *name, const LatencyHistogram &histogram) {
+  static constexpr auto P50 = 50.0;
+  static constexpr auto P99 = 99.0;
+  static constexpr auto P999 = 99.9;
+  std::array<char, 128> line{};
+  std::snprintf(line.data(), line.size(), "%-8s %8llu %10s %10s %10s %10s\n",
+                name, static_cast<unsigned long long>(histogram.count()),
+                format_ms(histogram.percentile(P50)).c_str(),
+                format_ms(histogram.percentile(P99)).c_str(),
+                format_ms(histogram.percentile(P999)).c_str(),
+                format_ms(histogram.max()).c_str());
+  std::cout << line.data();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  Options options;
+  try {
+    if (!parse_options(argc, argv, options)) {
+      std::cerr << "Usage: " << argv[0]
+                << " <folder|list.m3u> [--clients N] [--seconds S]"
+                   " [--think-ms M] [--seed N]"
+                   " [--mix pause,resume,seek,next,volume]\n";
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid option value: " << e.what() << '\n';
+    return 1;
+  }
+
+  try {
+    auto sink = std::make_unique<NullSink>(Clock::steady());
+    auto *device = sink.get();
+    Player player(std::move(sink));
+    player.set_playlist(std::make_unique<Playlist>(options.source));
+    player.resume();
+
+    std::mutex control;
+    std::vector<Histograms> histograms(options.clients);
+    const auto deadline = std::chrono::steady_clock::now() + options.duration;
+    {
+      std::vector<std::jthread> clients;
+      clients.reserve(options.clients);
+      for (unsigned id = 0; id < options.clients; ++id) {
+        clients.emplace_back(run_client, std::ref(player), std::ref(control),
+                             std::cref(options), id, deadline,
+                             std::ref(histograms[id]));
+      }
+    }
+
+    Histograms merged;
+    LatencyHistogram all;
+    for (const auto &client : histograms) {
+      for (size_t i = 0; i < COMMANDS; ++i) {
+        merged.at(i).merge(client.at(i));
+        all.merge(client.at(i));
+      }
+    }
+
+    std::cout << options.clients << " clients, " << options.duration.count()
+              << " s, think " << options.think_time.count() << " ms\n"
+              << "command     count    p50[ms]    p99[ms]   p999[ms]    "
+                 "max[ms]\n";
+    for (size_t i = 0; i < COMMANDS; ++i) {
+      print_row(COMMAND_NAMES.at(i), merged.at(i));
+    }
+    print_row("all", all);
+    std::cout << "underruns: " << device->underruns() << '\n';
+  } catch (const std::exception &e) {
+    std::cerr << "[ERROR] " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+// DSP kernel throughput: runs every kernel implementation available on this
+// machine over audio cut into the Player's decode blocks, the way the output
+// chain applies them, and compares each with the scalar reference.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/audio/dsp.hpp"
+
+namespace {
+
+constexpr auto CHANNELS = 2;
+constexpr auto RATE = 44100;
+constexpr auto TRACK_SECONDS = 10;
+constexpr size_t BLOCK = 8192 / sizeof(int16_t); ///< One Player decode block
+
+struct Stage {
+  const char *name;
+  std::function<void(const DspKernels &, std::span<int16_t>, float *)> run;
+};
+
+/// Steady volume, a fade step per block, and the follower's resampler input
+const std::array<Stage, 3> STAGES{{
+    {"gain",
+     [](const DspKernels &kernels, std::span<int16_t> block, float *) {
+       kernels.apply_gain(block, 0.8F);
+     }},
+    {"fade",
+     [](const DspKernels &kernels, std::span<int16_t> block, float *) {
+       kernels.apply_ramp(block, CHANNELS, 0.8F, 0.7F);
+     }},
+    {"to_float",
+     [](const DspKernels &kernels, std::span<int16_t> block, float *scratch) {
+       kernels.to_float(block, scratch);
+     }},
+}};
+
+/// Processes the track block by block until `duration` has passed
+auto throughput(const Stage &stage, const DspKernels &kernels,
+                const std::vector<int16_t> &track,
+                std::chrono::milliseconds duration) -> double {
+  std::vector<int16_t> work(track);
+  std::vector<float> scratch(BLOCK);
+  uint64_t samples = 0;
+  const auto start = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::steady_clock::duration::zero();
+  while (elapsed < duration) {
+    // Restore the input so gains never decay the signal to zero
+    std::copy(track.begin(), track.end(), work.begin());
+    for (size_t offset = 0; offset + BLOCK <= work.size(); offset += BLOCK) {
+      stage.run(kernels, std::span{work}.subspan(offset, BLOCK),
+                scratch.data());
+      samples += BLOCK;
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+  }
+  return static_cast<double>(samples) /
+         std::chrono::duration<double>(elapsed).count() / 1e6;
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  auto duration = std::chrono::milliseconds(1000);
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if (option == "--ms") {
+      duration = std::chrono::milliseconds(std::stoi(argv[i + 1]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--ms <per measurement>]\n";
+      return 1;
+    }
+  }
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> sample(-20000, 20000);
+  std::vector<int16_t> track(static_cast<size_t>(RATE) * CHANNELS *
+                             TRACK_SECONDS);
+  for (auto &value : track) {
+    value = static_cast<int16_t>(sample(random));
+  }
+
+  std::cout << "Selected kernels: " << dsp_kernels().name << "\n";
+  std::printf("%-10s %-8s %14s %9s\n", "stage", "kernels", "Msamples/s",
+              "speedup");
+  for (const auto &stage : STAGES) {
+    const double reference =
+        throughput(stage, dsp_scalar(), track, duration);
+    for (const auto *kernels : dsp_available()) {
+      const double rate = kernels == &dsp_scalar()
+                              ? reference
+                              : throughput(stage, *kernels, track, duration);
+      std::printf("%-10s %-8s %14.1f %8.2fx\n", stage.name, kernels->name,
+                  rate, rate / reference);
+    }
+  }
+  return 0;
+}
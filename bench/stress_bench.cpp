@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+// Playback stress harness: plays a playlist into a real-time NullSink while
+// CPU hogs, memory-bandwidth streamers and I/O storms on the library disk
+// compete with the decoder. Noise grows level by level; each level reports
+// underruns, the lowest output buffer level and quality degradations, and
+// every glitch is listed with its time. The headroom is the last level that
+// played cleanly.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/null_sink.hpp"
+#include "../src/audio/player.hpp"
+#include "../src/audio/playlist.hpp"
+
+namespace {
+
+constexpr auto SAMPLE_PERIOD = std::chrono::milliseconds(1);
+constexpr auto SETTLE_TIME = std::chrono::seconds(1); ///< Of each track
+constexpr size_t IO_CHUNK = size_t{1} << 20;
+constexpr size_t IO_FILE_CHUNKS = 4;
+constexpr size_t MIB = size_t{1} << 20;
+
+struct Options {
+  std::string source;
+  std::chrono::seconds duration{20}; ///< Per level
+  unsigned levels{3};
+  unsigned cpu_hogs{1};
+  unsigned memory_threads{1};
+  size_t memory_mb{64};
+  unsigned io_threads{1};
+  std::filesystem::path io_dir;
+};
+
+struct LevelResult {
+  unsigned level{0};
+  uint64_t underruns{0};
+  std::optional<std::chrono::milliseconds> min_buffer{};
+  uint64_t degradations{0};
+  uint64_t decode_errors{0};
+};
+
+auto parse_options(int argc, char *argv[], Options &options) -> bool {
+  if (argc < 2) {
+    return false;
+  }
+  options.source = argv[1];
+  for (int i = 2; i < argc; ++i) {
+    const std::string option = argv[i];
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (option == "--seconds") {
+      options.duration = std::chrono::seconds(std::stoul(value));
+    } else if (option == "--levels") {
+      options.levels = static_cast<unsigned>(std::stoul(value));
+    } else if (option == "--cpu") {
+      options.cpu_hogs = static_cast<unsigned>(std::stoul(value));
+    } else if (option == "--memory") {
+      options.memory_threads = static_cast<unsigned>(std::stoul(value));
+    } else if (option == "--memory-mb") {
+      options.memory_mb = std::stoul(value);
+    } else if (option == "--io") {
+      options.io_threads = static_cast<unsigned>(std::stoul(value));
+    } else if (option == "--io-dir") {
+      options.io_dir = value;
+    } else {
+      return false;
+    }
+  }
+  if (options.io_dir.empty()) {
+    // Storm the disk the library lives on
+    const std::filesystem::path source(options.source);
+    options.io_dir =
+        std::filesystem::is_directory(source) ? source : source.parent_path();
+  }
+  return options.duration.count() > 0 && options.memory_mb > 0;
+}
+
+/// Spins on integer arithmetic, never sleeping
+void hog_cpu(const std::stop_token &stop) {
+  static constexpr int BATCH = 1 << 16;
+  static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+  static constexpr uint64_t INCREMENT = 1442695040888963407ULL;
+  volatile uint64_t result = 0;
+  uint64_t state = 1;
+  while (!stop.stop_requested()) {
+    for (int i = 0; i < BATCH; ++i) {
+      state = (state * MULTIPLIER) + INCREMENT;
+    }
+    result = state;
+  }
+  (void)result;
+}
+
+/// Copies between two buffers far larger than the caches
+void stream_memory(const std::stop_token &stop, size_t bytes) {
+  std::vector<char> from(bytes, 1);
+  std::vector<char> to(bytes, 0);
+  while (!stop.stop_requested()) {
+    std::memcpy(to.data(), from.data(), bytes);
+    std::swap(from, to);
+  }
+}
+
+/// Reads a file past the page cache, so the player's reads miss it too
+void read_uncached(const std::string &path, std::vector<char> &buffer) {
+  const int file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return;
+  }
+  while (::read(file, buffer.data(), buffer.size()) > 0) {
+  }
+  ::posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+  ::close(file);
+}
+
+/// Writes and syncs a scratch file, then reads a song without the cache
+void storm_io(const std::stop_token &stop, const std::filesystem::path &dir,
+              const std::vector<std::string> &songs, unsigned id) {
+  const auto scratch = dir / (".jpod_stress_" + std::to_string(id));
+  std::vector<char> buffer(IO_CHUNK, static_cast<char>(id));
+  size_t song = id;
+  while (!stop.stop_requested()) {
+    const int file =
+        ::open(scratch.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (file < 0) {
+      std::cerr << "[WARN] Cannot write to " << dir << '\n';
+      return;
+    }
+    for (size_t chunk = 0;
+         chunk < IO_FILE_CHUNKS && !stop.stop_requested(); ++chunk) {
+      if (::write(file, buffer.data(), buffer.size()) < 0) {
+        break;
+      }
+      ::fsync(file);
+    }
+    ::posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(file);
+    if (!songs.empty()) {
+      read_uncached(songs[song++ % songs.size()], buffer);
+    }
+  }
+  std::filesystem::remove(scratch);
+}
+
+/// Noise of one level: level times each configured worker count
+class Noise {
+public:
+  Noise(const Options &options, const std::vector<std::string> &songs,
+        unsigned level) {
+    for (unsigned i = 0; i < options.cpu_hogs * level; ++i) {
+      workers_.emplace_back(hog_cpu);
+    }
+    for (unsigned i = 0; i < options.memory_threads * level; ++i) {
+      workers_.emplace_back(stream_memory, options.memory_mb * MIB);
+    }
+    for (unsigned i = 0; i < options.io_threads * level; ++i) {
+      workers_.emplace_back(storm_io, std::cref(options.io_dir),
+                            std::cref(songs), i);
+    }
+  }
+
+private:
+  std::vector<std::jthread> workers_;
+};
+
+/// Tracks the lowest output level away from track starts and ends
+auto watch_buffer(Player &player, const NullSink &device,
+                  std::chrono::steady_clock::time_point deadline)
+    -> std::optional<std::chrono::milliseconds> {
+  std::optional<std::chrono::milliseconds> lowest;
+  const auto settle = static_cast<int>(SETTLE_TIME.count());
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(SAMPLE_PERIOD);
+    const auto [elapsed, total] = player.get_progress();
+    const auto rate = device.format().bytes_per_second();
+    if (!player.is_playing() || rate == 0 || elapsed < settle ||
+        elapsed + settle >= total) {
+      continue;
+    }
+    const auto level = std::chrono::milliseconds(
+        uint64_t{device.queued_bytes()} * 1000 / rate);
+    lowest = std::min(lowest.value_or(level), level);
+  }
+  return lowest;
+}
+
+auto format_seconds(std::chrono::nanoseconds value) -> std::string {
+  std::array<char, 32> text{};
+  std::snprintf(text.data(), text.size(), "%.3f",
+                std::chrono::duration<double>(value).count());
+  return text.data();
+}
+
+void print_row(const LevelResult &result, const Options &options) {
+  std::array<char, 128> line{};
+  const auto min_buffer =
+      result.min_buffer ? std::to_string(result.min_buffer->count()) : "-";
+  std::snprintf(line.data(), line.size(),
+                "%5u %5u %5u %5u %10llu %15s %8llu %14llu\n", result.level,
+                options.cpu_hogs * result.level,
+                options.memory_threads * result.level,
+                options.io_threads * result.level,
+                static_cast<unsigned long long>(result.underruns),
+                min_buffer.c_str(),
+                static_cast<unsigned long long>(result.degradations),
+                static_cast<unsigned long long>(result.decode_errors));
+  std::cout << line.data();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  Options options;
+  try {
+    if (!parse_options(argc, argv, options)) {
+      std::cerr << "Usage: " << argv[0]
+                << " <folder|list.m3u> [--seconds S] [--levels N]"
+                   " [--cpu N] [--memory N] [--memory-mb M] [--io N]"
+                   " [--io-dir DIR]\n";
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid option value: " << e.what() << '\n';
+    return 1;
+  }
+
+  try {
+    auto sink = std::make_unique<NullSink>(Clock::steady());
+    auto *device = sink.get();
+    auto playlist = std::make_unique<Playlist>(options.source);
+    const auto songs = playlist->songs();
+    Player player(std::move(sink));
+    player.set_playlist(std::move(playlist));
+    player.resume();
+
+    const auto start = Clock::steady().now();
+    std::vector<LevelResult> results;
+    std::cout << "level   cpu   mem    io  underruns  min buffer[ms]"
+                 "  degrade  decode errors\n";
+    for (unsigned level = 0; level <= options.levels; ++level) {
+      const auto before = player.stats();
+      const auto underruns = device->underruns();
+      LevelResult result{.level = level};
+      {
+        Noise noise(options, songs, level);
+        result.min_buffer = watch_buffer(
+            player, *device,
+            std::chrono::steady_clock::now() + options.duration);
+      }
+      const auto after = player.stats();
+      result.underruns = device->underruns() - underruns;
+      result.degradations =
+          after.quality.degradations - before.quality.degradations;
+      result.decode_errors = after.decode_errors - before.decode_errors;
+      print_row(result, options);
+      results.push_back(result);
+    }
+    player.pause();
+
+    const auto glitches = device->glitches();
+    if (!glitches.empty()) {
+      std::cout << "glitches [s from start, gap ms]:\n";
+      for (const auto &glitch : glitches) {
+        std::cout << "  " << format_seconds(glitch.at - start) << "  "
+                  << std::chrono::duration<double, std::milli>(glitch.gap)
+                         .count()
+                  << '\n';
+      }
+    }
+
+    const auto failed =
+        std::ranges::find_if(results, [](const LevelResult &result) {
+          return result.underruns > 0;
+        });
+    if (failed == results.begin()) {
+      std::cout << "headroom: none, underruns without noise\n";
+    } else {
+      std::cout << "headroom: level " << std::prev(failed)->level
+                << (failed == results.end() ? " (no underruns)\n" : "\n");
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "[ERROR] " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
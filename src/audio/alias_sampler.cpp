@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "alias_sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+AliasSampler::AliasSampler(const std::vector<double> &weights)
+    : weights_(weights.begin(), weights.end()) {
+  for (auto &weight : weights_) {
+    weight = std::max(weight, 0.0);
+  }
+  block_size_ = std::max(
+      MIN_BLOCK,
+      static_cast<size_t>(std::sqrt(static_cast<double>(weights_.size()))));
+  const auto blocks = (weights_.size() + block_size_ - 1) / block_size_;
+  blocks_.resize(blocks);
+  totals_.resize(blocks);
+  for (size_t block = 0; block < blocks; ++block) {
+    build(block_weights(block), blocks_[block]);
+    totals_[block] = blocks_[block].total;
+  }
+  build(totals_, top_);
+}
+
+void AliasSampler::set_weight(size_t item, double weight) {
+  weights_.at(item) = std::max(weight, 0.0);
+  const auto block = item / block_size_;
+  build(block_weights(block), blocks_[block]);
+  totals_[block] = blocks_[block].total;
+  build(totals_, top_);
+}
+
+auto AliasSampler::pick(std::mt19937_64 &random) const -> size_t {
+  if (weights_.empty()) {
+    return 0;
+  }
+  const auto block = draw(top_, random);
+  return (block * block_size_) + draw(blocks_[block], random);
+}
+
+auto AliasSampler::weight(size_t item) const -> double {
+  return weights_.at(item);
+}
+
+auto AliasSampler::total() const -> double { return top_.total; }
+
+auto AliasSampler::size() const -> size_t { return weights_.size(); }
+
+void AliasSampler::build(std::span<const double> weights, Table &table) {
+  const auto count = weights.size();
+  table.probability.assign(count, 1.0);
+  table.alias.resize(count);
+  table.total = 0.0;
+  for (const auto weight : weights) {
+    table.total += weight;
+  }
+  for (size_t column = 0; column < count; ++column) {
+    table.alias[column] = static_cast<uint32_t>(column);
+  }
+  if (table.total <= 0.0) {
+    return; // Uniform: every column keeps itself
+  }
+
+  // Scale to an average of 1, then let each short column borrow the rest of
+  // its height from a tall one
+  std::vector<double> scaled(count);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (size_t column = 0; column < count; ++column) {
+    scaled[column] =
+        weights[column] * static_cast<double>(count) / table.total;
+    (scaled[column] < 1.0 ? small : large)
+        .push_back(static_cast<uint32_t>(column));
+  }
+  while (!small.empty() && !large.empty()) {
+    const auto short_column = small.back();
+    small.pop_back();
+    const auto tall_column = large.back();
+    table.probability[short_column] = scaled[short_column];
+    table.alias[short_column] = tall_column;
+    scaled[tall_column] -= 1.0 - scaled[short_column];
+    if (scaled[tall_column] < 1.0) {
+      large.pop_back();
+      small.push_back(tall_column);
+    }
+  }
+  // Whatever is left is 1 up to rounding error
+}
+
+auto AliasSampler::draw(const Table &table, std::mt19937_64 &random)
+    -> size_t {
+  std::uniform_int_distribution<size_t> column_of(0,
+                                                  table.probability.size() - 1);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  const auto column = column_of(random);
+  return chance(random) < table.probability[column] ? column
+                                                    : table.alias[column];
+}
+
+auto AliasSampler::block_weights(size_t block) const
+    -> std::span<const double> {
+  const auto begin = block * block_size_;
+  const auto end = std::min(begin + block_size_, weights_.size());
+  return std::span{weights_}.subspan(begin, end - begin);
+}
@@ -0,0 +1,98 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "../util/memory_accounting.hpp"
+
+/**
+ * @class AliasSampler
+ * @brief Picks indices with probability proportional to their weights in
+ * O(1), using Walker's alias method.
+ *
+ * Items are split into blocks of about sqrt(n). Each block has its own
+ * alias table, and a top-level table picks a block by its total weight. A
+ * pick is one lookup in each, and changing one weight rebuilds only its
+ * block and the top level: O(sqrt(n)) instead of O(n).
+ *
+ * If every weight is zero, all items are equally likely.
+ */
+class AliasSampler {
+public:
+  static constexpr size_t MIN_BLOCK = 64; ///< Smallest block size
+
+  /**
+   * @brief Builds the tables.
+   * @param weights Non-negative weight of each item; negative counts as 0.
+   */
+  explicit AliasSampler(const std::vector<double> &weights);
+
+  /**
+   * @brief Changes the weight of one item.
+   * @param item Index of the item.
+   * @param weight New non-negative weight.
+   */
+  void set_weight(size_t item, double weight);
+
+  /**
+   * @brief Picks an item.
+   * @param random Source of randomness.
+   * @return Index of the item, or 0 if there are none.
+   */
+  [[nodiscard]] auto pick(std::mt19937_64 &random) const -> size_t;
+
+  /**
+   * @brief Gets the weight of an item.
+   * @param item Index of the item.
+   * @return Its weight.
+   */
+  [[nodiscard]] auto weight(size_t item) const -> double;
+
+  /**
+   * @brief Gets the sum of all weights.
+   * @return Total weight.
+   */
+  [[nodiscard]] auto total() const -> double;
+
+  /**
+   * @brief Gets the number of items.
+   * @return Item count.
+   */
+  [[nodiscard]] auto size() const -> size_t;
+
+private:
+  using Doubles = TaggedVector<double, MemoryTag::SHUFFLE>;
+  using Columns = TaggedVector<uint32_t, MemoryTag::SHUFFLE>;
+
+  /// One alias table over a contiguous run of weights
+  struct Table {
+    Doubles probability; ///< Chance of keeping each column
+    Columns alias;       ///< Where each column goes otherwise
+    double total{0.0};   ///< Sum of the weights
+  };
+
+  /// Builds a table with Vose's method in O(weights.size())
+  static void build(std::span<const double> weights, Table &table);
+
+  /// Draws a column of a table, then keeps it or takes its alias
+  static auto draw(const Table &table, std::mt19937_64 &random) -> size_t;
+
+  /// Gets the weights of one block
+  [[nodiscard]] auto block_weights(size_t block) const
+      -> std::span<const double>;
+
+  Doubles weights_;       ///< Weight of each item
+  size_t block_size_{1};  ///< Items per block, the last may be short
+  TaggedVector<Table, MemoryTag::SHUFFLE> blocks_; ///< Table of each block
+  Doubles totals_;        ///< Total weight of each block
+  Table top_;             ///< Alias table over the blocks
+};
@@ -0,0 +1,86 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstdint>
+#include <span>
+
+/**
+ * @struct AudioFormat
+ * @brief Layout of the interleaved signed 16-bit PCM handed to sinks.
+ */
+struct AudioFormat {
+  int32_t sample_rate{0}; ///< Frames per second
+  int channels{0};        ///< Interleaved channels per frame
+
+  auto operator==(const AudioFormat &other) const -> bool = default;
+
+  /**
+   * @brief Gets the PCM byte rate.
+   * @return Bytes per second of audio in this format.
+   */
+  [[nodiscard]] constexpr auto bytes_per_second() const -> uint32_t {
+    return static_cast<uint32_t>(sample_rate) *
+           static_cast<uint32_t>(channels) * sizeof(int16_t);
+  }
+};
+
+/**
+ * @class AudioSink
+ * @brief Destination for the decoded, post-DSP PCM stream.
+ *
+ * The Player decodes once and writes every processed block to its sink. A
+ * sink may be an audio device, a file, a network encoder, or a fan-out
+ * feeding several of them.
+ *
+ * Sinks are opened paused; the Player resumes them when playback starts.
+ */
+class AudioSink {
+public:
+  AudioSink() = default;
+  virtual ~AudioSink() = default;
+
+  AudioSink(AudioSink &sink) = delete;
+  AudioSink(AudioSink &&sink) = delete;
+
+  auto operator=(AudioSink &sink) -> AudioSink & = delete;
+  auto operator=(AudioSink &&sink) -> AudioSink && = delete;
+
+  /**
+   * @brief Opens the sink, or reopens it for a new format, paused.
+   * @param format Format of subsequent writes.
+   * @throws std::runtime_error if the output cannot be opened.
+   */
+  virtual void open(const AudioFormat &format) = 0;
+
+  /**
+   * @brief Queues interleaved samples for output.
+   * @param samples Interleaved signed 16-bit samples.
+   */
+  virtual void write(std::span<const int16_t> samples) = 0;
+
+  /**
+   * @brief Gets how much audio is queued but not yet output.
+   * @return Queued bytes; the Player paces decoding on this value.
+   */
+  [[nodiscard]] virtual auto queued_bytes() const -> uint32_t = 0;
+
+  /// Drops all queued audio, e.g. after a seek.
+  virtual void clear() = 0;
+
+  /// Stops consuming queued audio.
+  virtual void pause() = 0;
+
+  /// Resumes consuming queued audio.
+  virtual void resume() = 0;
+
+  /**
+   * @brief Checks whether open() succeeded.
+   * @return true if the sink accepts writes.
+   */
+  [[nodiscard]] virtual auto is_open() const -> bool = 0;
+};
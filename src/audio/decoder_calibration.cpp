@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "decoder_calibration.hpp"
+
+#include <mpg123.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// MPEG-1 Layer III, no CRC, 128 kbit/s, 44.1 kHz, stereo, original
+constexpr std::array<unsigned char, 4> FRAME_HEADER{0xFF, 0xFB, 0x90, 0x04};
+constexpr size_t FRAME_BYTES = 417; ///< 144 * 128000 / 44100, unpadded
+constexpr size_t PCM_BLOCK = 8192;  ///< Same as Player's decode block
+
+/// Decodes the frames ROUNDS times with one decoder, keeping the best time
+auto time_decoder(const char *name, const std::vector<unsigned char> &frames)
+    -> std::optional<std::chrono::nanoseconds> {
+  int error = MPG123_OK;
+  mpg123_handle *handle = mpg123_new(name, &error);
+  if (handle == nullptr) {
+    return std::nullopt;
+  }
+  mpg123_param(handle, MPG123_ADD_FLAGS, MPG123_QUIET, 0);
+  std::vector<unsigned char> pcm(PCM_BLOCK);
+  std::optional<std::chrono::nanoseconds> best;
+  for (int round = 0; round < DecoderCalibration::ROUNDS; ++round) {
+    if (mpg123_open_feed(handle) != MPG123_OK) {
+      break;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    mpg123_feed(handle, frames.data(), frames.size());
+    size_t decoded = 0;
+    size_t done = 0;
+    int result = MPG123_OK;
+    while ((result = mpg123_read(handle, pcm.data(), pcm.size(), &done)) ==
+               MPG123_OK ||
+           result == MPG123_NEW_FORMAT) {
+      decoded += done;
+    }
+    const auto time = std::chrono::steady_clock::now() - start;
+    mpg123_close(handle);
+    if (decoded == 0) {
+      best.reset();
+      break;
+    }
+    best = std::min(best.value_or(std::chrono::nanoseconds::max()),
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+  }
+  mpg123_delete(handle);
+  return best;
+}
+
+} // namespace
+
+DecoderCalibration::DecoderCalibration(fs::path cache_file)
+    : cache_file_(std::move(cache_file)) {}
+
+auto DecoderCalibration::select(bool recalibrate) -> std::string {
+  if (!recalibrate) {
+    if (auto decoder = cached()) {
+      return *decoder;
+    }
+  }
+  const auto timings = measure();
+  if (timings.empty()) {
+    std::cerr << "[WARN] No mpg123 decoder could be calibrated\n";
+    return {};
+  }
+  std::error_code error;
+  fs::create_directories(cache_file_.parent_path(), error);
+  std::ofstream out(cache_file_, std::ios::trunc);
+  out << fingerprint() << '\n' << timings.front().name << '\n';
+  if (!out) {
+    std::cerr << "[WARN] Cannot write " << cache_file_ << "\n";
+  }
+  return timings.front().name;
+}
+
+auto DecoderCalibration::cached() const -> std::optional<std::string> {
+  std::ifstream in(cache_file_);
+  std::string key;
+  std::string decoder;
+  if (!std::getline(in, key) || !std::getline(in, decoder) ||
+      key != fingerprint() || decoder.empty()) {
+    return std::nullopt;
+  }
+  return decoder;
+}
+
+auto DecoderCalibration::measure() -> std::vector<DecoderTiming> {
+  mpg123_init();
+  const auto frames = frame_set();
+  std::vector<DecoderTiming> timings;
+  const char **names = mpg123_supported_decoders();
+  for (; names != nullptr && *names != nullptr; ++names) {
+    if (const auto time = time_decoder(*names, frames)) {
+      timings.push_back({*names, *time});
+    }
+  }
+  std::ranges::sort(timings, {}, &DecoderTiming::time);
+  return timings;
+}
+
+auto DecoderCalibration::frame_set() -> std::vector<unsigned char> {
+  // Zeroed side info and main data: every granule decodes to silence
+  std::vector<unsigned char> frames(FRAMES * FRAME_BYTES, 0);
+  for (size_t frame = 0; frame < FRAMES; ++frame) {
+    std::ranges::copy(FRAME_HEADER, frames.begin() + static_cast<std::ptrdiff_t>(
+                                                         frame * FRAME_BYTES));
+  }
+  return frames;
+}
+
+auto DecoderCalibration::default_cache_file() -> fs::path {
+  if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr) {
+    return fs::path(xdg) / "jpod_nano" / "decoder";
+  }
+  if (const char *home = std::getenv("HOME"); home != nullptr) {
+    return fs::path(home) / ".cache" / "jpod_nano" / "decoder";
+  }
+  return fs::temp_directory_path() / "jpod_nano" / "decoder";
+}
+
+auto DecoderCalibration::fingerprint() -> std::string {
+  // x86 names the model; ARM identifies the core by implementer and part
+  std::string cpu;
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  for (const auto *key : {"model name", "CPU implementer", "CPU part"}) {
+    cpuinfo.clear();
+    cpuinfo.seekg(0);
+    while (std::getline(cpuinfo, line)) {
+      if (line.starts_with(key)) {
+        const auto value = line.find_first_not_of(" \t", line.find(':') + 1);
+        cpu += (value == std::string::npos ? "" : line.substr(value)) + ' ';
+        break;
+      }
+    }
+  }
+  std::string decoders;
+  mpg123_init();
+  const char **names = mpg123_supported_decoders();
+  for (; names != nullptr && *names != nullptr; ++names) {
+    decoders += std::string(*names) + ',';
+  }
+  return "cpu=" + cpu + "decoders=" + decoders;
+}
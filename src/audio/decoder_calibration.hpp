@@ -0,0 +1,84 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct DecoderTiming
+ * @brief Time one mpg123 decoder took for the calibration frame set.
+ */
+struct DecoderTiming {
+  std::string name;              ///< mpg123 decoder name
+  std::chrono::nanoseconds time; ///< Best of DecoderCalibration::ROUNDS
+};
+
+/**
+ * @class DecoderCalibration
+ * @brief Picks the fastest libmpg123 synth decoder for this CPU.
+ *
+ * Every decoder mpg123_supported_decoders() reports decodes the same
+ * built-in set of Layer III frames, and the fastest wins. The frames carry
+ * silence, which costs the synthesis filterbank, where the decoders differ,
+ * exactly as much as music does.
+ *
+ * The choice is cached in a small text file keyed by the CPU model and the
+ * list of decoders, so it is measured again only when either changes.
+ */
+class DecoderCalibration {
+public:
+  static constexpr size_t FRAMES = 400; ///< About 10 s of audio
+  static constexpr int ROUNDS = 3;      ///< Timed decodes per decoder
+
+  /**
+   * @brief Constructs a calibration.
+   * @param cache_file Where the choice is persisted.
+   */
+  explicit DecoderCalibration(
+      std::filesystem::path cache_file = default_cache_file());
+
+  /**
+   * @brief Gets the cached choice, or measures and caches a new one.
+   * @param recalibrate Measure even if the cache is valid.
+   * @return Name of the decoder to use, empty if none could be measured.
+   */
+  auto select(bool recalibrate = false) -> std::string;
+
+  /**
+   * @brief Reads the cached choice.
+   * @return The decoder, if the cache exists and matches this machine.
+   */
+  [[nodiscard]] auto cached() const -> std::optional<std::string>;
+
+  /**
+   * @brief Times every supported decoder on the frame set.
+   * @return Timings, fastest first; decoders that fail are left out.
+   */
+  [[nodiscard]] static auto measure() -> std::vector<DecoderTiming>;
+
+  /**
+   * @brief Builds the built-in frame set.
+   * @return FRAMES MPEG-1 Layer III frames, 44.1 kHz stereo at 128 kbit/s.
+   */
+  [[nodiscard]] static auto frame_set() -> std::vector<unsigned char>;
+
+  /**
+   * @brief Gets the default cache file.
+   * @return $XDG_CACHE_HOME/jpod_nano/decoder, or under ~/.cache.
+   */
+  [[nodiscard]] static auto default_cache_file() -> std::filesystem::path;
+
+private:
+  /// Identifies the CPU and libmpg123 build the cache is valid for
+  [[nodiscard]] static auto fingerprint() -> std::string;
+
+  std::filesystem::path cache_file_; ///< Persisted choice
+};
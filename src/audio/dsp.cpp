@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "dsp.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+namespace {
+
+auto saturate(float value) -> int16_t {
+  return static_cast<int16_t>(
+      std::clamp(value, static_cast<float>(std::numeric_limits<int16_t>::min()),
+                 static_cast<float>(std::numeric_limits<int16_t>::max())));
+}
+
+void apply_gain(std::span<int16_t> samples, float gain) {
+  for (auto &sample : samples) {
+    sample = saturate(static_cast<float>(sample) * gain);
+  }
+}
+
+void apply_ramp(std::span<int16_t> samples, int channels, float from,
+                float to) {
+  const auto width = static_cast<size_t>(std::max(channels, 1));
+  const auto frames = samples.size() / width;
+  if (frames == 0) {
+    return;
+  }
+  const float step = (to - from) / static_cast<float>(frames);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const float gain = from + (step * static_cast<float>((i / width) + 1));
+    samples[i] = saturate(static_cast<float>(samples[i]) * gain);
+  }
+}
+
+void to_float(std::span<const int16_t> input, float *output) {
+  std::copy(input.begin(), input.end(), output);
+}
+
+constexpr DspKernels SCALAR{"scalar", apply_gain, apply_ramp, to_float};
+
+} // namespace
+
+auto dsp_scalar() -> const DspKernels & { return SCALAR; }
+
+auto dsp_available() -> std::vector<const DspKernels *> {
+  std::vector<const DspKernels *> kernels{&SCALAR};
+  if (const auto *neon = dsp_neon(); neon != nullptr) {
+    kernels.push_back(neon);
+  }
+  return kernels;
+}
+
+auto dsp_kernels() -> const DspKernels & {
+  static const DspKernels &selected = []() -> const DspKernels & {
+    const auto kernels = dsp_available();
+    if (const char *name = std::getenv("JPOD_NANO_DSP"); name != nullptr) {
+      const auto found =
+          std::ranges::find_if(kernels, [name](const DspKernels *kernel) {
+            return std::string_view(kernel->name) == name;
+          });
+      if (found != kernels.end()) {
+        return **found;
+      }
+      std::cerr << "[WARN] Unknown DSP kernels " << name << ", using "
+                << kernels.back()->name << "\n";
+    }
+    return *kernels.back();
+  }();
+  return selected;
+}
@@ -0,0 +1,79 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @struct DspKernels
+ * @brief One implementation of the per-sample kernels of the output chain.
+ *
+ * Every implementation produces the same output as the scalar one, apart
+ * from rounding of the ramp gain, which may differ by one LSB where the
+ * compiler fuses the scalar multiply-add.
+ */
+struct DspKernels {
+  const char *name; ///< "scalar", "neon"
+
+  /**
+   * @brief Scales samples in place, saturating to the int16_t range.
+   * @param samples Interleaved samples.
+   * @param gain Linear gain.
+   */
+  void (*apply_gain)(std::span<int16_t> samples, float gain);
+
+  /**
+   * @brief Scales samples by a gain moving linearly across the block.
+   *
+   * Frame f of n gets from + (to - from) * (f + 1) / n, so the block ends
+   * exactly at `to` and consecutive ramps join without a step.
+   *
+   * @param samples Interleaved samples.
+   * @param channels Interleaved channels per frame.
+   * @param from Gain before the first frame.
+   * @param to Gain at the last frame.
+   */
+  void (*apply_ramp)(std::span<int16_t> samples, int channels, float from,
+                     float to);
+
+  /**
+   * @brief Converts samples to float without scaling.
+   * @param input Samples to convert.
+   * @param output Destination for input.size() values.
+   */
+  void (*to_float)(std::span<const int16_t> input, float *output);
+};
+
+/**
+ * @brief Gets the portable reference kernels.
+ * @return The scalar implementation.
+ */
+auto dsp_scalar() -> const DspKernels &;
+
+/**
+ * @brief Gets the ARM NEON kernels.
+ * @return The NEON implementation, or nullptr if not built for NEON.
+ */
+auto dsp_neon() -> const DspKernels *;
+
+/**
+ * @brief Lists the kernels usable on this machine.
+ * @return Implementations, scalar first and fastest last.
+ */
+auto dsp_available() -> std::vector<const DspKernels *>;
+
+/**
+ * @brief Gets the kernels the output chain uses.
+ *
+ * The fastest available, unless the JPOD_NANO_DSP environment variable names
+ * another one. Selected once, on first use.
+ *
+ * @return The selected implementation.
+ */
+auto dsp_kernels() -> const DspKernels &;
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "dsp.hpp"
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr size_t LANES = 8; ///< int16_t samples per vector
+
+/// Scales 8 samples, 4 per gain vector, truncating and saturating
+auto scale(int16x8_t samples, float32x4_t low_gain, float32x4_t high_gain)
+    -> int16x8_t {
+  const auto low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+  const auto high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+  return vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vmulq_f32(low, low_gain))),
+                      vqmovn_s32(vcvtq_s32_f32(vmulq_f32(high, high_gain))));
+}
+
+auto saturate(float value) -> int16_t {
+  return static_cast<int16_t>(
+      std::clamp(value, static_cast<float>(std::numeric_limits<int16_t>::min()),
+                 static_cast<float>(std::numeric_limits<int16_t>::max())));
+}
+
+void apply_gain(std::span<int16_t> samples, float gain) {
+  const auto gains = vdupq_n_f32(gain);
+  size_t i = 0;
+  for (; i + LANES <= samples.size(); i += LANES) {
+    vst1q_s16(samples.data() + i,
+              scale(vld1q_s16(samples.data() + i), gains, gains));
+  }
+  dsp_scalar().apply_gain(samples.subspan(i), gain);
+}
+
+void apply_ramp(std::span<int16_t> samples, int channels, float from,
+                float to) {
+  if (channels != 1 && channels != 2) {
+    // Frame indices of other layouts do not map onto whole vectors
+    dsp_scalar().apply_ramp(samples, channels, from, to);
+    return;
+  }
+  const auto width = static_cast<size_t>(channels);
+  const auto frames = samples.size() / width;
+  if (frames == 0) {
+    return;
+  }
+  const float step = (to - from) / static_cast<float>(frames);
+
+  // Frame number + 1 of each lane, relative to the first sample of a vector
+  static constexpr float MONO[LANES] = {1, 2, 3, 4, 5, 6, 7, 8};
+  static constexpr float STEREO[LANES] = {1, 1, 2, 2, 3, 3, 4, 4};
+  const float *offsets = width == 1 ? MONO : STEREO;
+  const auto low_offset = vld1q_f32(offsets);
+  const auto high_offset = vld1q_f32(offsets + 4);
+  const auto froms = vdupq_n_f32(from);
+  const auto steps = vdupq_n_f32(step);
+
+  size_t i = 0;
+  for (; i + LANES <= samples.size(); i += LANES) {
+    const auto base = vdupq_n_f32(static_cast<float>(i / width));
+    const auto low_gain =
+        vaddq_f32(froms, vmulq_f32(steps, vaddq_f32(base, low_offset)));
+    const auto high_gain =
+        vaddq_f32(froms, vmulq_f32(steps, vaddq_f32(base, high_offset)));
+    vst1q_s16(samples.data() + i,
+              scale(vld1q_s16(samples.data() + i), low_gain, high_gain));
+  }
+  for (; i < samples.size(); ++i) {
+    const float gain = from + (step * static_cast<float>((i / width) + 1));
+    samples[i] = saturate(static_cast<float>(samples[i]) * gain);
+  }
+}
+
+void to_float(std::span<const int16_t> input, float *output) {
+  size_t i = 0;
+  for (; i + LANES <= input.size(); i += LANES) {
+    const auto samples = vld1q_s16(input.data() + i);
+    vst1q_f32(output + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))));
+    vst1q_f32(output + i + 4,
+              vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))));
+  }
+  dsp_scalar().to_float(input.subspan(i), output + i);
+}
+
+constexpr DspKernels NEON{"neon", apply_gain, apply_ramp, to_float};
+
+} // namespace
+
+auto dsp_neon() -> const DspKernels * { return &NEON; }
+
+#else
+
+auto dsp_neon() -> const DspKernels * { return nullptr; }
+
+#endif
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "fan_out_sink.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr int64_t MS_PER_SECOND = 1000;
+
+auto samples_for(std::chrono::milliseconds latency, int32_t rate,
+                 int channels) -> size_t {
+  return static_cast<size_t>(latency.count() * rate * channels /
+                             MS_PER_SECOND);
+}
+
+} // namespace
+
+FanOutSink::Output::Output(std::unique_ptr<AudioSink> output_sink,
+                           std::chrono::milliseconds output_latency)
+    : sink(std::move(output_sink)), latency(output_latency),
+      ring(samples_for(output_latency, MAX_SAMPLE_RATE, MAX_CHANNELS)) {}
+
+FanOutSink::FanOutSink(std::unique_ptr<AudioSink> primary)
+    : primary_(std::move(primary)) {
+  if (!primary_) {
+    throw std::runtime_error("FanOutSink requires a primary sink");
+  }
+}
+
+FanOutSink::~FanOutSink() {
+  for (auto &output : outputs_) {
+    output->worker.request_stop();
+    wake(*output);
+    output->worker.join();
+  }
+}
+
+auto FanOutSink::add_output(std::unique_ptr<AudioSink> sink,
+                            std::chrono::milliseconds latency) -> size_t {
+  auto output = std::make_unique<Output>(std::move(sink), latency);
+  auto &ref = *output;
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  if (format_.sample_rate > 0) {
+    configure(ref, format_);
+  }
+  ref.paused.store(paused_);
+  ref.worker = std::jthread(
+      [&ref](const std::stop_token &token) { drain(ref, token); });
+  outputs_.push_back(std::move(output));
+  auto snapshot = std::make_shared<Snapshot>();
+  snapshot->reserve(outputs_.size());
+  for (const auto &added : outputs_) {
+    snapshot->push_back(added.get());
+  }
+  snapshot_.store(std::move(snapshot));
+  return outputs_.size() - 1;
+}
+
+auto FanOutSink::output_count() const -> size_t {
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  return outputs_.size();
+}
+
+auto FanOutSink::dropped_samples(size_t index) const -> uint64_t {
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  return outputs_.at(index)->dropped.load();
+}
+
+auto FanOutSink::primary() -> AudioSink & { return *primary_; }
+
+void FanOutSink::open(const AudioFormat &format) {
+  primary_->open(format);
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  format_ = format;
+  paused_ = true;
+  for (auto &output : outputs_) {
+    output->paused.store(true);
+    configure(*output, format);
+    wake(*output);
+  }
+}
+
+void FanOutSink::write(std::span<const int16_t> samples) {
+  primary_->write(samples);
+  // Called per block: no lock, and the list never changes under the loop
+  const auto outputs = snapshot_.load();
+  for (auto *output : *outputs) {
+    // Never wait for a slow output: drop the block for it instead
+    if (output->ring.size() + samples.size() > output->limit.load() ||
+        !output->ring.push(samples)) {
+      output->dropped.fetch_add(samples.size());
+      continue;
+    }
+    wake(*output);
+  }
+}
+
+auto FanOutSink::queued_bytes() const -> uint32_t {
+  return primary_->queued_bytes();
+}
+
+void FanOutSink::clear() {
+  primary_->clear();
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  for (auto &output : outputs_) {
+    output->flush_position.store(output->ring.write_position());
+    output->clear_generation.fetch_add(1);
+    wake(*output);
+  }
+}
+
+void FanOutSink::pause() {
+  primary_->pause();
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  paused_ = true;
+  for (auto &output : outputs_) {
+    output->paused.store(true);
+    wake(*output);
+  }
+}
+
+void FanOutSink::resume() {
+  primary_->resume();
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  paused_ = false;
+  for (auto &output : outputs_) {
+    output->paused.store(false);
+    wake(*output);
+  }
+}
+
+auto FanOutSink::is_open() const -> bool { return primary_->is_open(); }
+
+void FanOutSink::configure(Output &output, const AudioFormat &format) {
+  {
+    std::lock_guard<std::mutex> lock(output.format_mutex);
+    output.format = format;
+  }
+  output.limit.store(std::min(
+      output.ring.capacity(),
+      samples_for(output.latency, format.sample_rate, format.channels)));
+  // Audio queued before the new format must not reach the reopened sink
+  output.flush_position.store(output.ring.write_position());
+  output.format_generation.fetch_add(1);
+}
+
+void FanOutSink::wake(Output &output) {
+  output.wakeups.fetch_add(1);
+  output.wakeups.notify_one();
+}
+
+void FanOutSink::drain(Output &output, const std::stop_token &token) {
+  uint64_t applied_format = 0;
+  uint64_t applied_clear = 0;
+  bool applied_paused = true;
+
+  while (!token.stop_requested()) {
+    const auto seen = output.wakeups.load();
+
+    const auto format_generation = output.format_generation.load();
+    const auto clear_generation = output.clear_generation.load();
+    if (format_generation != applied_format ||
+        clear_generation != applied_clear) {
+      const auto flush = output.flush_position.load();
+      const auto read = output.ring.read_position();
+      if (flush > read) {
+        output.ring.consume(flush - read);
+      }
+      if (format_generation != applied_format) {
+        AudioFormat format;
+        {
+          std::lock_guard<std::mutex> lock(output.format_mutex);
+          format = output.format;
+        }
+        try {
+          output.sink->open(format);
+        } catch (const std::exception &e) {
+          std::cerr << "[WARN] Fan-out output failed to open: " << e.what()
+                    << '\n';
+        }
+        applied_paused = true;
+        applied_format = format_generation;
+      } else {
+        output.sink->clear();
+      }
+      applied_clear = clear_generation;
+    }
+
+    const bool paused = output.paused.load();
+    if (paused != applied_paused) {
+      paused ? output.sink->pause() : output.sink->resume();
+      applied_paused = paused;
+    }
+
+    auto [first, second] = output.ring.peek();
+    if (!first.empty()) {
+      output.sink->write(first);
+      if (!second.empty()) {
+        output.sink->write(second);
+      }
+      output.ring.consume(first.size() + second.size());
+      continue;
+    }
+    output.wakeups.wait(seen);
+  }
+}
@@ -0,0 +1,139 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "audio_sink.hpp"
+#include "ring_buffer.hpp"
+
+/**
+ * @class FanOutSink
+ * @brief Tee stage feeding one decoded stream to several sinks.
+ *
+ * The primary sink (normally the audio device) is written synchronously and
+ * paces decoding. Every additional output gets its own lock-free ring sized
+ * to its latency budget and a worker thread draining it, so a slow output
+ * (disk, network) never stalls the device or the other outputs: when an
+ * output's ring is full, the block is dropped for that output only and
+ * counted.
+ *
+ * Control calls (open, clear, pause, resume) are forwarded to the outputs
+ * through their workers, ordered with respect to the audio already queued.
+ * write() takes no lock: it walks an immutable snapshot of the output list
+ * that add_output() republishes.
+ */
+class FanOutSink : public AudioSink {
+public:
+  static constexpr auto DEFAULT_LATENCY = std::chrono::milliseconds(500);
+  static constexpr int32_t MAX_SAMPLE_RATE = 192000; ///< Ring sizing bound
+  static constexpr int MAX_CHANNELS = 2;             ///< Ring sizing bound
+
+  /**
+   * @brief Constructs a fan-out around the pacing sink.
+   * @param primary The sink that paces decoding.
+   */
+  explicit FanOutSink(std::unique_ptr<AudioSink> primary);
+
+  /**
+   * @brief Destructor.
+   * Stops all output workers.
+   */
+  ~FanOutSink() override;
+
+  FanOutSink(FanOutSink &sink) = delete;
+  FanOutSink(FanOutSink &&sink) = delete;
+
+  auto operator=(FanOutSink &sink) -> FanOutSink & = delete;
+  auto operator=(FanOutSink &&sink) -> FanOutSink && = delete;
+
+  /**
+   * @brief Adds an output fed from the same stream.
+   * @param sink The additional sink.
+   * @param latency Audio the output may lag behind before blocks are dropped.
+   * @return Index of the output, for dropped_samples().
+   */
+  auto add_output(std::unique_ptr<AudioSink> sink,
+                  std::chrono::milliseconds latency = DEFAULT_LATENCY)
+      -> size_t;
+
+  /**
+   * @brief Gets the number of additional outputs.
+   * @return Output count, excluding the primary sink.
+   */
+  [[nodiscard]] auto output_count() const -> size_t;
+
+  /**
+   * @brief Gets how many samples an output lost to a full ring.
+   * @param index Output index returned by add_output().
+   * @return Dropped interleaved samples.
+   */
+  [[nodiscard]] auto dropped_samples(size_t index) const -> uint64_t;
+
+  /**
+   * @brief Accesses the pacing sink.
+   * @return The primary sink.
+   */
+  [[nodiscard]] auto primary() -> AudioSink &;
+
+  void open(const AudioFormat &format) override;
+  void write(std::span<const int16_t> samples) override;
+  [[nodiscard]] auto queued_bytes() const -> uint32_t override;
+  void clear() override;
+  void pause() override;
+  void resume() override;
+  [[nodiscard]] auto is_open() const -> bool override;
+
+private:
+  /**
+   * @struct Output
+   * @brief An additional sink with its ring, pending commands and worker.
+   */
+  struct Output {
+    std::unique_ptr<AudioSink> sink;          ///< Destination
+    std::chrono::milliseconds latency;        ///< Lag budget
+    PcmRing ring;                             ///< Samples not yet written
+    std::atomic<size_t> limit{0};             ///< Samples allowed in ring
+    std::mutex format_mutex;                  ///< Protects format
+    AudioFormat format;                       ///< Format to open with
+    std::atomic<uint64_t> format_generation{0}; ///< Bumped by open()
+    std::atomic<uint64_t> clear_generation{0};  ///< Bumped by clear()
+    std::atomic<size_t> flush_position{0};    ///< Ring position to drop up to
+    std::atomic<bool> paused{true};           ///< Requested pause state
+    std::atomic<uint64_t> wakeups{0};         ///< Worker wake counter
+    std::atomic<uint64_t> dropped{0};         ///< Samples lost to overflow
+    std::jthread worker;                      ///< Drains ring into sink
+
+    Output(std::unique_ptr<AudioSink> output_sink,
+           std::chrono::milliseconds output_latency);
+  };
+
+  /// Worker loop applying commands and writing queued audio to a sink.
+  static void drain(Output &output, const std::stop_token &token);
+
+  /// Wakes an output's worker.
+  static void wake(Output &output);
+
+  /// Applies a format to an output's ring limit and queues its open().
+  static void configure(Output &output, const AudioFormat &format);
+
+  /// Outputs as seen by write(); they live as long as the fan-out
+  using Snapshot = std::vector<Output *>;
+
+  std::unique_ptr<AudioSink> primary_;          ///< Pacing sink
+  mutable std::mutex outputs_mutex_;            ///< Protects outputs_
+  std::vector<std::unique_ptr<Output>> outputs_; ///< Additional outputs
+  std::atomic<std::shared_ptr<const Snapshot>> snapshot_{
+      std::make_shared<const Snapshot>()}; ///< outputs_ for write()
+  AudioFormat format_;                          ///< Last opened format
+  bool paused_{true};                           ///< Last pause state
+};
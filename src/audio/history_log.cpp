@@ -0,0 +1,367 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "history_log.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#include "resume_state.hpp"
+
+namespace fs = std::filesystem;
+
+struct HistoryLog::IndexHeader {
+  static constexpr uint32_t MAGIC = 0x4A504849; // "JPHI"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;        ///< MAGIC
+  uint32_t version;      ///< VERSION
+  uint64_t capacity;     ///< Table slots, a power of 2
+  uint64_t tracks;       ///< Used slots
+  uint64_t applied;      ///< Log records folded in
+  uint64_t recent_count; ///< Plays ever put in recent
+  std::array<PlayRecord, RECENT_PLAYS> recent; ///< Ring of the latest plays
+};
+
+namespace {
+
+constexpr size_t REPLAY_BATCH = 4096; ///< Records read per pread()
+
+/// Order of top_tracks(): most plays first, ties by most recent play
+auto ranks_before(const TrackStats &a, const TrackStats &b) -> bool {
+  return a.plays != b.plays ? a.plays > b.plays
+                            : a.last_played_ms > b.last_played_ms;
+}
+
+} // namespace
+
+auto TrackStats::skip_rate() const -> double {
+  return plays == 0 ? 0.0
+                    : static_cast<double>(skips) / static_cast<double>(plays);
+}
+
+HistoryLog::HistoryLog(fs::path directory) : directory_(std::move(directory)) {
+  std::error_code error;
+  fs::create_directories(directory_, error);
+  const auto log_path = directory_ / "history.log";
+  log_fd_ = ::open(log_path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                   0644);
+  if (log_fd_ < 0) {
+    throw std::runtime_error("Cannot open " + log_path.string());
+  }
+  struct stat info {};
+  fstat(log_fd_, &info);
+  const auto records = static_cast<uint64_t>(info.st_size) / sizeof(PlayRecord);
+  if (static_cast<uint64_t>(info.st_size) % sizeof(PlayRecord) != 0) {
+    // Torn by a crash mid-append; the play was never counted
+    (void)!ftruncate(log_fd_, static_cast<off_t>(records * sizeof(PlayRecord)));
+  }
+  try {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    map_index(MIN_CAPACITY, false);
+    catch_up(records);
+    rebuild_top();
+  } catch (...) {
+    ::close(log_fd_);
+    throw;
+  }
+  writer_ = std::jthread(
+      [this](const std::stop_token &token) { writer_thread(token); });
+}
+
+HistoryLog::~HistoryLog() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    writer_.request_stop();
+  }
+  queued_.notify_all();
+  writer_.join();
+  munmap(header_, mapped_bytes_);
+  ::close(log_fd_);
+}
+
+void HistoryLog::record(uint64_t track,
+                        std::chrono::system_clock::time_point start,
+                        std::chrono::milliseconds listened, bool skipped) {
+  const PlayRecord play{
+      track,
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          start.time_since_epoch())
+          .count(),
+      static_cast<uint32_t>(std::clamp<int64_t>(
+          listened.count(), 0, std::numeric_limits<uint32_t>::max())),
+      skipped ? PlayRecord::SKIPPED : 0U};
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    try {
+      queue_.push_back(play);
+    } catch (const std::bad_alloc &) {
+      // Over the index budget: lose the play, not the caller's thread
+      std::cerr << "[WARN] Listening history over its memory budget; play "
+                   "not recorded\n";
+      return;
+    }
+    ++queued_count_;
+  }
+  queued_.notify_one();
+}
+
+void HistoryLog::flush() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  const auto target = queued_count_;
+  written_.wait(lock, [this, target] { return written_count_ >= target; });
+}
+
+auto HistoryLog::stats(uint64_t track) const -> std::optional<TrackStats> {
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  const auto &slot = find_slot(track);
+  if (slot.track == 0) {
+    return std::nullopt;
+  }
+  return slot;
+}
+
+auto HistoryLog::top_tracks(size_t count) const -> std::vector<TrackStats> {
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  const auto end = std::min(count, top_.size());
+  return {top_.begin(), top_.begin() + static_cast<std::ptrdiff_t>(end)};
+}
+
+auto HistoryLog::recently_played(size_t count) const
+    -> std::vector<PlayRecord> {
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  const auto available = std::min<uint64_t>(header_->recent_count, RECENT_PLAYS);
+  std::vector<PlayRecord> recent;
+  for (uint64_t back = 1; back <= std::min<uint64_t>(count, available);
+       ++back) {
+    recent.push_back(
+        header_->recent[(header_->recent_count - back) % RECENT_PLAYS]);
+  }
+  return recent;
+}
+
+auto HistoryLog::total_plays() const -> uint64_t {
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  return header_->applied;
+}
+
+auto HistoryLog::track_id(std::string_view path) -> uint64_t {
+  // 0 marks an empty table slot
+  return std::max<uint64_t>(1, ResumeState::hash(path));
+}
+
+auto HistoryLog::default_directory() -> fs::path {
+  if (const char *xdg = std::getenv("XDG_STATE_HOME"); xdg != nullptr) {
+    return fs::path(xdg) / "jpod_nano" / "history";
+  }
+  if (const char *home = std::getenv("HOME"); home != nullptr) {
+    return fs::path(home) / ".local" / "state" / "jpod_nano" / "history";
+  }
+  return fs::temp_directory_path() / "jpod_nano" / "history";
+}
+
+void HistoryLog::writer_thread(const std::stop_token &token) {
+  Records batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queued_.wait(lock,
+                   [&] { return !queue_.empty() || token.stop_requested(); });
+      if (queue_.empty()) {
+        return;
+      }
+      batch.swap(queue_);
+    }
+    // One append per batch; the index only counts what reached the log
+    const auto *bytes = reinterpret_cast<const char *>(batch.data());
+    size_t left = batch.size() * sizeof(PlayRecord);
+    while (left > 0) {
+      const auto written = ::write(log_fd_, bytes, left);
+      if (written <= 0) {
+        break;
+      }
+      bytes += written;
+      left -= static_cast<size_t>(written);
+    }
+    if (left > 0) {
+      std::cerr << "[WARN] Cannot append to the listening history\n";
+    } else if (!index_behind_) {
+      std::lock_guard<std::mutex> lock(table_mutex_);
+      try {
+        for (const auto &play : batch) {
+          apply(play);
+        }
+      } catch (const std::bad_alloc &) {
+        // Over the index budget to grow the table. The log has every play,
+        // so the index stops here and the next start catches up from it.
+        std::cerr << "[WARN] Listening history index over its memory "
+                     "budget; it catches up on the next start\n";
+        index_behind_ = true;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      written_count_ += batch.size();
+    }
+    written_.notify_all();
+    batch.clear();
+  }
+}
+
+void HistoryLog::map_index(uint64_t capacity, bool reset) {
+  const auto path = directory_ / "history.idx";
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path.string());
+  }
+  if (!reset) {
+    // Reuse the table only if it is ours and complete
+    IndexHeader existing{};
+    struct stat info {};
+    const bool valid =
+        pread(fd, &existing, sizeof(existing), 0) ==
+            static_cast<ssize_t>(sizeof(existing)) &&
+        existing.magic == IndexHeader::MAGIC &&
+        existing.version == IndexHeader::VERSION && existing.capacity > 0 &&
+        (existing.capacity & (existing.capacity - 1)) == 0 &&
+        fstat(fd, &info) == 0 &&
+        static_cast<uint64_t>(info.st_size) >=
+            sizeof(IndexHeader) + (existing.capacity * sizeof(TrackStats));
+    reset = !valid;
+    capacity = valid ? existing.capacity : capacity;
+  }
+  const auto bytes = sizeof(IndexHeader) + (capacity * sizeof(TrackStats));
+  mapped_charge_.resize(bytes);
+  // Truncating to 0 first leaves a zeroed file, i.e. an empty table
+  const bool sized = (!reset || ftruncate(fd, 0) == 0) &&
+                     ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+  void *mapping = sized ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, 0)
+                        : MAP_FAILED;
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    mapped_charge_.resize(mapped_bytes_);
+    throw std::runtime_error("Cannot map " + path.string());
+  }
+  if (header_ != nullptr) {
+    munmap(header_, mapped_bytes_);
+  }
+  header_ = static_cast<IndexHeader *>(mapping);
+  slots_ = reinterpret_cast<TrackStats *>(header_ + 1);
+  mapped_bytes_ = bytes;
+  if (reset) {
+    header_->magic = IndexHeader::MAGIC;
+    header_->version = IndexHeader::VERSION;
+    header_->capacity = capacity;
+  }
+}
+
+void HistoryLog::catch_up(uint64_t log_records) {
+  if (header_->applied > log_records) {
+    // Index from another log: start over
+    map_index(MIN_CAPACITY, true);
+  }
+  std::vector<PlayRecord> records(REPLAY_BATCH);
+  while (header_->applied < log_records) {
+    const auto count =
+        std::min<uint64_t>(REPLAY_BATCH, log_records - header_->applied);
+    const auto bytes = static_cast<ssize_t>(count * sizeof(PlayRecord));
+    if (pread(log_fd_, records.data(), static_cast<size_t>(bytes),
+              static_cast<off_t>(header_->applied * sizeof(PlayRecord))) !=
+        bytes) {
+      throw std::runtime_error("Cannot read the listening history");
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+      apply(records[i]);
+    }
+  }
+}
+
+void HistoryLog::apply(const PlayRecord &record) {
+  if ((header_->tracks + 1) * 100 > header_->capacity * MAX_LOAD_PERCENT) {
+    // Rebuild at twice the size; a crash meanwhile leaves a valid empty
+    // table that the next start refills from the log
+    std::vector<TrackStats> used;
+    used.reserve(header_->tracks);
+    std::copy_if(slots_, slots_ + header_->capacity, std::back_inserter(used),
+                 [](const TrackStats &slot) { return slot.track != 0; });
+    const auto saved = *header_;
+    map_index(saved.capacity * 2, true);
+    for (const auto &stats : used) {
+      find_slot(stats.track) = stats;
+    }
+    header_->tracks = saved.tracks;
+    header_->applied = saved.applied;
+    header_->recent_count = saved.recent_count;
+    header_->recent = saved.recent;
+  }
+
+  auto &slot = find_slot(record.track);
+  if (slot.track == 0) {
+    slot.track = record.track;
+    ++header_->tracks;
+  }
+  ++slot.plays;
+  if ((record.flags & PlayRecord::SKIPPED) != 0) {
+    ++slot.skips;
+  }
+  slot.last_played_ms = std::max(slot.last_played_ms, record.start_ms);
+  slot.listened_ms += record.listened_ms;
+  rank(slot);
+  header_->recent[header_->recent_count % RECENT_PLAYS] = record;
+  ++header_->recent_count;
+  ++header_->applied;
+}
+
+void HistoryLog::rank(const TrackStats &stats) {
+  // Aggregates only grow, so a track can only enter the top by its own play
+  const auto old = std::ranges::find(top_, stats.track, &TrackStats::track);
+  if (old != top_.end()) {
+    top_.erase(old);
+  }
+  const auto at = std::ranges::upper_bound(top_, stats, ranks_before);
+  if (at == top_.end() && top_.size() >= TOP_TRACKS) {
+    return;
+  }
+  top_.insert(at, stats);
+  if (top_.size() > TOP_TRACKS) {
+    top_.pop_back();
+  }
+}
+
+void HistoryLog::rebuild_top() {
+  top_.clear();
+  std::copy_if(slots_, slots_ + header_->capacity, std::back_inserter(top_),
+               [](const TrackStats &slot) { return slot.track != 0; });
+  const auto kept = std::min(TOP_TRACKS, top_.size());
+  std::partial_sort(top_.begin(),
+                    top_.begin() + static_cast<std::ptrdiff_t>(kept),
+                    top_.end(), ranks_before);
+  top_.resize(kept);
+  top_.shrink_to_fit();
+}
+
+auto HistoryLog::find_slot(uint64_t track) const -> TrackStats & {
+  // Linear probing; the load limit guarantees an empty slot
+  const auto mask = header_->capacity - 1;
+  for (auto index = track & mask;; index = (index + 1) & mask) {
+    if (slots_[index].track == track || slots_[index].track == 0) {
+      return slots_[index];
+    }
+  }
+}
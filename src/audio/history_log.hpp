@@ -0,0 +1,193 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../util/memory_accounting.hpp"
+
+/**
+ * @struct PlayRecord
+ * @brief One play as stored in the history log.
+ */
+struct PlayRecord {
+  static constexpr uint32_t SKIPPED = 1U; ///< Left before the track ended
+
+  uint64_t track;       ///< HistoryLog::track_id() of the song
+  int64_t start_ms;     ///< Unix time playback started, in milliseconds
+  uint32_t listened_ms; ///< How far into the track playback got
+  uint32_t flags;       ///< SKIPPED
+};
+
+static_assert(sizeof(PlayRecord) == 24, "Log records are 24 bytes on disk");
+
+/**
+ * @struct TrackStats
+ * @brief Aggregates of every play of one track.
+ */
+struct TrackStats {
+  uint64_t track;         ///< HistoryLog::track_id() of the song, 0 if unused
+  uint64_t plays;         ///< Plays, skipped ones included
+  uint64_t skips;         ///< Plays left before the end
+  int64_t last_played_ms; ///< Unix time of the newest play
+  uint64_t listened_ms;   ///< Listening time over all plays
+
+  /**
+   * @brief Gets the share of plays that were skipped.
+   * @return Between 0 and 1.
+   */
+  [[nodiscard]] auto skip_rate() const -> double;
+};
+
+/**
+ * @class HistoryLog
+ * @brief Listening history with aggregates that need no scan to query.
+ *
+ * Every play is appended as a PlayRecord to `history.log` by a background
+ * thread, so recording never blocks playback on the disk. The same thread
+ * folds each record into `history.idx`, an mmap'd open-addressing table of
+ * TrackStats plus a ring of the most recent plays. Queries read the table
+ * directly, however many years of plays the log holds.
+ *
+ * The index records how many log records it contains. On startup a missing,
+ * foreign or stale index is rebuilt or caught up from the log, and a torn
+ * record at the end of the log is dropped. A crash between appending and
+ * counting a record can count that one play twice.
+ */
+class HistoryLog {
+public:
+  static constexpr size_t RECENT_PLAYS = 64;     ///< Kept for recently_played()
+  static constexpr size_t TOP_TRACKS = 64;       ///< Kept for top_tracks()
+  static constexpr uint64_t MIN_CAPACITY = 1024; ///< Initial table slots
+  static constexpr uint64_t MAX_LOAD_PERCENT = 70; ///< Table grows above this
+
+  /**
+   * @brief Opens or creates the history and starts the writer thread.
+   * @param directory Holds history.log and history.idx.
+   * @throws std::runtime_error if the files cannot be opened or mapped.
+   */
+  explicit HistoryLog(std::filesystem::path directory = default_directory());
+
+  /**
+   * @brief Destructor.
+   * Writes out queued plays, then stops the writer thread.
+   */
+  ~HistoryLog();
+
+  HistoryLog(HistoryLog &log) = delete;
+  HistoryLog(HistoryLog &&log) = delete;
+
+  auto operator=(HistoryLog &log) -> HistoryLog & = delete;
+  auto operator=(HistoryLog &&log) -> HistoryLog && = delete;
+
+  /**
+   * @brief Queues a play for the writer thread; does not block on I/O.
+   * @param track track_id() of the song.
+   * @param start When playback of it started.
+   * @param listened How far into the track playback got.
+   * @param skipped Left before the track ended.
+   */
+  void record(uint64_t track, std::chrono::system_clock::time_point start,
+              std::chrono::milliseconds listened, bool skipped);
+
+  /// Blocks until every queued play is in the log and the aggregates.
+  void flush();
+
+  /**
+   * @brief Gets the aggregates of one track.
+   * @param track track_id() of the song.
+   * @return The aggregates, or std::nullopt if it was never played.
+   */
+  [[nodiscard]] auto stats(uint64_t track) const -> std::optional<TrackStats>;
+
+  /**
+   * @brief Gets the most played tracks; does not scan the table.
+   * @param count Maximum number, at most TOP_TRACKS.
+   * @return Most plays first, ties by most recent play.
+   */
+  [[nodiscard]] auto top_tracks(size_t count) const -> std::vector<TrackStats>;
+
+  /**
+   * @brief Gets the latest plays.
+   * @param count Maximum number, at most RECENT_PLAYS.
+   * @return Newest first.
+   */
+  [[nodiscard]] auto recently_played(size_t count) const
+      -> std::vector<PlayRecord>;
+
+  /**
+   * @brief Gets the number of plays ever recorded.
+   * @return Plays in the log.
+   */
+  [[nodiscard]] auto total_plays() const -> uint64_t;
+
+  /**
+   * @brief Identifies a song across runs.
+   * @param path Path or URL of the song.
+   * @return A stable nonzero ID.
+   */
+  [[nodiscard]] static auto track_id(std::string_view path) -> uint64_t;
+
+  /**
+   * @brief Gets the default history directory.
+   * @return $XDG_STATE_HOME/jpod_nano/history, or under ~/.local/state.
+   */
+  [[nodiscard]] static auto default_directory() -> std::filesystem::path;
+
+private:
+  struct IndexHeader;
+
+  using Records = TaggedVector<PlayRecord, MemoryTag::INDEX>;
+
+  /// Appends queued plays to the log and folds them into the index
+  void writer_thread(const std::stop_token &token);
+
+  /// Maps history.idx with room for `capacity` tracks, resetting if asked
+  void map_index(uint64_t capacity, bool reset);
+
+  /// Brings the index up to date with the log; table_mutex_ held
+  void catch_up(uint64_t log_records);
+
+  /// Folds one record into the index; table_mutex_ held
+  void apply(const PlayRecord &record);
+
+  /// Moves a track's new aggregates into top_ if they rank; table_mutex_ held
+  void rank(const TrackStats &stats);
+
+  /// Refills top_ from the whole table; table_mutex_ held
+  void rebuild_top();
+
+  /// Finds the slot of a track, or the empty slot it would go in
+  [[nodiscard]] auto find_slot(uint64_t track) const -> TrackStats &;
+
+  std::filesystem::path directory_; ///< Holds both files
+  int log_fd_{-1};                  ///< history.log, append-only
+
+  mutable std::mutex table_mutex_; ///< Guards the mapping
+  IndexHeader *header_{nullptr};   ///< Start of the history.idx mapping
+  TrackStats *slots_{nullptr};     ///< Table after the header
+  size_t mapped_bytes_{0};         ///< Size of the mapping
+  MemoryCharge mapped_charge_{MemoryTag::INDEX}; ///< Charges the mapping
+  std::vector<TrackStats> top_; ///< Most played first, at most TOP_TRACKS
+  bool index_behind_{false}; ///< Index stopped short of the log; writer only
+
+  std::mutex queue_mutex_;             ///< Guards queue_ and the counters
+  std::condition_variable queued_;     ///< Wakes the writer thread
+  std::condition_variable written_;    ///< Wakes flush()
+  Records queue_;                      ///< Plays not yet written
+  uint64_t queued_count_{0};           ///< Plays ever queued
+  uint64_t written_count_{0};          ///< Plays ever written and applied
+  std::jthread writer_;                ///< Runs writer_thread()
+};
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "null_sink.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr uint64_t NS_PER_SECOND = 1'000'000'000;
+
+} // namespace
+
+NullSink::NullSink(Clock &clock) : clock_(&clock) {}
+
+void NullSink::open(const AudioFormat &format) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain();
+    format_ = format;
+    played_ += queued_;
+    queued_ = 0;
+    starved_ = false;
+  }
+  open_.store(true);
+  paused_.store(true);
+}
+
+void NullSink::write(std::span<const int16_t> samples) {
+  samples_written_.fetch_add(samples.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto bytes = samples.size_bytes();
+  if (clock_ == nullptr) {
+    played_ += bytes;
+    return;
+  }
+  drain();
+  const auto now = clock_->now();
+  if (starved_ && now > drained_at_) {
+    ++underruns_;
+    if (glitches_.size() < MAX_GLITCHES) {
+      glitches_.push_back({drained_at_, now - drained_at_});
+    }
+  }
+  starved_ = false;
+  if (queued_ == 0) {
+    // An idle device starts playing the new audio now
+    drained_at_ = now;
+  }
+  queued_ += bytes;
+}
+
+auto NullSink::queued_bytes() const -> uint32_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  drain();
+  return static_cast<uint32_t>(
+      std::min<uint64_t>(queued_, std::numeric_limits<uint32_t>::max()));
+}
+
+void NullSink::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  queued_ = 0;
+  starved_ = false;
+}
+
+void NullSink::pause() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  drain();
+  paused_.store(true);
+  starved_ = false;
+}
+
+void NullSink::resume() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (paused_.load() && clock_ != nullptr) {
+    drained_at_ = clock_->now();
+  }
+  paused_.store(false);
+}
+
+auto NullSink::is_open() const -> bool { return open_.load(); }
+
+auto NullSink::samples_written() const -> uint64_t {
+  return samples_written_.load();
+}
+
+auto NullSink::format() const -> AudioFormat {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return format_;
+}
+
+auto NullSink::is_paused() const -> bool { return paused_.load(); }
+
+auto NullSink::played_bytes() const -> uint64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  drain();
+  return played_;
+}
+
+auto NullSink::underruns() const -> uint64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return underruns_;
+}
+
+auto NullSink::glitches() const -> std::vector<Glitch> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return glitches_;
+}
+
+void NullSink::drain() const {
+  if (clock_ == nullptr || paused_.load() || queued_ == 0) {
+    return;
+  }
+  const uint64_t rate = format_.bytes_per_second();
+  const uint64_t frame = std::max(1, format_.channels) * sizeof(int16_t);
+  if (rate == 0) {
+    return;
+  }
+  const auto now = clock_->now();
+  const auto elapsed = static_cast<uint64_t>(std::max<int64_t>(
+      0, std::chrono::duration_cast<std::chrono::nanoseconds>(now - drained_at_)
+             .count()));
+  auto bytes = elapsed * rate / NS_PER_SECOND;
+  bytes -= bytes % frame;
+  if (bytes >= queued_) {
+    // Remember when the audio ran out; a later write means a gap
+    drained_at_ += std::chrono::nanoseconds(queued_ * NS_PER_SECOND / rate);
+    starved_ = true;
+    played_ += queued_;
+    queued_ = 0;
+    return;
+  }
+  // Advance by whole frames only so no fraction of a frame is lost
+  played_ += bytes;
+  queued_ -= bytes;
+  drained_at_ += std::chrono::nanoseconds(bytes * NS_PER_SECOND / rate);
+}
@@ -0,0 +1,110 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "../util/clock.hpp"
+#include "audio_sink.hpp"
+
+/**
+ * @class NullSink
+ * @brief AudioSink that discards audio while counting it.
+ *
+ * Used for headless runs, tests and benchmarks where no device exists.
+ * Without a clock audio vanishes on write; with one the sink behaves like a
+ * device playing in real time on that clock, so it paces its writer.
+ */
+class NullSink : public AudioSink {
+public:
+  static constexpr size_t MAX_GLITCHES = 4096; ///< Underruns remembered
+
+  /**
+   * @struct Glitch
+   * @brief One underrun: where playback ran dry and for how long.
+   */
+  struct Glitch {
+    Clock::time_point at;         ///< Clock time the queue ran out
+    std::chrono::nanoseconds gap; ///< Silence until the next write()
+  };
+
+  NullSink() = default;
+
+  /**
+   * @brief Constructs a sink that plays out at the format's rate.
+   * @param clock Time base; written audio stays queued until it has played.
+   */
+  explicit NullSink(Clock &clock);
+
+  void open(const AudioFormat &format) override;
+  void write(std::span<const int16_t> samples) override;
+  [[nodiscard]] auto queued_bytes() const -> uint32_t override;
+  void clear() override;
+  void pause() override;
+  void resume() override;
+  [[nodiscard]] auto is_open() const -> bool override;
+
+  /**
+   * @brief Gets the number of samples written since construction.
+   * @return Interleaved sample count.
+   */
+  [[nodiscard]] auto samples_written() const -> uint64_t;
+
+  /**
+   * @brief Gets the format of the last open().
+   * @return The current format.
+   */
+  [[nodiscard]] auto format() const -> AudioFormat;
+
+  /**
+   * @brief Checks whether the sink is paused.
+   * @return true if paused.
+   */
+  [[nodiscard]] auto is_paused() const -> bool;
+
+  /**
+   * @brief Gets the bytes that finished playing on the clock.
+   * @return Played bytes, equal to all written bytes without a clock.
+   */
+  [[nodiscard]] auto played_bytes() const -> uint64_t;
+
+  /**
+   * @brief Gets how often playback ran dry before more audio arrived.
+   *
+   * Running out at the end of a track is not counted unless the track
+   * continues; a new open(), clear() or pause() forgives the gap.
+   *
+   * @return Underrun count, always 0 without a clock.
+   */
+  [[nodiscard]] auto underruns() const -> uint64_t;
+
+  /**
+   * @brief Gets the first MAX_GLITCHES underruns counted by underruns().
+   * @return Glitches, oldest first.
+   */
+  [[nodiscard]] auto glitches() const -> std::vector<Glitch>;
+
+private:
+  /// Moves audio that played since the last call out of the queue.
+  void drain() const;
+
+  Clock *clock_{nullptr};                ///< Pacing clock, if any
+  mutable std::mutex mutex_;             ///< Protects format_ and the queue
+  mutable uint64_t queued_{0};           ///< Bytes not played yet
+  mutable uint64_t played_{0};           ///< Bytes played so far
+  mutable Clock::time_point drained_at_; ///< Play position of the queue
+  mutable bool starved_{false};          ///< Ran dry while playing
+  uint64_t underruns_{0};                ///< Starvations ended by write()
+  std::vector<Glitch> glitches_;         ///< First MAX_GLITCHES underruns
+  AudioFormat format_;                   ///< Format of the last open()
+  std::atomic<bool> open_{false};        ///< open() was called
+  std::atomic<bool> paused_{true};       ///< Pause state
+  std::atomic<uint64_t> samples_written_{0}; ///< Samples discarded so far
+};
@@ -7,21 +7,34 @@
 
 #include "player.hpp"
 
+#include "dsp.hpp"
+#include "sdl_sink.hpp"
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
 #include <algorithm>
+#include <bit>
 #include <chrono>
 #include <csignal>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
 #include <ranges>
 #include <stdexcept>
+#include <string_view>
 #include <thread>
+#include <vector>
 
-Player::Player() {
-  // Init libraries
-  if (SDL_Init(SDL_INIT_AUDIO) != 0) {
-    throw std::runtime_error("SDL_Init failed: " + std::string(SDL_GetError()));
-  }
+Player::Player() : Player(std::make_unique<SdlSink>()) {}
 
+Player::Player(std::unique_ptr<AudioSink> sink, Clock &clock)
+    : sink_(std::make_unique<FanOutSink>(std::move(sink))), clock_(clock),
+      window_start_(clock.now()) {
+  // Init libraries
   if (mpg123_init() != MPG123_OK) {
     throw std::runtime_error("mpg123_init failed");
   }
@@ -30,73 +43,402 @@ Player::Player() {
   if (mpg_handler_ == nullptr) {
     throw std::runtime_error("mpg123_new failed");
   }
+  // Only used by mpg123_open_handle(), i.e. for http:// songs
+  mpg123_replace_reader_handle(mpg_handler_, &HttpSource::mpg123_read,
+                               &HttpSource::mpg123_lseek, nullptr);
+  // Search as far as it takes for the next good frame after corrupt data
+  mpg123_param(mpg_handler_, MPG123_RESYNC_LIMIT, -1, 0);
+  validator_ = std::make_unique<TrackValidator>();
 
   player_thread_ = std::jthread(
       [this](const std::stop_token &token) { player_thread(token); });
 }
 
 Player::~Player() {
+  // Quitting is not skipping
+  record_play(false);
+
   // Stop the player
-  state_.store(State::SWITCH_OFF);
+  set_state(State::SWITCH_OFF);
+  request_trim();
+  if (reactor_ != nullptr) {
+    reactor_->cancel_timer(pump_timer_);
+    if (fade_) {
+      reactor_->cancel_timer(fade_->timer);
+    }
+  }
+  // It may be finishing a track with the decoder and validator
+  player_thread_.request_stop();
+  if (player_thread_.joinable()) {
+    player_thread_.join();
+  }
 
   // Clean up
   {
-    std::lock_guard<std::mutex> lock(audio_mutex_);
-    if (audio_device_.has_value()) {
-      SDL_CloseAudioDevice(audio_device_.value());
-      audio_device_.reset();
+    TracedMutex::Guard lock(audio_mutex_);
+    pause_audio_device();
+  }
+  {
+    std::lock_guard<std::mutex> lock(validation_mutex_);
+    if (validation_.valid()) {
+      validation_.wait();
     }
   }
+  validator_.reset();
   mpg123_close(mpg_handler_);
   mpg123_delete(mpg_handler_);
   mpg123_exit();
-  SDL_Quit();
 }
 
 void Player::set_playlist(std::unique_ptr<Playlist> playlist) {
   playlist_ = std::move(playlist);
-  load_current();
+  if (!playlist_) {
+    return;
+  }
+  playlist_hash_ = ResumeState::HASH_BASIS;
+  for (const auto &song : playlist_->songs()) {
+    playlist_hash_ = ResumeState::hash(song + '\n', playlist_hash_);
+  }
+  if (!restore_position()) {
+    load_current();
+  }
+}
+
+void Player::set_resume_state(std::unique_ptr<ResumeState> state) {
+  resume_state_ = std::move(state);
+}
+
+void Player::set_history(std::unique_ptr<HistoryLog> history) {
+  history_ = std::move(history);
+}
+
+auto Player::get_history() const -> const HistoryLog * {
+  return history_.get();
+}
+
+void Player::set_radio(bool on) {
+  if (!playlist_ || playlist_->is_radio() == on) {
+    return;
+  }
+  if (!on) {
+    playlist_->stop_radio();
+    validate_ahead();
+    return;
+  }
+  const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  std::vector<double> weights;
+  weights.reserve(playlist_->size());
+  for (const auto &song : playlist_->songs()) {
+    weights.push_back(Radio::weight(
+        history_ ? history_->stats(HistoryLog::track_id(song)) : std::nullopt,
+        now_ms));
+  }
+  std::random_device device;
+  playlist_->start_radio(std::move(weights),
+                         (uint64_t{device()} << 32U) | device());
+  validate_ahead();
+}
+
+void Player::record_play(bool skipped) {
+  const auto started = play_started_ms_.exchange(0);
+  if (!history_ || started == 0 || path_.empty()) {
+    return;
+  }
+  history_->record(
+      HistoryLog::track_id(path_),
+      std::chrono::system_clock::time_point(std::chrono::milliseconds(started)),
+      elapsed(), skipped);
+
+  // The writer folds the play in later; the radio reweighs the song now
+  const auto song = song_;
+  if (playlist_ && song && playlist_->is_radio()) {
+    const auto track = HistoryLog::track_id(path_);
+    auto stats = history_->stats(track).value_or(TrackStats{track, 0, 0, 0, 0});
+    ++stats.plays;
+    stats.skips += skipped ? 1 : 0;
+    stats.last_played_ms = std::max(stats.last_played_ms, started);
+    const auto now_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    playlist_->set_weight(*song, Radio::weight(stats, now_ms));
+  }
+}
+
+auto Player::restore_position() -> bool {
+  const auto point = resume_state_ ? resume_state_->load() : std::nullopt;
+  if (!point || point->playlist != playlist_hash_) {
+    return false;
+  }
+  if (point->shuffle_seed) {
+    playlist_->reshuffle(*point->shuffle_seed);
+  }
+  if (!playlist_->jump_to(point->position) ||
+      open_song(playlist_->current()) || track_hash_ != point->track) {
+    return false;
+  }
+
+  const auto sample = std::max<int64_t>(0, point->sample);
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (point->anchor_frame > 0) {
+      // Seed mpg123's frame index so the seek jumps instead of scanning
+      std::array<off_t, 2> offsets{static_cast<off_t>(point->first_offset),
+                                   static_cast<off_t>(point->anchor_offset)};
+      mpg123_set_index(mpg_handler_, offsets.data(),
+                       static_cast<off_t>(point->anchor_frame),
+                       offsets.size());
+    }
+    if (mpg123_seek(mpg_handler_, static_cast<off_t>(sample), SEEK_SET) < 0) {
+      std::cerr << "[WARN] Cannot resume " << path_ << " at sample " << sample
+                << '\n';
+    } else {
+      static constexpr auto MS_PER_SECOND = 1000;
+      set_elapsed(std::chrono::milliseconds(
+          sample * MS_PER_SECOND / std::max<int64_t>(1, sample_rate_)));
+    }
+  }
+  transition([volume = point->volume](Control &control) {
+    control.volume = volume;
+    return true;
+  });
+  set_volume(point->volume);
+  validate_ahead();
+  if (point->playing) {
+    resume();
+  }
+  return true;
+}
+
+void Player::save_position() {
+  const auto now = clock_.now();
+  const bool playing = control().state == State::PLAY;
+  if (!resume_state_ || !playlist_ || icy_stream_ || sync_follower_ ||
+      path_.empty() ||
+      (now - saved_at_ < RESUME_INTERVAL && playing == saved_playing_)) {
+    return;
+  }
+  saved_at_ = now;
+  saved_playing_ = playing;
+
+  ResumePoint point{playlist_hash_,
+                    track_hash_,
+                    playlist_->position(),
+                    playlist_->shuffle_seed(),
+                    playing,
+                    playing ? get_volume() : control().volume,
+                    0,
+                    0,
+                    0,
+                    0};
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    // Decoded but not yet heard: in the sink, and in deep mode also ahead
+    auto pending = static_cast<int64_t>(sink_->queued_bytes() / sizeof(int16_t));
+    if (deep_pcm_) {
+      pending += static_cast<int64_t>(deep_pcm_->size()) -
+                 static_cast<int64_t>(deep_fed_);
+    }
+    point.sample = std::max<int64_t>(
+        0, (static_cast<int64_t>(mpg123_tell(mpg_handler_)) << down_sample_) -
+               (pending / std::max(1, channels_)));
+
+    // The index entry at or before the sample, to seek without a scan
+    off_t *offsets = nullptr;
+    off_t step = 0;
+    size_t fill = 0;
+    const auto samples_per_frame = mpg123_spf(mpg_handler_);
+    if (mpg123_index(mpg_handler_, &offsets, &step, &fill) == MPG123_OK &&
+        fill > 0 && step > 0 && samples_per_frame > 0) {
+      const auto entry = std::min<int64_t>(
+          static_cast<int64_t>(fill) - 1,
+          point.sample / samples_per_frame / static_cast<int64_t>(step));
+      point.first_offset = offsets[0];
+      point.anchor_frame = entry * static_cast<int64_t>(step);
+      point.anchor_offset = offsets[entry];
+    }
+  }
+  resume_state_->save(point);
 }
 
 void Player::load_current() {
   if (!playlist_) {
     return;
   }
-  load_song(playlist_->current());
+  const auto &path = playlist_->current();
+  if (auto error = open_song(path)) {
+    mark_unplayable(path, *error);
+    skipped_tracks_.fetch_add(1);
+    advance(true);
+    return;
+  }
+  validate_ahead();
 }
 
 void Player::next_song() {
   if (playlist_) {
     pause();
-    load_song(playlist_->next());
-    resume();
+    if (advance(true)) {
+      resume();
+    }
   }
 }
 
 void Player::prev_song() {
   if (playlist_) {
     pause();
-    load_song(playlist_->prev());
+    if (advance(false)) {
+      resume();
+    }
+  }
+}
+
+void Player::play_song(size_t song) {
+  if (!playlist_ || !playlist_->select(song)) {
+    return;
+  }
+  pause();
+  const auto &path = playlist_->current();
+  if (!is_unplayable(path)) {
+    auto error = open_song(path);
+    if (!error) {
+      validate_ahead();
+      resume();
+      return;
+    }
+    mark_unplayable(path, *error);
+  }
+  skipped_tracks_.fetch_add(1);
+  if (advance(true)) {
     resume();
   }
 }
 
+auto Player::advance(bool forward) -> bool {
+  // Each entry gets one chance, so an all-bad playlist ends instead of looping
+  for (size_t tried = 0; tried < playlist_->size(); ++tried) {
+    const auto &path = forward ? playlist_->next() : playlist_->prev();
+    if (is_unplayable(path)) {
+      skipped_tracks_.fetch_add(1);
+      continue;
+    }
+    if (auto error = open_song(path)) {
+      mark_unplayable(path, *error);
+      skipped_tracks_.fetch_add(1);
+      continue;
+    }
+    validate_ahead();
+    return true;
+  }
+  set_state(State::STOPPED);
+  std::cerr << "[WARN] No playable song in the playlist\n";
+  return false;
+}
+
+void Player::validate_ahead() {
+  std::vector<std::string> upcoming;
+  for (size_t ahead = 1;
+       ahead <= std::min(VALIDATE_AHEAD, playlist_->size() - 1); ++ahead) {
+    const auto &path = playlist_->peek(ahead);
+    // Downloading ahead is the cache's job, not ours
+    if (!HttpUrl::is_url(path) && !is_unplayable(path)) {
+      upcoming.push_back(path);
+    }
+  }
+  if (upcoming.empty()) {
+    return;
+  }
+  auto validate = [this, upcoming = std::move(upcoming)] {
+    for (const auto &path : upcoming) {
+      if (auto error = validator_->validate(path)) {
+        mark_unplayable(path, *error);
+      }
+    }
+  };
+  if (reactor_ != nullptr) {
+    // Single-threaded: a few header reads are cheaper than a thread
+    validate();
+    return;
+  }
+  // set_radio() gets here from the UI thread too
+  std::lock_guard<std::mutex> lock(validation_mutex_);
+  if (validation_.valid()) {
+    validation_.wait();
+  }
+  validation_ = std::async(std::launch::async, std::move(validate));
+}
+
+void Player::mark_unplayable(const std::string &path,
+                             const std::string &error) {
+  std::lock_guard<std::mutex> lock(unplayable_mutex_);
+  try {
+    if (unplayable_.insert(path).second) {
+      std::cerr << "[WARN] Skipping unplayable song: " << error << '\n';
+    }
+  } catch (const std::bad_alloc &) {
+    // Over the cache budget: skip it now and try it again next time round
+    std::cerr << "[WARN] Skipping unplayable song, not remembered: " << error
+              << '\n';
+  }
+}
+
+auto Player::is_unplayable(const std::string &path) const -> bool {
+  std::lock_guard<std::mutex> lock(unplayable_mutex_);
+  return unplayable_.contains(path);
+}
+
 void Player::load_song(const std::string &path) {
+  if (auto error = open_song(path)) {
+    throw std::runtime_error(*error);
+  }
+}
+
+auto Player::open_song(const std::string &path)
+    -> std::optional<std::string> {
+  record_play(true);
   // Stop song
-  state_.store(State::STOPPED);
+  set_state(State::STOPPED);
+  request_trim();
   {
-    std::lock_guard<std::mutex> lock(audio_mutex_);
+    TracedMutex::Guard lock(audio_mutex_);
     pause_audio_device();
   }
 
-  if (mpg123_open(mpg_handler_, path.c_str()) != MPG123_OK) {
-    throw std::runtime_error("Failed to open " + path);
+  mpg123_close(mpg_handler_);
+  http_source_.reset();
+  icy_stream_.reset();
+  // Every track starts at full quality, in its own format; the controller
+  // belongs to the decoding thread, which resets it before the next block
+  quality_reset_.store(true);
+  set_decode_params(QualityController::Level::FULL);
+  int opened = MPG123_ERR;
+  if (HttpUrl::is_url(path)) {
+    try {
+      http_source_ =
+          std::make_unique<HttpSource>(path, HttpSource::default_cache_dir());
+    } catch (const std::exception &e) {
+      return "Failed to open " + path + ": " + e.what();
+    }
+    opened = mpg123_open_handle(mpg_handler_, http_source_.get());
+  } else {
+    opened = mpg123_open(mpg_handler_, path.c_str());
+  }
+  if (opened != MPG123_OK) {
+    return "Failed to open " + path;
   }
 
   long rate = 0;
   int channels = 0;
   int encoding = 0;
-  mpg123_getformat(mpg_handler_, &rate, &channels, &encoding);
+  if (mpg123_getformat(mpg_handler_, &rate, &channels, &encoding) !=
+          MPG123_OK ||
+      rate <= 0) {
+    mpg123_close(mpg_handler_);
+    http_source_.reset();
+    return "No MPEG audio in " + path;
+  }
   sample_rate_ = static_cast<int64_t>(rate);
 
   off_t total_samples = mpg123_length(mpg_handler_);
@@ -105,8 +447,29 @@ void Player::load_song(const std::string &path) {
   } else {
     total_seconds_ = 0;
   }
-  elapsed_seconds_ = 0;
-  elapsed_duration_ = std::chrono::seconds(0);
+  path_ = path;
+  // Kept with the path, so record_play() needs no search of the playlist
+  song_.reset();
+  if (playlist_) {
+    const auto song = playlist_->current_song();
+    if (playlist_->songs()[song] == path) {
+      song_ = song;
+    }
+  }
+  {
+    // Same path and size: most likely the same encoding
+    std::error_code error;
+    const auto size =
+        HttpUrl::is_url(path) ? 0 : std::filesystem::file_size(path, error);
+    track_hash_ = ResumeState::hash(std::to_string(size),
+                                    ResumeState::hash(path + '\n'));
+  }
+  timeline_.store(0);
+  track_decoded_ = false;
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    reset_deep_buffer();
+  }
 
   mpg123_id3v1 *data1{nullptr};
   mpg123_id3v2 *data2{nullptr};
@@ -115,194 +478,1016 @@ void Player::load_song(const std::string &path) {
   if ((meta & MPG123_ID3) != 0) {
     mpg123_id3(mpg_handler_, &data1, &data2);
     if (data2 != nullptr) {
-      title_ = (data2->title != nullptr) ? data2->title->p : "";
-      artist_ = (data2->artist != nullptr) ? data2->artist->p : "";
+      set_track_info((data2->title != nullptr) ? data2->title->p : "",
+                     (data2->artist != nullptr) ? data2->artist->p : "");
     } else if (data1 != nullptr) {
-      title_ = data1->title;
-      artist_ = data1->artist;
+      set_track_info(data1->title, data1->artist);
     }
   }
+  update_stream_metadata();
 
-  SDL_AudioSpec want{};
-  SDL_AudioSpec have{};
-  SDL_zero(want);
-  want.freq = rate;
-  want.format = AUDIO_S16SYS;
-  want.channels = channels;
-  want.samples = SDL_AUDIO_BUFFER_SIZE;
+  open_audio_device(rate, channels);
+  return std::nullopt;
+}
+
+void Player::load_stream(const std::string &url) {
+  if (reactor_ != nullptr) {
+    throw std::runtime_error("Live streams need the player thread");
+  }
+  record_play(true);
+  // Stop song
+  set_state(State::STOPPED);
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    pause_audio_device();
+  }
 
-  std::lock_guard<std::mutex> lock(audio_mutex_);
-  audio_device_ = SDL_OpenAudioDevice(nullptr, 0, &want, &have, 0);
-  if (audio_device_ == 0) {
-    throw std::runtime_error("SDL_OpenAudioDevice error: " +
-                             std::string(SDL_GetError()));
+  mpg123_close(mpg_handler_);
+  http_source_.reset();
+  icy_stream_ = std::make_unique<IcyStream>(url);
+  if (mpg123_open_feed(mpg_handler_) != MPG123_OK) {
+    throw std::runtime_error("mpg123_open_feed failed for " + url);
   }
 
-  pause_audio_device();
+  // The format is only known once the first frames are decoded
+  path_ = url;
+  song_.reset();
+  set_track_info(icy_stream_->station_name(), "");
+  live_title_.clear();
+  total_seconds_ = 0;
+  timeline_.store(0);
+  update_stream_metadata();
+}
+
+void Player::open_audio_device(long rate, int channels) {
+  TracedMutex::Guard lock(audio_mutex_);
+  sink_->open(AudioFormat{static_cast<int32_t>(rate), channels});
+  channels_ = channels;
+  decode_channels_ = channels;
+  down_sample_ = 0;
+  resampler_.reset(channels);
+  zone_sync_.reset();
 }
 
 void Player::pause() {
-  if (state_.load() == State::SWITCH_OFF) {
+  // Playing on while fading out; the volume to come back to is the current
+  const auto begun = transition([this](Control &control) {
+    if (control.state == State::SWITCH_OFF) {
+      return false;
+    }
+    if (control.state != State::PAUSE) {
+      control.volume = get_volume();
+    }
+    return true;
+  });
+  if (!begun) {
     return;
   }
-  auto now = std::chrono::steady_clock::now();
-  elapsed_duration_ +=
-      std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time_);
-  if (state_.load() != State::PAUSE) {
-    last_volume_.store(get_volume());
+  run_timeline(false);
+  auto faded = fade_to(VOLUME_MUTE, DEFAULT_FADE_DURATION, [this, begun] {
+    // A command issued meanwhile supersedes this one, device included
+    const auto paused = transition([&begun](Control &control) {
+      if (control.generation != begun->generation) {
+        return false;
+      }
+      control.state = State::PAUSE;
+      return true;
+    });
+    if (!paused) {
+      return;
+    }
+    // Pauses the device, unless a resume got in since the transition above
+    sync_device();
+    request_trim();
+    if (sync_leader_) {
+      publish_media_clock(false);
+    }
+  });
+  // On a reactor the loop finishes the pause; waiting would stall it
+  if (reactor_ == nullptr) {
+    faded.wait();
   }
-  auto fade_future = fade_to(VOLUME_MUTE);
-  fade_future.wait();
-  pause_audio_device();
-  state_.store(State::PAUSE);
 }
 
 void Player::resume() {
-  if (state_.load() == State::SWITCH_OFF) {
+  const auto begun = transition([](Control &control) {
+    return control.state != State::SWITCH_OFF;
+  });
+  if (!begun) {
     return;
   }
-  start_time_ = std::chrono::steady_clock::now();
+  if (!icy_stream_ && play_started_ms_.load() == 0) {
+    play_started_ms_.store(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+  }
+  run_timeline(true);
   resume_audio_device();
-  auto fade_future = fade_to(last_volume_.load());
-  fade_future.wait();
-  state_.store(State::PLAY);
+  auto faded = fade_to(begun->volume, DEFAULT_FADE_DURATION, [this, begun] {
+    const auto playing = transition([&begun](Control &control) {
+      if (control.generation != begun->generation) {
+        return false;
+      }
+      control.state = State::PLAY;
+      return true;
+    });
+    if (playing) {
+      sync_device();
+      request_trim();
+    }
+  });
+  if (reactor_ == nullptr) {
+    faded.wait();
+  }
+}
+
+auto Player::Control::pack() const -> uint64_t {
+  return static_cast<uint64_t>(state) |
+         (static_cast<uint64_t>(generation & GENERATION_MASK) << 8U) |
+         (static_cast<uint64_t>(std::bit_cast<uint32_t>(volume)) << 32U);
+}
+
+auto Player::Control::unpack(uint64_t word) -> Control {
+  static constexpr uint64_t STATE_MASK = 0xFF;
+  return {static_cast<State>(word & STATE_MASK),
+          static_cast<uint32_t>(word >> 8U) & GENERATION_MASK,
+          std::bit_cast<float>(static_cast<uint32_t>(word >> 32U))};
+}
+
+auto Player::control() const -> Control {
+  return Control::unpack(control_.load(std::memory_order_acquire));
+}
+
+template <typename Change>
+auto Player::transition(Change change) -> std::optional<Control> {
+  auto word = control_.load(std::memory_order_acquire);
+  while (true) {
+    auto next = Control::unpack(word);
+    if (!change(next)) {
+      return std::nullopt;
+    }
+    next.generation = (next.generation + 1) & Control::GENERATION_MASK;
+    if (control_.compare_exchange_weak(word, next.pack(),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return next;
+    }
+  }
+}
+
+void Player::set_state(State state) {
+  transition([state](Control &control) {
+    control.state = state;
+    return true;
+  });
+}
+
+void Player::sync_device() {
+  // Whoever transitioned last may have touched the device first
+  if (control().state == State::PLAY) {
+    resume_audio_device();
+  } else {
+    pause_audio_device();
+  }
+}
+
+auto Player::elapsed() const -> std::chrono::milliseconds {
+  const auto word = timeline_.load(std::memory_order_acquire);
+  const auto value = word >> 1;
+  return std::chrono::milliseconds(
+      (word & 1) != 0 ? timeline_now() - value : value);
+}
+
+void Player::set_elapsed(std::chrono::milliseconds position) {
+  auto word = timeline_.load(std::memory_order_acquire);
+  int64_t next = 0;
+  do {
+    const auto running = word & 1;
+    next = ((running != 0 ? timeline_now() - position.count()
+                          : position.count())
+            << 1) |
+           running;
+  } while (!timeline_.compare_exchange_weak(word, next,
+                                            std::memory_order_acq_rel));
+}
+
+void Player::run_timeline(bool running) {
+  auto word = timeline_.load(std::memory_order_acquire);
+  int64_t next = 0;
+  do {
+    if (((word & 1) != 0) == running) {
+      return;
+    }
+    const auto now = timeline_now();
+    // Position while stopped and start while running convert the same way
+    next = ((now - (word >> 1)) << 1) | (running ? 1 : 0);
+  } while (!timeline_.compare_exchange_weak(word, next,
+                                            std::memory_order_acq_rel));
+}
+
+auto Player::timeline_now() const -> int64_t {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             clock_.now().time_since_epoch())
+      .count();
 }
 
 void Player::player_thread(const std::stop_token &token) {
   while (!token.stop_requested() && should_continue()) {
     static constexpr auto SLEEP = 5U;
-    std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP));
-    if (state_.load() != State::PLAY) {
+    if (deep_mode_.load() && control().state != State::PLAY) {
+      // Commands wake the thread; only a follower polls, for the leader
+      const auto wait = sync_follower_
+                            ? std::chrono::milliseconds(SLEEP)
+                            : std::chrono::milliseconds(STATS_WINDOW);
+      sleep_for_command(clock_.now() + wait);
+    } else {
+      idle(std::chrono::milliseconds(SLEEP));
+    }
+    save_position();
+    if (sync_follower_) {
+      follow_leader_state();
+    }
+    if (control().state != State::PLAY) {
       continue;
     }
 
-    resume_audio_device();
-
-    stream_audio();
-    wait_for_buffer_to_drain();
+    if (stream_server_ && !icy_stream_) {
+      stream_passthrough();
+    } else if (icy_stream_) {
+      stream_live();
+    } else {
+      resume_audio_device();
 
-    if (state_.load() == State::PLAY) {
-      mpg123_close(mpg_handler_);
-      if (playlist_) {
-        next_song();
+      if (deep_mode_.load() && !sync_leader_ && !sync_follower_) {
+        stream_deep();
       } else {
-        state_.store(State::STOPPED);
+        stream_audio();
       }
+      if (!in_step_with_leader()) {
+        continue;
+      }
+      wait_for_buffer_to_drain();
     }
+
+    if (control().state == State::PLAY) {
+      finish_track();
+    }
+  }
+}
+
+void Player::finish_track() {
+  record_play(false);
+  mpg123_close(mpg_handler_);
+  if (sync_follower_) {
+    // The leader decides what plays next
+    set_state(State::STOPPED);
+  } else if (playlist_) {
+    next_song();
+  } else {
+    set_state(State::STOPPED);
   }
 }
 
 auto Player::should_continue() const -> bool {
-  return state_.load() != State::SWITCH_OFF;
+  return control().state != State::SWITCH_OFF;
 }
 
 void Player::stream_audio() {
   static constexpr auto DELAY_MS = 10U;
-  static constexpr auto BUFFER_MULTIPLIER = 32U;
   size_t completed_bytes = 0;
 
-  while ((state_.load() == State::PLAY) &&
-         (mpg123_read(mpg_handler_, buffer_.data(), buffer_.size(),
-                      &completed_bytes)) == MPG123_OK) {
-    update_elapsed_time();
-    wait_until_buffer_has_space(DELAY_MS, BUFFER_MULTIPLIER);
-    apply_volume(std::span{reinterpret_cast<int16_t *>(buffer_.data()),
-                           completed_bytes / 2});
-    std::lock_guard<std::mutex> lock(audio_mutex_);
-    if (audio_device_.has_value()) {
-      SDL_QueueAudio(audio_device_.value(), buffer_.data(), completed_bytes);
+  while ((control().state == State::PLAY) && in_step_with_leader() &&
+         decode_block(completed_bytes) == MPG123_OK) {
+    wait_until_buffer_has_space(DELAY_MS, QUEUE_DEPTH);
+    queue_audio(completed_bytes);
+    sync_zone();
+    // Not before: the decoded block would count as heard without being queued
+    save_position();
+  }
+}
+
+void Player::pump() {
+  note_wakeup();
+  save_position();
+  if (sync_follower_) {
+    follow_leader_state();
+  }
+  if (control().state != State::PLAY || !in_step_with_leader()) {
+    return;
+  }
+  resume_audio_device();
+
+  // Decode until the queue is full; the next tick continues from there
+  size_t completed_bytes = 0;
+  while (control().state == State::PLAY && !track_decoded_) {
+    {
+      TracedMutex::Guard lock(audio_mutex_);
+      if (!sink_->is_open() ||
+          sink_->queued_bytes() > AUDIO_BUFFER_SIZE * QUEUE_DEPTH) {
+        return;
+      }
+    }
+    if (decode_block(completed_bytes) != MPG123_OK) {
+      track_decoded_ = true;
+      break;
+    }
+    queue_audio(completed_bytes);
+    sync_zone();
+  }
+
+  // Let the queue play out before moving on
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (control().state != State::PLAY ||
+        (sink_->is_open() && sink_->queued_bytes() > 0)) {
+      return;
+    }
+  }
+  finish_track();
+}
+
+void Player::stream_deep() {
+#ifdef __linux__
+  // Let the kernel batch this thread's wakeups with others
+  prctl(PR_SET_TIMERSLACK,
+        static_cast<unsigned long>(
+            std::chrono::nanoseconds(TIMER_SLACK).count()));
+#endif
+  const auto samples_per_second =
+      static_cast<int64_t>(sample_rate_) * std::max(1, channels_);
+  const auto to_duration = [samples_per_second](size_t samples) {
+    return std::chrono::milliseconds(static_cast<int64_t>(samples) * 1000 /
+                                     std::max<int64_t>(1, samples_per_second));
+  };
+  const auto low = static_cast<size_t>(
+      samples_per_second *
+      std::chrono::duration_cast<std::chrono::milliseconds>(DEEP_SINK_LOW)
+          .count() /
+      1000);
+
+  while (control().state == State::PLAY) {
+    size_t queued = 0;
+    bool all_fed = false;
+    {
+      TracedMutex::Guard lock(audio_mutex_);
+      if (!sink_->is_open() || !deep_pcm_) {
+        return;
+      }
+      // Retire what was heard; the rest of the fed audio is still queued
+      queued = sink_->queued_bytes() / sizeof(int16_t);
+      const auto played = deep_fed_ > queued ? deep_fed_ - queued : 0;
+      deep_pcm_->consume(std::min(played, deep_pcm_->size()));
+      deep_fed_ -= std::min(played, deep_fed_);
+      if (trim_requested_.exchange(false)) {
+        // Re-feed from what is audible now, so the change is heard at once
+        sink_->clear();
+        deep_fed_ = 0;
+        queued = 0;
+      }
+    }
+    save_position();
+    refill_deep_buffer();
+    queued = feed_from_deep_buffer(queued);
+    {
+      TracedMutex::Guard lock(audio_mutex_);
+      if (!deep_pcm_ || (deep_decoded_ && deep_pcm_->size() == 0)) {
+        // Played out; trims could re-feed the sink until here
+        return;
+      }
+      all_fed = deep_decoded_ && deep_fed_ == deep_pcm_->size();
+    }
+    // Wake while the sink still holds DEEP_SINK_LOW, or when the track ends
+    auto sleep = all_fed ? to_duration(queued)
+                         : to_duration(queued > low ? queued - low : 0);
+    sleep = std::max(sleep, std::chrono::milliseconds(10));
+    sleep_for_command(clock_.now() + sleep);
+  }
+}
+
+void Player::refill_deep_buffer() {
+  size_t depth = 0;
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (!deep_pcm_) {
+      return;
+    }
+    depth = std::min(deep_pcm_->capacity(),
+                     static_cast<size_t>(deep_depth_.count()) *
+                         static_cast<size_t>(sample_rate_) *
+                         static_cast<size_t>(std::max(1, channels_)));
+    if (deep_decoded_ || deep_pcm_->size() > depth / DEEP_REFILL_DIVISOR) {
+      return;
+    }
+  }
+  // One burst up to full, then the decoder is idle for a long while
+  size_t completed_bytes = 0;
+  while (control().state == State::PLAY) {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (!deep_pcm_ ||
+        deep_pcm_->size() + (buffer_.size() / sizeof(int16_t)) > depth) {
+      return;
+    }
+    if (decode_block(completed_bytes) != MPG123_OK) {
+      deep_decoded_ = true;
+      return;
+    }
+    deep_pcm_->push(std::span{reinterpret_cast<const int16_t *>(buffer_.data()),
+                              completed_bytes / sizeof(int16_t)});
+  }
+}
+
+auto Player::feed_from_deep_buffer(size_t queued) -> size_t {
+  const auto target = static_cast<size_t>(
+      static_cast<int64_t>(sample_rate_) * std::max(1, channels_) *
+      std::chrono::seconds(DEEP_SINK_TARGET).count());
+  while (queued < target && control().state == State::PLAY) {
+    size_t count = 0;
+    {
+      TracedMutex::Guard lock(audio_mutex_);
+      if (!deep_pcm_) {
+        break;
+      }
+      const auto [first, second] = deep_pcm_->peek();
+      const auto want = std::min(target - queued,
+                                 buffer_.size() / sizeof(int16_t));
+      auto *out = reinterpret_cast<int16_t *>(buffer_.data());
+      auto skip = deep_fed_;
+      for (const auto part : {first, second}) {
+        const auto from = std::min(skip, part.size());
+        skip -= from;
+        const auto take = std::min(want - count, part.size() - from);
+        std::copy_n(part.begin() + static_cast<ptrdiff_t>(from), take,
+                    out + count);
+        count += take;
+      }
+      deep_fed_ += count;
+    }
+    if (count == 0) {
+      break;
+    }
+    queue_audio(count * sizeof(int16_t));
+    queued += count;
+  }
+  return queued;
+}
+
+void Player::reset_deep_buffer() {
+  if (deep_pcm_) {
+    deep_pcm_->clear();
+  }
+  deep_fed_ = 0;
+  deep_decoded_ = false;
+}
+
+void Player::sleep_for_command(Clock::time_point deadline) {
+  {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    const auto sequence = wake_sequence_;
+    const auto state = control().state;
+    // A trim requested just before the sleep only matters while playing
+    const auto trim_pending = [this, state] {
+      return state == State::PLAY && trim_requested_.load();
+    };
+    while (wake_sequence_ == sequence && control().state == state &&
+           !trim_pending() && clock_.now() < deadline) {
+      clock_.wait_until(wake_, lock, deadline);
+    }
+  }
+  note_wakeup();
+}
+
+void Player::request_trim() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    trim_requested_.store(deep_mode_.load());
+    ++wake_sequence_;
+  }
+  wake_.notify_all();
+}
+
+void Player::idle(std::chrono::milliseconds delay) {
+  clock_.sleep_for(delay);
+  note_wakeup();
+}
+
+void Player::note_wakeup() {
+  const auto wakeups = wakeups_.fetch_add(1) + 1;
+  const auto now = clock_.now();
+  const auto window = now - window_start_;
+  if (window >= STATS_WINDOW) {
+    wakeup_rate_.store(static_cast<double>(wakeups - window_wakeups_) /
+                       std::chrono::duration<double>(window).count());
+    window_wakeups_ = wakeups;
+    window_start_ = now;
+  }
+}
+
+void Player::queue_audio(size_t bytes) {
+  std::span samples{reinterpret_cast<int16_t *>(buffer_.data()), bytes / 2};
+  if (down_sample_ != 0 || decode_channels_ != channels_) {
+    try {
+      samples = expand_degraded(samples);
+    } catch (const std::bad_alloc &) {
+      // Over the pcm budget: lose this block, not the player thread; the
+      // refusal shows in the tag's usage
+      return;
+    }
+  }
+  apply_volume(samples);
+  TracedMutex::Guard lock(audio_mutex_);
+  if (!sink_->is_open()) {
+    return;
+  }
+  if (sync_follower_) {
+    resampler_.process(samples, resampled_);
+    sink_->write(resampled_);
+  } else {
+    sink_->write(samples);
+  }
+}
+
+auto Player::decode_block(size_t &bytes) -> int {
+  if (quality_reset_.exchange(false)) {
+    pending_quality_.reset();
+    quality_.reset(clock_.now());
+  }
+  // Deep mode calls in with audio_mutex_ held and never degrades
+  if (pending_quality_ && !deep_mode_.load()) {
+    const auto reopened = apply_quality(*pending_quality_);
+    pending_quality_.reset();
+    if (!reopened) {
+      bytes = 0;
+      return MPG123_ERR; // Ends the track; the next one opens afresh
+    }
+  }
+  const auto start = clock_.now();
+  int result = MPG123_OK;
+  // A corrupt frame is dropped and decoding resyncs at the next good one
+  for (int retries = 0; retries < MAX_DECODE_ERRORS; ++retries) {
+    result = mpg123_read(mpg_handler_, buffer_.data(), buffer_.size(), &bytes);
+    if (bytes > 0 || (result != MPG123_ERR && result != MPG123_NEW_FORMAT)) {
+      break;
+    }
+    if (result == MPG123_ERR) {
+      decode_errors_.fetch_add(1);
+    }
+  }
+  if (result != MPG123_DONE && bytes > 0) {
+    result = MPG123_OK;
+  }
+  const auto decode_time = clock_.now() - start;
+  // Streams cannot be reopened at a frame, and deep mode keeps its own margin
+  if (result != MPG123_OK || !adaptive_quality_.load() || deep_mode_.load() ||
+      http_source_ || sample_rate_ <= 0) {
+    return result;
+  }
+
+  const auto decoded_per_second =
+      (static_cast<int64_t>(sample_rate_) >> down_sample_) *
+      std::max(1, decode_channels_) * static_cast<int64_t>(sizeof(int16_t));
+  const auto output_per_second = static_cast<int64_t>(sample_rate_) *
+                                 std::max(1, channels_) *
+                                 static_cast<int64_t>(sizeof(int16_t));
+  const auto to_time = [](int64_t bytes, int64_t per_second) {
+    return std::chrono::nanoseconds(bytes * 1'000'000'000 / per_second);
+  };
+  const auto audio =
+      to_time(static_cast<int64_t>(bytes), decoded_per_second);
+  std::chrono::nanoseconds queued{0};
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    queued = to_time(sink_->queued_bytes(), output_per_second);
+  }
+  // The block is still in the old format; switch before the next one
+  pending_quality_ = quality_.observe(
+      clock_.now(), std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        decode_time),
+      audio, queued + audio);
+  return result;
+}
+
+auto Player::apply_quality(QualityController::Level level) -> bool {
+  if (decode_params(level) == decode_params(decode_level_)) {
+    // Only the DSP changes, and it reads quality_.level() itself
+    return true;
+  }
+  // mpg123 takes these parameters on open: reopen at the same frame
+  TracedMutex::Guard lock(audio_mutex_);
+  const auto frame = mpg123_tellframe(mpg_handler_);
+  const auto reopen_at = [this, frame](QualityController::Level at) {
+    mpg123_close(mpg_handler_);
+    set_decode_params(at);
+    return reopen_decoder() &&
+           mpg123_seek_frame(mpg_handler_, frame, SEEK_SET) >= 0;
+  };
+  const auto previous = decode_level_;
+  if (!reopen_at(level)) {
+    std::cerr << "[WARN] Cannot reopen " << path_ << " at "
+              << QualityController::name(level) << " quality\n";
+    if (!reopen_at(previous)) {
+      mpg123_close(mpg_handler_);
+      mark_unplayable(path_, "Cannot reopen " + path_);
+      return false;
     }
   }
+  long rate = 0;
+  int channels = 0;
+  int encoding = 0;
+  mpg123_getformat(mpg_handler_, &rate, &channels, &encoding);
+  decode_channels_ = channels;
+  down_sample_ = 0;
+  while (rate > 0 && (rate << down_sample_) < sample_rate_) {
+    ++down_sample_;
+  }
+  return true;
+}
+
+auto Player::reopen_decoder() -> bool {
+  if (http_source_) {
+    // mpg123 reads from wherever the source is; the cache keeps it cheap
+    return http_source_->seek(0, SEEK_SET) == 0 &&
+           mpg123_open_handle(mpg_handler_, http_source_.get()) == MPG123_OK;
+  }
+  return mpg123_open(mpg_handler_, path_.c_str()) == MPG123_OK;
+}
+
+auto Player::decode_params(QualityController::Level level)
+    -> std::pair<bool, long> {
+  using Level = QualityController::Level;
+  long down_sample = 0;
+  if (level == Level::HALF_RATE) {
+    down_sample = 1;
+  } else if (level == Level::QUARTER_RATE) {
+    down_sample = 2;
+  }
+  return {level >= Level::MONO, down_sample};
+}
+
+void Player::set_decode_params(QualityController::Level level) {
+  const auto [mono, down_sample] = decode_params(level);
+  if (mono) {
+    mpg123_param(mpg_handler_, MPG123_ADD_FLAGS, MPG123_MONO_MIX, 0);
+  } else {
+    mpg123_param(mpg_handler_, MPG123_REMOVE_FLAGS, MPG123_FORCE_MONO, 0);
+  }
+  mpg123_param(mpg_handler_, MPG123_DOWN_SAMPLE, down_sample, 0);
+  decode_level_ = level;
+}
+
+auto Player::expand_degraded(std::span<int16_t> samples)
+    -> std::span<int16_t> {
+  // Sample-and-hold up to the sink rate, mono copied to every channel
+  const auto in_channels = static_cast<size_t>(std::max(1, decode_channels_));
+  const auto out_channels = static_cast<size_t>(std::max(1, channels_));
+  const auto repeat = size_t{1} << static_cast<size_t>(down_sample_);
+  const auto frames = samples.size() / in_channels;
+  expanded_.resize(frames * repeat * out_channels);
+  auto out = expanded_.begin();
+  for (size_t frame = 0; frame < frames; ++frame) {
+    const auto *in = samples.data() + (frame * in_channels);
+    for (size_t copy = 0; copy < repeat; ++copy) {
+      for (size_t channel = 0; channel < out_channels; ++channel) {
+        *out++ = in[std::min(channel, in_channels - 1)];
+      }
+    }
+  }
+  return expanded_;
+}
+
+void Player::stream_live() {
+  static constexpr auto READ_TIMEOUT = std::chrono::milliseconds(100);
+  static constexpr auto DELAY_MS = 10U;
+  std::array<char, AUDIO_BUFFER_SIZE> input{};
+
+  while (control().state == State::PLAY && !icy_stream_->finished()) {
+    const auto received = icy_stream_->read(input, READ_TIMEOUT);
+    if (received == 0) {
+      continue;
+    }
+    mpg123_feed(mpg_handler_,
+                reinterpret_cast<const unsigned char *>(input.data()),
+                received);
+    update_live_title();
+
+    size_t completed_bytes = 0;
+    int result = MPG123_OK;
+    while (control().state == State::PLAY &&
+           (result = mpg123_read(mpg_handler_, buffer_.data(), buffer_.size(),
+                                 &completed_bytes)) != MPG123_NEED_MORE) {
+      if (result == MPG123_NEW_FORMAT) {
+        long rate = 0;
+        int channels = 0;
+        int encoding = 0;
+        mpg123_getformat(mpg_handler_, &rate, &channels, &encoding);
+        sample_rate_ = static_cast<int32_t>(rate);
+        open_audio_device(rate, channels);
+        resume_audio_device();
+        continue;
+      }
+      if (result != MPG123_OK) {
+        std::cerr << "[WARN] Stream decode error: "
+                  << mpg123_strerror(mpg_handler_) << '\n';
+        break;
+      }
+      wait_until_buffer_has_space(DELAY_MS, QUEUE_DEPTH);
+      queue_audio(completed_bytes);
+    }
+  }
+}
+
+void Player::update_live_title() {
+  auto title = icy_stream_->stream_title();
+  if (title.empty() || title == live_title_) {
+    return;
+  }
+  live_title_ = title;
+  static constexpr std::string_view SEPARATOR = " - ";
+  const auto separator = title.find(SEPARATOR);
+  if (separator == std::string::npos) {
+    set_track_info(title, icy_stream_->station_name());
+  } else {
+    set_track_info(title.substr(separator + SEPARATOR.size()),
+                   title.substr(0, separator));
+  }
+  update_stream_metadata();
+}
+
+void Player::stream_passthrough() {
+  static constexpr auto CHUNK_SIZE = 16U * 1024U;
+  static constexpr auto DELAY_MS = 20U;
+  static constexpr auto MS_PER_SECOND = 1000;
+
+  // Songs from a URL come through their cached source, as the decoder's do
+  const bool remote = HttpUrl::is_url(path_);
+  std::ifstream file;
+  int64_t file_size = -1;
+  if (remote) {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (http_source_) {
+      file_size = static_cast<int64_t>(http_source_->size());
+    }
+  } else {
+    file.open(path_, std::ios::binary | std::ios::ate);
+    if (file) {
+      file_size = static_cast<int64_t>(file.tellg());
+    }
+  }
+  if (file_size < 0) {
+    std::cerr << "[WARN] Cannot stream " << path_ << '\n';
+    return;
+  }
+  const auto read_at = [&](int64_t offset, std::span<char> out) -> int64_t {
+    if (!remote) {
+      file.clear();
+      file.seekg(offset);
+      file.read(out.data(), static_cast<std::streamsize>(out.size()));
+      return file.gcount();
+    }
+    TracedMutex::Guard lock(audio_mutex_);
+    if (!http_source_ || http_source_->seek(offset, SEEK_SET) != offset) {
+      return -1;
+    }
+    return http_source_->read(out);
+  };
+  // Average byte rate paces VBR files well enough for listener buffers
+  const int64_t byte_rate = file_size / std::max(1, total_seconds_);
+
+  std::vector<char> chunk(CHUNK_SIZE);
+  int64_t sent = 0;
+  while (control().state == State::PLAY && sent < file_size) {
+    const auto elapsed_ms = elapsed().count();
+
+    // Stay one second ahead so listeners never starve
+    const int64_t target = std::min(
+        file_size, (byte_rate * elapsed_ms / MS_PER_SECOND) + byte_rate);
+
+    // A seek moved the clock: reposition instead of catching up
+    if (target + byte_rate < sent || target > sent + (2 * byte_rate)) {
+      sent = std::max<int64_t>(0, target - byte_rate);
+    }
+
+    while (sent < target) {
+      const auto want = std::min<int64_t>(CHUNK_SIZE, target - sent);
+      const auto got =
+          read_at(sent, std::span{chunk.data(), static_cast<size_t>(want)});
+      if (got <= 0) {
+        return;
+      }
+      stream_server_->publish(
+          std::span{chunk.data(), static_cast<size_t>(got)});
+      sent += got;
+    }
+    idle(std::chrono::milliseconds(DELAY_MS));
+  }
+}
+
+void Player::update_stream_metadata() {
+  if (!stream_server_) {
+    return;
+  }
+  const auto title = get_title();
+  const auto artist = get_artist();
+  if (artist.empty()) {
+    stream_server_->set_metadata(title);
+  } else {
+    stream_server_->set_metadata(artist + " - " + title);
+  }
+}
+
+void Player::set_track_info(std::string title, std::string artist) {
+  std::lock_guard<std::mutex> lock(metadata_mutex_);
+  title_ = std::move(title);
+  artist_ = std::move(artist);
+}
+
+void Player::sync_zone() {
+  if (sync_leader_) {
+    publish_media_clock(true);
+    return;
+  }
+  if (!sync_follower_ || !sync_follower_->synchronized()) {
+    return;
+  }
+  const auto clock = sync_follower_->media_clock();
+  if (!clock || !clock->playing || clock->path != path_) {
+    return;
+  }
+
+  TracedMutex::Guard lock(audio_mutex_);
+  const auto now = steady_now_ns();
+  const auto expected = clock->frame_at(sync_follower_->to_leader(now));
+  const auto correction =
+      zone_sync_.update(now, expected, audible_frame(), sample_rate_);
+  resampler_.set_ratio(correction.ratio);
+  sync_error_.store(zone_sync_.error());
+  if (!correction.seek_frame) {
+    return;
+  }
+
+  // Too far off to slew: jump to where the leader is and drop the backlog
+  const auto target = std::max<int64_t>(0, *correction.seek_frame);
+  if (mpg123_seek(mpg_handler_, static_cast<off_t>(target), SEEK_SET) < 0) {
+    std::cerr << "[WARN] Sync seek failed\n";
+    return;
+  }
+  sink_->clear();
+  resampler_.reset(channels_);
+  static constexpr auto MS_PER_SECOND = 1000;
+  set_elapsed(
+      std::chrono::milliseconds(target * MS_PER_SECOND / sample_rate_));
+}
+
+void Player::follow_leader_state() {
+  const auto clock = sync_follower_->media_clock();
+  if (!clock || !sync_follower_->synchronized()) {
+    return;
+  }
+  const auto state = control().state;
+  if (!clock->playing) {
+    if (state == State::PLAY) {
+      pause();
+    }
+    return;
+  }
+  if (clock->path != path_) {
+    try {
+      load_song(clock->path);
+      resume();
+    } catch (const std::exception &e) {
+      std::cerr << "[WARN] Cannot follow leader: " << e.what() << '\n';
+      path_ = clock->path; // Do not retry until the leader moves on
+      song_.reset();
+    }
+    return;
+  }
+  if (state == State::PAUSE) {
+    resume();
+  }
+}
+
+auto Player::in_step_with_leader() const -> bool {
+  if (!sync_follower_) {
+    return true;
+  }
+  const auto clock = sync_follower_->media_clock();
+  return !clock || (clock->playing && clock->path == path_);
+}
+
+void Player::publish_media_clock(bool playing) {
+  int64_t frame = 0;
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    frame = audible_frame();
+  }
+  sync_leader_->publish(
+      {sync_leader_->now(), frame, sample_rate_, playing, path_});
+}
+
+auto Player::audible_frame() const -> int64_t {
+  const auto position = static_cast<int64_t>(mpg123_tell(mpg_handler_));
+  const auto frame_bytes = static_cast<int64_t>(channels_) *
+                           static_cast<int64_t>(sizeof(int16_t));
+  const auto queued =
+      frame_bytes > 0 ? sink_->queued_bytes() / frame_bytes : 0;
+  return std::max<int64_t>(0, position - queued);
 }
 
 void Player::wait_until_buffer_has_space(unsigned delay_ms,
                                          unsigned multiplier) {
-  while (state_.load() == State::PLAY) {
+  while (control().state == State::PLAY) {
     bool buffer_ready = false;
     {
-      std::lock_guard<std::mutex> lock(audio_mutex_);
-      if (audio_device_.has_value()) {
-        buffer_ready = SDL_GetQueuedAudioSize(audio_device_.value()) <=
-                       SDL_AUDIO_BUFFER_SIZE * multiplier;
+      TracedMutex::Guard lock(audio_mutex_);
+      if (sink_->is_open()) {
+        buffer_ready =
+            sink_->queued_bytes() <= AUDIO_BUFFER_SIZE * multiplier;
       }
     }
     if (buffer_ready) {
       break;
     }
-    SDL_Delay(delay_ms);
+    idle(std::chrono::milliseconds(delay_ms));
   }
 }
 
 void Player::wait_for_buffer_to_drain() {
   static constexpr auto DELAY_MS = 50U;
-  while (state_.load() == State::PLAY) {
-    std::lock_guard<std::mutex> lock(audio_mutex_);
-    if (!audio_device_.has_value()) {
+  while (control().state == State::PLAY) {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (!sink_->is_open()) {
       break;
     }
-    if (SDL_GetQueuedAudioSize(audio_device_.value()) <= 0) {
+    if (sink_->queued_bytes() <= 0) {
       break;
     }
-    SDL_Delay(DELAY_MS);
+    idle(std::chrono::milliseconds(DELAY_MS));
   }
 }
 
-void Player::update_elapsed_time() {
-  auto now = std::chrono::steady_clock::now();
-  elapsed_seconds_ =
-      static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(
-                           elapsed_duration_ + (now - start_time_))
-                           .count());
-}
-
 auto Player::is_playing() const noexcept -> bool {
-  return state_.load() == State::PLAY;
+  return control().state == State::PLAY;
 }
 
 auto Player::get_progress() const noexcept -> std::pair<int, int> {
-  return {elapsed_seconds_.load(), total_seconds_};
+  const auto seconds = static_cast<int>(
+      std::chrono::duration_cast<std::chrono::seconds>(elapsed()).count());
+  // The timeline runs on while the last buffer drains
+  return {total_seconds_ > 0 ? std::min(seconds, total_seconds_) : seconds,
+          total_seconds_};
 }
 
-auto Player::get_title() const noexcept -> const std::string & {
+auto Player::get_title() const -> std::string {
+  std::lock_guard<std::mutex> lock(metadata_mutex_);
   return title_;
 }
-auto Player::get_artist() const noexcept -> const std::string & {
+auto Player::get_artist() const -> std::string {
+  std::lock_guard<std::mutex> lock(metadata_mutex_);
   return artist_;
 }
 
 void Player::seek_relative(int delta_seconds) {
-  std::lock_guard<std::mutex> lock(audio_mutex_);
+  {
+    // Held across the whole seek on purpose: the player thread decodes from
+    // the same handle, and mpg123's frame index keeps the seek short. Only
+    // resume(), which fades for hundreds of milliseconds, runs unlocked.
+    TracedMutex::Guard lock(audio_mutex_);
 
-  if (state_.load() == State::SWITCH_OFF || !audio_device_.has_value()) {
-    return;
-  }
+    if (control().state == State::SWITCH_OFF || !sink_->is_open()) {
+      return;
+    }
 
-  // Compute new position in seconds
-  const int current = elapsed_seconds_.load();
-  const int target = std::clamp(current + delta_seconds, 0, total_seconds_);
+    // Compute new position in seconds
+    const int current = get_progress().first;
+    const int target = std::clamp(current + delta_seconds, 0, total_seconds_);
 
-  // Seek to the new position
-  long rate = 0;
-  int channels = 0;
-  int encoding = 0;
-  mpg123_getformat(mpg_handler_, &rate, &channels, &encoding);
-  const auto sample_offset = static_cast<off_t>(target * rate);
-  if (mpg123_seek(mpg_handler_, sample_offset, SEEK_SET) == MPG123_ERR) {
-    std::cerr << "[WARN] Seek failed\n";
-    return;
-  }
+    // Seek to the new position
+    long rate = 0;
+    int channels = 0;
+    int encoding = 0;
+    mpg123_getformat(mpg_handler_, &rate, &channels, &encoding);
+    const auto sample_offset = static_cast<off_t>(target * rate);
+    if (mpg123_seek(mpg_handler_, sample_offset, SEEK_SET) == MPG123_ERR) {
+      std::cerr << "[WARN] Seek failed\n";
+      return;
+    }
 
-  // Reset buffer and timing
-  if (audio_device_.has_value()) {
-    SDL_ClearQueuedAudio(audio_device_.value());
+    // Reset buffer and timing
+    sink_->clear();
+    track_decoded_ = false;
+    reset_deep_buffer();
+    request_trim();
+    quality_.restart_buffering();
+    set_elapsed(std::chrono::seconds(target));
   }
-  elapsed_duration_ = std::chrono::seconds(target);
-  start_time_ = std::chrono::steady_clock::now();
   resume();
 }
 
 void Player::set_volume(float vol) {
   volume_.store(std::clamp(vol, VOLUME_MUTE, VOLUME_FULL));
+  if (deep_mode_.load()) {
+    request_trim();
+  }
 }
 
 void Player::adjust_volume(float delta) { set_volume(get_volume() + delta); }
@@ -311,34 +1496,216 @@ auto Player::get_volume() const -> float { return volume_.load(); }
 
 auto Player::get_playlist() -> std::unique_ptr<Playlist> & { return playlist_; }
 
+auto Player::add_output(std::unique_ptr<AudioSink> sink,
+                        std::chrono::milliseconds latency) -> size_t {
+  return sink_->add_output(std::move(sink), latency);
+}
+
+auto Player::get_sink() -> FanOutSink & { return *sink_; }
+
+auto Player::get_clock() const noexcept -> Clock & { return clock_; }
+
+void Player::set_deep_buffer(std::chrono::seconds depth) {
+  if (reactor_ != nullptr) {
+    throw std::runtime_error("Deep buffer mode needs the player thread");
+  }
+  if (is_playing()) {
+    throw std::runtime_error("Cannot change the deep buffer while playing");
+  }
+  TracedMutex::Guard lock(audio_mutex_);
+  deep_depth_ = depth;
+  deep_fed_ = 0;
+  deep_decoded_ = false;
+  if (depth.count() <= 0) {
+    deep_mode_.store(false);
+    deep_pcm_.reset();
+    return;
+  }
+  // Sized for the largest MP3 format so no track reallocates
+  deep_pcm_ = std::make_unique<PcmRing>(
+      static_cast<size_t>(depth.count()) * DEEP_MAX_RATE * DEEP_MAX_CHANNELS);
+  deep_mode_.store(true);
+}
+
+void Player::set_adaptive_quality(bool enabled) {
+  adaptive_quality_.store(enabled);
+}
+
+void Player::set_decoder(const std::string &name) {
+  TracedMutex::Guard lock(audio_mutex_);
+  if (mpg123_decoder(mpg_handler_, name.c_str()) != MPG123_OK) {
+    throw std::runtime_error("Cannot use mpg123 decoder " + name + ": " +
+                             mpg123_strerror(mpg_handler_));
+  }
+}
+
+auto Player::stats() const -> Stats {
+  std::chrono::milliseconds buffered{0};
+  std::string decoder;
+  {
+    TracedMutex::Guard lock(audio_mutex_);
+    if (const char *name = mpg123_current_decoder(mpg_handler_);
+        name != nullptr) {
+      decoder = name;
+    }
+    const auto rate = static_cast<int64_t>(sample_rate_) * std::max(1, channels_);
+    if (rate > 0) {
+      const auto queued =
+          static_cast<int64_t>(sink_->queued_bytes() / sizeof(int16_t));
+      const auto ahead = deep_pcm_
+                             ? static_cast<int64_t>(deep_pcm_->size()) -
+                                   static_cast<int64_t>(deep_fed_) + queued
+                             : queued;
+      buffered = std::chrono::milliseconds(ahead * 1000 / rate);
+    }
+  }
+  return {wakeups_.load(),        wakeup_rate_.load(),  buffered,
+          deep_mode_.load(),      decoder,              quality_.counters(),
+          skipped_tracks_.load(), decode_errors_.load(),
+          MemoryAccounting::report()};
+}
+
+void Player::set_lock_tracing(bool enabled) {
+  audio_mutex_.set_tracing(enabled);
+}
+
+auto Player::lock_report() const -> std::vector<TracedMutex::SiteReport> {
+  return audio_mutex_.report();
+}
+
+void Player::attach(Reactor &reactor) {
+  if (deep_mode_.load()) {
+    throw std::runtime_error("Deep buffer mode needs the player thread");
+  }
+  if (is_playing()) {
+    throw std::runtime_error("attach() must precede playback");
+  }
+  if (stream_server_ || icy_stream_) {
+    throw std::runtime_error("Streaming modes need the player thread");
+  }
+  player_thread_.request_stop();
+  player_thread_.join();
+  reactor_ = &reactor;
+  pump_timer_ = reactor.add_timer(PUMP_INTERVAL, [this] { pump(); });
+}
+
+void Player::start_stream_server(uint16_t port) {
+  if (reactor_ != nullptr) {
+    throw std::runtime_error("Stream server mode needs the player thread");
+  }
+  stream_server_ = std::make_unique<StreamServer>(port);
+  update_stream_metadata();
+}
+
+auto Player::get_stream_server() const noexcept -> StreamServer * {
+  return stream_server_.get();
+}
+
+void Player::start_sync_leader(uint16_t port) {
+  sync_leader_ = std::make_unique<ClockLeader>(port);
+}
+
+void Player::follow_leader(const std::string &host, uint16_t port) {
+  sync_follower_ = std::make_unique<ClockFollower>(host, port);
+}
+
+auto Player::get_sync_leader() const noexcept -> ClockLeader * {
+  return sync_leader_.get();
+}
+
+auto Player::get_sync_follower() const noexcept -> ClockFollower * {
+  return sync_follower_.get();
+}
+
+auto Player::get_sync_error() const -> double { return sync_error_.load(); }
+
 void Player::apply_volume(std::span<int16_t> buffer) {
   const auto volume = get_volume();
-  std::ranges::for_each(buffer, [volume](int16_t &data) {
-    data = static_cast<int16_t>(data * volume);
-  });
+  const auto &kernels = dsp_kernels();
+  if (volume == applied_volume_ ||
+      quality_.level() >= QualityController::Level::LEAN_DSP) {
+    kernels.apply_gain(buffer, volume);
+    applied_volume_ = volume;
+  } else {
+    kernels.apply_ramp(buffer, std::max(1, channels_), applied_volume_,
+                       volume);
+    applied_volume_ = volume;
+  }
 }
 
-auto Player::fade_to(float target, int duration_ms) -> std::future<void> {
-  return std::async(std::launch::async, [this, target, duration_ms] {
-    static constexpr auto N_STEPS = 10;
-    auto step = (target - get_volume()) / N_STEPS;
-    for (int i = 0; i < N_STEPS; ++i) {
+auto Player::fade_to(float target, int duration_ms,
+                     std::function<void()> then) -> std::future<void> {
+  const auto generation = control().generation;
+  if (reactor_ != nullptr) {
+    // No thread per fade on the event loop, and no sleeping on it either
+    if (fade_) {
+      finish_fade(); // Superseded; ends at the next step anyway
+    }
+    fade_ = std::make_unique<Fade>();
+    fade_->target = target;
+    fade_->step = (target - get_volume()) / FADE_STEPS;
+    fade_->generation = generation;
+    fade_->then = std::move(then);
+    auto done = fade_->done.get_future();
+    set_volume(get_volume() + fade_->step);
+    fade_->steps = 1;
+    fade_->timer = reactor_->add_timer(
+        std::chrono::milliseconds(std::max(1, duration_ms / FADE_STEPS)),
+        [this] { step_fade(); });
+    return done;
+  }
+  auto fade = [this, target, duration_ms, generation,
+               then = std::move(then)] {
+    auto step = (target - get_volume()) / FADE_STEPS;
+    for (int i = 0; i < FADE_STEPS; ++i) {
+      if (control().generation != generation) {
+        break; // Superseded; the newer transition owns the volume
+      }
       set_volume(get_volume() + step);
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(duration_ms / N_STEPS));
+      clock_.sleep_for(
+          std::chrono::milliseconds(duration_ms / FADE_STEPS));
     }
-    set_volume(target);
-  });
+    if (control().generation == generation) {
+      set_volume(target);
+    }
+    if (then) {
+      then();
+    }
+  };
+  return std::async(std::launch::async, std::move(fade));
+}
+
+void Player::step_fade() {
+  if (control().generation == fade_->generation &&
+      fade_->steps < FADE_STEPS) {
+    set_volume(get_volume() + fade_->step);
+    ++fade_->steps;
+    return;
+  }
+  finish_fade();
+}
+
+void Player::finish_fade() {
+  // Detached first: the continuation may start the next fade
+  const auto fade = std::move(fade_);
+  reactor_->cancel_timer(fade->timer);
+  if (control().generation == fade->generation) {
+    set_volume(fade->target);
+  }
+  if (fade->then) {
+    fade->then();
+  }
+  fade->done.set_value();
 }
 
 void Player::pause_audio_device() {
-  if (audio_device_.has_value()) {
-    SDL_PauseAudioDevice(audio_device_.value(), 1);
+  if (sink_->is_open()) {
+    sink_->pause();
   }
 }
 
 void Player::resume_audio_device() {
-  if (audio_device_.has_value()) {
-    SDL_PauseAudioDevice(audio_device_.value(), 0);
+  if (sink_->is_open()) {
+    sink_->resume();
   }
 }
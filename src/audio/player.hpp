@@ -6,40 +6,86 @@
 // License. See the LICENSE file in the project root for full license
 // information.
 
-#include <SDL2/SDL.h>
 #include <mpg123.h>
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
+#include <string>
 #include <thread>
-
+#include <unordered_set>
+#include <vector>
+
+#include "../net/clock_sync.hpp"
+#include "../net/http_source.hpp"
+#include "../net/icy_stream.hpp"
+#include "../net/stream_server.hpp"
+#include "../util/clock.hpp"
+#include "../util/memory_accounting.hpp"
+#include "../util/reactor.hpp"
+#include "../util/traced_mutex.hpp"
+#include "audio_sink.hpp"
+#include "fan_out_sink.hpp"
+#include "history_log.hpp"
 #include "playlist.hpp"
+#include "quality_controller.hpp"
+#include "resampler.hpp"
+#include "resume_state.hpp"
+#include "ring_buffer.hpp"
+#include "track_validator.hpp"
+#include "zone_sync.hpp"
 
 /**
  * @class Player
- * @brief Handles MP3 playback using SDL2 and libmpg123 with playlist support.
+ * @brief Handles MP3 playback using libmpg123 with playlist support.
  *
  * The Player class is responsible for decoding and playing MP3 files,
  * managing playback state (play, pause, stop), handling volume control,
  * seeking, and transitioning between songs in a playlist.
  *
- * It uses SDL2 for audio output and libmpg123 for MP3 decoding.
- * Playback runs in a dedicated thread with cooperative cancellation.
+ * It uses libmpg123 for MP3 decoding and writes the processed PCM to an
+ * AudioSink (SDL2 by default). Decoding happens once; extra outputs are fed
+ * from the same stream through a FanOutSink. Playback runs in a dedicated
+ * thread with cooperative cancellation.
  *
  * @note Playback and audio device interactions are thread-safe.
  */
 class Player {
   friend class PlayerTest; ///< Allows test fixture to access private members
   friend class CLITest; ///< Allows CLI test fixture to access private members
-
-  static constexpr auto SDL_AUDIO_BUFFER_SIZE = 8192U; ///< Audio buffer size
+  friend class PlayerManualClockTest; ///< Steps fades on a MANUAL clock
+
+  static constexpr auto AUDIO_BUFFER_SIZE = 8192U; ///< Decode block size
+  static constexpr auto QUEUE_DEPTH = 32U; ///< Decode blocks queued ahead
+  static constexpr auto PUMP_INTERVAL =
+      std::chrono::milliseconds(10); ///< Decode period in reactor mode
+  static constexpr auto DEEP_SINK_TARGET =
+      std::chrono::seconds(2); ///< Sink fill per deep-mode wakeup
+  static constexpr auto DEEP_SINK_LOW =
+      std::chrono::milliseconds(500); ///< Sink level that ends a deep sleep
+  static constexpr auto DEEP_REFILL_DIVISOR =
+      4U; ///< Deep buffer refills below 1/4 full
+  static constexpr auto DEEP_MAX_RATE = 48000; ///< Sizes the deep buffer
+  static constexpr auto DEEP_MAX_CHANNELS = 2; ///< Sizes the deep buffer
+  static constexpr auto TIMER_SLACK =
+      std::chrono::milliseconds(50); ///< Player thread slack in deep mode
+  static constexpr size_t VALIDATE_AHEAD = 2; ///< Entries checked in advance
+  static constexpr int MAX_DECODE_ERRORS = 64; ///< Resyncs before giving up
+  static constexpr auto RESUME_INTERVAL =
+      std::chrono::milliseconds(250); ///< Period of resume state saves
+  static constexpr auto STATS_WINDOW =
+      std::chrono::seconds(5); ///< Period of the wakeup rate
   static constexpr auto VOLUME_FULL = 1.0F;            ///< Max volume
   static constexpr auto VOLUME_MUTE = 0.0F;            ///< Muted volume
   static constexpr auto DEFAULT_FADE_DURATION =
       300; ///< Fade duration in milliseconds
+  static constexpr auto FADE_STEPS = 10; ///< Volume steps per fade
 
   /**
    * @enum State
@@ -52,7 +98,47 @@ class Player {
     SWITCH_OFF = 3 ///< Shutdown state
   };
 
+  /**
+   * @struct Control
+   * @brief Playback state, volume to play at and generation, packed into
+   * one 64-bit word so they always change together.
+   *
+   * Every transition bumps the generation. Work started for one generation,
+   * such as a fade, stops as soon as the generation moves on, so a pause
+   * and a resume pressed in quick succession never fight over the volume.
+   */
+  struct Control {
+    static constexpr uint32_t GENERATION_MASK = 0xFFFFFF; ///< 24 bits kept
+
+    State state{State::STOPPED}; ///< Playback state
+    uint32_t generation{0};      ///< Transitions so far, modulo 2^24
+    float volume{VOLUME_FULL};   ///< Volume to fade to when resuming
+
+    /// Packs into state | generation << 8 | volume bits << 32
+    [[nodiscard]] auto pack() const -> uint64_t;
+
+    /// Inverse of pack()
+    [[nodiscard]] static auto unpack(uint64_t word) -> Control;
+  };
+
 public:
+  /**
+   * @struct Stats
+   * @brief Runtime counters of the playback loop.
+   */
+  struct Stats {
+    uint64_t wakeups;             ///< Decode-loop wakeups since construction
+    double wakeups_per_second;    ///< Over the last complete STATS_WINDOW
+    std::chrono::milliseconds buffered; ///< Decoded audio not yet heard
+    bool deep_buffer;             ///< Deep-buffer mode is enabled
+    std::string decoder;          ///< Active mpg123 synth decoder
+    QualityController::Counters quality; ///< Adaptive quality state
+    uint64_t skipped_tracks;      ///< Unplayable playlist entries passed over
+    uint64_t decode_errors;       ///< Corrupt data the decoder resynced past
+    std::array<MemoryAccounting::Usage, MemoryAccounting::TAGS>
+        memory; ///< Heap use per subsystem, process-wide
+  };
+
   /**
    * @brief Constructs and initializes the Player.
    * Initializes SDL2 and mpg123, and starts the background playback thread.
@@ -60,6 +146,16 @@ public:
    */
   Player();
 
+  /**
+   * @brief Constructs a Player writing to the given sink.
+   * @param sink Primary output for decoded audio; it paces playback.
+   * @param clock Time base for fades, progress and buffer waits; must
+   * outlive the Player.
+   * @throws std::runtime_error if mpg123 fails to initialize.
+   */
+  explicit Player(std::unique_ptr<AudioSink> sink,
+                  Clock &clock = Clock::steady());
+
   /**
    * @brief Destructor.
    * Stops playback and releases audio resources.
@@ -74,30 +170,75 @@ public:
 
   /**
    * @brief Sets the playlist for the player.
+   *
+   * With a resume state whose last point belongs to the same playlist, the
+   * play order, song, position and volume are restored, and playback
+   * continues if it was running.
+   *
    * @param playlist A unique pointer to a Playlist object.
    */
   void set_playlist(std::unique_ptr<Playlist> playlist);
 
-  /// Loads and prepares the current song in the playlist.
+  /**
+   * @brief Saves the playback position every RESUME_INTERVAL.
+   *
+   * Set before set_playlist() to resume from the saved point. The position
+   * is the last audible sample, and mpg123's frame index is saved along
+   * with it so restoring seeks straight to it instead of scanning the file.
+   *
+   * @param state Where to save; nullptr stops saving.
+   */
+  void set_resume_state(std::unique_ptr<ResumeState> state);
+
+  /// Loads the current song in the playlist, or the next playable one.
   void load_current();
 
-  /// Moves to the next song and starts playback.
+  /// Moves to the next playable song and starts playback.
   void next_song();
 
-  /// Moves to the previous song and starts playback.
+  /// Moves to the previous playable song and starts playback.
   void prev_song();
 
+  /**
+   * @brief Plays a song of the playlist, or the next playable one after it.
+   * @param song Index in Playlist::songs().
+   */
+  void play_song(size_t song);
+
   /**
    * @brief Loads a specific song for playback.
-   * @param path Filesystem path to the MP3 file.
+   * @param path Filesystem path or http:// URL of the MP3 file. URLs are read
+   * through an HttpSource backed by the on-disk cache.
    * @throws std::runtime_error if the file cannot be opened.
    */
   void load_song(const std::string &path);
 
-  /// Pauses playback with a fade-out effect.
+  /**
+   * @brief Loads a specific song for playback, reporting failure by value.
+   * @param path Filesystem path or http:// URL of the MP3 file.
+   * @return Why the song cannot be played, or std::nullopt once loaded.
+   */
+  [[nodiscard]] auto open_song(const std::string &path)
+      -> std::optional<std::string>;
+
+  /**
+   * @brief Loads a live Icecast/SHOUTcast MP3 stream for playback.
+   *
+   * The stream is received into an adaptive jitter buffer and fed to
+   * mpg123's feed decoder; ICY `StreamTitle` updates become the title and
+   * artist. Live streams report a total duration of 0.
+   *
+   * @param url http:// URL of the mount point.
+   * @throws std::runtime_error if the stream cannot be opened.
+   */
+  void load_stream(const std::string &url);
+
+  /// Pauses playback with a fade-out effect; attached to a reactor, returns
+  /// while the loop runs the fade.
   void pause();
 
-  /// Resumes playback with a fade-in effect.
+  /// Resumes playback with a fade-in effect; attached to a reactor, returns
+  /// while the loop runs the fade.
   void resume();
 
   /**
@@ -121,15 +262,15 @@ public:
 
   /**
    * @brief Gets the song title if available from ID3 metadata.
-   * @return Reference to the current song title string.
+   * @return Copy of the current song title, safe to keep across tracks.
    */
-  [[nodiscard]] auto get_title() const noexcept -> const std::string &;
+  [[nodiscard]] auto get_title() const -> std::string;
 
   /**
    * @brief Gets the song artist if available from ID3 metadata.
-   * @return Reference to the current song artist string.
+   * @return Copy of the current song artist.
    */
-  [[nodiscard]] auto get_artist() const noexcept -> const std::string &;
+  [[nodiscard]] auto get_artist() const -> std::string;
 
   /**
    * @brief Accesses the currently loaded playlist.
@@ -137,6 +278,33 @@ public:
    */
   [[nodiscard]] auto get_playlist() -> std::unique_ptr<Playlist> &;
 
+  /**
+   * @brief Records every play of a local or http:// song.
+   *
+   * A play starts when the song first plays and is recorded when another
+   * one is loaded, as skipped unless the song played to its end.
+   *
+   * @param history Where to record; nullptr stops recording.
+   */
+  void set_history(std::unique_ptr<HistoryLog> history);
+
+  /**
+   * @brief Accesses the listening history.
+   * @return The history, or nullptr if plays are not recorded.
+   */
+  [[nodiscard]] auto get_history() const -> const HistoryLog *;
+
+  /**
+   * @brief Turns radio mode on or off for the playlist.
+   *
+   * Radio mode plays songs at random, weighted by the listening history:
+   * songs played to the end come back more often, skipped and just-played
+   * ones less. The current song keeps playing.
+   *
+   * @param on true to start the radio, false to go back to the playlist.
+   */
+  void set_radio(bool on);
+
   /**
    * @brief Sets the playback volume.
    * @param vol A float between 0.0 (mute) and 1.0 (full volume).
@@ -149,6 +317,156 @@ public:
    */
   void adjust_volume(float delta);
 
+  /**
+   * @brief Adds an output fed from the same decoded, post-volume stream.
+   * @param sink The additional sink, e.g. a recorder.
+   * @param latency How far the output may lag before blocks are dropped.
+   * @return Index of the output within the fan-out stage.
+   */
+  auto add_output(std::unique_ptr<AudioSink> sink,
+                  std::chrono::milliseconds latency =
+                      FanOutSink::DEFAULT_LATENCY) -> size_t;
+
+  /**
+   * @brief Accesses the fan-out stage in front of all outputs.
+   * @return The fan-out sink.
+   */
+  [[nodiscard]] auto get_sink() -> FanOutSink &;
+
+  /**
+   * @brief Accesses the time base of the player.
+   * @return The clock given at construction.
+   */
+  [[nodiscard]] auto get_clock() const noexcept -> Clock &;
+
+  /**
+   * @brief Enables or disables deep-buffer playback for battery use.
+   *
+   * The decoder runs in bursts that fill a preallocated buffer of `depth`
+   * seconds of unity-gain PCM, and the player thread sleeps, with timer
+   * slack, for as long as DEEP_SINK_TARGET of queued output allows instead
+   * of polling every few milliseconds. Volume and seek changes trim the
+   * queued output and re-feed it from the buffer, so they are heard as
+   * promptly as in normal mode. Ignored while synchronizing zones.
+   *
+   * @param depth Seconds to buffer; zero returns to normal mode.
+   * @throws std::runtime_error if attached to a reactor or playing.
+   */
+  void set_deep_buffer(std::chrono::seconds depth);
+
+  /**
+   * @brief Enables or disables adaptive decode quality.
+   *
+   * When enabled, a QualityController watches decode time and the output
+   * buffer of local files and, under CPU pressure, reopens the decoder in
+   * cheaper modes (mono, half or quarter rate) whose output is expanded back
+   * to the track's format. Each track starts at full quality. Not used in
+   * deep-buffer mode, which rides out load on its own buffer.
+   *
+   * @param enabled true to adapt; enabled by default.
+   */
+  void set_adaptive_quality(bool enabled);
+
+  /**
+   * @brief Selects the mpg123 synth decoder, e.g. from DecoderCalibration.
+   * @param name One of mpg123_supported_decoders().
+   * @throws std::runtime_error if mpg123 rejects the decoder.
+   */
+  void set_decoder(const std::string &name);
+
+  /**
+   * @brief Gets playback loop counters.
+   * @return Current stats.
+   */
+  [[nodiscard]] auto stats() const -> Stats;
+
+  /**
+   * @brief Starts or stops timing the lock over the decoder and sink.
+   * @param enabled true to record wait and hold times per call site.
+   */
+  void set_lock_tracing(bool enabled);
+
+  /**
+   * @brief Gets the recorded times of the lock over the decoder and sink.
+   * @return One entry per call site, longest worst-case wait first.
+   */
+  [[nodiscard]] auto lock_report() const
+      -> std::vector<TracedMutex::SiteReport>;
+
+  /**
+   * @brief Moves decoding from the player thread onto an event loop.
+   *
+   * The player thread exits and a PUMP_INTERVAL timer on the reactor tops
+   * up the sink instead; fades are stepped by reactor timers rather than a
+   * thread of their own. Local files only: streaming modes keep the
+   * player thread. Must be called before playback starts.
+   *
+   * @param reactor Loop that will drive decoding; must outlive the Player.
+   * @throws std::runtime_error if playing or in a streaming mode.
+   */
+  void attach(Reactor &reactor);
+
+  /**
+   * @brief Switches the player to HTTP stream server mode.
+   *
+   * Instead of decoding to the local device, the current song's MP3 bytes
+   * are passed through untouched and fanned out to HTTP listeners at the
+   * song's average byte rate, with ICY metadata from get_title() and
+   * get_artist().
+   *
+   * @param port TCP port to listen on, 0 for an ephemeral port.
+   * @throws std::runtime_error if the port cannot be bound.
+   */
+  void start_stream_server(uint16_t port);
+
+  /**
+   * @brief Accesses the stream server, if streaming mode is enabled.
+   * @return Pointer to the server, or nullptr in local playback mode.
+   */
+  [[nodiscard]] auto get_stream_server() const noexcept -> StreamServer *;
+
+  /**
+   * @brief Makes this player the leader zone of a synchronized group.
+   *
+   * Followers poll the leader's clock and media position over UDP.
+   *
+   * @param port UDP port to listen on, 0 for an ephemeral port.
+   * @throws std::runtime_error if the port cannot be bound.
+   */
+  void start_sync_leader(uint16_t port);
+
+  /**
+   * @brief Makes this player a follower zone of a leader.
+   *
+   * The follower mirrors the leader's track and play/pause state and keeps
+   * its output aligned with the leader's by resampling, or by seeking when
+   * too far off. Tracks are opened by the leader's path, so zones must see
+   * the same files.
+   *
+   * @param host Leader host name or address.
+   * @param port Leader UDP port.
+   * @throws std::runtime_error if the leader cannot be resolved.
+   */
+  void follow_leader(const std::string &host, uint16_t port);
+
+  /**
+   * @brief Accesses the sync leader, if leader mode is enabled.
+   * @return Pointer to the leader, or nullptr.
+   */
+  [[nodiscard]] auto get_sync_leader() const noexcept -> ClockLeader *;
+
+  /**
+   * @brief Accesses the sync follower, if follower mode is enabled.
+   * @return Pointer to the follower, or nullptr.
+   */
+  [[nodiscard]] auto get_sync_follower() const noexcept -> ClockFollower *;
+
+  /**
+   * @brief Gets how far a follower is from the leader.
+   * @return Seconds ahead of the leader (negative: behind).
+   */
+  [[nodiscard]] auto get_sync_error() const -> double;
+
 private:
   /// Internal thread function for managing playback loop.
   void player_thread(const std::stop_token &token);
@@ -156,6 +474,117 @@ private:
   /// Streams audio from the MP3 decoder to the audio buffer.
   void stream_audio();
 
+  /// Tops up the sink without blocking; the reactor-mode decode step.
+  void pump();
+
+  /// Plays the current song from the deep buffer in bursts.
+  void stream_deep();
+
+  /// Decodes into the deep buffer if it ran low.
+  void refill_deep_buffer();
+
+  /**
+   * @brief Feeds the sink from the deep buffer up to DEEP_SINK_TARGET.
+   * @param queued Samples the sink holds.
+   * @return Samples the sink holds afterwards.
+   */
+  auto feed_from_deep_buffer(size_t queued) -> size_t;
+
+  /// Drops the deep buffer contents. Requires audio_mutex_.
+  void reset_deep_buffer();
+
+  /**
+   * @brief Sleeps until a deadline, a command or a state change.
+   * @param deadline Latest wakeup.
+   */
+  void sleep_for_command(Clock::time_point deadline);
+
+  /// Wakes the player thread; a deep-mode loop trims and re-feeds the sink.
+  void request_trim();
+
+  /**
+   * @brief Sleeps on the player thread and counts the wakeup.
+   * @param delay Time to sleep.
+   */
+  void idle(std::chrono::milliseconds delay);
+
+  /// Counts one decode-loop wakeup and updates the rate.
+  void note_wakeup();
+
+  /// Moves on after the current track played out.
+  void finish_track();
+
+  /**
+   * @brief Steps through the playlist to the next song that opens.
+   * @param forward Direction to step in.
+   * @return false if no entry in the playlist can be played.
+   */
+  auto advance(bool forward) -> bool;
+
+  /// Validates the next VALIDATE_AHEAD local entries in the background.
+  void validate_ahead();
+
+  /**
+   * @brief Remembers that a song cannot be played.
+   * @param path The song.
+   * @param error Why, for the warning.
+   */
+  void mark_unplayable(const std::string &path, const std::string &error);
+
+  /**
+   * @brief Checks whether a song is known to be unplayable.
+   * @param path The song.
+   * @return true if it failed to open or validate.
+   */
+  [[nodiscard]] auto is_unplayable(const std::string &path) const -> bool;
+
+  /// Decodes the live stream from its jitter buffer until it ends.
+  void stream_live();
+
+  /// Splits the live stream's ICY title into title and artist.
+  void update_live_title();
+
+  /**
+   * @brief Opens the sink for a decoded format, paused.
+   * @param rate Sample rate in Hz.
+   * @param channels Channel count.
+   * @throws std::runtime_error if the device cannot be opened.
+   */
+  void open_audio_device(long rate, int channels);
+
+  /// Passes the current song's MP3 bytes through to the stream server.
+  void stream_passthrough();
+
+  /// Publishes "Artist - Title" as ICY metadata to the stream server.
+  void update_stream_metadata();
+
+  /// Replaces title_ and artist_ together, as the getters may run meanwhile.
+  void set_track_info(std::string title, std::string artist);
+
+  /// Publishes the leader's media clock or corrects a follower's position.
+  void sync_zone();
+
+  /// Mirrors the leader's track and play/pause state on a follower.
+  void follow_leader_state();
+
+  /**
+   * @brief Checks whether a follower is on the track the leader plays.
+   * @return true if not following, or if the track matches.
+   */
+  [[nodiscard]] auto in_step_with_leader() const -> bool;
+
+  /**
+   * @brief Publishes the leader's media clock anchored at the present.
+   * @param playing Whether the leader timeline advances.
+   */
+  void publish_media_clock(bool playing);
+
+  /**
+   * @brief Predicts the media frame audible now. Requires audio_mutex_.
+   * @return Decoder position minus the audio queued ahead of it.
+   */
+  [[nodiscard]] auto audible_frame() const -> int64_t;
+
   /// Determines if playback should continue.
   [[nodiscard]] auto should_continue() const -> bool;
 
@@ -165,11 +594,108 @@ private:
   /// Waits for the audio buffer to fully drain.
   void wait_for_buffer_to_drain();
 
-  /// Updates the elapsed time counter based on playback.
-  void update_elapsed_time();
+  /// Gets the control word.
+  [[nodiscard]] auto control() const -> Control;
+
+  /**
+   * @brief Changes the control word with compare-and-swap.
+   *
+   * @param change Edits a copy of the current value, or returns false to
+   * leave it; called again if another thread got in first.
+   * @return The value stored, with its generation bumped, if any.
+   */
+  template <typename Change>
+  auto transition(Change change) -> std::optional<Control>;
+
+  /// Moves to a state unconditionally.
+  void set_state(State state);
+
+  /// Pauses or resumes the sink to match the state, after a transition.
+  void sync_device();
+
+  /// Gets the playback position off timeline_.
+  [[nodiscard]] auto elapsed() const -> std::chrono::milliseconds;
+
+  /// Moves the playback position, keeping the timeline running or stopped.
+  void set_elapsed(std::chrono::milliseconds position);
+
+  /// Starts or stops the timeline at the current position.
+  void run_timeline(bool running);
+
+  /// Gets clock_ in the milliseconds timeline_ counts in.
+  [[nodiscard]] auto timeline_now() const -> int64_t;
+
+  /// Saves to resume_state_ if RESUME_INTERVAL passed or play state changed.
+  void save_position();
+
+  /**
+   * @brief Records the play of the current song, if it was played.
+   * @param skipped It was left before its end.
+   */
+  void record_play(bool skipped);
+
+  /**
+   * @brief Continues from the saved point if it matches the playlist.
+   * @return false if nothing was restored.
+   */
+  auto restore_position() -> bool;
+
+  /**
+   * @brief Applies volume to a decoded block and writes it to the sink.
+   * @param bytes Number of valid bytes in buffer_.
+   */
+  void queue_audio(size_t bytes);
+
+  /**
+   * @brief Decodes one block into buffer_ and lets the quality controller
+   * weigh its cost.
+   * @param bytes Set to the number of decoded bytes.
+   * @return The mpg123_read() result.
+   */
+  auto decode_block(size_t &bytes) -> int;
+
+  /**
+   * @brief Reopens the current song at the same frame in a quality level.
+   *
+   * Levels that only change the DSP, like LEAN_DSP, keep the open decoder.
+   * If the song cannot be reopened in the new level, the previous one is
+   * restored; if that fails too, the song is marked unplayable.
+   *
+   * @param level Level to decode at from now on.
+   * @return false if no decoder is left open and the track must end.
+   */
+  auto apply_quality(QualityController::Level level) -> bool;
+
+  /**
+   * @brief Reopens the current song from its start, the way open_song()
+   * opened it: through the HttpSource for URLs, by path otherwise.
+   * @return true if opened.
+   */
+  auto reopen_decoder() -> bool;
+
+  /**
+   * @brief Sets the mpg123 parameters of a quality level for the next open.
+   * @param level The level.
+   */
+  void set_decode_params(QualityController::Level level);
+
+  /// mpg123 parameters of a level: mono mix-down and down-sampling shift
+  [[nodiscard]] static auto decode_params(QualityController::Level level)
+      -> std::pair<bool, long>;
+
+  /**
+   * @brief Expands a block decoded at reduced quality to the sink format.
+   * @param samples Decoded samples.
+   * @return The expanded samples, in expanded_.
+   */
+  auto expand_degraded(std::span<int16_t> samples) -> std::span<int16_t>;
 
   /**
    * @brief Applies volume gain to raw audio buffer.
+   *
+   * A volume change since the previous buffer is ramped across this one, so
+   * fades and steps do not click.
+   *
    * @param buffer Span of 16-bit PCM samples.
    */
   void apply_volume(std::span<int16_t> buffer);
@@ -182,45 +708,149 @@ private:
 
   /**
    * @brief Gradually fades to a new volume.
+   *
+   * The fade belongs to the current generation and stops early, leaving
+   * the volume to the newer transition, once that changes.
+   *
+   * Attached to a reactor, the steps run on loop timers, so the future must
+   * not be waited for on the loop thread; chain work through @p then.
+   *
    * @param target Final volume level.
    * @param duration_ms Total duration of the fade in milliseconds.
+   * @param then Run when the fade ends or is superseded, before the future
+   * completes.
    * @return A std::future that completes when fade is done.
    */
   [[nodiscard]] auto fade_to(float target,
-                             int duration_ms = DEFAULT_FADE_DURATION)
+                             int duration_ms = DEFAULT_FADE_DURATION,
+                             std::function<void()> then = {})
       -> std::future<void>;
 
-  /// Pauses the SDL audio device (if open).
+  /// Takes one step of the reactor fade, finishing it after the last.
+  void step_fade();
+
+  /// Ends the reactor fade: cancels its timer, runs its continuation.
+  void finish_fade();
+
+  /// Pauses the audio sink (if open).
   void pause_audio_device();
 
-  /// Resumes the SDL audio device (if open).
+  /// Resumes the audio sink (if open).
   void resume_audio_device();
 
   // Thread-safe variables
-  std::mutex audio_mutex_;                      ///< Protects audio state
-  std::atomic<float> volume_{VOLUME_FULL};      ///< Current volume
-  std::atomic<float> last_volume_{VOLUME_FULL}; ///< Volume before pause
-  std::atomic<int> elapsed_seconds_{0};         ///< Playback progress
-  std::atomic<State> state_{State::STOPPED};    ///< Current player state
+  mutable TracedMutex audio_mutex_;         ///< Protects decoder and sink
+  std::atomic<float> volume_{VOLUME_FULL};  ///< Current gain, fades included
+  float applied_volume_{VOLUME_FULL};       ///< Gain of the last buffer
+  std::atomic<uint64_t> control_{Control{}.pack()}; ///< Packed Control
 
   // Audio
-  std::optional<SDL_AudioDeviceID> audio_device_{0}; ///< SDL audio handle
+  std::unique_ptr<FanOutSink> sink_;                 ///< Output stage
   mpg123_handle *mpg_handler_{nullptr};              ///< MP3 decoder handle
-  std::array<char, SDL_AUDIO_BUFFER_SIZE> buffer_;   ///< PCM output buffer
+  std::unique_ptr<HttpSource> http_source_;          ///< Source of URL songs
+  std::unique_ptr<IcyStream> icy_stream_;            ///< Live stream input
+  std::array<char, AUDIO_BUFFER_SIZE> buffer_;   ///< PCM output buffer
   int32_t sample_rate_{0};                           ///< MP3 sample rate
+  int channels_{0};                                  ///< Decoded channels
 
   // Metadata
+  std::string path_;     ///< Current song path
+  std::optional<size_t> song_; ///< path_'s index in the playlist, if from it
+  mutable std::mutex metadata_mutex_; ///< Guards title_ and artist_
   std::string title_;    ///< Current song title
   std::string artist_;   ///< Current song artist
+  std::string live_title_; ///< Last ICY title applied
   int total_seconds_{0}; ///< Song duration in seconds
 
   // Timing
-  std::chrono::steady_clock::time_point
-      start_time_; ///< Playback start timestamp
-  std::chrono::milliseconds elapsed_duration_{
-      0}; ///< Duration before last pause
+  Clock &clock_; ///< Time base for all playback timing
+  /// Position in ms << 1 while stopped; while running, the timeline_now()
+  /// of position 0 << 1 | 1. One word, so readers never see it torn.
+  std::atomic<int64_t> timeline_{0};
 
   // Playlist and thread
   std::unique_ptr<Playlist> playlist_; ///< Current playlist
+  std::unique_ptr<StreamServer> stream_server_; ///< HTTP passthrough output
+
+  // Multi-room sync
+  std::unique_ptr<ClockLeader> sync_leader_;     ///< Set in leader mode
+  std::unique_ptr<ClockFollower> sync_follower_; ///< Set in follower mode
+  ZoneSync zone_sync_;                           ///< Follower alignment
+  std::atomic<double> sync_error_{0.0};          ///< Last filtered error
+  Resampler resampler_;                          ///< Follower rate correction
+  std::vector<int16_t> resampled_;               ///< Resampler output
+
+  // Deep buffer mode
+  std::atomic<bool> deep_mode_{false};  ///< deep_pcm_ set; read without lock
+  std::unique_ptr<PcmRing> deep_pcm_;   ///< Unity-gain PCM ahead; audio_mutex_
+  std::chrono::seconds deep_depth_{0};  ///< Configured depth
+  size_t deep_fed_{0};                  ///< deep_pcm_ samples in the sink
+  bool deep_decoded_{false};            ///< Track fully in deep_pcm_
+  std::atomic<bool> trim_requested_{false}; ///< Re-feed the sink
+  std::mutex wake_mutex_;               ///< Guards sleeps for commands
+  std::condition_variable wake_;        ///< Ends a deep-mode sleep
+  uint64_t wake_sequence_{0};           ///< Bumped per wake_ notification
+
+  // Adaptive quality
+  QualityController quality_;             ///< Picks the decode level
+  std::atomic<bool> adaptive_quality_{true}; ///< quality_ may degrade
+  std::optional<QualityController::Level>
+      pending_quality_;                    ///< Applied before the next block
+  std::atomic<bool> quality_reset_{false}; ///< New track; back to FULL
+  QualityController::Level decode_level_{
+      QualityController::Level::FULL};     ///< Level mpg123 was opened at
+  int decode_channels_{0};                 ///< Channels mpg123 outputs
+  int down_sample_{0};                     ///< log2 of the rate reduction
+  TaggedVector<int16_t, MemoryTag::PCM>
+      expanded_;                           ///< Degraded block at sink format
+
+  // Resume state
+  std::unique_ptr<ResumeState> resume_state_; ///< Saved position, if enabled
+  uint64_t playlist_hash_{0};                 ///< Identity of playlist_
+  uint64_t track_hash_{0};                    ///< Identity of path_
+  Clock::time_point saved_at_;                ///< Last save
+  bool saved_playing_{false};                 ///< Play state of last save
+
+  // Listening history
+  std::unique_ptr<HistoryLog> history_;   ///< Records plays, if enabled
+  std::atomic<int64_t> play_started_ms_{0}; ///< Unix ms of the play, 0 if none
+
+  // Unplayable tracks
+  std::unique_ptr<TrackValidator> validator_;     ///< Checks upcoming entries
+  mutable std::mutex unplayable_mutex_;           ///< Guards unplayable_
+  std::unordered_set<std::string, std::hash<std::string>,
+                     std::equal_to<std::string>,
+                     TaggedAllocator<std::string, MemoryTag::CACHE>>
+      unplayable_;                                ///< Songs that failed
+  std::mutex validation_mutex_;                   ///< Guards validation_
+  std::future<void> validation_;                  ///< Running validation
+  std::atomic<uint64_t> skipped_tracks_{0};       ///< Entries passed over
+  std::atomic<uint64_t> decode_errors_{0};        ///< Resyncs
+
+  // Stats
+  std::atomic<uint64_t> wakeups_{0};        ///< Decode-loop wakeups
+  std::atomic<double> wakeup_rate_{0.0};    ///< Wakeups per second
+  uint64_t window_wakeups_{0};              ///< wakeups_ at window start
+  Clock::time_point window_start_;          ///< Start of the rate window
+
+  // Reactor mode
+  /**
+   * @struct Fade
+   * @brief A fade stepped by a reactor timer.
+   */
+  struct Fade {
+    Reactor::TimerId timer{-1};  ///< Timer taking the steps
+    float target{VOLUME_MUTE};   ///< Final volume
+    float step{0.0F};            ///< Volume change per step
+    int steps{0};                ///< Steps taken
+    uint32_t generation{0};      ///< Transition the fade belongs to
+    std::function<void()> then;  ///< Continuation
+    std::promise<void> done;     ///< Completed after the continuation
+  };
+
+  Reactor *reactor_{nullptr};          ///< Loop driving pump(), if attached
+  Reactor::TimerId pump_timer_{-1};    ///< Timer calling pump()
+  std::unique_ptr<Fade> fade_;         ///< Fade in progress, loop thread only
+  bool track_decoded_{false};          ///< pump() reached the end of track
   std::jthread player_thread_;         ///< Background playback thread
 };
\ No newline at end of file
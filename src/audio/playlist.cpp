@@ -9,16 +9,31 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <new>
+#include <numeric>
 #include <random>
 #include <stdexcept>
 
+#include "../net/http_client.hpp"
+
 namespace fs = std::filesystem;
 
 Playlist::Playlist(const std::string &folder_path) {
-  load_songs(folder_path);
+  const fs::path path(folder_path);
+  if (fs::is_regular_file(path) &&
+      (path.extension() == ".m3u" || path.extension() == ".m3u8")) {
+    load_m3u(folder_path);
+  } else {
+    load_songs(folder_path);
+  }
   if (songs_.empty()) {
     throw std::runtime_error("No MP3 files found in folder: " + folder_path);
   }
+  IndexList order(songs_.size());
+  std::iota(order.begin(), order.end(), 0);
+  order_.store(std::make_shared<const Order>(
+      Order{.songs = std::make_shared<const IndexList>(std::move(order))}));
 }
 
 void Playlist::load_songs(const std::string &folder_path) {
@@ -26,39 +41,292 @@ void Playlist::load_songs(const std::string &folder_path) {
     if (entry.is_regular_file()) {
       const auto &path = entry.path();
       if (path.extension() == ".mp3") {
-        shuffle_order_.emplace_back(songs_.size());
-        songs_.emplace_back(path.string());
+        add_song(path.string());
       }
     }
   }
   std::ranges::sort(songs_, std::less{}, std::identity{});
 }
 
+void Playlist::load_m3u(const std::string &m3u_path) {
+  std::ifstream file(m3u_path);
+  const auto base = fs::path(m3u_path).parent_path();
+  std::string line;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    if (HttpUrl::is_url(line) || fs::path(line).is_absolute()) {
+      add_song(line);
+    } else {
+      add_song((base / line).string());
+    }
+  }
+}
+
+void Playlist::add_song(std::string path) {
+  // Charged before it is stored, so an oversized list stops at the first
+  // path over the budget rather than once it is all in memory
+  static constexpr size_t FIRST_CAPACITY = 64;
+  auto bytes = songs_charge_.bytes();
+  if (path.capacity() > std::string().capacity()) {
+    bytes += path.capacity() + 1; // Heap buffer, terminator included
+  }
+  const auto capacity = songs_.capacity();
+  if (songs_.size() == capacity) {
+    const auto grown = std::max(FIRST_CAPACITY, capacity * 2);
+    // The old array is freed once the new one is filled
+    songs_charge_.resize(bytes + (grown * sizeof(std::string)));
+    songs_.reserve(grown);
+    bytes += (grown - capacity) * sizeof(std::string);
+  }
+  songs_charge_.resize(bytes);
+  songs_.push_back(std::move(path));
+}
+
 auto Playlist::current() const -> const std::string & {
-  return songs_.at(shuffle_order_[index_]);
+  const auto order = snapshot();
+  return songs_.at((*order->songs)[order->index]);
+}
+
+auto Playlist::current_song() const -> size_t {
+  const auto order = snapshot();
+  return (*order->songs)[order->index];
 }
 
 auto Playlist::next() -> const std::string & {
-  index_ = (index_ + 1) % songs_.size();
-  return current();
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto order = *snapshot();
+  if (order.shuffle) {
+    std::optional<IndexList> ring;
+    try {
+      ring.emplace(*order.songs);
+    } catch (const std::bad_alloc &) {
+      // Over the shuffle budget: replay the ring as drawn instead of
+      // drawing; the refusal shows in the tag's usage
+    }
+    order.index = (order.index + 1) % order.songs->size();
+    order.ahead -= std::min<size_t>(order.ahead, 1);
+    if (ring) {
+      draw_ahead(order, *ring);
+      order.songs = std::make_shared<const IndexList>(std::move(*ring));
+    }
+    order.behind =
+        std::min(order.behind + 1, order.songs->size() - order.ahead - 1);
+  } else {
+    order.index = (order.index + 1) % order.songs->size();
+  }
+  const auto song = (*order.songs)[order.index];
+  publish(std::move(order));
+  return songs_.at(song);
 }
 
 auto Playlist::prev() -> const std::string & {
-  if (index_ == 0) {
-    index_ = songs_.size();
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto order = *snapshot();
+  if (order.shuffle) {
+    // Back through the ring, never onto picks still ahead
+    if (order.behind > 0) {
+      --order.behind;
+      ++order.ahead;
+      order.index = (order.index + order.songs->size() - 1) %
+                    order.songs->size();
+    }
+  } else {
+    order.index = (order.index + order.songs->size() - 1) %
+                  order.songs->size();
   }
-  index_ = (index_ - 1) % songs_.size();
-  return current();
+  const auto song = (*order.songs)[order.index];
+  publish(std::move(order));
+  return songs_.at(song);
 }
 
-auto Playlist::has_next() const -> bool { return index_ + 1 < songs_.size(); }
+auto Playlist::peek(size_t ahead) const -> const std::string & {
+  const auto order = snapshot();
+  return songs_.at(
+      (*order->songs)[(order->index + ahead) % order->songs->size()]);
+}
+
+auto Playlist::size() const -> size_t { return songs_.size(); }
 
-auto Playlist::has_prev() const -> bool { return index_ > 0; }
+auto Playlist::has_next() const -> bool {
+  const auto order = snapshot();
+  return order->shuffle || order->index + 1 < order->songs->size();
+}
+
+auto Playlist::has_prev() const -> bool {
+  const auto order = snapshot();
+  return order->shuffle ? order->behind > 0 : order->index > 0;
+}
 
 void Playlist::reshuffle() {
-  shuffle_order_.resize(songs_.size());
-  std::iota(shuffle_order_.begin(), shuffle_order_.end(), 0);
-  std::shuffle(shuffle_order_.begin(), shuffle_order_.end(),
-               std::mt19937{std::random_device{}()});
-  index_ = 0;
+  std::random_device device;
+  reshuffle((uint64_t{device()} << 32U) | device());
+}
+
+void Playlist::reshuffle(uint64_t seed) {
+  auto songs = shuffled(seed);
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  radio_.reset();
+  publish(Order{.songs = std::move(songs), .seed = seed});
+}
+
+void Playlist::reshuffle_async() {
+  std::random_device device;
+  const auto seed = (uint64_t{device()} << 32U) | device();
+  // Joined on return, outside the lock, so a newer call never waits on it
+  std::jthread previous;
+  std::lock_guard<std::mutex> lock(shuffler_mutex_);
+  previous = std::move(shuffler_);
+  previous.request_stop();
+  shuffler_ = std::jthread([this, seed](const std::stop_token &token) {
+    Indices songs;
+    try {
+      songs = shuffled(seed, token);
+    } catch (const std::bad_alloc &) {
+      return; // Over the shuffle budget: the current order stays
+    }
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    if (songs && !token.stop_requested()) {
+      radio_.reset();
+      publish(Order{.songs = std::move(songs), .seed = seed});
+    }
+  });
+}
+
+void Playlist::wait_for_reshuffle() {
+  std::lock_guard<std::mutex> lock(shuffler_mutex_);
+  if (shuffler_.joinable()) {
+    shuffler_.join();
+  }
+}
+
+auto Playlist::shuffle_seed() const -> std::optional<uint64_t> {
+  return snapshot()->seed;
+}
+
+auto Playlist::position() const -> size_t { return snapshot()->index; }
+
+auto Playlist::jump_to(size_t position) -> bool {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto order = *snapshot();
+  if (order.shuffle || position >= order.songs->size()) {
+    return false;
+  }
+  order.index = position;
+  publish(std::move(order));
+  return true;
+}
+
+auto Playlist::select(size_t song) -> bool {
+  if (song >= songs_.size()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto order = *snapshot();
+  if (order.shuffle) {
+    auto ring = *order.songs;
+    ring[order.index] = song;
+    radio_->exclude(song);
+    order.songs = std::make_shared<const IndexList>(std::move(ring));
+  } else {
+    order.index = static_cast<size_t>(
+        std::ranges::find(*order.songs, song) - order.songs->begin());
+  }
+  publish(std::move(order));
+  return true;
+}
+
+auto Playlist::songs() const -> const std::vector<std::string> & {
+  return songs_;
+}
+
+auto Playlist::find(const std::string &path) const -> std::optional<size_t> {
+  const auto found = std::ranges::find(songs_, path);
+  if (found == songs_.end()) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(found - songs_.begin());
+}
+
+void Playlist::start_radio(std::vector<double> weights, uint64_t seed) {
+  weights.resize(songs_.size(), 1.0);
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto order = *snapshot();
+  if (order.shuffle) {
+    return;
+  }
+  const auto song = (*order.songs)[order.index];
+  radio_ = std::make_unique<Radio>(std::move(weights), seed);
+  radio_->exclude(song);
+  IndexList ring(RADIO_RING, song);
+  order.shuffle = std::move(order.songs);
+  order.index = 0;
+  order.ahead = 0;
+  order.behind = 0;
+  draw_ahead(order, ring);
+  order.songs = std::make_shared<const IndexList>(std::move(ring));
+  publish(std::move(order));
+}
+
+void Playlist::stop_radio() {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto order = *snapshot();
+  if (!order.shuffle) {
+    return;
+  }
+  const auto song = (*order.songs)[order.index];
+  radio_.reset();
+  order.songs = std::move(order.shuffle);
+  order.index = static_cast<size_t>(std::ranges::find(*order.songs, song) -
+                                    order.songs->begin());
+  order.ahead = 0;
+  order.behind = 0;
+  publish(std::move(order));
+}
+
+auto Playlist::is_radio() const -> bool {
+  return snapshot()->shuffle != nullptr;
+}
+
+void Playlist::set_weight(size_t song, double weight) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  if (radio_ && song < songs_.size()) {
+    radio_->set_weight(song, weight);
+  }
+}
+
+auto Playlist::snapshot() const -> std::shared_ptr<const Order> {
+  return order_.load(std::memory_order_acquire);
+}
+
+void Playlist::publish(Order order) {
+  order_.store(std::make_shared<const Order>(std::move(order)),
+               std::memory_order_release);
+}
+
+auto Playlist::shuffled(uint64_t seed, const std::stop_token &token) const
+    -> Indices {
+  static constexpr size_t STOP_CHECK_INTERVAL = 4096;
+  IndexList order(songs_.size());
+  std::iota(order.begin(), order.end(), 0);
+  // Fisher-Yates by hand, so a superseded reshuffle can give up midway
+  std::mt19937_64 engine{seed};
+  for (size_t i = order.size(); i > 1; --i) {
+    if (i % STOP_CHECK_INTERVAL == 0 && token.stop_requested()) {
+      return nullptr;
+    }
+    std::uniform_int_distribution<size_t> pick(0, i - 1);
+    std::swap(order[i - 1], order[pick(engine)]);
+  }
+  return std::make_shared<const IndexList>(std::move(order));
+}
+
+void Playlist::draw_ahead(Order &order, IndexList &ring) {
+  for (; order.ahead < RADIO_LOOKAHEAD; ++order.ahead) {
+    ring[(order.index + order.ahead + 1) % ring.size()] = radio_->next();
+  }
 }
@@ -6,28 +6,60 @@
 // License. See the LICENSE file in the project root for full license
 // information.
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "../util/memory_accounting.hpp"
+#include "radio.hpp"
+
 /**
  * @class Playlist
  * @brief Manages a list of MP3 file paths and provides shuffle, navigation, and
  * access utilities.
  *
  * The Playlist class is responsible for loading MP3 files from a specified
- * folder, maintaining a shuffle order, and allowing navigation through the list
- * of songs.
+ * folder or M3U file, maintaining a shuffle order, and allowing navigation
+ * through the list of songs. Entries loaded from an M3U file may be http://
+ * URLs.
+ *
+ * In radio mode the play order is an endless weighted random sequence
+ * instead: a ring of the last RADIO_RING picks, drawn RADIO_LOOKAHEAD ahead
+ * so peek() sees the songs that will actually play.
+ *
+ * The playlist is safe to share between threads. The order and position are
+ * an immutable snapshot behind an atomic pointer: readers take the current
+ * one without locking, and every change builds a new one and swaps it in.
+ * Changes are serialized among themselves, and a reshuffle builds its order
+ * before taking their lock, so readers never wait on it.
  */
 class Playlist {
 public:
+  static constexpr size_t RADIO_RING = 64;     ///< Picks kept for prev()
+  static constexpr size_t RADIO_LOOKAHEAD = 4; ///< Picks drawn ahead
+
   /**
    * @brief Constructs a Playlist from the MP3 files in the given folder.
    *
-   * @param folder_path Path to the directory containing MP3 files.
+   * @param folder_path Path to the directory containing MP3 files, or to an
+   * `.m3u`/`.m3u8` file listing paths and http:// URLs.
    * @throws std::runtime_error if no MP3 files are found.
+   * @throws std::bad_alloc at the first path over the playlist budget.
    */
   explicit Playlist(const std::string &folder_path);
 
+  Playlist(Playlist &playlist) = delete;
+  Playlist(Playlist &&playlist) = delete;
+
+  auto operator=(Playlist &playlist) -> Playlist & = delete;
+  auto operator=(Playlist &&playlist) -> Playlist && = delete;
+
   /**
    * @brief Gets the currently selected song.
    *
@@ -35,6 +67,13 @@ public:
    */
   [[nodiscard]] auto current() const -> const std::string &;
 
+  /**
+   * @brief Gets where the current song is in load order.
+   *
+   * @return Index of current() in songs().
+   */
+  [[nodiscard]] auto current_song() const -> size_t;
+
   /**
    * @brief Moves to the next song in the playlist.
    *
@@ -49,6 +88,21 @@ public:
    */
   auto prev() -> const std::string &;
 
+  /**
+   * @brief Looks ahead without moving.
+   *
+   * @param ahead Songs after the current one, wrapping around.
+   * @return Reference to the full path of that MP3 file.
+   */
+  [[nodiscard]] auto peek(size_t ahead) const -> const std::string &;
+
+  /**
+   * @brief Gets the number of songs.
+   *
+   * @return Song count.
+   */
+  [[nodiscard]] auto size() const -> size_t;
+
   /**
    * @brief Checks if there is a next song available.
    *
@@ -69,6 +123,103 @@ public:
    */
   void reshuffle();
 
+  /**
+   * @brief Reshuffles into the order a seed always produces.
+   * Resets the index to the beginning.
+   *
+   * @param seed Seed of the order, e.g. a saved shuffle_seed().
+   */
+  void reshuffle(uint64_t seed);
+
+  /**
+   * @brief Randomly reshuffles on a background thread and returns at once.
+   *
+   * The new order replaces the old one when ready, resetting the index to
+   * the beginning. A newer request cancels an unfinished one.
+   */
+  void reshuffle_async();
+
+  /**
+   * @brief Waits until a reshuffle_async() has taken effect.
+   */
+  void wait_for_reshuffle();
+
+  /**
+   * @brief Gets the seed of the current order.
+   *
+   * @return The seed, or std::nullopt if the songs are in load order.
+   */
+  [[nodiscard]] auto shuffle_seed() const -> std::optional<uint64_t>;
+
+  /**
+   * @brief Gets the position of the current song in the play order.
+   *
+   * @return Zero-based position.
+   */
+  [[nodiscard]] auto position() const -> size_t;
+
+  /**
+   * @brief Makes the song at a position in the play order current.
+   *
+   * @param position Zero-based position.
+   * @return false, leaving the current song, if out of range.
+   */
+  auto jump_to(size_t position) -> bool;
+
+  /**
+   * @brief Makes a song current wherever it is in the play order.
+   *
+   * In radio mode the song replaces the current pick.
+   *
+   * @param song Index in songs().
+   * @return false, leaving the current song, if out of range.
+   */
+  auto select(size_t song) -> bool;
+
+  /**
+   * @brief Gets the songs in load order, independent of shuffling.
+   *
+   * @return Full paths and URLs.
+   */
+  [[nodiscard]] auto songs() const -> const std::vector<std::string> &;
+
+  /**
+   * @brief Finds a song in load order.
+   *
+   * @param path Full path or URL, as in songs().
+   * @return Its index in songs(), if present.
+   */
+  [[nodiscard]] auto find(const std::string &path) const
+      -> std::optional<size_t>;
+
+  /**
+   * @brief Switches to radio mode, keeping the current song.
+   *
+   * @param weights Weight of each song in songs() order.
+   * @param seed Seed of the picks.
+   */
+  void start_radio(std::vector<double> weights, uint64_t seed);
+
+  /**
+   * @brief Returns to the shuffle or load order, keeping the current song.
+   */
+  void stop_radio();
+
+  /**
+   * @brief Checks whether radio mode is on.
+   *
+   * @return true in radio mode.
+   */
+  [[nodiscard]] auto is_radio() const -> bool;
+
+  /**
+   * @brief Changes the radio weight of one song; ignored outside radio mode.
+   *
+   * @param song Index in songs().
+   * @param weight New weight.
+   */
+  void set_weight(size_t song, double weight);
+
 private:
   /**
    * @brief Loads MP3 file paths from the given directory into the playlist.
@@ -77,7 +228,58 @@ private:
    */
   void load_songs(const std::string &folder_path);
 
-  std::vector<std::string> songs_;    ///< List of full paths to MP3 files
-  std::vector<size_t> shuffle_order_; ///< Current shuffle order of song indices
-  size_t index_ = 0;                  ///< Index into the shuffle_order_ vector
+  /**
+   * @brief Loads entries from an M3U playlist, keeping their order.
+   *
+   * Comment lines are skipped, URLs and absolute paths are kept as-is and
+   * relative paths are resolved against the M3U file's directory.
+   *
+   * @param m3u_path Path to the M3U file.
+   */
+  void load_m3u(const std::string &m3u_path);
+
+  /**
+   * @brief Charges a path to the playlist budget, then appends it.
+   *
+   * @param path Full path or URL.
+   * @throws std::bad_alloc if the path or the growth of songs_ is over the
+   * budget.
+   */
+  void add_song(std::string path);
+
+  using IndexList = TaggedVector<size_t, MemoryTag::SHUFFLE>;
+  using Indices = std::shared_ptr<const IndexList>;
+
+  /// One state of the play order; published whole, never modified
+  struct Order {
+    Indices songs{};  ///< Indices into songs_, or the radio ring
+    size_t index = 0; ///< Position of the current song in songs
+    std::optional<uint64_t> seed{}; ///< Seed of the shuffle, if shuffled
+    Indices shuffle{};  ///< In radio mode, the order to return to; else null
+    size_t ahead = 0;   ///< Radio picks drawn after index
+    size_t behind = 0;  ///< Radio picks played before index, for prev()
+  };
+
+  /// Gets the current order; lock-free for the caller
+  [[nodiscard]] auto snapshot() const -> std::shared_ptr<const Order>;
+
+  /// Swaps in a new order. Requires write_mutex_.
+  void publish(Order order);
+
+  /// Builds the order a seed produces, in O(songs); null if token stops it
+  [[nodiscard]] auto shuffled(uint64_t seed,
+                              const std::stop_token &token = {}) const
+      -> Indices;
+
+  /// Draws radio picks until RADIO_LOOKAHEAD lie ahead. Requires write_mutex_.
+  void draw_ahead(Order &order, IndexList &ring);
+
+  std::vector<std::string> songs_; ///< Full paths, fixed after construction
+  MemoryCharge songs_charge_{MemoryTag::PLAYLIST}; ///< Bytes of songs_
+  std::atomic<std::shared_ptr<const Order>> order_; ///< Current order
+  std::mutex write_mutex_;       ///< Serializes changes of order_ and radio_
+  std::unique_ptr<Radio> radio_; ///< Picks in radio mode
+  std::mutex shuffler_mutex_;    ///< Guards shuffler_
+  std::jthread shuffler_; ///< Builds reshuffle_async() orders; last, so it
+                          ///< stops before what it publishes to is gone
 };
\ No newline at end of file
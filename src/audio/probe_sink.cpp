@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "probe_sink.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1'000'000'000;
+
+} // namespace
+
+ProbeSink::ProbeSink(Clock &clock) : NullSink(clock), clock_(clock) {}
+
+void ProbeSink::open(const AudioFormat &format) {
+  {
+    std::lock_guard<std::mutex> lock(probe_mutex_);
+    samples_.clear();
+    blocks_.clear();
+    pauses_.clear();
+    capture_format_ = format;
+  }
+  NullSink::open(format);
+}
+
+void ProbeSink::write(std::span<const int16_t> samples) {
+  {
+    std::lock_guard<std::mutex> lock(probe_mutex_);
+    const auto rate = static_cast<int64_t>(capture_format_.bytes_per_second());
+    const auto ahead = rate > 0 ? static_cast<int64_t>(queued_bytes()) *
+                                      NS_PER_SECOND / rate
+                                : 0;
+    blocks_.push_back({clock_.now() + std::chrono::nanoseconds(ahead),
+                       samples_.size(), samples.size(), samples.size()});
+    samples_.insert(samples_.end(), samples.begin(), samples.end());
+  }
+  NullSink::write(samples);
+}
+
+void ProbeSink::clear() {
+  {
+    std::lock_guard<std::mutex> lock(probe_mutex_);
+    cut_timeline();
+  }
+  NullSink::clear();
+}
+
+void ProbeSink::pause() {
+  {
+    std::lock_guard<std::mutex> lock(probe_mutex_);
+    if (!is_paused()) {
+      cut_timeline();
+      pauses_.push_back(clock_.now());
+    }
+  }
+  NullSink::pause();
+}
+
+auto ProbeSink::first_change(std::span<const int16_t> reference,
+                             Clock::time_point since) const
+    -> std::optional<Clock::time_point> {
+  std::lock_guard<std::mutex> lock(probe_mutex_);
+
+  // Least-squares gain of what was heard just before the command
+  double dot = 0;
+  double energy = 0;
+  for (const auto &block : blocks_) {
+    for (size_t i = 0; i < block.heard; ++i) {
+      const auto index = block.offset + i;
+      const auto time = sample_time(block, i);
+      if (index >= reference.size() || time >= since) {
+        break;
+      }
+      if (time >= since - BASELINE_WINDOW) {
+        dot += static_cast<double>(samples_[index]) * reference[index];
+        energy += static_cast<double>(reference[index]) * reference[index];
+      }
+    }
+  }
+  if (energy <= 0) {
+    return std::nullopt;
+  }
+  const auto gain = dot / energy;
+
+  std::optional<Clock::time_point> change;
+  const auto pause = std::ranges::find_if(
+      pauses_, [since](const auto &time) { return time >= since; });
+  if (pause != pauses_.end()) {
+    change = *pause;
+  }
+  for (const auto &block : blocks_) {
+    for (size_t i = 0; i < block.heard; ++i) {
+      const auto index = block.offset + i;
+      const auto time = sample_time(block, i);
+      if (time < since) {
+        continue;
+      }
+      if (index >= reference.size() || (change && time >= *change)) {
+        return change;
+      }
+      const auto expected = gain * reference[index];
+      if (std::abs(samples_[index] - expected) >
+          TOLERANCE + (RELATIVE * std::abs(expected))) {
+        return time;
+      }
+    }
+  }
+  return change;
+}
+
+auto ProbeSink::sample_time(const Block &block, size_t index) const
+    -> Clock::time_point {
+  const auto channels = static_cast<int64_t>(std::max(1, capture_format_.channels));
+  const auto frame = static_cast<int64_t>(index) / channels;
+  return block.audible + std::chrono::nanoseconds(
+                             frame * NS_PER_SECOND /
+                             std::max<int64_t>(1, capture_format_.sample_rate));
+}
+
+void ProbeSink::cut_timeline() {
+  const auto now = clock_.now();
+  const auto channels = static_cast<int64_t>(std::max(1, capture_format_.channels));
+  for (auto &block : blocks_) {
+    if (block.audible >= now) {
+      block.heard = 0;
+      continue;
+    }
+    const auto played = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            now - block.audible)
+                            .count();
+    const auto frames = (played * capture_format_.sample_rate / NS_PER_SECOND) + 1;
+    block.heard = std::min(block.heard, static_cast<size_t>(frames * channels));
+  }
+}
@@ -0,0 +1,98 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "null_sink.hpp"
+
+/**
+ * @class ProbeSink
+ * @brief Clock-paced NullSink that keeps what it played and when.
+ *
+ * Every written sample is stamped with the time it becomes audible: the
+ * write time plus the audio queued ahead of it. clear() and pause() cut the
+ * timeline, since queued audio is then dropped or held. Comparing the
+ * captured stream with a reference decode of the same track finds when the
+ * effect of a command (volume step, pause, seek) was first heard.
+ *
+ * The capture restarts on every open(); the timeline is exact up to the
+ * first pause() after it.
+ */
+class ProbeSink : public NullSink {
+public:
+  static constexpr auto BASELINE_WINDOW =
+      std::chrono::milliseconds(200); ///< Audio that sets the baseline gain
+  static constexpr double TOLERANCE = 2.0;  ///< Absolute deviation allowed
+  static constexpr double RELATIVE = 0.01;  ///< Deviation allowed per unit
+
+  /**
+   * @brief Constructs a probe playing out on a clock.
+   * @param clock Time base of the timeline.
+   */
+  explicit ProbeSink(Clock &clock);
+
+  void open(const AudioFormat &format) override;
+  void write(std::span<const int16_t> samples) override;
+  void clear() override;
+  void pause() override;
+
+  /**
+   * @brief Finds when the output first stopped following the reference.
+   *
+   * The gain of the audio heard during BASELINE_WINDOW before `since` is
+   * fitted against the reference; the result is the audible time of the
+   * first later sample off that gain, or of the first pause, whichever
+   * comes first.
+   *
+   * @param reference Decode of the track from the start, at unity gain.
+   * @param since Time the command was issued.
+   * @return Audible time of the change, or nullopt if none was heard or
+   * no baseline audio exists.
+   */
+  [[nodiscard]] auto first_change(std::span<const int16_t> reference,
+                                  Clock::time_point since) const
+      -> std::optional<Clock::time_point>;
+
+private:
+  /**
+   * @struct Block
+   * @brief One write() in the capture.
+   */
+  struct Block {
+    Clock::time_point audible; ///< When its first sample is heard
+    size_t offset;             ///< Index of its first sample in samples_
+    size_t count;              ///< Samples written
+    size_t heard;              ///< Samples heard before a cut
+  };
+
+  /**
+   * @brief Gets when a sample of a block is heard. Requires probe_mutex_.
+   * @param block The block.
+   * @param index Sample index within the block.
+   * @return Audible time.
+   */
+  [[nodiscard]] auto sample_time(const Block &block, size_t index) const
+      -> Clock::time_point;
+
+  /**
+   * @brief Stops the timeline of queued audio at the present.
+   * Requires probe_mutex_.
+   */
+  void cut_timeline();
+
+  Clock &clock_;                          ///< Time base
+  mutable std::mutex probe_mutex_;        ///< Protects the capture
+  std::vector<int16_t> samples_;          ///< Everything written since open()
+  std::vector<Block> blocks_;             ///< Timeline of samples_
+  std::vector<Clock::time_point> pauses_; ///< pause() times since open()
+  AudioFormat capture_format_;            ///< Format of the capture
+};
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "quality_controller.hpp"
+
+#include <array>
+
+auto QualityController::observe(Clock::time_point now,
+                                std::chrono::nanoseconds decode_time,
+                                std::chrono::nanoseconds audio,
+                                std::chrono::nanoseconds buffered)
+    -> std::optional<Level> {
+  if (audio.count() <= 0) {
+    return std::nullopt;
+  }
+  const auto ratio = static_cast<double>(decode_time.count()) /
+                     static_cast<double>(audio.count());
+  auto load = load_.load();
+  load = measured_ ? load + (LOAD_SMOOTHING * (ratio - load)) : ratio;
+  load_.store(load);
+  measured_ = true;
+  if (buffered >= SAFE_BUFFER) {
+    primed_.store(true);
+  }
+
+  const auto level = level_.load();
+  const bool pressure =
+      load > DEGRADE_LOAD || (primed_.load() && buffered < LOW_BUFFER);
+  if (pressure) {
+    headroom_since_.reset();
+    if (level != Level::QUARTER_RATE &&
+        (!changed_ || now - *changed_ >= DEGRADE_HOLD)) {
+      return step(now, true);
+    }
+    return std::nullopt;
+  }
+  if (load > RECOVER_LOAD || buffered < SAFE_BUFFER) {
+    headroom_since_.reset();
+    return std::nullopt;
+  }
+  if (!headroom_since_) {
+    headroom_since_ = now;
+  }
+  if (level != Level::FULL && now - *headroom_since_ >= RECOVER_HOLD) {
+    return step(now, false);
+  }
+  return std::nullopt;
+}
+
+void QualityController::reset(Clock::time_point now) {
+  level_.store(Level::FULL);
+  primed_.store(false);
+  changed_ = now;
+  headroom_since_.reset();
+}
+
+void QualityController::restart_buffering() { primed_.store(false); }
+
+auto QualityController::level() const -> Level { return level_.load(); }
+
+auto QualityController::counters() const -> Counters {
+  return {level_.load(), degradations_.load(), recoveries_.load(),
+          load_.load()};
+}
+
+auto QualityController::name(Level level) -> const char * {
+  static constexpr std::array<const char *, 5> NAMES{
+      "full", "lean-dsp", "mono", "half-rate", "quarter-rate"};
+  return NAMES.at(static_cast<size_t>(level));
+}
+
+auto QualityController::step(Clock::time_point now, bool down) -> Level {
+  const auto current = static_cast<uint8_t>(level_.load());
+  const auto next = static_cast<Level>(down ? current + 1 : current - 1);
+  level_.store(next);
+  (down ? degradations_ : recoveries_).fetch_add(1);
+  changed_ = now;
+  // Each further step up needs a full hold of headroom of its own
+  headroom_since_ = down ? std::nullopt : std::optional{now};
+  return next;
+}
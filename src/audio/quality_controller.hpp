@@ -0,0 +1,123 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "../util/clock.hpp"
+
+/**
+ * @class QualityController
+ * @brief Trades decode fidelity for continuity when the CPU is overloaded.
+ *
+ * Fed the decode time and the output buffer level for every decoded block,
+ * it steps down one Level at a time while decoding takes too large a share
+ * of real time or the output is about to run dry, and back up once there has
+ * been headroom for RECOVER_HOLD. The gap between DEGRADE_LOAD and
+ * RECOVER_LOAD, and the hold times, keep it from oscillating.
+ *
+ * Observing is meant for one decode thread; level() and counters() may be
+ * read from any thread.
+ */
+class QualityController {
+public:
+  /// Each level includes the savings of the ones before it.
+  enum class Level : uint8_t {
+    FULL,         ///< Full decode and DSP
+    LEAN_DSP,     ///< Volume changes step instead of ramping
+    MONO,         ///< mpg123 mixes down to one channel
+    HALF_RATE,    ///< mpg123 synthesizes at half the sample rate
+    QUARTER_RATE, ///< mpg123 synthesizes at a quarter of the sample rate
+  };
+
+  /**
+   * @struct Counters
+   * @brief Controller state for stats.
+   */
+  struct Counters {
+    Level level;           ///< Current level
+    uint64_t degradations; ///< Steps down since construction
+    uint64_t recoveries;   ///< Steps up since construction
+    double load;           ///< Smoothed decode time per second of audio
+  };
+
+  static constexpr double LOAD_SMOOTHING = 0.1; ///< Weight of each new block
+  static constexpr double DEGRADE_LOAD = 0.6;   ///< Load that steps down
+  static constexpr double RECOVER_LOAD = 0.2;   ///< Load that allows recovery
+  static constexpr auto LOW_BUFFER =
+      std::chrono::milliseconds(250); ///< Output level that steps down
+  static constexpr auto SAFE_BUFFER =
+      std::chrono::seconds(1); ///< Output level that allows recovery
+  static constexpr auto DEGRADE_HOLD =
+      std::chrono::seconds(1); ///< Minimum time between steps down
+  static constexpr auto RECOVER_HOLD =
+      std::chrono::seconds(10); ///< Headroom needed for each step up
+
+  /**
+   * @brief Accounts one decoded block.
+   * @param now Current time.
+   * @param decode_time Time the decoder took for the block.
+   * @param audio Playing time of the block.
+   * @param buffered Output queued but not yet heard, including the block.
+   * @return The new level if it changed.
+   */
+  auto observe(Clock::time_point now, std::chrono::nanoseconds decode_time,
+               std::chrono::nanoseconds audio,
+               std::chrono::nanoseconds buffered) -> std::optional<Level>;
+
+  /**
+   * @brief Returns to FULL without counting a recovery, e.g. for a new track.
+   *
+   * The output buffer only counts as running dry again once it has been
+   * filled to SAFE_BUFFER.
+   *
+   * @param now Current time.
+   */
+  void reset(Clock::time_point now);
+
+  /**
+   * @brief Notes that the output was emptied on purpose, e.g. by a seek.
+   *
+   * It only counts as running dry again once refilled to SAFE_BUFFER.
+   */
+  void restart_buffering();
+
+  /**
+   * @brief Gets the current level.
+   * @return The level.
+   */
+  [[nodiscard]] auto level() const -> Level;
+
+  /**
+   * @brief Gets the counters.
+   * @return Current counters.
+   */
+  [[nodiscard]] auto counters() const -> Counters;
+
+  /**
+   * @brief Names a level for display.
+   * @param level The level.
+   * @return Lower-case name, e.g. "half-rate".
+   */
+  [[nodiscard]] static auto name(Level level) -> const char *;
+
+private:
+  /// Moves one level and restarts the hold times
+  auto step(Clock::time_point now, bool down) -> Level;
+
+  std::atomic<Level> level_{Level::FULL};    ///< Current level
+  std::atomic<uint64_t> degradations_{0};    ///< Steps down
+  std::atomic<uint64_t> recoveries_{0};      ///< Steps up
+  std::atomic<double> load_{0.0};            ///< Smoothed load
+  bool measured_{false};                     ///< load_ has a sample
+  std::atomic<bool> primed_{false};          ///< Buffer reached SAFE_BUFFER
+  std::optional<Clock::time_point> changed_; ///< Last level change
+  std::optional<Clock::time_point> headroom_since_; ///< Start of headroom
+};
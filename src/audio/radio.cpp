@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "radio.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Radio::Radio(std::vector<double> weights, uint64_t seed)
+    : sampler_(std::move(weights)), random_(seed),
+      window_(std::min(EXCLUDE_WINDOW, sampler_.size() / 2)),
+      recent_count_(sampler_.size(), 0) {}
+
+auto Radio::next() -> size_t {
+  auto song = sampler_.pick(random_);
+  for (int redraw = 0; redraw < MAX_REDRAWS && recent_count_[song] > 0;
+       ++redraw) {
+    song = sampler_.pick(random_);
+  }
+  exclude(song);
+  return song;
+}
+
+void Radio::exclude(size_t song) {
+  if (window_ == 0 || song >= recent_count_.size()) {
+    return;
+  }
+  recent_.push_back(song);
+  ++recent_count_[song];
+  if (recent_.size() > window_) {
+    --recent_count_[recent_.front()];
+    recent_.pop_front();
+  }
+}
+
+void Radio::set_weight(size_t song, double weight) {
+  sampler_.set_weight(song, weight);
+}
+
+auto Radio::weight(const std::optional<TrackStats> &stats, int64_t now_ms)
+    -> double {
+  if (!stats || stats->plays == 0) {
+    return 1.0;
+  }
+  const auto completed = static_cast<double>(stats->plays - stats->skips);
+  const auto affinity = 1.0 + std::log1p(completed);
+  const auto liking = 1.0 - (SKIP_PENALTY * stats->skip_rate());
+  const auto since = std::chrono::milliseconds(
+      std::max<int64_t>(0, now_ms - stats->last_played_ms));
+  const auto recency = std::clamp(
+      std::chrono::duration<double>(since) / RECENCY_RECOVERY, MIN_RECENCY,
+      1.0);
+  return affinity * liking * recency;
+}
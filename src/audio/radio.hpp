@@ -0,0 +1,83 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "alias_sampler.hpp"
+#include "history_log.hpp"
+
+/**
+ * @class Radio
+ * @brief Endless weighted random song selection that avoids repeats.
+ *
+ * Songs are drawn with an AliasSampler, so a pick is O(1) however large the
+ * library. The last EXCLUDE_WINDOW picks (fewer for small playlists) are
+ * excluded by drawing again, which stays O(1) on average as long as they
+ * carry a small share of the total weight.
+ */
+class Radio {
+public:
+  static constexpr size_t EXCLUDE_WINDOW = 50; ///< Recent picks not repeated
+  static constexpr int MAX_REDRAWS = 32;      ///< Then a recent pick is fine
+  static constexpr double SKIP_PENALTY = 0.75; ///< Weight lost if always skipped
+  static constexpr double MIN_RECENCY = 0.1;  ///< Weight kept just after a play
+  static constexpr auto RECENCY_RECOVERY =
+      std::chrono::hours(24); ///< Time until a played song is back to full
+
+  /**
+   * @brief Starts a station.
+   * @param weights Weight of each song, e.g. from weight().
+   * @param seed Seed of the picks.
+   */
+  Radio(std::vector<double> weights, uint64_t seed);
+
+  /**
+   * @brief Picks the next song.
+   * @return Index of the song in the weights.
+   */
+  auto next() -> size_t;
+
+  /**
+   * @brief Counts a song as just picked, e.g. the one playing at the start.
+   * @param song Index of the song.
+   */
+  void exclude(size_t song);
+
+  /**
+   * @brief Changes the weight of one song in O(sqrt(n)).
+   * @param song Index of the song.
+   * @param weight New weight.
+   */
+  void set_weight(size_t song, double weight);
+
+  /**
+   * @brief Weighs a song by its listening history.
+   *
+   * Songs played to the end gain weight logarithmically, skipped ones lose
+   * up to SKIP_PENALTY, and a song played recently starts at MIN_RECENCY
+   * and recovers over RECENCY_RECOVERY. A song never played weighs 1.
+   *
+   * @param stats Aggregates of the song, if it was ever played.
+   * @param now_ms Current Unix time in milliseconds.
+   * @return The weight.
+   */
+  [[nodiscard]] static auto weight(const std::optional<TrackStats> &stats,
+                                   int64_t now_ms) -> double;
+
+private:
+  AliasSampler sampler_;          ///< Weighted draws
+  std::mt19937_64 random_;        ///< Source of the draws
+  size_t window_;                 ///< Picks excluded, < number of songs
+  std::deque<size_t> recent_;     ///< Last window_ picks, oldest first
+  std::vector<uint16_t> recent_count_; ///< Times each song is in recent_
+};
@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "recording_sink.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr int32_t SIZING_RATE = 48000; ///< Ring sizing assumes 48 kHz
+constexpr int SIZING_CHANNELS = 2;     ///< Ring sizing assumes stereo
+constexpr uint64_t RIFF_OVERHEAD = 36; ///< RIFF size minus data size
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t BITS_PER_SAMPLE = 16;
+
+void put_le(std::byte *out, uint32_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = static_cast<std::byte>((value >> (8 * i)) & 0xFFU);
+  }
+}
+
+auto wav_header(const AudioFormat &format, uint64_t data_bytes)
+    -> std::array<std::byte, RecordingSink::WAV_HEADER_SIZE> {
+  std::array<std::byte, RecordingSink::WAV_HEADER_SIZE> header{};
+  const auto tag = [&](size_t offset, const char *text) {
+    std::memcpy(header.data() + offset, text, 4);
+  };
+  const auto channels = static_cast<uint32_t>(format.channels);
+  const auto data = static_cast<uint32_t>(data_bytes);
+  tag(0, "RIFF");
+  put_le(header.data() + 4, data + RIFF_OVERHEAD, 4);
+  tag(8, "WAVE");
+  tag(12, "fmt ");
+  put_le(header.data() + 16, 16, 4);
+  put_le(header.data() + 20, WAVE_FORMAT_PCM, 2);
+  put_le(header.data() + 22, channels, 2);
+  put_le(header.data() + 24, static_cast<uint32_t>(format.sample_rate), 4);
+  put_le(header.data() + 28, format.bytes_per_second(), 4);
+  put_le(header.data() + 32, channels * sizeof(int16_t), 2);
+  put_le(header.data() + 34, BITS_PER_SAMPLE, 2);
+  tag(36, "data");
+  put_le(header.data() + 40, data, 4);
+  return header;
+}
+
+auto round_up(size_t value, size_t alignment) -> size_t {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void RecordingSink::AlignedDelete::operator()(std::byte *data) const {
+  std::free(data); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+RecordingSink::RecordingSink(Options options)
+    : options_(std::move(options)),
+      ring_(static_cast<size_t>(options_.buffer.count()) * SIZING_RATE *
+            SIZING_CHANNELS),
+      staging_(static_cast<std::byte *>(
+          std::aligned_alloc(ALIGNMENT, WRITE_BLOCK))) {
+  if (!staging_) {
+    throw std::bad_alloc();
+  }
+  std::error_code error;
+  std::filesystem::create_directories(options_.directory, error);
+  if (error) {
+    throw std::runtime_error("Cannot create recording directory " +
+                             options_.directory.string() + ": " +
+                             error.message());
+  }
+  writer_ = std::jthread([this](const std::stop_token &token) { run(token); });
+}
+
+RecordingSink::~RecordingSink() {
+  writer_.request_stop();
+  writer_.join();
+}
+
+void RecordingSink::open(const AudioFormat &format) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  changes_.push_back({ring_.write_position(), format});
+  open_.store(true);
+}
+
+void RecordingSink::write(std::span<const int16_t> samples) {
+  if (!ring_.push(samples)) {
+    dropped_.fetch_add(samples.size());
+  }
+}
+
+auto RecordingSink::queued_bytes() const -> uint32_t { return 0; }
+
+// Audio already handed over was decoded for playback; keep it
+void RecordingSink::clear() {}
+
+void RecordingSink::pause() {}
+
+void RecordingSink::resume() {}
+
+auto RecordingSink::is_open() const -> bool { return open_.load(); }
+
+void RecordingSink::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto generation = ++flush_requested_;
+  wake_.notify_all();
+  flushed_.wait(lock, [&] { return flush_done_ >= generation; });
+}
+
+auto RecordingSink::files() const -> std::vector<std::filesystem::path> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return files_;
+}
+
+auto RecordingSink::dropped_samples() const -> uint64_t {
+  return dropped_.load();
+}
+
+auto RecordingSink::recorded_bytes() const -> uint64_t {
+  return recorded_.load();
+}
+
+void RecordingSink::run(const std::stop_token &token) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    const auto requested = flush_requested_;
+    const bool stopping = token.stop_requested();
+    lock.unlock();
+
+    try {
+      drain();
+      if (stopping) {
+        close_file();
+      } else if (requested != flush_done_) {
+        sync_file();
+      }
+    } catch (const std::exception &e) {
+      fail(e.what());
+    }
+
+    lock.lock();
+    if (requested != flush_done_) {
+      flush_done_ = requested;
+      flushed_.notify_all();
+    }
+    if (stopping) {
+      return;
+    }
+    wake_.wait_for(lock, token, POLL_INTERVAL,
+                   [&] { return flush_requested_ != flush_done_; });
+  }
+}
+
+void RecordingSink::drain() {
+  while (true) {
+    // Snapshot the ring first: any open() before these samples is then
+    // guaranteed to be visible in changes_
+    auto [first, second] = ring_.peek();
+    const auto read = ring_.read_position();
+    auto available = first.size() + second.size();
+
+    std::optional<AudioFormat> next;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!changes_.empty() && changes_.front().position <= read) {
+        next = changes_.front().format;
+        changes_.erase(changes_.begin());
+      } else if (!changes_.empty()) {
+        available = std::min(available, changes_.front().position - read);
+      }
+    }
+    if (next) {
+      close_file();
+      format_ = *next;
+      const auto frame = static_cast<uint64_t>(format_.channels) *
+                         sizeof(int16_t);
+      file_limit_ = std::numeric_limits<uint64_t>::max();
+      if (options_.rotate_after.count() > 0) {
+        file_limit_ = static_cast<uint64_t>(options_.rotate_after.count()) *
+                      format_.bytes_per_second();
+      }
+      if (options_.container == Container::WAV) {
+        file_limit_ = std::min<uint64_t>(
+            file_limit_, std::numeric_limits<uint32_t>::max() - RIFF_OVERHEAD);
+      }
+      file_limit_ = frame > 0 ? file_limit_ / frame * frame : 0;
+      continue;
+    }
+
+    if (available == 0) {
+      return;
+    }
+    first = first.first(std::min(first.size(), available));
+    second = second.first(available - first.size());
+    record(first);
+    record(second);
+    ring_.consume(available);
+  }
+}
+
+void RecordingSink::record(std::span<const int16_t> samples) {
+  if (failed_ || file_limit_ == 0) {
+    dropped_.fetch_add(samples.size());
+    return;
+  }
+  auto bytes = std::as_bytes(samples);
+  while (!bytes.empty()) {
+    if (fd_ < 0) {
+      open_file();
+    }
+    const auto count = static_cast<size_t>(
+        std::min<uint64_t>(bytes.size(), file_limit_ - data_bytes_));
+    stage(bytes.first(count));
+    data_bytes_ += count;
+    recorded_.fetch_add(count);
+    bytes = bytes.subspan(count);
+    if (data_bytes_ >= file_limit_) {
+      close_file();
+    }
+  }
+}
+
+void RecordingSink::open_file() {
+  const auto now = std::time(nullptr);
+  std::tm local{};
+  localtime_r(&now, &local);
+  std::ostringstream name;
+  name << options_.prefix << '-' << std::put_time(&local, "%Y%m%d-%H%M%S")
+       << '-' << std::setw(3) << std::setfill('0') << sequence_++
+       << (options_.container == Container::WAV ? ".wav" : ".raw");
+  const auto path = options_.directory / name.str();
+
+  // O_RDWR: with O_DIRECT the header is patched read-modify-write
+  constexpr int FLAGS = O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC;
+  constexpr mode_t MODE = 0644;
+  direct_ = options_.direct_io;
+  fd_ = ::open(path.c_str(), FLAGS | (direct_ ? O_DIRECT : 0), MODE);
+  if (fd_ < 0 && direct_ && errno == EINVAL) {
+    std::cerr << "[WARN] O_DIRECT not supported for " << path
+              << ", using buffered writes\n";
+    direct_ = false;
+    fd_ = ::open(path.c_str(), FLAGS, MODE);
+  }
+  if (fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot create " + path.string());
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.push_back(path);
+  }
+
+  staged_ = 0;
+  block_offset_ = 0;
+  data_bytes_ = 0;
+  if (options_.container == Container::WAV) {
+    const auto header = wav_header(format_, 0);
+    stage(header);
+  }
+}
+
+void RecordingSink::close_file() {
+  if (fd_ < 0) {
+    return;
+  }
+  sync_file();
+  ::close(fd_);
+  fd_ = -1;
+}
+
+void RecordingSink::sync_file() {
+  if (fd_ < 0) {
+    return;
+  }
+  if (block_offset_ == 0) {
+    patch_header();
+  }
+  if (staged_ > 0) {
+    // The partial block stays staged; later writes overwrite it in place
+    const auto size = direct_ ? round_up(staged_, ALIGNMENT) : staged_;
+    std::memset(staging_.get() + staged_, 0, size - staged_);
+    write_at(staging_.get(), size, block_offset_);
+  }
+  if (direct_ && ::ftruncate(fd_, static_cast<off_t>(block_offset_ +
+                                                     staged_)) != 0) {
+    throw std::system_error(errno, std::generic_category(), "ftruncate");
+  }
+  if (block_offset_ > 0) {
+    patch_header();
+  }
+}
+
+void RecordingSink::stage(std::span<const std::byte> bytes) {
+  while (!bytes.empty()) {
+    const auto count = std::min(bytes.size(), WRITE_BLOCK - staged_);
+    std::memcpy(staging_.get() + staged_, bytes.data(), count);
+    staged_ += count;
+    bytes = bytes.subspan(count);
+    if (staged_ == WRITE_BLOCK) {
+      write_at(staging_.get(), WRITE_BLOCK, block_offset_);
+      block_offset_ += WRITE_BLOCK;
+      staged_ = 0;
+    }
+  }
+}
+
+void RecordingSink::patch_header() {
+  if (options_.container != Container::WAV) {
+    return;
+  }
+  const auto header = wav_header(format_, data_bytes_);
+  if (block_offset_ == 0) {
+    std::memcpy(staging_.get(), header.data(), header.size());
+    return;
+  }
+  if (!direct_) {
+    write_at(header.data(), header.size(), 0);
+    return;
+  }
+  AlignedBuffer block(
+      static_cast<std::byte *>(std::aligned_alloc(ALIGNMENT, ALIGNMENT)));
+  if (!block || ::pread(fd_, block.get(), ALIGNMENT, 0) !=
+                    static_cast<ssize_t>(ALIGNMENT)) {
+    throw std::runtime_error("Cannot read back WAV header");
+  }
+  std::memcpy(block.get(), header.data(), header.size());
+  write_at(block.get(), ALIGNMENT, 0);
+}
+
+void RecordingSink::write_at(const std::byte *data, size_t size,
+                             uint64_t offset) {
+  while (size > 0) {
+    const auto written = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "Recording write failed");
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+    offset += static_cast<uint64_t>(written);
+  }
+}
+
+void RecordingSink::fail(const std::string &what) {
+  std::cerr << "[WARN] Recording stopped: " << what << '\n';
+  failed_ = true;
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
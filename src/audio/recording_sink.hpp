@@ -0,0 +1,187 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_sink.hpp"
+#include "ring_buffer.hpp"
+
+/**
+ * @class RecordingSink
+ * @brief AudioSink capturing the played stream to WAV or raw PCM files.
+ *
+ * write() only copies samples into a lock-free ring and never blocks or
+ * makes a system call; a dedicated writer thread drains the ring in large,
+ * block-aligned writes, optionally with O_DIRECT to keep recordings out of
+ * the page cache. If the disk stalls for longer than the ring covers, new
+ * audio is dropped and counted instead of delaying the caller.
+ *
+ * A new file is started on every format change and whenever the current
+ * file reaches the rotation length.
+ */
+class RecordingSink : public AudioSink {
+public:
+  /// File layout of recordings.
+  enum class Container : uint8_t {
+    WAV, ///< RIFF/WAVE with a 44-byte header
+    RAW, ///< Headerless interleaved s16le
+  };
+
+  /**
+   * @struct Options
+   * @brief Recording configuration.
+   */
+  struct Options {
+    std::filesystem::path directory;         ///< Where files are created
+    std::string prefix{"jpod"};              ///< File name prefix
+    Container container{Container::WAV};     ///< File layout
+    std::chrono::seconds rotate_after{0};    ///< File length, 0 = unlimited
+    bool direct_io{false};                   ///< Bypass the page cache
+    std::chrono::seconds buffer{DEFAULT_BUFFER}; ///< Disk stall tolerance
+  };
+
+  static constexpr auto DEFAULT_BUFFER = std::chrono::seconds(10);
+  static constexpr size_t WRITE_BLOCK = 256 * 1024; ///< Bytes per write
+  static constexpr size_t ALIGNMENT = 4096;         ///< O_DIRECT granularity
+  static constexpr size_t WAV_HEADER_SIZE = 44;
+  static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(50);
+
+  /**
+   * @brief Constructs a recorder and starts its writer thread.
+   * @param options Recording configuration.
+   * @throws std::runtime_error if the directory cannot be created.
+   */
+  explicit RecordingSink(Options options);
+
+  /**
+   * @brief Destructor.
+   * Writes out all buffered audio and finalizes the current file.
+   */
+  ~RecordingSink() override;
+
+  RecordingSink(RecordingSink &sink) = delete;
+  RecordingSink(RecordingSink &&sink) = delete;
+
+  auto operator=(RecordingSink &sink) -> RecordingSink & = delete;
+  auto operator=(RecordingSink &&sink) -> RecordingSink && = delete;
+
+  void open(const AudioFormat &format) override;
+  void write(std::span<const int16_t> samples) override;
+  [[nodiscard]] auto queued_bytes() const -> uint32_t override;
+  void clear() override;
+  void pause() override;
+  void resume() override;
+  [[nodiscard]] auto is_open() const -> bool override;
+
+  /**
+   * @brief Blocks until everything written so far is on disk with a valid
+   * header.
+   */
+  void flush();
+
+  /**
+   * @brief Gets the files created so far, oldest first.
+   * @return Paths of finished and in-progress recordings.
+   */
+  [[nodiscard]] auto files() const -> std::vector<std::filesystem::path>;
+
+  /**
+   * @brief Gets how many samples were lost to a full ring.
+   * @return Dropped interleaved samples.
+   */
+  [[nodiscard]] auto dropped_samples() const -> uint64_t;
+
+  /**
+   * @brief Gets how many PCM bytes reached the files.
+   * @return Recorded bytes, excluding headers.
+   */
+  [[nodiscard]] auto recorded_bytes() const -> uint64_t;
+
+private:
+  /**
+   * @struct FormatChange
+   * @brief open() call ordered against the samples in the ring.
+   */
+  struct FormatChange {
+    size_t position;    ///< Ring write position at the time of open()
+    AudioFormat format; ///< New format
+  };
+
+  /// Frees memory from std::aligned_alloc.
+  struct AlignedDelete {
+    void operator()(std::byte *data) const;
+  };
+  using AlignedBuffer = std::unique_ptr<std::byte[], AlignedDelete>;
+
+  /// Writer thread loop.
+  void run(const std::stop_token &token);
+
+  /// Moves ring contents into files, honouring format changes.
+  void drain();
+
+  /// Appends PCM to the current file, rotating as needed.
+  void record(std::span<const int16_t> samples);
+
+  /// Creates the next file for format_.
+  void open_file();
+
+  /// Writes out the staged tail and header, then closes the file.
+  void close_file();
+
+  /// Makes the current file complete and valid on disk.
+  void sync_file();
+
+  /// Appends bytes to the staging block, writing it out when full.
+  void stage(std::span<const std::byte> bytes);
+
+  /// Rewrites the WAV header with the current data size.
+  void patch_header();
+
+  /// Writes a whole buffer at an offset.
+  void write_at(const std::byte *data, size_t size, uint64_t offset);
+
+  /// Stops recording after an I/O error.
+  void fail(const std::string &what);
+
+  Options options_;                      ///< Configuration
+  PcmRing ring_;                         ///< Samples not yet staged
+  std::atomic<bool> open_{false};        ///< open() was called
+  std::atomic<uint64_t> dropped_{0};     ///< Samples lost to overflow
+  std::atomic<uint64_t> recorded_{0};    ///< PCM bytes handed to files
+
+  mutable std::mutex mutex_;             ///< Protects the fields below
+  std::condition_variable_any wake_;     ///< Wakes the writer
+  std::condition_variable flushed_;      ///< Signals flush completion
+  std::vector<FormatChange> changes_;    ///< Pending format changes
+  std::vector<std::filesystem::path> files_; ///< Created files
+  uint64_t flush_requested_{0};          ///< Flush generation requested
+  uint64_t flush_done_{0};               ///< Flush generation completed
+
+  // Writer thread state
+  AudioFormat format_;                   ///< Format of recorded audio
+  AlignedBuffer staging_;                ///< Block being assembled
+  size_t staged_{0};                     ///< Bytes in staging_
+  int fd_{-1};                           ///< Current file, -1 if none
+  bool direct_{false};                   ///< fd_ uses O_DIRECT
+  bool failed_{false};                   ///< An I/O error stopped recording
+  uint64_t block_offset_{0};             ///< File offset of staging_
+  uint64_t data_bytes_{0};               ///< PCM bytes in the current file
+  uint64_t file_limit_{0};               ///< PCM bytes per file
+  unsigned sequence_{0};                 ///< File counter for names
+
+  std::jthread writer_;                  ///< Drains the ring to disk
+};
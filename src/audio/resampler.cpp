@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "resampler.hpp"
+
+#include "dsp.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/// Catmull-Rom interpolation between p1 and p2.
+auto cubic(float p0, float p1, float p2, float p3, float t) -> float {
+  const float a = (-0.5F * p0) + (1.5F * p1) - (1.5F * p2) + (0.5F * p3);
+  const float b = p0 - (2.5F * p1) + (2.0F * p2) - (0.5F * p3);
+  const float c = (-0.5F * p0) + (0.5F * p2);
+  return (((a * t + b) * t + c) * t) + p1;
+}
+
+auto to_sample(float value) -> int16_t {
+  return static_cast<int16_t>(
+      std::clamp(std::lround(value),
+                 static_cast<long>(std::numeric_limits<int16_t>::min()),
+                 static_cast<long>(std::numeric_limits<int16_t>::max())));
+}
+
+} // namespace
+
+Resampler::Resampler(int channels) { reset(channels); }
+
+void Resampler::set_ratio(double ratio) { ratio_.store(ratio); }
+
+auto Resampler::ratio() const -> double { return ratio_.load(); }
+
+void Resampler::reset(int channels) {
+  channels_ = std::max(channels, 1);
+  // One silent frame of history so the first input frame can be centred
+  frames_.assign(static_cast<size_t>(channels_), 0.0F);
+  position_ = 1.0;
+}
+
+void Resampler::process(std::span<const int16_t> input,
+                        std::vector<int16_t> &output) {
+  output.clear();
+  const auto pending = frames_.size();
+  frames_.resize(pending + input.size());
+  dsp_kernels().to_float(input, frames_.data() + pending);
+  const auto channels = static_cast<size_t>(channels_);
+  const auto available = frames_.size() / channels;
+  const double step = 1.0 / ratio_.load();
+
+  // Frames i-1 .. i+2 are needed to interpolate at position i + t
+  while (position_ + 2.0 < static_cast<double>(available)) {
+    const auto index = static_cast<size_t>(position_);
+    const auto t = static_cast<float>(position_ - static_cast<double>(index));
+    const float *p0 = frames_.data() + ((index - 1) * channels);
+    for (size_t channel = 0; channel < channels; ++channel) {
+      output.push_back(to_sample(
+          cubic(p0[channel], p0[channel + channels],
+                p0[channel + (2 * channels)], p0[channel + (3 * channels)], t)));
+    }
+    position_ += step;
+  }
+
+  const auto consumed = static_cast<size_t>(position_) - 1;
+  frames_.erase(frames_.begin(),
+                frames_.begin() + static_cast<std::ptrdiff_t>(
+                                      consumed * channels));
+  position_ -= static_cast<double>(consumed);
+}
@@ -0,0 +1,66 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @class Resampler
+ * @brief Streaming resampler with a continuously adjustable ratio.
+ *
+ * Meant for clock correction rather than format conversion: the ratio stays
+ * within a fraction of a percent of 1 and may be changed from another
+ * thread at any time; the change applies from the next output frame on, with
+ * no discontinuity. Interpolation is cubic (Catmull-Rom), which passes a
+ * ratio of exactly 1 through unchanged.
+ */
+class Resampler {
+public:
+  /**
+   * @brief Constructs a resampler at ratio 1.
+   * @param channels Interleaved channels per frame.
+   */
+  explicit Resampler(int channels = 2);
+
+  /**
+   * @brief Sets the conversion ratio.
+   * @param ratio Output frames per input frame; above 1 stretches.
+   */
+  void set_ratio(double ratio);
+
+  /**
+   * @brief Gets the conversion ratio.
+   * @return Output frames per input frame.
+   */
+  [[nodiscard]] auto ratio() const -> double;
+
+  /**
+   * @brief Drops the interpolation history, e.g. after a seek.
+   * @param channels Interleaved channels of subsequent input.
+   */
+  void reset(int channels);
+
+  /**
+   * @brief Converts a block of input.
+   *
+   * A few input frames are held back as interpolation history and come out
+   * with the next call.
+   *
+   * @param input Interleaved input samples.
+   * @param output Replaced with the interleaved output samples.
+   */
+  void process(std::span<const int16_t> input, std::vector<int16_t> &output);
+
+private:
+  int channels_;                   ///< Interleaved channels
+  std::atomic<double> ratio_{1.0}; ///< Output frames per input frame
+  std::vector<float> frames_;      ///< Pending input, history first
+  double position_{1.0};           ///< Read position in frames_, in frames
+};
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "resume_state.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t FNV_PRIME = 0x100000001b3;
+
+/// Reads one slot without tearing; std::nullopt if empty or left mid-save
+auto read_slot(const ResumeSlot &slot)
+    -> std::optional<std::pair<uint64_t, ResumePoint>> {
+  while (true) {
+    const auto before = slot.sequence.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1U) != 0) {
+      return std::nullopt;
+    }
+    ResumePoint point{
+        slot.playlist.load(std::memory_order_relaxed),
+        slot.track.load(std::memory_order_relaxed),
+        slot.position.load(std::memory_order_relaxed),
+        std::nullopt,
+        slot.playing.load(std::memory_order_relaxed) != 0,
+        slot.volume.load(std::memory_order_relaxed),
+        slot.sample.load(std::memory_order_relaxed),
+        slot.first_offset.load(std::memory_order_relaxed),
+        slot.anchor_frame.load(std::memory_order_relaxed),
+        slot.anchor_offset.load(std::memory_order_relaxed)};
+    if (slot.shuffled.load(std::memory_order_relaxed) != 0) {
+      point.shuffle_seed = slot.shuffle_seed.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == before) {
+      return std::pair{before, point};
+    }
+  }
+}
+
+} // namespace
+
+ResumeState::ResumeState(fs::path file) {
+  std::error_code error;
+  fs::create_directories(file.parent_path(), error);
+  const int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open resume state " + file.string());
+  }
+  // A short or foreign file is grown and reset below
+  const bool sized = ftruncate(fd, sizeof(ResumeStateFile)) == 0;
+  void *mapping = sized ? mmap(nullptr, sizeof(ResumeStateFile),
+                               PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                        : MAP_FAILED;
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Cannot map resume state " + file.string());
+  }
+  file_ = static_cast<ResumeStateFile *>(mapping);
+
+  if (file_->magic != ResumeStateFile::MAGIC ||
+      file_->version != ResumeStateFile::VERSION) {
+    // Zeroed memory is a valid state for every atomic: no point saved yet
+    std::memset(mapping, 0, sizeof(ResumeStateFile));
+    file_->magic = ResumeStateFile::MAGIC;
+    file_->version = ResumeStateFile::VERSION;
+  }
+  // Continue from the newest complete save, so the next one overwrites a
+  // slot torn by a crash rather than the last good point
+  for (const auto &slot : file_->slots) {
+    const auto sequence = slot.sequence.load();
+    if ((sequence & 1U) == 0) {
+      generation_ = std::max(generation_, sequence / 2);
+    }
+  }
+}
+
+ResumeState::~ResumeState() { munmap(file_, sizeof(ResumeStateFile)); }
+
+void ResumeState::save(const ResumePoint &point) {
+  const auto generation = ++generation_;
+  auto &slot = file_->slots[generation % 2];
+  slot.sequence.store((2 * generation) - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.playlist.store(point.playlist, std::memory_order_relaxed);
+  slot.track.store(point.track, std::memory_order_relaxed);
+  slot.position.store(point.position, std::memory_order_relaxed);
+  slot.shuffle_seed.store(point.shuffle_seed.value_or(0),
+                          std::memory_order_relaxed);
+  slot.shuffled.store(point.shuffle_seed ? 1 : 0, std::memory_order_relaxed);
+  slot.playing.store(point.playing ? 1 : 0, std::memory_order_relaxed);
+  slot.volume.store(point.volume, std::memory_order_relaxed);
+  slot.sample.store(point.sample, std::memory_order_relaxed);
+  slot.first_offset.store(point.first_offset, std::memory_order_relaxed);
+  slot.anchor_frame.store(point.anchor_frame, std::memory_order_relaxed);
+  slot.anchor_offset.store(point.anchor_offset, std::memory_order_relaxed);
+  slot.sequence.store(2 * generation, std::memory_order_release);
+}
+
+auto ResumeState::load() const -> std::optional<ResumePoint> {
+  std::optional<std::pair<uint64_t, ResumePoint>> newest;
+  for (const auto &slot : file_->slots) {
+    const auto read = read_slot(slot);
+    if (read && (!newest || read->first > newest->first)) {
+      newest = read;
+    }
+  }
+  if (!newest) {
+    return std::nullopt;
+  }
+  return newest->second;
+}
+
+auto ResumeState::default_file() -> fs::path {
+  if (const char *xdg = std::getenv("XDG_STATE_HOME"); xdg != nullptr) {
+    return fs::path(xdg) / "jpod_nano" / "resume";
+  }
+  if (const char *home = std::getenv("HOME"); home != nullptr) {
+    return fs::path(home) / ".local" / "state" / "jpod_nano" / "resume";
+  }
+  return fs::temp_directory_path() / "jpod_nano" / "resume";
+}
+
+auto ResumeState::hash(std::string_view text, uint64_t basis) -> uint64_t {
+  for (const auto character : text) {
+    basis ^= static_cast<unsigned char>(character);
+    basis *= FNV_PRIME;
+  }
+  return basis;
+}
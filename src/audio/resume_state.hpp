@@ -0,0 +1,136 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+/**
+ * @struct ResumePoint
+ * @brief Where playback was, in enough detail to continue at the same sample.
+ */
+struct ResumePoint {
+  uint64_t playlist;    ///< ResumeState::hash() of the songs in load order
+  uint64_t track;       ///< ResumeState::hash() of the current song's path
+  uint64_t position;    ///< Position of the current song in the play order
+  std::optional<uint64_t> shuffle_seed; ///< Seed of the play order
+  bool playing;         ///< Playback was running, not paused
+  float volume;         ///< Volume before any pause fade
+  int64_t sample;       ///< Last audible sample of the current song
+  int64_t first_offset; ///< Byte offset of the song's first frame
+  int64_t anchor_frame; ///< Frame at or before sample, 0 if none
+  int64_t anchor_offset; ///< Byte offset of anchor_frame
+};
+
+/**
+ * @struct ResumeSlot
+ * @brief One copy of a ResumePoint, published with a seqlock.
+ */
+struct ResumeSlot {
+  std::atomic<uint64_t> sequence; ///< Twice the generation, odd while written
+  std::atomic<uint64_t> playlist;       ///< ResumePoint::playlist
+  std::atomic<uint64_t> track;          ///< ResumePoint::track
+  std::atomic<uint64_t> position;       ///< ResumePoint::position
+  std::atomic<uint64_t> shuffle_seed;   ///< ResumePoint::shuffle_seed
+  std::atomic<uint32_t> shuffled;       ///< Nonzero if shuffle_seed is set
+  std::atomic<uint32_t> playing;        ///< ResumePoint::playing
+  std::atomic<float> volume;            ///< ResumePoint::volume
+  std::atomic<int64_t> sample;          ///< ResumePoint::sample
+  std::atomic<int64_t> first_offset;    ///< ResumePoint::first_offset
+  std::atomic<int64_t> anchor_frame;    ///< ResumePoint::anchor_frame
+  std::atomic<int64_t> anchor_offset;   ///< ResumePoint::anchor_offset
+};
+
+/**
+ * @struct ResumeStateFile
+ * @brief Layout of the state file.
+ *
+ * Saves alternate between the two slots. A process killed mid-save leaves
+ * that slot's sequence odd, and the other slot still holds the previous
+ * point, so a restart always finds a complete one.
+ */
+struct ResumeStateFile {
+  static constexpr uint32_t MAGIC = 0x4A505253; // "JPRS"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;      ///< MAGIC
+  uint32_t version;    ///< VERSION
+  ResumeSlot slots[2]; ///< Written alternately
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<float>::is_always_lock_free,
+              "Resume state fields must be address-free");
+
+/**
+ * @class ResumeState
+ * @brief Crash-safe record of the playback position in a memory-mapped file.
+ *
+ * A save is a handful of stores into the mapping, cheap enough to repeat
+ * every fraction of a second from the decode thread. The kernel owns the
+ * pages, so they survive the process crashing; they reach the disk with
+ * normal writeback.
+ *
+ * One process saves at a time; any number may load.
+ */
+class ResumeState {
+public:
+  /**
+   * @brief Opens or creates the state file and maps it.
+   * @param file Path of the state file; a file that is not one is reset.
+   * @throws std::runtime_error if the file cannot be created or mapped.
+   */
+  explicit ResumeState(std::filesystem::path file = default_file());
+
+  /**
+   * @brief Destructor.
+   * Unmaps the file.
+   */
+  ~ResumeState();
+
+  ResumeState(ResumeState &state) = delete;
+  ResumeState(ResumeState &&state) = delete;
+
+  auto operator=(ResumeState &state) -> ResumeState & = delete;
+  auto operator=(ResumeState &&state) -> ResumeState && = delete;
+
+  /**
+   * @brief Publishes a new point.
+   * @param point Where playback is now.
+   */
+  void save(const ResumePoint &point);
+
+  /**
+   * @brief Reads the newest complete point.
+   * @return The point, or std::nullopt if none was ever saved.
+   */
+  [[nodiscard]] auto load() const -> std::optional<ResumePoint>;
+
+  /**
+   * @brief Gets the default state file.
+   * @return $XDG_STATE_HOME/jpod_nano/resume, or under ~/.local/state.
+   */
+  [[nodiscard]] static auto default_file() -> std::filesystem::path;
+
+  /**
+   * @brief Hashes text stably across runs and builds (64-bit FNV-1a).
+   * @param text Text to hash.
+   * @param basis Previous hash, to hash several strings in sequence.
+   * @return The hash.
+   */
+  [[nodiscard]] static auto hash(std::string_view text,
+                                 uint64_t basis = HASH_BASIS) -> uint64_t;
+
+  static constexpr uint64_t HASH_BASIS = 0xcbf29ce484222325; ///< FNV offset
+
+private:
+  ResumeStateFile *file_{nullptr}; ///< Shared mapping of the file
+  uint64_t generation_{0};         ///< Newest generation saved or found
+};
@@ -0,0 +1,151 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../util/memory_accounting.hpp"
+
+/**
+ * @class RingBuffer
+ * @brief Lock-free single-producer/single-consumer ring of trivially
+ * copyable items.
+ *
+ * Head and tail are free-running counters on separate cache lines; the
+ * producer only writes the tail and the consumer only writes the head, so
+ * neither side ever blocks or takes a lock.
+ *
+ * @tparam T Item type, typically int16_t samples or bytes.
+ * @tparam Allocator Allocator of the storage, e.g. a TaggedAllocator.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class RingBuffer {
+public:
+  /**
+   * @brief Constructs an empty ring.
+   * @param capacity Minimum number of items, rounded up to a power of 2.
+   */
+  explicit RingBuffer(size_t capacity)
+      : buffer_(std::bit_ceil(std::max<size_t>(capacity, 1))),
+        mask_(buffer_.size() - 1) {}
+
+  /**
+   * @brief Appends all items, or none if they do not fit. Producer only.
+   * @param items Items to append.
+   * @return true if the items were appended.
+   */
+  auto push(std::span<const T> items) -> bool {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    const auto head = head_.load(std::memory_order_acquire);
+    if (buffer_.size() - (tail - head) < items.size()) {
+      return false;
+    }
+    const auto start = tail & mask_;
+    const auto first = std::min(items.size(), buffer_.size() - start);
+    std::copy_n(items.begin(), first, buffer_.begin() + start);
+    std::copy(items.begin() + first, items.end(), buffer_.begin());
+    tail_.store(tail + items.size(), std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Removes up to out.size() items. Consumer only.
+   * @param out Destination for the items.
+   * @return Number of items removed.
+   */
+  auto pop(std::span<T> out) -> size_t {
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    const auto count = std::min(out.size(), tail - head);
+    const auto start = head & mask_;
+    const auto first = std::min(count, buffer_.size() - start);
+    std::copy_n(buffer_.begin() + start, first, out.begin());
+    std::copy_n(buffer_.begin(), count - first, out.begin() + first);
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Gets the readable items as up to two contiguous spans without
+   * copying. Consumer only; release them with consume().
+   * @return The first and second (wrapped) readable regions.
+   */
+  [[nodiscard]] auto peek() const -> std::pair<std::span<const T>,
+                                               std::span<const T>> {
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    const auto count = tail - head;
+    const auto start = head & mask_;
+    const auto first = std::min(count, buffer_.size() - start);
+    return {std::span<const T>{buffer_.data() + start, first},
+            std::span<const T>{buffer_.data(), count - first}};
+  }
+
+  /**
+   * @brief Releases items previously obtained with peek(). Consumer only.
+   * @param count Number of items to release.
+   */
+  void consume(size_t count) {
+    head_.store(head_.load(std::memory_order_relaxed) + count,
+                std::memory_order_release);
+  }
+
+  /**
+   * @brief Gets the total number of items ever consumed.
+   * @return Free-running read counter.
+   */
+  [[nodiscard]] auto read_position() const -> size_t {
+    return head_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Gets the total number of items ever pushed.
+   * @return Free-running write counter.
+   */
+  [[nodiscard]] auto write_position() const -> size_t {
+    return tail_.load(std::memory_order_acquire);
+  }
+
+  /// Drops all readable items. Consumer only.
+  void clear() {
+    head_.store(tail_.load(std::memory_order_acquire),
+                std::memory_order_release);
+  }
+
+  /**
+   * @brief Gets the number of readable items.
+   * @return Items currently stored.
+   */
+  [[nodiscard]] auto size() const -> size_t {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Gets the ring capacity.
+   * @return Maximum number of items.
+   */
+  [[nodiscard]] auto capacity() const -> size_t { return buffer_.size(); }
+
+private:
+  static constexpr size_t CACHE_LINE = 64; ///< Avoids false sharing
+
+  std::vector<T, Allocator> buffer_;               ///< Item storage
+  size_t mask_;                                    ///< capacity - 1
+  alignas(CACHE_LINE) std::atomic<size_t> head_{0}; ///< Consumer counter
+  alignas(CACHE_LINE) std::atomic<size_t> tail_{0}; ///< Producer counter
+};
+
+/// Ring of PCM samples, charged to MemoryTag::PCM
+using PcmRing = RingBuffer<int16_t, TaggedAllocator<int16_t, MemoryTag::PCM>>;
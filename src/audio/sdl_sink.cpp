@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "sdl_sink.hpp"
+
+#include <stdexcept>
+#include <string>
+
+SdlSink::SdlSink() {
+  if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+    throw std::runtime_error("SDL_Init failed: " + std::string(SDL_GetError()));
+  }
+}
+
+SdlSink::~SdlSink() {
+  if (device_ != 0) {
+    SDL_CloseAudioDevice(device_);
+  }
+  SDL_QuitSubSystem(SDL_INIT_AUDIO);
+}
+
+void SdlSink::open(const AudioFormat &format) {
+  SDL_AudioSpec want{};
+  SDL_AudioSpec have{};
+  SDL_zero(want);
+  want.freq = format.sample_rate;
+  want.format = AUDIO_S16SYS;
+  want.channels = static_cast<Uint8>(format.channels);
+  want.samples = DEVICE_SAMPLES;
+
+  if (device_ != 0) {
+    SDL_CloseAudioDevice(device_);
+  }
+  device_ = SDL_OpenAudioDevice(nullptr, 0, &want, &have, 0);
+  if (device_ == 0) {
+    throw std::runtime_error("SDL_OpenAudioDevice error: " +
+                             std::string(SDL_GetError()));
+  }
+  pause();
+}
+
+void SdlSink::write(std::span<const int16_t> samples) {
+  if (device_ != 0) {
+    SDL_QueueAudio(device_, samples.data(),
+                   static_cast<Uint32>(samples.size_bytes()));
+  }
+}
+
+auto SdlSink::queued_bytes() const -> uint32_t {
+  return (device_ != 0) ? SDL_GetQueuedAudioSize(device_) : 0;
+}
+
+void SdlSink::clear() {
+  if (device_ != 0) {
+    SDL_ClearQueuedAudio(device_);
+  }
+}
+
+void SdlSink::pause() {
+  if (device_ != 0) {
+    SDL_PauseAudioDevice(device_, 1);
+  }
+}
+
+void SdlSink::resume() {
+  if (device_ != 0) {
+    SDL_PauseAudioDevice(device_, 0);
+  }
+}
+
+auto SdlSink::is_open() const -> bool { return device_ != 0; }
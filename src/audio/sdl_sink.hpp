@@ -0,0 +1,49 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <SDL2/SDL.h>
+
+#include "audio_sink.hpp"
+
+/**
+ * @class SdlSink
+ * @brief AudioSink playing through an SDL2 audio device queue.
+ */
+class SdlSink : public AudioSink {
+public:
+  static constexpr auto DEVICE_SAMPLES = 8192U; ///< SDL callback size
+
+  /**
+   * @brief Initializes the SDL audio subsystem.
+   * @throws std::runtime_error if SDL fails to initialize.
+   */
+  SdlSink();
+
+  /**
+   * @brief Destructor.
+   * Closes the device and shuts down the SDL audio subsystem.
+   */
+  ~SdlSink() override;
+
+  SdlSink(SdlSink &sink) = delete;
+  SdlSink(SdlSink &&sink) = delete;
+
+  auto operator=(SdlSink &sink) -> SdlSink & = delete;
+  auto operator=(SdlSink &&sink) -> SdlSink && = delete;
+
+  void open(const AudioFormat &format) override;
+  void write(std::span<const int16_t> samples) override;
+  [[nodiscard]] auto queued_bytes() const -> uint32_t override;
+  void clear() override;
+  void pause() override;
+  void resume() override;
+  [[nodiscard]] auto is_open() const -> bool override;
+
+private:
+  SDL_AudioDeviceID device_{0}; ///< SDL audio handle, 0 if closed
+};
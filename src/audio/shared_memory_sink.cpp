@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "shared_memory_sink.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+SharedMemorySink::SharedMemorySink(size_t capacity, const std::string &name) {
+  const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const auto header_size =
+      std::max(page, std::bit_ceil(sizeof(SharedRingHeader)));
+  capacity_ = std::bit_ceil(std::max(capacity, page));
+
+  fd_ = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd_ < 0) {
+    throw std::runtime_error("memfd_create failed");
+  }
+  if (ftruncate(fd_, static_cast<off_t>(header_size + capacity_)) != 0) {
+    ::close(fd_);
+    throw std::runtime_error("Cannot size shared ring");
+  }
+  // Readers map the full size; make sure it can never shrink under them
+  fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+  try {
+    mapping_ =
+        std::make_unique<SharedRingMapping>(fd_, header_size, capacity_, true);
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+  // The memfd starts zeroed, which is a valid state for every atomic
+  auto &header = mapping_->header();
+  header.header_size = header_size;
+  header.capacity = capacity_;
+  header.version = SharedRingHeader::VERSION;
+  header.paused.store(1);
+  std::atomic_thread_fence(std::memory_order_release);
+  header.magic = SharedRingHeader::MAGIC;
+}
+
+SharedMemorySink::~SharedMemorySink() {
+  mapping_.reset();
+  ::close(fd_);
+}
+
+void SharedMemorySink::open(const AudioFormat &format) {
+  auto &header = mapping_->header();
+  const auto sequence = header.format_sequence.load(std::memory_order_relaxed);
+  header.format_sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  header.previous_rate.store(header.sample_rate.load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+  header.previous_channels.store(
+      header.channels.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  header.sample_rate.store(format.sample_rate, std::memory_order_relaxed);
+  header.channels.store(format.channels, std::memory_order_relaxed);
+  header.format_position.store(header.write_position.load(),
+                               std::memory_order_relaxed);
+  header.format_sequence.store(sequence + 2, std::memory_order_release);
+  header.paused.store(1);
+  open_.store(true);
+}
+
+void SharedMemorySink::write(std::span<const int16_t> samples) {
+  auto &header = mapping_->header();
+  auto position = header.write_position.load(std::memory_order_relaxed);
+  auto bytes = std::as_bytes(samples);
+  if (bytes.size() > capacity_) {
+    // Only the newest capacity bytes can ever be read
+    position += bytes.size() - capacity_;
+    bytes = bytes.last(capacity_);
+  }
+  // The mirrored mapping makes the wrap invisible: one copy, no split
+  std::memcpy(mapping_->data() + (position & (capacity_ - 1)), bytes.data(),
+              bytes.size());
+  header.write_position.store(position + bytes.size(),
+                              std::memory_order_release);
+  shared_ring_wake(header);
+}
+
+auto SharedMemorySink::queued_bytes() const -> uint32_t { return 0; }
+
+void SharedMemorySink::clear() {
+  auto &header = mapping_->header();
+  header.flush_position.store(header.write_position.load(),
+                              std::memory_order_release);
+}
+
+void SharedMemorySink::pause() { mapping_->header().paused.store(1); }
+
+void SharedMemorySink::resume() { mapping_->header().paused.store(0); }
+
+auto SharedMemorySink::is_open() const -> bool { return open_.load(); }
+
+auto SharedMemorySink::path() const -> std::string {
+  return "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(fd_);
+}
+
+auto SharedMemorySink::capacity() const -> size_t { return capacity_; }
@@ -0,0 +1,77 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "audio_sink.hpp"
+#include "shared_ring.hpp"
+
+/**
+ * @class SharedMemorySink
+ * @brief AudioSink publishing PCM into a memfd-backed ring for local
+ * processes.
+ *
+ * Encoders and analyzers open path() with a SharedRingReader and read the
+ * audio in place from their own mapping: no sockets and no copies on the
+ * consumer side. Each reader keeps its own position, so they are fully
+ * independent; the sink never waits for any of them, and readers that fall
+ * more than the ring capacity behind skip ahead.
+ */
+class SharedMemorySink : public AudioSink {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 4U << 20U; ///< ~20 s of CD audio
+
+  /**
+   * @brief Creates and maps the ring.
+   * @param capacity Data bytes, rounded up to a power of 2 and page size.
+   * @param name memfd name, shown in /proc/<pid>/fd.
+   * @throws std::runtime_error if the memfd cannot be created or mapped.
+   */
+  explicit SharedMemorySink(size_t capacity = DEFAULT_CAPACITY,
+                            const std::string &name = "jpod_nano_pcm");
+
+  /**
+   * @brief Destructor.
+   * Unmaps and closes the ring; open readers keep their mapping.
+   */
+  ~SharedMemorySink() override;
+
+  SharedMemorySink(SharedMemorySink &sink) = delete;
+  SharedMemorySink(SharedMemorySink &&sink) = delete;
+
+  auto operator=(SharedMemorySink &sink) -> SharedMemorySink & = delete;
+  auto operator=(SharedMemorySink &&sink) -> SharedMemorySink && = delete;
+
+  void open(const AudioFormat &format) override;
+  void write(std::span<const int16_t> samples) override;
+  [[nodiscard]] auto queued_bytes() const -> uint32_t override;
+  void clear() override;
+  void pause() override;
+  void resume() override;
+  [[nodiscard]] auto is_open() const -> bool override;
+
+  /**
+   * @brief Gets the path other processes open the ring with.
+   * @return /proc/<pid>/fd/<fd> of the memfd.
+   */
+  [[nodiscard]] auto path() const -> std::string;
+
+  /**
+   * @brief Gets the ring data capacity.
+   * @return Capacity in bytes.
+   */
+  [[nodiscard]] auto capacity() const -> size_t;
+
+private:
+  int fd_{-1};                                 ///< memfd
+  size_t capacity_{0};                         ///< Data bytes
+  std::unique_ptr<SharedRingMapping> mapping_; ///< Writable mapping
+  std::atomic<bool> open_{false};              ///< open() was called
+};
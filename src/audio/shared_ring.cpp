@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "shared_ring.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+
+namespace {
+
+constexpr long NS_PER_MS = 1'000'000;
+constexpr long MS_PER_SECOND = 1000;
+
+auto futex(std::atomic<uint32_t> &word, int operation, uint32_t value,
+           const timespec *timeout) -> long {
+  // Not FUTEX_PRIVATE: waiters and wakers live in different processes
+  return syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), operation,
+                 value, timeout, nullptr, 0);
+}
+
+auto frame_bytes(const AudioFormat &format) -> uint64_t {
+  return std::max<uint64_t>(1, static_cast<uint64_t>(format.channels)) *
+         sizeof(int16_t);
+}
+
+} // namespace
+
+SharedRingMapping::SharedRingMapping(int fd, size_t header_size,
+                                     size_t capacity, bool writable)
+    : size_(header_size + (2 * capacity)), header_size_(header_size) {
+  // Reserve the whole range, then map the file over it: header and data
+  // once, and the data again right behind itself
+  void *base =
+      mmap(nullptr, size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    throw std::runtime_error("Cannot reserve shared ring address space");
+  }
+  base_ = static_cast<std::byte *>(base);
+  const int data_protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  const bool mapped =
+      mmap(base_, header_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+           fd, 0) != MAP_FAILED &&
+      mmap(base_ + header_size, capacity, data_protection,
+           MAP_SHARED | MAP_FIXED, fd, static_cast<off_t>(header_size)) !=
+          MAP_FAILED &&
+      mmap(base_ + header_size + capacity, capacity, data_protection,
+           MAP_SHARED | MAP_FIXED, fd, static_cast<off_t>(header_size)) !=
+          MAP_FAILED;
+  if (!mapped) {
+    munmap(base_, size_);
+    throw std::runtime_error("Cannot map shared ring");
+  }
+}
+
+SharedRingMapping::~SharedRingMapping() { munmap(base_, size_); }
+
+auto SharedRingMapping::header() const -> SharedRingHeader & {
+  return *reinterpret_cast<SharedRingHeader *>(base_);
+}
+
+auto SharedRingMapping::data() const -> std::byte * {
+  return base_ + header_size_;
+}
+
+auto shared_ring_format(const SharedRingHeader &header) -> SharedRingFormat {
+  while (true) {
+    const auto before = header.format_sequence.load(std::memory_order_acquire);
+    if ((before & 1U) != 0) {
+      continue;
+    }
+    SharedRingFormat format{
+        {header.sample_rate.load(std::memory_order_relaxed),
+         header.channels.load(std::memory_order_relaxed)},
+        {header.previous_rate.load(std::memory_order_relaxed),
+         header.previous_channels.load(std::memory_order_relaxed)},
+        header.format_position.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header.format_sequence.load(std::memory_order_relaxed) == before) {
+      return format;
+    }
+  }
+}
+
+void shared_ring_wake(SharedRingHeader &header) {
+  header.wake_sequence.fetch_add(1);
+  if (header.waiters.load() > 0) {
+    futex(header.wake_sequence, FUTEX_WAKE, INT_MAX, nullptr);
+  }
+}
+
+SharedRingReader::SharedRingReader(const std::string &path) {
+  // Read-write only for the waiters counter; data is mapped read-only
+  fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd_ < 0) {
+    throw std::runtime_error("Cannot open shared ring " + path);
+  }
+  // The fixed leading fields, read before anything is mapped
+  struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t header_size;
+    uint64_t capacity;
+  } prefix{};
+  const bool valid =
+      pread(fd_, &prefix, sizeof(prefix), 0) ==
+          static_cast<ssize_t>(sizeof(prefix)) &&
+      prefix.magic == SharedRingHeader::MAGIC &&
+      prefix.version == SharedRingHeader::VERSION && prefix.capacity > 0 &&
+      (prefix.capacity & (prefix.capacity - 1)) == 0;
+  if (!valid) {
+    ::close(fd_);
+    throw std::runtime_error(path + " is not a jpod-nano shared ring");
+  }
+  try {
+    mapping_ = std::make_unique<SharedRingMapping>(
+        fd_, prefix.header_size, prefix.capacity, false);
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+  read_position_ = mapping_->header().write_position.load();
+}
+
+SharedRingReader::~SharedRingReader() {
+  mapping_.reset();
+  ::close(fd_);
+}
+
+auto SharedRingReader::peek() -> std::span<const int16_t> {
+  auto &header = mapping_->header();
+  const auto write = header.write_position.load(std::memory_order_acquire);
+  const auto format = shared_ring_format(header);
+
+  // Skip audio that was cleared, or that the writer already overwrote
+  const auto flush = header.flush_position.load(std::memory_order_acquire);
+  if (read_position_ < flush) {
+    read_position_ = flush;
+  }
+  if (write - read_position_ > header.capacity) {
+    auto resume = write - (header.capacity / 2);
+    if (resume >= format.position) {
+      resume -= (resume - format.position) % frame_bytes(format.current);
+    }
+    read_position_ = resume;
+    ++overruns_;
+  }
+
+  auto end = write;
+  if (read_position_ < format.position) {
+    end = std::min(end, format.position);
+  }
+  const auto bytes = (end - read_position_) & ~uint64_t{1};
+  const auto *start = mapping_->data() +
+                      (read_position_ & (header.capacity - 1));
+  return {reinterpret_cast<const int16_t *>(start),
+          static_cast<size_t>(bytes / sizeof(int16_t))};
+}
+
+auto SharedRingReader::consume(size_t samples) -> bool {
+  const auto &header = mapping_->header();
+  const auto start = read_position_;
+  read_position_ += samples * sizeof(int16_t);
+  // Intact if the writer has not wrapped onto the released range yet
+  const auto write = header.write_position.load(std::memory_order_acquire);
+  return write - start <= header.capacity;
+}
+
+auto SharedRingReader::wait(std::chrono::milliseconds timeout) -> bool {
+  auto &header = mapping_->header();
+  header.waiters.fetch_add(1);
+  const auto sequence = header.wake_sequence.load();
+  bool ready = !peek().empty();
+  if (!ready) {
+    const auto count = timeout.count();
+    const timespec relative{static_cast<time_t>(count / MS_PER_SECOND),
+                            (count % MS_PER_SECOND) * NS_PER_MS};
+    futex(header.wake_sequence, FUTEX_WAIT, sequence, &relative);
+    ready = !peek().empty();
+  }
+  header.waiters.fetch_sub(1);
+  return ready;
+}
+
+auto SharedRingReader::format() const -> AudioFormat {
+  const auto format = shared_ring_format(mapping_->header());
+  return read_position_ < format.position ? format.previous : format.current;
+}
+
+auto SharedRingReader::is_paused() const -> bool {
+  return mapping_->header().paused.load() != 0;
+}
+
+auto SharedRingReader::overruns() const -> uint64_t { return overruns_; }
@@ -0,0 +1,208 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "audio_sink.hpp"
+
+/**
+ * @struct SharedRingHeader
+ * @brief Layout of the first page of a shared PCM ring.
+ *
+ * The data region of `capacity` bytes follows at `header_size`. Positions
+ * are free-running byte counters; data for position p lives at
+ * `p & (capacity - 1)`. Every mapping maps the data region twice, back to
+ * back, so any span of up to `capacity` bytes is contiguous in memory.
+ *
+ * There is one writer and any number of readers. Readers map the data
+ * read-only and only touch `waiters` in the header; the writer never waits
+ * for them. A reader that falls more than `capacity` behind is lapped and
+ * must resynchronize.
+ */
+struct SharedRingHeader {
+  static constexpr uint32_t MAGIC = 0x4A50534D; // "JPSM"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;       ///< MAGIC
+  uint32_t version;     ///< VERSION
+  uint64_t header_size; ///< Offset of the data region, a page multiple
+  uint64_t capacity;    ///< Data bytes, a power of 2 and page multiple
+
+  // Format, published with a seqlock
+  std::atomic<uint32_t> format_sequence; ///< Odd while being updated
+  std::atomic<int32_t> sample_rate;      ///< Current format
+  std::atomic<int32_t> channels;         ///< Current format
+  std::atomic<int32_t> previous_rate;    ///< Format before format_position
+  std::atomic<int32_t> previous_channels; ///< Format before format_position
+  std::atomic<uint64_t> format_position; ///< Where the current format starts
+
+  std::atomic<uint64_t> flush_position; ///< Audio before this was cleared
+  std::atomic<uint32_t> paused;         ///< Nonzero while output is paused
+
+  alignas(64) std::atomic<uint64_t> write_position; ///< Bytes ever written
+  std::atomic<uint32_t> wake_sequence; ///< Futex word bumped per write
+  std::atomic<uint32_t> waiters;       ///< Readers blocked in wait()
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared ring counters must be address-free");
+
+/**
+ * @class SharedRingMapping
+ * @brief Maps a shared ring file with its data region mirrored.
+ */
+class SharedRingMapping {
+public:
+  /**
+   * @brief Maps header and mirrored data.
+   * @param fd Ring file descriptor.
+   * @param header_size Offset of the data region.
+   * @param capacity Size of the data region.
+   * @param writable Map the data region for writing rather than read-only.
+   * @throws std::runtime_error if the mapping fails.
+   */
+  SharedRingMapping(int fd, size_t header_size, size_t capacity,
+                    bool writable);
+
+  /**
+   * @brief Destructor.
+   * Unmaps the ring.
+   */
+  ~SharedRingMapping();
+
+  SharedRingMapping(SharedRingMapping &mapping) = delete;
+  SharedRingMapping(SharedRingMapping &&mapping) = delete;
+
+  auto operator=(SharedRingMapping &mapping) -> SharedRingMapping & = delete;
+  auto operator=(SharedRingMapping &&mapping) -> SharedRingMapping && = delete;
+
+  /**
+   * @brief Accesses the header.
+   * @return The shared header.
+   */
+  [[nodiscard]] auto header() const -> SharedRingHeader &;
+
+  /**
+   * @brief Gets the start of the mirrored data region.
+   * @return Pointer valid for 2 * capacity bytes.
+   */
+  [[nodiscard]] auto data() const -> std::byte *;
+
+private:
+  std::byte *base_{nullptr}; ///< Start of the reservation
+  size_t size_{0};           ///< Header plus twice the capacity
+  size_t header_size_{0};    ///< Offset of the data region
+};
+
+/**
+ * @struct SharedRingFormat
+ * @brief Consistent snapshot of the seqlock-protected format fields.
+ */
+struct SharedRingFormat {
+  AudioFormat current;  ///< Format from position on
+  AudioFormat previous; ///< Format before position
+  uint64_t position;    ///< Where current starts
+};
+
+/**
+ * @brief Reads the format fields of a ring without tearing.
+ * @param header The ring header.
+ * @return The format snapshot.
+ */
+auto shared_ring_format(const SharedRingHeader &header) -> SharedRingFormat;
+
+/**
+ * @brief Wakes readers blocked on a ring.
+ * @param header The ring header.
+ */
+void shared_ring_wake(SharedRingHeader &header);
+
+/**
+ * @class SharedRingReader
+ * @brief Zero-copy reader of a ring published by SharedMemorySink.
+ *
+ * Readers keep their own position, so any number can follow one ring
+ * independently. peek() hands out samples straight from the shared mapping;
+ * since the writer never waits, consume() reports whether they were still
+ * intact when the reader finished with them.
+ */
+class SharedRingReader {
+public:
+  /**
+   * @brief Opens and maps a ring, starting at its current write position.
+   * @param path Ring file, e.g. SharedMemorySink::path().
+   * @throws std::runtime_error if the file is not a valid ring.
+   */
+  explicit SharedRingReader(const std::string &path);
+
+  /**
+   * @brief Destructor.
+   * Unmaps the ring and closes the file.
+   */
+  ~SharedRingReader();
+
+  SharedRingReader(SharedRingReader &reader) = delete;
+  SharedRingReader(SharedRingReader &&reader) = delete;
+
+  auto operator=(SharedRingReader &reader) -> SharedRingReader & = delete;
+  auto operator=(SharedRingReader &&reader) -> SharedRingReader && = delete;
+
+  /**
+   * @brief Gets readable samples without copying.
+   *
+   * Never spans a format change, so all returned samples are in format().
+   * Skips ahead first if the reader was lapped or audio was cleared.
+   *
+   * @return Contiguous interleaved samples, possibly empty.
+   */
+  [[nodiscard]] auto peek() -> std::span<const int16_t>;
+
+  /**
+   * @brief Releases samples obtained from peek().
+   * @param samples Number of samples to release.
+   * @return false if the writer overwrote them before release.
+   */
+  auto consume(size_t samples) -> bool;
+
+  /**
+   * @brief Waits for the writer to publish more audio.
+   * @param timeout Longest wait.
+   * @return true if samples are readable.
+   */
+  auto wait(std::chrono::milliseconds timeout) -> bool;
+
+  /**
+   * @brief Gets the format of the samples at the read position.
+   * @return The audio format.
+   */
+  [[nodiscard]] auto format() const -> AudioFormat;
+
+  /**
+   * @brief Checks whether the writer's output is paused.
+   * @return true if paused.
+   */
+  [[nodiscard]] auto is_paused() const -> bool;
+
+  /**
+   * @brief Gets how often the reader was lapped.
+   * @return Number of resynchronizations.
+   */
+  [[nodiscard]] auto overruns() const -> uint64_t;
+
+private:
+  int fd_{-1};                                 ///< Ring file
+  std::unique_ptr<SharedRingMapping> mapping_; ///< Read-only mapping
+  uint64_t read_position_{0};                  ///< Next byte to read
+  uint64_t overruns_{0};                       ///< Resynchronizations
+};
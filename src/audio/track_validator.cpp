@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "track_validator.hpp"
+
+#include <array>
+#include <stdexcept>
+
+TrackValidator::TrackValidator() {
+  mpg123_init();
+  handle_ = mpg123_new(nullptr, nullptr);
+  if (handle_ == nullptr) {
+    throw std::runtime_error("mpg123_new failed");
+  }
+  mpg123_param(handle_, MPG123_ADD_FLAGS, MPG123_QUIET, 0);
+}
+
+TrackValidator::~TrackValidator() { mpg123_delete(handle_); }
+
+auto TrackValidator::validate(const std::string &path)
+    -> std::optional<std::string> {
+  if (mpg123_open(handle_, path.c_str()) != MPG123_OK) {
+    return "Cannot open " + path + ": " + mpg123_strerror(handle_);
+  }
+  std::optional<std::string> error;
+  long rate = 0;
+  int channels = 0;
+  int encoding = 0;
+  if (mpg123_getformat(handle_, &rate, &channels, &encoding) != MPG123_OK ||
+      rate <= 0) {
+    error = "No MPEG audio in " + path;
+  } else {
+    std::array<unsigned char, 8192> pcm{};
+    size_t done = 0;
+    int result = MPG123_NEW_FORMAT;
+    while (result == MPG123_NEW_FORMAT) {
+      result = mpg123_read(handle_, pcm.data(), pcm.size(), &done);
+    }
+    if (done == 0) {
+      error = "No decodable audio in " + path;
+    }
+  }
+  mpg123_close(handle_);
+  return error;
+}
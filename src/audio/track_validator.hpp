@@ -0,0 +1,52 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <mpg123.h>
+
+#include <optional>
+#include <string>
+
+/**
+ * @class TrackValidator
+ * @brief Checks ahead of time that a local file will play.
+ *
+ * Opens the file with a private mpg123 handle and decodes its first block,
+ * which is what fails for missing, truncated or non-MPEG files. Cheap enough
+ * to run on upcoming playlist entries while the current one plays.
+ */
+class TrackValidator {
+public:
+  /**
+   * @brief Creates the private decoder handle.
+   * @throws std::runtime_error if mpg123 cannot create it.
+   */
+  TrackValidator();
+
+  /**
+   * @brief Destructor.
+   * Deletes the decoder handle.
+   */
+  ~TrackValidator();
+
+  TrackValidator(TrackValidator &validator) = delete;
+  TrackValidator(TrackValidator &&validator) = delete;
+
+  auto operator=(TrackValidator &validator) -> TrackValidator & = delete;
+  auto operator=(TrackValidator &&validator) -> TrackValidator && = delete;
+
+  /**
+   * @brief Validates one file.
+   * @param path Local file path.
+   * @return Why the file cannot be played, or std::nullopt if it can.
+   */
+  [[nodiscard]] auto validate(const std::string &path)
+      -> std::optional<std::string>;
+
+private:
+  mpg123_handle *handle_{nullptr}; ///< Used for one file at a time
+};
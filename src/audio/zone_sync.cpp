@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "zone_sync.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double NS_PER_SECOND = 1e9;
+
+} // namespace
+
+auto ZoneSync::update(int64_t now_ns, int64_t expected_frame,
+                      int64_t audible_frame, int32_t sample_rate)
+    -> SyncCorrection {
+  if (sample_rate <= 0) {
+    return {};
+  }
+  const double error = static_cast<double>(audible_frame - expected_frame) /
+                       sample_rate;
+
+  if (!primed_) {
+    error_ = error;
+    last_ns_ = now_ns;
+    primed_ = true;
+  } else {
+    error_ += SMOOTHING * (error - error_);
+  }
+
+  if (std::abs(error_) > SEEK_THRESHOLD) {
+    reset();
+    return {1.0, expected_frame};
+  }
+
+  const double elapsed =
+      static_cast<double>(now_ns - last_ns_) / NS_PER_SECOND;
+  last_ns_ = now_ns;
+  // Clamp the integral so it alone can never exceed the slew limit
+  integral_ = std::clamp(integral_ + (error_ * elapsed),
+                         -MAX_ADJUST / GAIN_I, MAX_ADJUST / GAIN_I);
+
+  // Ahead of the leader: stretch (ratio above 1) to fall back
+  const double adjust = (GAIN_P * error_) + (GAIN_I * integral_);
+  return {1.0 + std::clamp(adjust, -MAX_ADJUST, MAX_ADJUST), std::nullopt};
+}
+
+void ZoneSync::reset() {
+  primed_ = false;
+  error_ = 0.0;
+  integral_ = 0.0;
+}
+
+auto ZoneSync::error() const -> double { return error_; }
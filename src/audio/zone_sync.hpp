@@ -0,0 +1,64 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstdint>
+#include <optional>
+
+/**
+ * @struct SyncCorrection
+ * @brief What a follower zone should do to stay aligned with the leader.
+ */
+struct SyncCorrection {
+  double ratio{1.0};                 ///< Resampler ratio to apply
+  std::optional<int64_t> seek_frame; ///< Jump here and drop queued audio
+};
+
+/**
+ * @class ZoneSync
+ * @brief PI controller keeping a follower zone on the leader's timeline.
+ *
+ * Each update compares the media frame the follower predicts to be audible
+ * now with the frame the leader's clock says should be audible. Small
+ * errors are corrected smoothly through the resampler ratio, with the
+ * integral term absorbing the steady drift between the two sound cards;
+ * errors too large to slew away are corrected with a seek.
+ */
+class ZoneSync {
+public:
+  static constexpr double SEEK_THRESHOLD = 0.08; ///< Seconds before seeking
+  static constexpr double MAX_ADJUST = 0.005;    ///< Largest ratio change
+  static constexpr double GAIN_P = 0.5;          ///< Ratio per second of error
+  static constexpr double GAIN_I = 0.06;         ///< Ratio per second² of error
+  static constexpr double SMOOTHING = 0.25;      ///< Error filter weight
+
+  /**
+   * @brief Computes the correction for the current position.
+   * @param now_ns Local time of the measurement.
+   * @param expected_frame Frame the leader says is audible now.
+   * @param audible_frame Frame predicted audible now on this zone.
+   * @param sample_rate Frames per second.
+   * @return Ratio to apply and an optional seek target.
+   */
+  auto update(int64_t now_ns, int64_t expected_frame, int64_t audible_frame,
+              int32_t sample_rate) -> SyncCorrection;
+
+  /// Forgets controller state, e.g. after a track change.
+  void reset();
+
+  /**
+   * @brief Gets the filtered alignment error.
+   * @return Seconds this zone is ahead of the leader (negative: behind).
+   */
+  [[nodiscard]] auto error() const -> double;
+
+private:
+  bool primed_{false};   ///< Whether error_ holds a measurement
+  double error_{0.0};    ///< Filtered error in seconds
+  double integral_{0.0}; ///< Integrated error in second²
+  int64_t last_ns_{0};   ///< Time of the previous update
+};
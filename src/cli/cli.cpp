@@ -7,14 +7,20 @@
 
 #include "cli.hpp"
 
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
 #include <termios.h>
 #include <unistd.h>
 
+#include <array>
 #include <chrono>
 #include <csignal>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <thread>
+#include <unordered_map>
 
 class TerminalRawMode {
 public:
@@ -31,7 +37,7 @@ private:
   termios orig_;
 };
 
-CLI::CLI(Player &player) : player_(player) {}
+CLI::CLI(Player &player, Clock &clock) : player_(player), clock_(clock) {}
 
 CLI::~CLI() { shutdown(); }
 
@@ -51,7 +57,7 @@ void CLI::start() {
 
   while (running_ && !sigint_received_) {
     static constexpr auto SLEEP = 200U;
-    std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP));
+    clock_.sleep_for(std::chrono::milliseconds(SLEEP));
   }
 
   shutdown();
@@ -69,7 +75,9 @@ void CLI::input_loop(const std::stop_token &token) {
   TerminalRawMode raw;
   std::cout
       << "Controls: SPACE = Play/Pause | a = -5s | d = +5s | ← → = Seek | "
-         "+ = Vol+ | - = Vol- | s = Shuffle | n/p = Next/Prev | q = Quit\n";
+         "+ = Vol+ | - = Vol- | s = Shuffle | n/p = Next/Prev | "
+         "r = Radio | h = History | m = Memory | l = Locks | b = Browse | "
+         "q = Quit\n";
 
   while (!token.stop_requested() && running_ && !sigint_received_) {
     int chr = getchar();
@@ -83,28 +91,113 @@ void CLI::input_loop(const std::stop_token &token) {
 
 void CLI::display_loop(const std::stop_token &token) {
   while (!token.stop_requested() && running_ && !sigint_received_) {
-    if (player_.get_progress().second > 0) {
-      static constexpr auto TIME_CONVERSIONS = 60;
-      auto [elapsed, total] = player_.get_progress(); // You’ll implement this
-      int elapsed_min = elapsed / TIME_CONVERSIONS;
-      int elapsed_sec = elapsed % TIME_CONVERSIONS;
-      int total_min = total / TIME_CONVERSIONS;
-      int total_sec = total % TIME_CONVERSIONS;
-
-      static constexpr auto WIDTH = 30;
-      int filled = (elapsed * WIDTH) / std::max(1, total);
-      std::string bar(filled, '#');
-      bar.resize(WIDTH, '-');
-      std::cout << "\r[" << bar << "] " << std::setw(2) << std::setfill('0')
-                << elapsed_min << ":" << std::setw(2) << std::setfill('0')
-                << elapsed_sec << " / " << std::setw(2) << std::setfill('0')
-                << total_min << ":" << std::setw(2) << std::setfill('0')
-                << total_sec << " | " << player_.get_title() << " - "
-                << player_.get_artist() << std::flush;
-    }
+    render_status();
 
     static constexpr auto SLEEP_MS = 100U;
-    std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_MS));
+    clock_.sleep_for(std::chrono::milliseconds(SLEEP_MS));
+  }
+}
+
+void CLI::render_status() {
+  if (refresh_browser()) {
+    return;
+  }
+  // Live streams have no duration but still show elapsed time and title
+  if (player_.get_progress().second == 0 && player_.get_title().empty()) {
+    return;
+  }
+  static constexpr auto TIME_CONVERSIONS = 60;
+  auto [elapsed, total] = player_.get_progress();
+  int elapsed_min = elapsed / TIME_CONVERSIONS;
+  int elapsed_sec = elapsed % TIME_CONVERSIONS;
+  int total_min = total / TIME_CONVERSIONS;
+  int total_sec = total % TIME_CONVERSIONS;
+
+  static constexpr auto WIDTH = 30;
+  int filled = (elapsed * WIDTH) / std::max(1, total);
+  std::string bar(filled, '#');
+  bar.resize(WIDTH, '-');
+  std::cout << "\r[" << bar << "] " << std::setw(2) << std::setfill('0')
+            << elapsed_min << ":" << std::setw(2) << std::setfill('0')
+            << elapsed_sec << " / " << std::setw(2) << std::setfill('0')
+            << total_min << ":" << std::setw(2) << std::setfill('0')
+            << total_sec << " | " << player_.get_title() << " - "
+            << player_.get_artist();
+  const auto stats = player_.stats();
+  if (stats.deep_buffer) {
+    std::cout << " | " << std::fixed << std::setprecision(1)
+              << stats.wakeups_per_second << " wakeups/s";
+  }
+  if (stats.quality.level != QualityController::Level::FULL) {
+    std::cout << " | " << QualityController::name(stats.quality.level);
+  }
+  if (stats.skipped_tracks > 0) {
+    std::cout << " | " << stats.skipped_tracks << " skipped";
+  }
+  std::cout << std::flush;
+}
+
+void CLI::run(Reactor &reactor) {
+  TerminalRawMode raw;
+  std::cout
+      << "Controls: SPACE = Play/Pause | a = -5s | d = +5s | ← → = Seek | "
+         "+ = Vol+ | - = Vol- | s = Shuffle | n/p = Next/Prev | "
+         "r = Radio | h = History | m = Memory | l = Locks | b = Browse | "
+         "q = Quit\n";
+
+  // SIGINT arrives as a readable fd instead of interrupting the loop
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigset_t previous;
+  pthread_sigmask(SIG_BLOCK, &mask, &previous);
+  const int signal_fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+
+  if (signal_fd >= 0) {
+    reactor.watch(signal_fd, [&reactor, signal_fd] {
+      signalfd_siginfo info{};
+      (void)!read(signal_fd, &info, sizeof(info));
+      sigint_received_ = true;
+      reactor.stop();
+    });
+  }
+  reactor.watch(STDIN_FILENO, [this, &reactor] {
+    static constexpr auto INPUT_SIZE = 32U;
+    std::array<char, INPUT_SIZE> input{};
+    const auto size = read(STDIN_FILENO, input.data(), input.size());
+    if (size <= 0) {
+      sigint_received_ = true; // End of input
+    } else {
+      handle_input(std::span{input.data(), static_cast<size_t>(size)});
+    }
+    if (!running_ || sigint_received_) {
+      reactor.stop();
+    }
+  });
+  static constexpr auto DISPLAY_INTERVAL = std::chrono::milliseconds(100);
+  const auto display_timer =
+      reactor.add_timer(DISPLAY_INTERVAL, [this] { render_status(); });
+
+  reactor.run();
+
+  reactor.cancel_timer(display_timer);
+  reactor.unwatch(STDIN_FILENO);
+  if (signal_fd >= 0) {
+    reactor.unwatch(signal_fd);
+    close(signal_fd);
+  }
+  pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+  shutdown();
+}
+
+void CLI::handle_input(std::span<const char> input) {
+  for (size_t i = 0; i < input.size(); ++i) {
+    if (input[i] == '\x1b' && i + 2 < input.size() && input[i + 1] == '[') {
+      handle_arrow(input[i + 2]);
+      i += 2;
+    } else if (input[i] != '\x1b') {
+      handle_key(static_cast<unsigned char>(input[i]));
+    }
   }
 }
 
@@ -112,6 +205,9 @@ void CLI::handle_key(int chr) {
   static constexpr int SEEK_RELATIVE = 5;
   static constexpr float VOLUME_DELTA = 0.1F;
 
+  if (handle_browser_key(chr)) {
+    return;
+  }
   switch (chr) {
   case ' ':
     player_.is_playing() ? player_.pause() : player_.resume();
@@ -145,21 +241,231 @@ void CLI::handle_key(int chr) {
   case 's':
   case 'S':
     if (auto &playlist = player_.get_playlist()) {
-      playlist->reshuffle();
+      playlist->reshuffle_async();
+    }
+    break;
+  case 'r':
+  case 'R':
+    if (auto &playlist = player_.get_playlist()) {
+      player_.set_radio(!playlist->is_radio());
+      std::cout << (playlist->is_radio() ? "\nRadio on\n" : "\nRadio off\n");
     }
     break;
+  case 'h':
+  case 'H':
+    show_history();
+    break;
+  case 'm':
+  case 'M':
+    show_memory();
+    break;
+  case 'l':
+  case 'L':
+    show_locks();
+    break;
+  case 'b':
+  case 'B':
+    open_browser();
+    break;
   default:
     break;
   }
 }
 
+void CLI::show_history() {
+  static constexpr size_t TOP_TRACKS = 5;
+  static constexpr double PERCENT = 100.0;
+
+  const auto *history = player_.get_history();
+  const auto &playlist = player_.get_playlist();
+  if (history == nullptr || !playlist) {
+    return;
+  }
+  // The log only knows IDs; the playlist gives them names
+  std::unordered_map<uint64_t, std::string> names;
+  for (const auto &song : playlist->songs()) {
+    names.emplace(HistoryLog::track_id(song),
+                  std::filesystem::path(song).filename().string());
+  }
+  std::cout << "\nMost played (" << history->total_plays() << " plays):\n";
+  for (const auto &track : history->top_tracks(TOP_TRACKS)) {
+    const auto name = names.find(track.track);
+    std::cout << "  " << std::setw(4) << std::setfill(' ') << track.plays
+              << "x  "
+              << (name != names.end() ? name->second : "(not in playlist)")
+              << "  " << std::fixed << std::setprecision(0)
+              << track.skip_rate() * PERCENT << "% skipped\n";
+  }
+}
+
+void CLI::show_memory() {
+  static constexpr size_t KIB = 1024;
+
+  const auto stats = player_.stats();
+  std::cout << "\nMemory [KiB]      in use       peak     budget\n";
+  for (size_t tag = 0; tag < MemoryAccounting::TAGS; ++tag) {
+    const auto &usage = stats.memory.at(tag);
+    std::cout << "  " << std::left << std::setw(10) << std::setfill(' ')
+              << MemoryAccounting::name(static_cast<MemoryTag>(tag))
+              << std::right << std::setw(12) << usage.bytes / KIB
+              << std::setw(11) << usage.peak / KIB << std::setw(11)
+              << (usage.budget == MemoryAccounting::UNLIMITED
+                      ? std::string("-")
+                      : std::to_string(usage.budget / KIB));
+    if (usage.refused > 0) {
+      std::cout << "  " << usage.refused << " refused";
+    }
+    std::cout << '\n';
+  }
+}
+
+void CLI::show_locks() {
+  static constexpr double P99 = 99.0;
+  static constexpr size_t SITE_WIDTH = 28;
+
+  const auto sites = player_.lock_report();
+  if (sites.empty()) {
+    std::cout << "\nNo lock times recorded; start with --trace-locks\n";
+    return;
+  }
+  const auto milliseconds = [](std::chrono::nanoseconds value) {
+    return std::chrono::duration<double, std::milli>(value).count();
+  };
+  std::cout << "\nAudio lock [ms]                 count  wait p99  wait max"
+               "  hold p99  hold max\n";
+  for (const auto &site : sites) {
+    // "void Player::seek_relative(int)" -> "seek_relative:123"
+    auto name = site.function.substr(0, site.function.find('('));
+    name = name.substr(name.find_last_of(" :") + 1) + ':' +
+           std::to_string(site.line);
+    std::cout << "  " << std::left << std::setw(SITE_WIDTH)
+              << std::setfill(' ') << name.substr(0, SITE_WIDTH) << std::right
+              << std::setw(7) << site.wait.count() << std::fixed
+              << std::setprecision(2) << std::setw(10)
+              << milliseconds(site.wait.percentile(P99)) << std::setw(10)
+              << milliseconds(site.wait.max()) << std::setw(10)
+              << milliseconds(site.hold.percentile(P99)) << std::setw(10)
+              << milliseconds(site.hold.max()) << '\n';
+  }
+}
+
+void CLI::open_browser() {
+  const auto &playlist = player_.get_playlist();
+  if (!playlist) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(browser_mutex_);
+  browser_ = std::make_unique<LibraryBrowser>(playlist->songs());
+  draw_browser();
+}
+
+auto CLI::handle_browser_key(int chr) -> bool {
+  static constexpr int BACKSPACE = 0x7f;
+  static constexpr int FIRST_PRINTABLE = 0x20;
+
+  std::optional<size_t> chosen;
+  {
+    std::lock_guard<std::mutex> lock(browser_mutex_);
+    if (!browser_) {
+      return false;
+    }
+    if (chr == '\n' || chr == '\r' || chr == '\t') {
+      chosen = chr == '\t' ? std::nullopt : browser_->selected();
+      browser_.reset();
+      std::cout << "\x1b[H\x1b[J" << std::flush;
+    } else if (chr == BACKSPACE || chr == '\b') {
+      browser_->erase();
+      draw_browser();
+    } else if (chr >= FIRST_PRINTABLE && chr < BACKSPACE) {
+      browser_->type(static_cast<char>(chr));
+      draw_browser();
+    }
+  }
+  // Switching songs fades out; the view must not wait for it
+  if (chosen) {
+    player_.play_song(*chosen);
+  }
+  return true;
+}
+
+auto CLI::handle_browser_arrow(int chr) -> bool {
+  std::lock_guard<std::mutex> lock(browser_mutex_);
+  if (!browser_) {
+    return false;
+  }
+  switch (chr) {
+  case 'A': // ↑
+    browser_->move(-1);
+    break;
+  case 'B': // ↓
+    browser_->move(1);
+    break;
+  case 'C': // →
+    browser_->page(1);
+    break;
+  case 'D': // ←
+    browser_->page(-1);
+    break;
+  default:
+    return true;
+  }
+  draw_browser();
+  return true;
+}
+
+auto CLI::refresh_browser() -> bool {
+  // Bounded so a long search still leaves a responsive frame rate
+  static constexpr auto FRAME_BUDGET = std::chrono::milliseconds(8);
+
+  std::lock_guard<std::mutex> lock(browser_mutex_);
+  if (!browser_) {
+    return false;
+  }
+  const auto deadline = clock_.now() + FRAME_BUDGET;
+  bool changed = false;
+  while (browser_->step()) {
+    changed = true;
+    if (clock_.now() >= deadline) {
+      break;
+    }
+  }
+  if (changed) {
+    draw_browser();
+  }
+  return true;
+}
+
+void CLI::draw_browser() {
+  const auto [rows, columns] = terminal_size();
+  // One row for the header and one to spare, so output never scrolls
+  browser_->resize(rows > 2 ? rows - 2 : 1);
+  std::cout << browser_->render(columns) << std::flush;
+}
+
+auto CLI::terminal_size() -> std::pair<size_t, size_t> {
+  static constexpr size_t DEFAULT_ROWS = 24;
+  static constexpr size_t DEFAULT_COLUMNS = 80;
+  winsize size{};
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0 ||
+      size.ws_col == 0) {
+    return {DEFAULT_ROWS, DEFAULT_COLUMNS};
+  }
+  return {size.ws_row, size.ws_col};
+}
+
 void CLI::handle_escape_sequence() {
   if (getchar() != '[') {
     return;
   }
+  handle_arrow(getchar());
+}
 
+void CLI::handle_arrow(int chr) {
   static constexpr int SEEK_RELATIVE = 5;
-  switch (getchar()) {
+  if (handle_browser_arrow(chr)) {
+    return;
+  }
+  switch (chr) {
   case 'C': // →
     player_.seek_relative(SEEK_RELATIVE);
     break;
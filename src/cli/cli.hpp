@@ -7,10 +7,16 @@
 // information.
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <thread>
+#include <utility>
 
 #include "../audio/player.hpp"
+#include "../util/reactor.hpp"
+#include "library_browser.hpp"
 
 /**
  * @class CLI
@@ -21,6 +27,9 @@
  * keypresses and dispatching commands to control playback through the Player
  * instance. It supports play/pause, volume, seeking, and song navigation, as
  * well as displaying song progress and metadata.
+ *
+ * The browse view ('b') takes over the screen with a LibraryBrowser of the
+ * playlist: typing filters, arrows scroll, Enter plays and Tab goes back.
  */
 class CLI {
   friend class CLITest; ///< Allows test fixture to access private members.
@@ -29,8 +38,9 @@ public:
   /**
    * @brief Constructs the CLI with a reference to an existing Player.
    * @param player The Player instance to control.
+   * @param clock Time base of the refresh loops; must outlive the CLI.
    */
-  explicit CLI(Player &player);
+  explicit CLI(Player &player, Clock &clock = Clock::steady());
 
   /**
    * @brief Destructor ensures proper shutdown and cleanup.
@@ -42,6 +52,17 @@ public:
    */
   void start();
 
+  /**
+   * @brief Runs the CLI on an event loop instead of its own threads.
+   *
+   * Keyboard input, SIGINT (via signalfd) and the display refresh become
+   * reactor handlers; together with Player::attach() everything but the
+   * audio device runs on the calling thread. Returns when the user quits.
+   *
+   * @param reactor Loop to run on the calling thread.
+   */
+  void run(Reactor &reactor);
+
 private:
   /**
    * @brief Signal handler for SIGINT (Ctrl+C).
@@ -55,11 +76,75 @@ private:
    */
   void handle_key(int chr);
 
+  /**
+   * @brief Prints the most played songs of the playlist.
+   */
+  void show_history();
+
+  /**
+   * @brief Prints heap use and budget of each subsystem.
+   */
+  void show_memory();
+
+  /**
+   * @brief Prints wait and hold times of the audio lock per call site.
+   */
+  void show_locks();
+
+  /**
+   * @brief Opens the browse view over the playlist.
+   */
+  void open_browser();
+
+  /**
+   * @brief Handles a key while the browse view is open.
+   * @param chr The character code pressed.
+   * @return false if the view is closed and the key is not for it.
+   */
+  auto handle_browser_key(int chr) -> bool;
+
+  /**
+   * @brief Scrolls the browse view for an arrow key, if it is open.
+   * @param chr The byte after "ESC [".
+   * @return false if the view is closed.
+   */
+  auto handle_browser_arrow(int chr) -> bool;
+
+  /**
+   * @brief Filters and redraws the browse view, if it is open.
+   * @return false if the view is closed.
+   */
+  auto refresh_browser() -> bool;
+
+  /// Draws the browse view to fit the terminal. Requires browser_mutex_.
+  void draw_browser();
+
+  /**
+   * @brief Gets the terminal size.
+   * @return Rows and columns; 24x80 if stdout is not a terminal.
+   */
+  [[nodiscard]] static auto terminal_size() -> std::pair<size_t, size_t>;
+
   /**
    * @brief Handles multi-character escape sequences (e.g., arrow keys).
    */
   void handle_escape_sequence();
 
+  /**
+   * @brief Handles a chunk of raw terminal input, escape sequences included.
+   * @param input Bytes read from the terminal.
+   */
+  void handle_input(std::span<const char> input);
+
+  /**
+   * @brief Handles the final byte of an arrow key sequence.
+   * @param chr The byte after "ESC [".
+   */
+  void handle_arrow(int chr);
+
+  /// Prints the progress bar and song info once.
+  void render_status();
+
   /**
    * @brief Runs the input loop for processing user commands.
    * @param token Stop token to cancel the loop.
@@ -78,10 +163,14 @@ private:
   void shutdown();
 
   Player &player_;                  ///< Reference to the Player instance.
+  Clock &clock_;                    ///< Time base of the refresh loops.
   std::atomic<bool> running_{true}; ///< Indicates whether the CLI is active.
   static inline std::atomic<bool> sigint_received_{
       false}; ///< Tracks SIGINT receipt.
 
+  std::mutex browser_mutex_;                 ///< Guards browser_.
+  std::unique_ptr<LibraryBrowser> browser_; ///< Browse view, if open.
+
   std::jthread input_thread_;   ///< Thread for handling user input.
   std::jthread display_thread_; ///< Thread for displaying playback info.
 };
\ No newline at end of file
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "library_browser.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+namespace {
+
+constexpr std::string_view CLEAR_LINE = "\x1b[K\r\n";
+
+/// Appends at most width bytes of text, never splitting a UTF-8 sequence
+void append_clipped(std::string &out, std::string_view text, size_t width) {
+  if (text.size() > width) {
+    while (width > 0 &&
+           (static_cast<unsigned char>(text[width]) & 0xC0U) == 0x80U) {
+      --width;
+    }
+    text = text.substr(0, width);
+  }
+  out += text;
+}
+
+auto lower(char chr) -> char {
+  return static_cast<char>(std::tolower(static_cast<unsigned char>(chr)));
+}
+
+} // namespace
+
+LibraryBrowser::LibraryBrowser(const std::vector<std::string> &songs) {
+  names_.reserve(songs.size());
+  for (const auto &song : songs) {
+    names_.push_back(std::filesystem::path(song).filename().string());
+  }
+}
+
+void LibraryBrowser::type(char chr) {
+  if (!query_.empty() && !filtering()) {
+    kept_.push_back(std::move(current_));
+  }
+  query_ += lower(chr);
+  refilter();
+  step();
+}
+
+void LibraryBrowser::erase() {
+  if (query_.empty()) {
+    return;
+  }
+  query_.pop_back();
+  if (!kept_.empty() && kept_.back().query == query_) {
+    current_ = std::move(kept_.back());
+    kept_.pop_back();
+    top_ = cursor_ = 0;
+    return;
+  }
+  refilter();
+  step();
+}
+
+auto LibraryBrowser::step() -> bool {
+  if (!filtering()) {
+    return false;
+  }
+  const auto end = std::min(candidates(), current_.scanned + FILTER_BATCH);
+  for (; current_.scanned < end; ++current_.scanned) {
+    const auto song = candidate(current_.scanned);
+    if (contains(names_[song], query_)) {
+      current_.matches.push_back(song);
+    }
+  }
+  return true;
+}
+
+auto LibraryBrowser::filtering() const -> bool {
+  return !query_.empty() && current_.scanned < candidates();
+}
+
+auto LibraryBrowser::query() const -> const std::string & { return query_; }
+
+auto LibraryBrowser::rows() const -> size_t {
+  return query_.empty() ? names_.size() : current_.matches.size();
+}
+
+void LibraryBrowser::resize(size_t height) {
+  height_ = std::max<size_t>(1, height);
+  move(0);
+}
+
+void LibraryBrowser::move(std::ptrdiff_t rows) {
+  const auto count = this->rows();
+  if (count == 0) {
+    top_ = cursor_ = 0;
+    return;
+  }
+  const auto target = static_cast<std::ptrdiff_t>(cursor_) + rows;
+  cursor_ = static_cast<size_t>(
+      std::clamp<std::ptrdiff_t>(target, 0,
+                                 static_cast<std::ptrdiff_t>(count) - 1));
+  if (cursor_ < top_) {
+    top_ = cursor_;
+  } else if (cursor_ >= top_ + height_) {
+    top_ = cursor_ - height_ + 1;
+  }
+}
+
+void LibraryBrowser::page(int pages) {
+  move(static_cast<std::ptrdiff_t>(pages) *
+       static_cast<std::ptrdiff_t>(height_));
+}
+
+auto LibraryBrowser::selected() const -> std::optional<size_t> {
+  if (cursor_ >= rows()) {
+    return std::nullopt;
+  }
+  return song_at(cursor_);
+}
+
+auto LibraryBrowser::render(size_t width) const -> std::string {
+  std::string out = "\x1b[H";
+  append_clipped(out,
+                 "Find: " + query_ + "  (" + std::to_string(rows()) + " of " +
+                     std::to_string(names_.size()) +
+                     (filtering() ? ", searching...)" : ")"),
+                 width);
+  out += CLEAR_LINE;
+  const auto end = std::min(rows(), top_ + height_);
+  for (auto row = top_; row < end; ++row) {
+    out += row == cursor_ ? "> " : "  ";
+    append_clipped(out, names_[song_at(row)], width > 2 ? width - 2 : 0);
+    out += CLEAR_LINE;
+  }
+  out += "\x1b[J"; // Rows left over from a longer list
+  return out;
+}
+
+void LibraryBrowser::refilter() {
+  current_ = Filter{query_, {}, 0};
+  top_ = cursor_ = 0;
+}
+
+auto LibraryBrowser::candidates() const -> size_t {
+  return kept_.empty() ? names_.size() : kept_.back().matches.size();
+}
+
+auto LibraryBrowser::candidate(size_t index) const -> uint32_t {
+  return kept_.empty() ? static_cast<uint32_t>(index)
+                       : kept_.back().matches[index];
+}
+
+auto LibraryBrowser::song_at(size_t row) const -> uint32_t {
+  return query_.empty() ? static_cast<uint32_t>(row) : current_.matches[row];
+}
+
+auto LibraryBrowser::contains(std::string_view name, std::string_view query)
+    -> bool {
+  return !std::ranges::search(name, query, [](char chr, char wanted) {
+            return lower(chr) == wanted;
+          }).empty();
+}
@@ -0,0 +1,138 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class LibraryBrowser
+ * @brief Filterable, scrollable list of songs for the terminal.
+ *
+ * Only the rows in the viewport are ever formatted, and scrolling just moves
+ * the cursor and the first visible row, so both cost the same for ten songs
+ * or a million. Filtering is case-insensitive substring matching on file
+ * names, done FILTER_BATCH names per step() so typing never stalls a frame.
+ * A longer query only searches the matches of the shorter one, and erasing
+ * goes back to the matches kept for each shorter query.
+ */
+class LibraryBrowser {
+public:
+  static constexpr size_t FILTER_BATCH = 65536; ///< Names matched per step()
+
+  /**
+   * @brief Lists the songs of a playlist.
+   * @param songs Full paths and URLs, in the order to list them.
+   */
+  explicit LibraryBrowser(const std::vector<std::string> &songs);
+
+  /**
+   * @brief Appends a character to the query and starts filtering.
+   * @param chr Printable character.
+   */
+  void type(char chr);
+
+  /**
+   * @brief Removes the last character of the query.
+   */
+  void erase();
+
+  /**
+   * @brief Filters up to FILTER_BATCH more names.
+   * @return true if the rows changed.
+   */
+  auto step() -> bool;
+
+  /**
+   * @brief Checks whether the rows are still being filtered.
+   * @return true until step() has checked every candidate.
+   */
+  [[nodiscard]] auto filtering() const -> bool;
+
+  /**
+   * @brief Gets the query typed so far.
+   * @return The query, lowercased.
+   */
+  [[nodiscard]] auto query() const -> const std::string &;
+
+  /**
+   * @brief Gets the number of rows matching the query so far.
+   * @return Row count.
+   */
+  [[nodiscard]] auto rows() const -> size_t;
+
+  /**
+   * @brief Sets how many rows fit on screen.
+   * @param height Visible rows, at least 1.
+   */
+  void resize(size_t height);
+
+  /**
+   * @brief Moves the cursor, scrolling to keep it visible.
+   * @param rows Rows down, or up if negative; clamped to the list.
+   */
+  void move(std::ptrdiff_t rows);
+
+  /**
+   * @brief Moves the cursor by whole screens.
+   * @param pages Screens down, or up if negative.
+   */
+  void page(int pages);
+
+  /**
+   * @brief Gets the song under the cursor.
+   * @return Its index in the songs, or std::nullopt if no row matches.
+   */
+  [[nodiscard]] auto selected() const -> std::optional<size_t>;
+
+  /**
+   * @brief Formats the viewport as terminal output.
+   *
+   * Starts at the top left and clears each line, so successive frames
+   * overwrite each other without flicker.
+   *
+   * @param width Columns per line.
+   * @return A header line and the visible rows.
+   */
+  [[nodiscard]] auto render(size_t width) const -> std::string;
+
+private:
+  /// The rows of one query; complete once scanned covers the candidates
+  struct Filter {
+    std::string query;             ///< Lowercased query
+    std::vector<uint32_t> matches; ///< Matching songs, in list order
+    size_t scanned = 0;            ///< Candidates checked
+  };
+
+  /// Restarts current_ for query_ from the newest kept filter
+  void refilter();
+
+  /// Gets the candidates current_ filters: all songs or a shorter query's
+  [[nodiscard]] auto candidates() const -> size_t;
+
+  /// Gets the song of a candidate of current_
+  [[nodiscard]] auto candidate(size_t index) const -> uint32_t;
+
+  /// Gets the song of a row
+  [[nodiscard]] auto song_at(size_t row) const -> uint32_t;
+
+  /// Checks a name for a lowercased query, ignoring case
+  [[nodiscard]] static auto contains(std::string_view name,
+                                     std::string_view query) -> bool;
+
+  std::vector<std::string> names_; ///< File name of each song
+  std::string query_;              ///< Lowercased query
+  std::vector<Filter> kept_;       ///< Complete filters of shorter queries
+  Filter current_;                 ///< Filter of query_, unless it is empty
+  size_t height_ = 1;              ///< Visible rows
+  size_t top_ = 0;                 ///< First visible row
+  size_t cursor_ = 0;              ///< Selected row
+};
@@ -8,31 +8,233 @@
 #include <mpg123.h>
 
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <optional>
+#include <string>
 #include <thread>
+#include "audio/decoder_calibration.hpp"
+#include "audio/history_log.hpp"
 #include "audio/player.hpp"
 #include "audio/playlist.hpp"
+#include "audio/recording_sink.hpp"
+#include "audio/resume_state.hpp"
+#include "audio/shared_memory_sink.hpp"
 #include "cli/cli.hpp"
+#include "net/http_client.hpp"
+#include "util/memory_accounting.hpp"
+#include "util/reactor.hpp"
 
 
 static constexpr auto SDL_AUDIO_BUFFER_SIZE = 4096U;
+static constexpr auto RECORDING_ROTATION = std::chrono::hours(1);
+static constexpr size_t MIB = size_t{1} << 20;
+static constexpr auto MAX_DEEP_BUFFER = std::chrono::minutes(10);
+
+// Parses a budget in MiB, rejecting anything whose byte count overflows
+static auto parse_mib(const std::string& text) -> std::optional<size_t> {
+    static constexpr size_t MAX_DIGITS = 19;  // Fits an unsigned long long
+    if (text.empty() || text.size() > MAX_DIGITS ||
+        text.find_first_not_of("0123456789") != std::string::npos) {
+        return std::nullopt;
+    }
+    const auto mib = std::stoull(text);
+    if (mib > MemoryAccounting::UNLIMITED / MIB) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(mib) * MIB;
+}
+
+// Parses a deep-buffer depth, rejecting signs, junk and absurd lengths
+static auto parse_depth(const std::string& text)
+    -> std::optional<std::chrono::seconds> {
+    static constexpr size_t MAX_DIGITS = 4;
+    if (text.empty() || text.size() > MAX_DIGITS ||
+        text.find_first_not_of("0123456789") != std::string::npos) {
+        return std::nullopt;
+    }
+    const auto depth = std::chrono::seconds(std::stoi(text));
+    if (depth > MAX_DEEP_BUFFER) {
+        return std::nullopt;
+    }
+    return depth;
+}
 
 auto main(int argc, char* argv[]) -> int {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <song.mp3>\n";
+        std::cerr << "Usage: " << argv[0]
+                  << " <folder|list.m3u|http://radio> [--stream <port>]"
+                     " [--record <dir>] [--record-raw] [--shm]"
+                     " [--leader <port> | --follow <host:port>]"
+                     " [--reactor] [--deep-buffer <seconds>]"
+                     " [--decoder <name> | --recalibrate]"
+                     " [--fixed-quality] [--no-resume] [--no-history] [--radio]"
+                     " [--memory-budget <subsystem>=<MiB>]... [--trace-locks]\n";
         return 1;
     }
 
     const char* filename = argv[1];
+    std::optional<uint16_t> stream_port;
+    std::optional<RecordingSink::Options> recording;
+    bool record_raw = false;
+    bool shared_memory = false;
+    bool single_thread = false;
+    std::chrono::seconds deep_buffer{0};
+    std::string decoder;
+    bool recalibrate = false;
+    bool fixed_quality = false;
+    bool resume = true;
+    bool history = true;
+    bool radio = false;
+    bool trace_locks = false;
+    std::optional<uint16_t> leader_port;
+    std::string follow;
+    for (int i = 2; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--stream" && i + 1 < argc) {
+            stream_port = HttpUrl::parse_port(argv[++i]);
+            if (!stream_port) {
+                std::cerr << "Invalid port: " << argv[i] << '\n';
+                return 1;
+            }
+        } else if (option == "--record" && i + 1 < argc) {
+            recording.emplace();
+            recording->directory = argv[++i];
+            recording->rotate_after = RECORDING_ROTATION;
+        } else if (option == "--record-raw") {
+            record_raw = true;
+        } else if (option == "--shm") {
+            shared_memory = true;
+        } else if (option == "--reactor") {
+            single_thread = true;
+        } else if (option == "--deep-buffer" && i + 1 < argc) {
+            const auto depth = parse_depth(argv[++i]);
+            if (!depth) {
+                std::cerr << "Invalid deep buffer: " << argv[i]
+                          << " (seconds, at most "
+                          << std::chrono::seconds(MAX_DEEP_BUFFER).count()
+                          << ")\n";
+                return 1;
+            }
+            deep_buffer = *depth;
+        } else if (option == "--decoder" && i + 1 < argc) {
+            decoder = argv[++i];
+        } else if (option == "--recalibrate") {
+            recalibrate = true;
+        } else if (option == "--fixed-quality") {
+            fixed_quality = true;
+        } else if (option == "--no-resume") {
+            resume = false;
+        } else if (option == "--no-history") {
+            history = false;
+        } else if (option == "--radio") {
+            radio = true;
+        } else if (option == "--trace-locks") {
+            trace_locks = true;
+        } else if (option == "--memory-budget" && i + 1 < argc) {
+            const std::string budget = argv[++i];
+            const auto equals = budget.find('=');
+            const auto tag = MemoryAccounting::parse(budget.substr(0, equals));
+            const auto bytes = equals == std::string::npos
+                                   ? std::nullopt
+                                   : parse_mib(budget.substr(equals + 1));
+            if (!tag || !bytes) {
+                std::cerr << "Invalid memory budget: " << budget << '\n';
+                return 1;
+            }
+            MemoryAccounting::set_budget(*tag, *bytes);
+        } else if (option == "--leader" && i + 1 < argc) {
+            leader_port = HttpUrl::parse_port(argv[++i]);
+            if (!leader_port) {
+                std::cerr << "Invalid port: " << argv[i] << '\n';
+                return 1;
+            }
+        } else if (option == "--follow" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find(':') != std::string::npos) {
+            follow = argv[++i];
+            if (!HttpUrl::parse_port(follow.substr(follow.rfind(':') + 1))) {
+                std::cerr << "Invalid port: " << follow << '\n';
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << option << '\n';
+            return 1;
+        }
+    }
+    if (recording && record_raw) {
+        recording->container = RecordingSink::Container::RAW;
+    }
 
 
     try {
-        auto playlist = std::make_unique<Playlist>(filename);
+        // Declared first: an attached player cancels its timers on destruction
+        std::optional<Reactor> reactor;
         Player player;
-        player.set_playlist(std::move(playlist));
+        if (single_thread) {
+            player.attach(reactor.emplace());
+        }
+        if (deep_buffer.count() > 0) {
+            player.set_deep_buffer(deep_buffer);
+        }
+        player.set_adaptive_quality(!fixed_quality);
+        player.set_lock_tracing(trace_locks);
+        if (decoder.empty()) {
+            // Measured once per CPU, then read from the cache
+            decoder = DecoderCalibration().select(recalibrate);
+        }
+        if (!decoder.empty()) {
+            player.set_decoder(decoder);
+            std::cout << "mpg123 decoder: " << decoder << "\n";
+        }
+        if (stream_port) {
+            player.start_stream_server(*stream_port);
+            std::cout << "Streaming on http://localhost:"
+                      << player.get_stream_server()->port() << "/\n";
+        }
+        if (recording) {
+            player.add_output(std::make_unique<RecordingSink>(*recording));
+        }
+        if (shared_memory) {
+            auto ring = std::make_unique<SharedMemorySink>();
+            std::cout << "PCM ring at " << ring->path() << "\n";
+            player.add_output(std::move(ring));
+        }
+        if (leader_port) {
+            player.start_sync_leader(*leader_port);
+            std::cout << "Leading sync group on UDP port "
+                      << player.get_sync_leader()->port() << "\n";
+        } else if (!follow.empty()) {
+            const auto colon = follow.rfind(':');
+            const auto port = HttpUrl::parse_port(follow.substr(colon + 1));
+            player.follow_leader(follow.substr(0, colon), *port);
+        }
+        if (history) {
+            try {
+                player.set_history(std::make_unique<HistoryLog>());
+            } catch (const std::exception& e) {
+                std::cerr << "[WARN] " << e.what() << '\n';
+            }
+        }
+        if (HttpUrl::is_url(filename)) {
+            player.load_stream(filename);
+        } else {
+            if (resume && !leader_port && follow.empty()) {
+                try {
+                    player.set_resume_state(std::make_unique<ResumeState>());
+                } catch (const std::exception& e) {
+                    std::cerr << "[WARN] " << e.what() << '\n';
+                }
+            }
+            player.set_playlist(std::make_unique<Playlist>(filename));
+            player.set_radio(radio);
+        }
 
         CLI cli(player);
-        cli.start();
+        if (single_thread) {
+            cli.run(*reactor);
+        } else {
+            cli.start();
+        }
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] " << e.what() << '\n';
         return 1;
@@ -0,0 +1,410 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "clock_sync.hpp"
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t MAGIC = 0x4A504353; // "JPCS"
+constexpr size_t MAX_PACKET = 1400;    ///< Fits one Ethernet frame
+constexpr size_t MAX_PATH = 1024;
+constexpr int POLL_TIMEOUT_MS = 50;    ///< Stop-token check period
+constexpr double NS_PER_SECOND = 1e9;
+constexpr double PPM = 1e6;
+
+enum class PacketType : uint8_t {
+  REQUEST = 1,
+  RESPONSE = 2,
+};
+
+/// Big-endian packet serializer.
+class PacketWriter {
+public:
+  void put(uint8_t value) { append(&value, sizeof(value)); }
+
+  void put(uint16_t value) {
+    value = htobe16(value);
+    append(&value, sizeof(value));
+  }
+
+  void put(uint32_t value) {
+    value = htobe32(value);
+    append(&value, sizeof(value));
+  }
+
+  void put(int64_t value) {
+    auto raw = htobe64(static_cast<uint64_t>(value));
+    append(&raw, sizeof(raw));
+  }
+
+  void put(const std::string &text) {
+    const auto size = std::min(text.size(), MAX_PATH);
+    put(static_cast<uint16_t>(size));
+    append(text.data(), size);
+  }
+
+  [[nodiscard]] auto data() const -> const char * { return buffer_.data(); }
+  [[nodiscard]] auto size() const -> size_t { return size_; }
+
+private:
+  void append(const void *data, size_t size) {
+    size = std::min(size, buffer_.size() - size_);
+    std::memcpy(buffer_.data() + size_, data, size);
+    size_ += size;
+  }
+
+  std::array<char, MAX_PACKET> buffer_{};
+  size_t size_{0};
+};
+
+/// Bounds-checked big-endian packet parser.
+class PacketReader {
+public:
+  PacketReader(const char *data, size_t size) : data_(data), size_(size) {}
+
+  auto get(uint8_t &value) -> bool { return take(&value, sizeof(value)); }
+
+  auto get(uint16_t &value) -> bool {
+    const bool ok = take(&value, sizeof(value));
+    value = be16toh(value);
+    return ok;
+  }
+
+  auto get(uint32_t &value) -> bool {
+    const bool ok = take(&value, sizeof(value));
+    value = be32toh(value);
+    return ok;
+  }
+
+  auto get(int64_t &value) -> bool {
+    uint64_t raw = 0;
+    const bool ok = take(&raw, sizeof(raw));
+    value = static_cast<int64_t>(be64toh(raw));
+    return ok;
+  }
+
+  auto get(std::string &text) -> bool {
+    uint16_t size = 0;
+    if (!get(size) || size > size_ - offset_) {
+      return false;
+    }
+    text.assign(data_ + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+private:
+  auto take(void *out, size_t size) -> bool {
+    if (size > size_ - offset_) {
+      return false;
+    }
+    std::memcpy(out, data_ + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  const char *data_;
+  size_t size_;
+  size_t offset_{0};
+};
+
+auto read_header(PacketReader &reader, PacketType expected) -> bool {
+  uint32_t magic = 0;
+  uint8_t type = 0;
+  return reader.get(magic) && magic == MAGIC && reader.get(type) &&
+         type == static_cast<uint8_t>(expected);
+}
+
+void write_header(PacketWriter &writer, PacketType type) {
+  writer.put(MAGIC);
+  writer.put(static_cast<uint8_t>(type));
+}
+
+} // namespace
+
+auto steady_now_ns() -> int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+auto MediaClock::frame_at(int64_t leader_now) const -> int64_t {
+  if (!playing) {
+    return frame;
+  }
+  const auto elapsed = static_cast<double>(leader_now - leader_ns);
+  return frame + std::llround(elapsed * sample_rate / NS_PER_SECOND);
+}
+
+void ClockEstimator::add(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+  samples_.push_back({t1 + ((t4 - t1) / 2), ((t2 - t1) + (t3 - t4)) / 2,
+                      (t4 - t1) - (t3 - t2)});
+  if (samples_.size() > WINDOW) {
+    samples_.pop_front();
+  }
+  fit();
+}
+
+void ClockEstimator::fit() {
+  min_delay_ = std::ranges::min(samples_, {}, &Sample::delay_ns).delay_ns;
+  base_local_ = samples_.back().local_ns;
+
+  // Queuing only ever adds delay: exchanges near the minimum are the
+  // symmetric ones whose offsets can be trusted
+  double count = 0.0;
+  double sum_x = 0.0;
+  double sum_y = 0.0;
+  for (const auto &sample : samples_) {
+    if (sample.delay_ns <= min_delay_ + DELAY_SLACK_NS) {
+      count += 1.0;
+      sum_x += static_cast<double>(sample.local_ns - base_local_);
+      sum_y += static_cast<double>(sample.offset_ns);
+    }
+  }
+  const double mean_x = sum_x / count;
+  const double mean_y = sum_y / count;
+  double covariance = 0.0;
+  double variance = 0.0;
+  for (const auto &sample : samples_) {
+    if (sample.delay_ns <= min_delay_ + DELAY_SLACK_NS) {
+      const auto x = static_cast<double>(sample.local_ns - base_local_);
+      covariance += (x - mean_x) *
+                    (static_cast<double>(sample.offset_ns) - mean_y);
+      variance += (x - mean_x) * (x - mean_x);
+    }
+  }
+  slope_ = variance > 0.0 ? covariance / variance : 0.0;
+  base_offset_ = mean_y - (slope_ * mean_x);
+}
+
+auto ClockEstimator::synchronized() const -> bool {
+  return samples_.size() >= MIN_SAMPLES;
+}
+
+auto ClockEstimator::to_leader(int64_t local_ns) const -> int64_t {
+  const auto x = static_cast<double>(local_ns - base_local_);
+  return local_ns + std::llround(base_offset_ + (slope_ * x));
+}
+
+auto ClockEstimator::drift_ppm() const -> double { return slope_ * PPM; }
+
+auto ClockEstimator::round_trip_ns() const -> int64_t { return min_delay_; }
+
+ClockLeader::ClockLeader(uint16_t port, TimeSource now)
+    : now_(std::move(now)) {
+  fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) {
+    throw std::runtime_error("ClockLeader: socket() failed");
+  }
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd_);
+    throw std::runtime_error("ClockLeader: cannot bind UDP port " +
+                             std::to_string(port));
+  }
+  socklen_t length = sizeof(addr);
+  getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &length);
+  port_ = ntohs(addr.sin_port);
+
+  thread_ = std::jthread([this](const std::stop_token &token) { serve(token); });
+}
+
+ClockLeader::~ClockLeader() {
+  thread_.request_stop();
+  thread_.join();
+  close(fd_);
+}
+
+auto ClockLeader::port() const -> uint16_t { return port_; }
+
+void ClockLeader::publish(const MediaClock &clock) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  clock_ = clock;
+}
+
+auto ClockLeader::now() const -> int64_t { return now_(); }
+
+auto ClockLeader::requests_served() const -> uint64_t { return served_.load(); }
+
+void ClockLeader::serve(const std::stop_token &token) {
+  std::array<char, MAX_PACKET> buffer{};
+  pollfd waiter{fd_, POLLIN, 0};
+  while (!token.stop_requested()) {
+    if (poll(&waiter, 1, POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+    sockaddr_storage peer{};
+    socklen_t peer_length = sizeof(peer);
+    const auto received =
+        recvfrom(fd_, buffer.data(), buffer.size(), 0,
+                 reinterpret_cast<sockaddr *>(&peer), &peer_length);
+    const auto t2 = now_();
+    if (received <= 0) {
+      continue;
+    }
+
+    PacketReader reader(buffer.data(), static_cast<size_t>(received));
+    int64_t t1 = 0;
+    if (!read_header(reader, PacketType::REQUEST) || !reader.get(t1)) {
+      continue;
+    }
+
+    MediaClock clock;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      clock = clock_;
+    }
+    PacketWriter writer;
+    write_header(writer, PacketType::RESPONSE);
+    writer.put(t1);
+    writer.put(t2);
+    writer.put(clock.leader_ns);
+    writer.put(clock.frame);
+    writer.put(static_cast<uint32_t>(clock.sample_rate));
+    writer.put(static_cast<uint8_t>(clock.playing ? 1 : 0));
+    writer.put(clock.path);
+    // t3 goes last so it is taken as late as possible
+    writer.put(now_());
+    sendto(fd_, writer.data(), writer.size(), 0,
+           reinterpret_cast<sockaddr *>(&peer), peer_length);
+    served_.fetch_add(1);
+  }
+}
+
+ClockFollower::ClockFollower(const std::string &host, uint16_t port,
+                             std::chrono::milliseconds interval,
+                             TimeSource now)
+    : now_(std::move(now)), interval_(interval) {
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  addrinfo *results = nullptr;
+  const auto service = std::to_string(port);
+  if (getaddrinfo(host.c_str(), service.c_str(), &hints, &results) != 0) {
+    throw std::runtime_error("ClockFollower: cannot resolve " + host);
+  }
+  fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  const bool connected =
+      fd_ >= 0 && connect(fd_, results->ai_addr, results->ai_addrlen) == 0;
+  freeaddrinfo(results);
+  if (!connected) {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    throw std::runtime_error("ClockFollower: cannot reach " + host);
+  }
+
+  thread_ = std::jthread(
+      [this](const std::stop_token &token) { poll_leader(token); });
+}
+
+ClockFollower::~ClockFollower() {
+  thread_.request_stop();
+  thread_.join();
+  close(fd_);
+}
+
+auto ClockFollower::synchronized() const -> bool {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return estimator_.synchronized();
+}
+
+auto ClockFollower::leader_now() const -> int64_t { return to_leader(now_()); }
+
+auto ClockFollower::to_leader(int64_t local_ns) const -> int64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return estimator_.to_leader(local_ns);
+}
+
+auto ClockFollower::drift_ppm() const -> double {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return estimator_.drift_ppm();
+}
+
+auto ClockFollower::round_trip_ns() const -> int64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return estimator_.round_trip_ns();
+}
+
+auto ClockFollower::media_clock() const -> std::optional<MediaClock> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return clock_;
+}
+
+void ClockFollower::poll_leader(const std::stop_token &token) {
+  std::array<char, MAX_PACKET> buffer{};
+  pollfd waiter{fd_, POLLIN, 0};
+  while (!token.stop_requested()) {
+    const auto t1 = now_();
+    PacketWriter request;
+    write_header(request, PacketType::REQUEST);
+    request.put(t1);
+    send(fd_, request.data(), request.size(), 0);
+
+    // Wait out the interval, accepting only the answer to this request
+    const auto deadline = std::chrono::steady_clock::now() + interval_;
+    bool answered = false;
+    while (!token.stop_requested()) {
+      const auto remaining =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              deadline - std::chrono::steady_clock::now())
+              .count();
+      if (remaining <= 0) {
+        break;
+      }
+      if (poll(&waiter, 1,
+               static_cast<int>(std::min<int64_t>(remaining,
+                                                  POLL_TIMEOUT_MS))) <= 0) {
+        continue;
+      }
+      const auto received = recv(fd_, buffer.data(), buffer.size(), 0);
+      const auto t4 = now_();
+      if (received <= 0 || answered) {
+        continue;
+      }
+
+      PacketReader reader(buffer.data(), static_cast<size_t>(received));
+      int64_t echoed = 0;
+      int64_t t2 = 0;
+      int64_t t3 = 0;
+      uint32_t rate = 0;
+      uint8_t playing = 0;
+      MediaClock clock;
+      if (!read_header(reader, PacketType::RESPONSE) || !reader.get(echoed) ||
+          echoed != t1 || !reader.get(t2) || !reader.get(clock.leader_ns) ||
+          !reader.get(clock.frame) || !reader.get(rate) ||
+          !reader.get(playing) || !reader.get(clock.path) ||
+          !reader.get(t3)) {
+        continue;
+      }
+      clock.sample_rate = static_cast<int32_t>(rate);
+      clock.playing = playing != 0;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      estimator_.add(t1, t2, t3, t4);
+      clock_ = std::move(clock);
+      answered = true;
+    }
+  }
+}
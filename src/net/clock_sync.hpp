@@ -0,0 +1,268 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+/// Time source in nanoseconds; injectable so tests can skew clocks.
+using TimeSource = std::function<int64_t()>;
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return Nanoseconds of std::chrono::steady_clock.
+ */
+auto steady_now_ns() -> int64_t;
+
+/**
+ * @struct MediaClock
+ * @brief Anchor of the leader's media timeline.
+ *
+ * `frame` was audible at leader time `leader_ns`; while playing, the
+ * timeline advances at `sample_rate` frames per leader second.
+ */
+struct MediaClock {
+  int64_t leader_ns{0};    ///< Leader time of the anchor
+  int64_t frame{0};        ///< Media frame audible at leader_ns
+  int32_t sample_rate{0};  ///< Frames per second
+  bool playing{false};     ///< Whether the timeline advances
+  std::string path;        ///< Track being played
+
+  /**
+   * @brief Extrapolates the audible frame.
+   * @param leader_now Leader time in nanoseconds.
+   * @return Media frame audible on the leader at that time.
+   */
+  [[nodiscard]] auto frame_at(int64_t leader_now) const -> int64_t;
+};
+
+/**
+ * @class ClockEstimator
+ * @brief NTP-style offset and drift estimate between two clocks.
+ *
+ * Each exchange yields the four timestamps t1 (request sent, local), t2
+ * (request received, leader), t3 (response sent, leader) and t4 (response
+ * received, local). Exchanges delayed by queuing are discarded by keeping
+ * only those close to the minimum round trip of the window, and a
+ * least-squares line through the remaining offsets gives both the offset
+ * and the relative drift of the leader clock.
+ */
+class ClockEstimator {
+public:
+  static constexpr size_t WINDOW = 64;     ///< Exchanges kept
+  static constexpr size_t MIN_SAMPLES = 8; ///< Exchanges before trusting
+  static constexpr int64_t DELAY_SLACK_NS = 100'000; ///< Accepted extra RTT
+
+  /**
+   * @brief Adds one request/response exchange.
+   * @param t1 Local send time.
+   * @param t2 Leader receive time.
+   * @param t3 Leader send time.
+   * @param t4 Local receive time.
+   */
+  void add(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+  /**
+   * @brief Checks whether enough exchanges were seen.
+   * @return true once the estimate can be used.
+   */
+  [[nodiscard]] auto synchronized() const -> bool;
+
+  /**
+   * @brief Maps a local time to leader time.
+   * @param local_ns Local time in nanoseconds.
+   * @return Estimated leader time.
+   */
+  [[nodiscard]] auto to_leader(int64_t local_ns) const -> int64_t;
+
+  /**
+   * @brief Gets the estimated relative drift.
+   * @return Leader minus local rate in parts per million.
+   */
+  [[nodiscard]] auto drift_ppm() const -> double;
+
+  /**
+   * @brief Gets the smallest round trip in the window.
+   * @return Round trip delay in nanoseconds.
+   */
+  [[nodiscard]] auto round_trip_ns() const -> int64_t;
+
+private:
+  /**
+   * @struct Sample
+   * @brief One exchange reduced to offset and delay.
+   */
+  struct Sample {
+    int64_t local_ns;  ///< Midpoint of t1 and t4
+    int64_t offset_ns; ///< Leader minus local
+    int64_t delay_ns;  ///< Round trip minus leader processing
+  };
+
+  /// Refits the offset line over the low-delay samples.
+  void fit();
+
+  std::deque<Sample> samples_; ///< Sliding window
+  int64_t base_local_{0};      ///< Reference local time of the fit
+  double base_offset_{0.0};    ///< Offset at base_local_
+  double slope_{0.0};          ///< Offset change per local nanosecond
+  int64_t min_delay_{0};       ///< Smallest delay in the window
+};
+
+/**
+ * @class ClockLeader
+ * @brief Answers clock exchanges and publishes the media clock over UDP.
+ *
+ * Followers poll the leader; each response carries the leader timestamps
+ * and the latest media clock, so no separate broadcast is needed.
+ */
+class ClockLeader {
+public:
+  /**
+   * @brief Binds the UDP socket and starts answering.
+   * @param port UDP port, 0 for ephemeral.
+   * @param now Leader time source.
+   * @throws std::runtime_error if the socket cannot be bound.
+   */
+  explicit ClockLeader(uint16_t port, TimeSource now = steady_now_ns);
+
+  /**
+   * @brief Destructor.
+   * Stops the serving thread and closes the socket.
+   */
+  ~ClockLeader();
+
+  ClockLeader(ClockLeader &leader) = delete;
+  ClockLeader(ClockLeader &&leader) = delete;
+
+  auto operator=(ClockLeader &leader) -> ClockLeader & = delete;
+  auto operator=(ClockLeader &&leader) -> ClockLeader && = delete;
+
+  /**
+   * @brief Gets the bound port.
+   * @return UDP port number.
+   */
+  [[nodiscard]] auto port() const -> uint16_t;
+
+  /**
+   * @brief Publishes a new media clock anchor.
+   * @param clock Anchor in this leader's time base.
+   */
+  void publish(const MediaClock &clock);
+
+  /**
+   * @brief Gets the leader time base.
+   * @return Current leader time in nanoseconds.
+   */
+  [[nodiscard]] auto now() const -> int64_t;
+
+  /**
+   * @brief Gets the number of exchanges answered.
+   * @return Response count.
+   */
+  [[nodiscard]] auto requests_served() const -> uint64_t;
+
+private:
+  /// Serving thread body.
+  void serve(const std::stop_token &token);
+
+  TimeSource now_;                   ///< Leader time base
+  int fd_{-1};                       ///< UDP socket
+  uint16_t port_{0};                 ///< Bound port
+  mutable std::mutex mutex_;         ///< Protects clock_
+  MediaClock clock_;                 ///< Latest anchor
+  std::atomic<uint64_t> served_{0};  ///< Responses sent
+  std::jthread thread_;              ///< Serving thread
+};
+
+/**
+ * @class ClockFollower
+ * @brief Polls a ClockLeader and tracks its clock and media timeline.
+ */
+class ClockFollower {
+public:
+  static constexpr auto DEFAULT_INTERVAL = std::chrono::milliseconds(100);
+
+  /**
+   * @brief Resolves the leader and starts polling.
+   * @param host Leader host name or address.
+   * @param port Leader UDP port.
+   * @param interval Time between exchanges.
+   * @param now Local time source.
+   * @throws std::runtime_error if the host cannot be resolved.
+   */
+  ClockFollower(const std::string &host, uint16_t port,
+                std::chrono::milliseconds interval = DEFAULT_INTERVAL,
+                TimeSource now = steady_now_ns);
+
+  /**
+   * @brief Destructor.
+   * Stops polling and closes the socket.
+   */
+  ~ClockFollower();
+
+  ClockFollower(ClockFollower &follower) = delete;
+  ClockFollower(ClockFollower &&follower) = delete;
+
+  auto operator=(ClockFollower &follower) -> ClockFollower & = delete;
+  auto operator=(ClockFollower &&follower) -> ClockFollower && = delete;
+
+  /**
+   * @brief Checks whether the clock estimate is usable.
+   * @return true once enough exchanges succeeded.
+   */
+  [[nodiscard]] auto synchronized() const -> bool;
+
+  /**
+   * @brief Gets the current time in the leader's time base.
+   * @return Estimated leader time in nanoseconds.
+   */
+  [[nodiscard]] auto leader_now() const -> int64_t;
+
+  /**
+   * @brief Maps a local time to leader time.
+   * @param local_ns Local time in nanoseconds.
+   * @return Estimated leader time.
+   */
+  [[nodiscard]] auto to_leader(int64_t local_ns) const -> int64_t;
+
+  /**
+   * @brief Gets the estimated relative drift.
+   * @return Leader minus local rate in parts per million.
+   */
+  [[nodiscard]] auto drift_ppm() const -> double;
+
+  /**
+   * @brief Gets the best recent round trip.
+   * @return Round trip delay in nanoseconds.
+   */
+  [[nodiscard]] auto round_trip_ns() const -> int64_t;
+
+  /**
+   * @brief Gets the latest media clock received.
+   * @return The leader's anchor, if any response arrived.
+   */
+  [[nodiscard]] auto media_clock() const -> std::optional<MediaClock>;
+
+private:
+  /// Polling thread body.
+  void poll_leader(const std::stop_token &token);
+
+  TimeSource now_;                       ///< Local time base
+  std::chrono::milliseconds interval_;   ///< Exchange period
+  int fd_{-1};                           ///< Connected UDP socket
+  mutable std::mutex mutex_;             ///< Protects the fields below
+  ClockEstimator estimator_;             ///< Offset/drift estimate
+  std::optional<MediaClock> clock_;      ///< Latest anchor
+  std::jthread thread_;                  ///< Polling thread
+};
@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "http_client.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view SCHEME = "http://";
+constexpr int DEFAULT_TIMEOUT_MS = 10000;
+constexpr int MAX_REDIRECTS = 5;
+
+/// Closes a socket when leaving scope.
+class SocketGuard {
+public:
+  explicit SocketGuard(int fd) : fd_(fd) {}
+  ~SocketGuard() { close(fd_); }
+  SocketGuard(SocketGuard &guard) = delete;
+  SocketGuard(SocketGuard &&guard) = delete;
+  auto operator=(SocketGuard &guard) -> SocketGuard & = delete;
+  auto operator=(SocketGuard &&guard) -> SocketGuard && = delete;
+
+private:
+  int fd_;
+};
+
+void send_all(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const auto result = send(fd, data.data() + sent, data.size() - sent, 0);
+    if (result <= 0) {
+      throw std::runtime_error("HTTP send failed");
+    }
+    sent += static_cast<size_t>(result);
+  }
+}
+
+/// Connects without blocking past the timeout; leaves the socket blocking.
+auto connect_within(int fd, const addrinfo &info, int timeout_ms) -> bool {
+  const int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+    return false;
+  }
+  bool connected = connect(fd, info.ai_addr, info.ai_addrlen) == 0;
+  if (!connected && errno == EINPROGRESS) {
+    pollfd pending{fd, POLLOUT, 0};
+    int error = 0;
+    socklen_t length = sizeof(error);
+    connected = poll(&pending, 1, timeout_ms) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 &&
+                error == 0;
+  }
+  return connected && fcntl(fd, F_SETFL, flags) == 0;
+}
+
+auto is_redirect(int status) -> bool {
+  return status == 301 || status == 302 || status == 303 || status == 307 ||
+         status == 308;
+}
+
+auto get_once(const HttpUrl &url, std::optional<HttpRange> range,
+              const std::map<std::string, std::string> &headers)
+    -> HttpResponse {
+  const int fd = http_connect(url, DEFAULT_TIMEOUT_MS);
+  SocketGuard guard(fd);
+
+  // HTTP/1.0 keeps servers from answering with chunked transfer coding
+  std::string request = "GET " + url.path + " HTTP/1.0\r\nHost: " + url.host +
+                        "\r\nUser-Agent: jpod_nano\r\nConnection: close\r\n";
+  if (range) {
+    request += "Range: bytes=" + std::to_string(range->first) + "-" +
+               std::to_string(range->last) + "\r\n";
+  }
+  for (const auto &[name, value] : headers) {
+    request += name + ": " + value + "\r\n";
+  }
+  request += "\r\n";
+  send_all(fd, request);
+
+  std::string data;
+  std::array<char, 64U * 1024U> chunk{};
+  HttpResponse response;
+  size_t header_end = std::string::npos;
+  std::optional<uint64_t> content_length;
+
+  while (true) {
+    const auto received = recv(fd, chunk.data(), chunk.size(), 0);
+    if (received < 0) {
+      throw std::runtime_error("HTTP receive failed from " + url.host);
+    }
+    if (received == 0) {
+      break;
+    }
+    data.append(chunk.data(), static_cast<size_t>(received));
+
+    if (header_end == std::string::npos) {
+      header_end = data.find("\r\n\r\n");
+      if (header_end == std::string::npos) {
+        continue;
+      }
+      response = parse_http_head(data.substr(0, header_end));
+      data.erase(0, header_end + 4);
+      if (auto length = response.headers.find("content-length");
+          length != response.headers.end()) {
+        content_length = std::stoull(length->second);
+        data.reserve(*content_length);
+      }
+    }
+    if (content_length && data.size() >= *content_length) {
+      break;
+    }
+  }
+
+  if (header_end == std::string::npos) {
+    throw std::runtime_error("Incomplete HTTP response from " + url.host);
+  }
+  if (content_length && data.size() < *content_length) {
+    throw std::runtime_error("Truncated HTTP body from " + url.host);
+  }
+  if (content_length) {
+    data.resize(*content_length);
+  }
+  response.body = std::move(data);
+  return response;
+}
+
+} // namespace
+
+auto parse_http_head(const std::string &head) -> HttpResponse {
+  HttpResponse response;
+  const auto status_end = head.find("\r\n");
+  const auto status_line = head.substr(0, status_end);
+  const auto space = status_line.find(' ');
+  if (space == std::string::npos || space + 1 >= status_line.size() ||
+      std::isdigit(static_cast<unsigned char>(status_line[space + 1])) == 0) {
+    throw std::runtime_error("Malformed HTTP status line: " + status_line);
+  }
+  response.status = std::stoi(status_line.substr(space + 1));
+
+  size_t pos = (status_end == std::string::npos) ? head.size() : status_end + 2;
+  while (pos < head.size()) {
+    const auto end = head.find("\r\n", pos);
+    const auto line = head.substr(pos, end - pos);
+    pos = (end == std::string::npos) ? head.size() : end + 2;
+    const auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    auto name = line.substr(0, colon);
+    std::ranges::transform(name, name.begin(), [](unsigned char chr) {
+      return static_cast<char>(std::tolower(chr));
+    });
+    auto value = line.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(' '));
+    response.headers[name] = value;
+  }
+  return response;
+}
+
+auto HttpUrl::is_url(const std::string &text) -> bool {
+  return text.starts_with(SCHEME);
+}
+
+auto HttpUrl::parse_port(const std::string &text) -> std::optional<uint16_t> {
+  static constexpr size_t MAX_DIGITS = 5;
+  if (text.empty() || text.size() > MAX_DIGITS ||
+      text.find_first_not_of("0123456789") != std::string::npos) {
+    return std::nullopt;
+  }
+  const auto port = std::stoul(text);
+  if (port > UINT16_MAX) {
+    return std::nullopt;
+  }
+  return static_cast<uint16_t>(port);
+}
+
+auto HttpUrl::parse(const std::string &url) -> HttpUrl {
+  if (!is_url(url)) {
+    throw std::runtime_error("Unsupported URL: " + url);
+  }
+  HttpUrl result;
+  const auto rest = url.substr(SCHEME.size());
+  const auto slash = rest.find('/');
+  const auto authority = rest.substr(0, slash);
+  if (slash != std::string::npos) {
+    result.path = rest.substr(slash);
+  }
+  const auto colon = authority.rfind(':');
+  if (colon != std::string::npos) {
+    result.host = authority.substr(0, colon);
+    const auto port = parse_port(authority.substr(colon + 1));
+    if (!port) {
+      throw std::runtime_error("Invalid port in URL: " + url);
+    }
+    result.port = *port;
+  } else {
+    result.host = authority;
+  }
+  if (result.host.empty()) {
+    throw std::runtime_error("Missing host in URL: " + url);
+  }
+  return result;
+}
+
+auto HttpResponse::total_size() const -> std::optional<uint64_t> {
+  if (auto range = headers.find("content-range"); range != headers.end()) {
+    const auto slash = range->second.rfind('/');
+    if (slash != std::string::npos && range->second[slash + 1] != '*') {
+      return std::stoull(range->second.substr(slash + 1));
+    }
+    return std::nullopt;
+  }
+  if (auto length = headers.find("content-length"); length != headers.end()) {
+    return std::stoull(length->second);
+  }
+  return std::nullopt;
+}
+
+auto http_connect(const HttpUrl &url, int timeout_ms) -> int {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *results = nullptr;
+  const auto port = std::to_string(url.port);
+  if (getaddrinfo(url.host.c_str(), port.c_str(), &hints, &results) != 0) {
+    throw std::runtime_error("Cannot resolve host: " + url.host);
+  }
+
+  int fd = -1;
+  for (auto *info = results; info != nullptr; info = info->ai_next) {
+    fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (connect_within(fd, *info, timeout_ms)) {
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(results);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot connect to " + url.host + ":" + port);
+  }
+
+  static constexpr int MS_PER_SECOND = 1000;
+  timeval timeout{};
+  timeout.tv_sec = timeout_ms / MS_PER_SECOND;
+  timeout.tv_usec = (timeout_ms % MS_PER_SECOND) * MS_PER_SECOND;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  return fd;
+}
+
+auto http_get(const HttpUrl &url, std::optional<HttpRange> range,
+              const std::map<std::string, std::string> &headers)
+    -> HttpResponse {
+  HttpUrl target = url;
+  for (int redirects = 0;; ++redirects) {
+    auto response = get_once(target, range, headers);
+    const auto location = response.headers.find("location");
+    if (!is_redirect(response.status) || location == response.headers.end()) {
+      return response;
+    }
+    if (redirects == MAX_REDIRECTS) {
+      throw std::runtime_error("Too many HTTP redirects from " + url.host);
+    }
+    if (HttpUrl::is_url(location->second)) {
+      target = HttpUrl::parse(location->second);
+    } else if (location->second.starts_with('/')) {
+      target.path = location->second;
+    } else {
+      throw std::runtime_error("Unsupported HTTP redirect to " +
+                               location->second);
+    }
+  }
+}
@@ -0,0 +1,109 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+/**
+ * @struct HttpUrl
+ * @brief Components of a plain `http://host[:port]/path` URL.
+ */
+struct HttpUrl {
+  std::string host;     ///< Host name or address
+  uint16_t port{80};    ///< TCP port
+  std::string path{"/"}; ///< Request target including query
+
+  /**
+   * @brief Parses an `http://` URL.
+   * @param url The URL string.
+   * @return The parsed URL.
+   * @throws std::runtime_error if the URL is not a valid http:// URL.
+   */
+  static auto parse(const std::string &url) -> HttpUrl;
+
+  /**
+   * @brief Checks whether a string looks like an `http://` URL.
+   * @param text Playlist entry or path.
+   * @return true if it starts with the http scheme.
+   */
+  [[nodiscard]] static auto is_url(const std::string &text) -> bool;
+
+  /**
+   * @brief Parses a decimal TCP/UDP port.
+   * @param text Digits only, no sign or spaces.
+   * @return The port, or std::nullopt if not a number in 0..65535.
+   */
+  [[nodiscard]] static auto parse_port(const std::string &text)
+      -> std::optional<uint16_t>;
+};
+
+/**
+ * @struct HttpRange
+ * @brief Inclusive byte range for a `Range: bytes=first-last` request.
+ */
+struct HttpRange {
+  uint64_t first{0}; ///< First byte offset
+  uint64_t last{0};  ///< Last byte offset (inclusive)
+};
+
+/**
+ * @struct HttpResponse
+ * @brief Status, headers and body of a completed HTTP request.
+ */
+struct HttpResponse {
+  int status{0};                              ///< HTTP status code
+  std::map<std::string, std::string> headers; ///< Lower-cased header names
+  std::string body;                           ///< Response payload
+
+  /**
+   * @brief Gets the total resource size from Content-Range or
+   * Content-Length.
+   * @return The size, or std::nullopt if the server did not report it.
+   */
+  [[nodiscard]] auto total_size() const -> std::optional<uint64_t>;
+};
+
+/**
+ * @brief Parses a status line and headers (without the final blank line).
+ *
+ * Accepts both `HTTP/1.x` and SHOUTcast-style `ICY` status lines.
+ *
+ * @param head Response head text.
+ * @return Response with status and headers set and an empty body.
+ * @throws std::runtime_error if the status line is malformed.
+ */
+auto parse_http_head(const std::string &head) -> HttpResponse;
+
+/**
+ * @brief Opens a blocking TCP connection to the URL's host.
+ * @param url Target URL.
+ * @param timeout_ms Bound on each connect attempt, then the send/receive
+ * timeout applied to the socket.
+ * @return Connected socket descriptor.
+ * @throws std::runtime_error if the host cannot be resolved or reached.
+ */
+auto http_connect(const HttpUrl &url, int timeout_ms) -> int;
+
+/**
+ * @brief Performs a blocking HTTP/1.0 GET, optionally for a byte range.
+ *
+ * Only plain http:// is supported; media on the internal web servers is
+ * not served over TLS. HTTP/1.0 rules out chunked bodies. Up to five
+ * redirects are followed, to absolute http:// or host-relative locations.
+ *
+ * @param url Target URL.
+ * @param range Optional byte range to request.
+ * @param headers Extra request headers, such as conditional validators.
+ * @return The response; non-2xx statuses are returned, not thrown.
+ * @throws std::runtime_error on connection or protocol errors.
+ */
+auto http_get(const HttpUrl &url, std::optional<HttpRange> range = std::nullopt,
+              const std::map<std::string, std::string> &headers = {})
+    -> HttpResponse;
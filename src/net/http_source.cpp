@@ -0,0 +1,442 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "http_source.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::array<char, 4> MAP_MAGIC{'J', 'P', 'H', '2'};
+constexpr size_t VALIDATOR_SIZE = 128;
+
+using Validator = std::array<char, VALIDATOR_SIZE>;
+
+/**
+ * @struct MapHeader
+ * @brief On-disk header of a chunk map sidecar, followed by one state byte
+ * per chunk.
+ */
+struct MapHeader {
+  std::array<char, 4> magic{MAP_MAGIC}; ///< File signature
+  uint32_t chunk_size{0};               ///< Chunk size the map was built with
+  uint64_t size{0};                     ///< Resource size
+  Validator etag{};                     ///< ETag, NUL-padded, may be empty
+  Validator last_modified{};            ///< Last-Modified, NUL-padded
+};
+
+/// Copies a response header into a fixed field; too long means absent.
+auto to_validator(const HttpResponse &response, const std::string &name)
+    -> Validator {
+  Validator field{};
+  const auto found = response.headers.find(name);
+  if (found != response.headers.end() && found->second.size() < field.size()) {
+    std::ranges::copy(found->second, field.begin());
+  }
+  return field;
+}
+
+auto from_validator(const Validator &field) -> std::string {
+  return {field.data(), strnlen(field.data(), field.size())};
+}
+
+auto cache_key(const std::string &url) -> std::string {
+  // FNV-1a keeps cache file names short and stable across runs
+  static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+  static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+  uint64_t hash = FNV_OFFSET;
+  for (const unsigned char chr : url) {
+    hash = (hash ^ chr) * FNV_PRIME;
+  }
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return key.str();
+}
+
+auto allocated_bytes(const fs::path &path) -> uint64_t {
+  struct stat info {};
+  if (stat(path.c_str(), &info) != 0) {
+    return 0;
+  }
+  // Sparse files only cost the blocks actually written
+  static constexpr uint64_t BLOCK_SIZE = 512;
+  return static_cast<uint64_t>(info.st_blocks) * BLOCK_SIZE;
+}
+
+} // namespace
+
+HttpSource::HttpSource(const std::string &url, fs::path cache_dir,
+                       uint64_t cache_limit, size_t prefetch_chunks)
+    : url_(HttpUrl::parse(url)), cache_dir_(std::move(cache_dir)),
+      prefetch_chunks_(prefetch_chunks) {
+  fs::create_directories(cache_dir_);
+  const auto key = cache_key(url);
+  data_path_ = cache_dir_ / (key + ".data");
+  map_path_ = cache_dir_ / (key + ".map");
+
+  open_entry(url_);
+  fs::last_write_time(map_path_, fs::file_time_type::clock::now());
+  evict(cache_limit);
+
+  if (prefetch_chunks_ > 0) {
+    prefetch_thread_ = std::jthread(
+        [this](const std::stop_token &token) { prefetch_loop(token); });
+  }
+}
+
+HttpSource::~HttpSource() {
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.request_stop();
+    prefetch_thread_.join();
+  }
+  close(data_fd_);
+  close(map_fd_);
+}
+
+void HttpSource::open_entry(const HttpUrl &url) {
+  MapHeader header;
+  map_fd_ = open(map_path_.c_str(), O_RDWR | O_CREAT, 0644);
+  data_fd_ = open(data_path_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (map_fd_ < 0 || data_fd_ < 0) {
+    throw std::runtime_error("Cannot open HTTP cache entry in " +
+                             cache_dir_.string());
+  }
+
+  const bool intact = pread(map_fd_, &header, sizeof(header), 0) ==
+                          static_cast<ssize_t>(sizeof(header)) &&
+                      header.magic == MAP_MAGIC &&
+                      header.chunk_size == CHUNK_SIZE &&
+                      fs::file_size(data_path_) == header.size;
+  std::map<std::string, std::string> conditions;
+  if (intact) {
+    if (const auto etag = from_validator(header.etag); !etag.empty()) {
+      conditions["If-None-Match"] = etag;
+    }
+    if (const auto modified = from_validator(header.last_modified);
+        !modified.empty()) {
+      conditions["If-Modified-Since"] = modified;
+    }
+  }
+
+  // Probe with the first chunk: a 206 reveals the size and saves a request,
+  // and for a cached entry a 304 confirms it is still current
+  HttpResponse response;
+  try {
+    response = http_get(url, HttpRange{0, CHUNK_SIZE - 1}, conditions);
+  } catch (const std::exception &e) {
+    if (!intact) {
+      throw;
+    }
+    std::cerr << "[WARN] Using cached " << url.path << " unrevalidated: "
+              << e.what() << '\n';
+    response.status = 304;
+  }
+  if (response.status != 304 && response.status != 200 &&
+      response.status != 206) {
+    throw std::runtime_error("HTTP " + std::to_string(response.status) +
+                             " for " + url.host + url.path);
+  }
+  const auto total = response.total_size();
+  const auto probed_size =
+      (response.status == 200 || !total) ? response.body.size() : *total;
+
+  // Without validators a matching size is the best evidence of no change
+  const bool current =
+      intact && (response.status == 304 ||
+                 (conditions.empty() && probed_size == header.size &&
+                  to_validator(response, "etag")[0] == '\0' &&
+                  to_validator(response, "last-modified")[0] == '\0'));
+  if (current) {
+    size_ = header.size;
+    const size_t count = (size_ + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunks_.resize(count);
+    const auto got =
+        pread(map_fd_, chunks_.data(), count, sizeof(MapHeader));
+    if (got != static_cast<ssize_t>(count)) {
+      std::ranges::fill(chunks_, ChunkState::MISSING);
+    }
+    std::ranges::replace(chunks_, ChunkState::FETCHING, ChunkState::MISSING);
+    if (response.status == 304) {
+      return;
+    }
+  } else {
+    size_ = probed_size;
+    const size_t count = (size_ + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunks_.assign(count, ChunkState::MISSING);
+    if (ftruncate(data_fd_, 0) != 0 ||
+        ftruncate(data_fd_, static_cast<off_t>(size_)) != 0 ||
+        ftruncate(map_fd_, 0) != 0) {
+      throw std::runtime_error("Cannot size HTTP cache entry " +
+                               data_path_.string());
+    }
+    header = MapHeader{};
+    header.chunk_size = CHUNK_SIZE;
+    header.size = size_;
+    header.etag = to_validator(response, "etag");
+    header.last_modified = to_validator(response, "last-modified");
+    std::vector<char> map(sizeof(header) + count, 0);
+    std::memcpy(map.data(), &header, sizeof(header));
+    if (pwrite(map_fd_, map.data(), map.size(), 0) !=
+            static_cast<ssize_t>(map.size()) ||
+        fsync(map_fd_) != 0) {
+      throw std::runtime_error("Cannot write HTTP cache map " +
+                               map_path_.string());
+    }
+  }
+
+  const std::span<const char> body{response.body};
+  for (size_t index = 0;
+       index < chunks_.size() && index * CHUNK_SIZE < body.size(); ++index) {
+    const auto offset = index * CHUNK_SIZE;
+    store_chunk(index,
+                body.subspan(offset, std::min(CHUNK_SIZE, body.size() - offset)));
+  }
+}
+
+auto HttpSource::read(std::span<char> out) -> ssize_t {
+  uint64_t pos = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pos = position_;
+  }
+  if (pos >= size_) {
+    return 0;
+  }
+
+  const auto wanted = static_cast<size_t>(
+      std::min<uint64_t>(out.size(), size_ - pos));
+  size_t done = 0;
+  while (done < wanted) {
+    const auto offset = pos + done;
+    const auto index = static_cast<size_t>(offset / CHUNK_SIZE);
+    if (!ensure_chunk(index)) {
+      break;
+    }
+    const auto chunk_end = std::min<uint64_t>((index + 1) * CHUNK_SIZE, size_);
+    const auto length = static_cast<size_t>(
+        std::min<uint64_t>(wanted - done, chunk_end - offset));
+    const auto got = pread(data_fd_, out.data() + done, length,
+                           static_cast<off_t>(offset));
+    if (got <= 0) {
+      break;
+    }
+    done += static_cast<size_t>(got);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    position_ = pos + done;
+  }
+  chunk_ready_.notify_all(); // Let the prefetcher follow the new position
+  return (done == 0) ? -1 : static_cast<ssize_t>(done);
+}
+
+auto HttpSource::seek(int64_t offset, int whence) -> int64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t base = 0;
+  if (whence == SEEK_CUR) {
+    base = static_cast<int64_t>(position_);
+  } else if (whence == SEEK_END) {
+    base = static_cast<int64_t>(size_);
+  }
+  const auto target = base + offset;
+  if (target < 0 || target > static_cast<int64_t>(size_)) {
+    return -1;
+  }
+  position_ = static_cast<uint64_t>(target);
+  chunk_ready_.notify_all();
+  return target;
+}
+
+auto HttpSource::size() const noexcept -> uint64_t { return size_; }
+
+auto HttpSource::fetched_bytes() const noexcept -> uint64_t {
+  return fetched_bytes_.load();
+}
+
+auto HttpSource::ensure_chunk(size_t index) -> bool {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    switch (chunks_.at(index)) {
+    case ChunkState::CACHED:
+      return true;
+    case ChunkState::FETCHING:
+      chunk_ready_.wait(lock);
+      break;
+    case ChunkState::MISSING:
+      chunks_[index] = ChunkState::FETCHING;
+      lock.unlock();
+      return fetch_chunk(index);
+    }
+  }
+}
+
+auto HttpSource::fetch_chunk(size_t index) -> bool {
+  const uint64_t first = index * CHUNK_SIZE;
+  const uint64_t last = std::min<uint64_t>(first + CHUNK_SIZE, size_) - 1;
+  try {
+    auto response = http_get(url_, HttpRange{first, last});
+    const std::span<const char> body{response.body};
+    if (response.status == 206 && body.size() == last - first + 1) {
+      return store_chunk(index, body);
+    }
+    if (response.status == 200 && body.size() == size_) {
+      // Server ignored the range; keep everything it sent
+      bool stored = false;
+      for (size_t other = 0; other < chunks_.size(); ++other) {
+        const auto offset = other * CHUNK_SIZE;
+        const bool kept = store_chunk(
+            other, body.subspan(offset, std::min<size_t>(
+                                            CHUNK_SIZE, body.size() - offset)));
+        stored = (other == index) ? kept : stored;
+      }
+      return stored;
+    }
+    std::cerr << "[WARN] HTTP " << response.status << " fetching chunk "
+              << index << " of " << url_.path << '\n';
+  } catch (const std::exception &e) {
+    std::cerr << "[WARN] " << e.what() << '\n';
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks_[index] = ChunkState::MISSING;
+  }
+  chunk_ready_.notify_all();
+  return false;
+}
+
+auto HttpSource::store_chunk(size_t index, std::span<const char> data)
+    -> bool {
+  const auto offset = static_cast<off_t>(index * CHUNK_SIZE);
+  // The bytes must be durable before the map claims them, or a crash could
+  // leave a chunk marked cached over a hole
+  const bool durable = pwrite(data_fd_, data.data(), data.size(), offset) ==
+                           static_cast<ssize_t>(data.size()) &&
+                       fdatasync(data_fd_) == 0;
+  if (!durable) {
+    std::cerr << "[WARN] Cannot write HTTP cache entry " << data_path_
+              << '\n';
+  }
+  fetched_bytes_.fetch_add(data.size());
+  {
+    // A chunk that did not reach the disk would read back as a hole
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks_[index] = durable ? ChunkState::CACHED : ChunkState::MISSING;
+    if (durable) {
+      const auto state = static_cast<char>(ChunkState::CACHED);
+      [[maybe_unused]] auto written =
+          pwrite(map_fd_, &state, 1,
+                 static_cast<off_t>(sizeof(MapHeader) + index));
+    }
+  }
+  chunk_ready_.notify_all();
+  return durable;
+}
+
+void HttpSource::prefetch_loop(const std::stop_token &token) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto next_missing = [this] {
+    const auto first = static_cast<size_t>(position_ / CHUNK_SIZE);
+    const auto last = std::min(first + prefetch_chunks_, chunks_.size());
+    for (auto index = first; index < last; ++index) {
+      if (chunks_[index] == ChunkState::MISSING) {
+        return index;
+      }
+    }
+    return chunks_.size();
+  };
+
+  while (!token.stop_requested()) {
+    if (!chunk_ready_.wait(lock, token,
+                           [&] { return next_missing() < chunks_.size(); })) {
+      return;
+    }
+    const auto index = next_missing();
+    chunks_[index] = ChunkState::FETCHING;
+    lock.unlock();
+    const bool fetched = fetch_chunk(index);
+    lock.lock();
+    if (!fetched) {
+      // Back off before retrying a failing server
+      static constexpr auto RETRY_DELAY = std::chrono::seconds(1);
+      chunk_ready_.wait_for(lock, token, RETRY_DELAY, [] { return false; });
+    }
+  }
+}
+
+void HttpSource::evict(uint64_t cache_limit) const {
+  struct Entry {
+    fs::path map;
+    fs::path data;
+    fs::file_time_type used;
+    uint64_t bytes;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  for (const auto &file : fs::directory_iterator(cache_dir_)) {
+    if (file.path().extension() != ".map") {
+      continue;
+    }
+    Entry entry{file.path(), file.path(), file.last_write_time(), 0};
+    entry.data.replace_extension(".data");
+    entry.bytes = allocated_bytes(entry.data) + allocated_bytes(entry.map);
+    total += entry.bytes;
+    entries.push_back(std::move(entry));
+  }
+
+  std::ranges::sort(entries, std::less{}, &Entry::used);
+  for (const auto &entry : entries) {
+    if (total <= cache_limit) {
+      break;
+    }
+    if (entry.map == map_path_) {
+      continue;
+    }
+    std::error_code error;
+    fs::remove(entry.data, error);
+    fs::remove(entry.map, error);
+    total -= entry.bytes;
+  }
+}
+
+auto HttpSource::default_cache_dir() -> fs::path {
+  if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr) {
+    return fs::path(xdg) / "jpod_nano" / "http";
+  }
+  if (const char *home = std::getenv("HOME"); home != nullptr) {
+    return fs::path(home) / ".cache" / "jpod_nano" / "http";
+  }
+  return fs::temp_directory_path() / "jpod_nano" / "http";
+}
+
+auto HttpSource::mpg123_read(void *handle, void *buffer, size_t size)
+    -> ssize_t {
+  return static_cast<HttpSource *>(handle)->read(
+      std::span{static_cast<char *>(buffer), size});
+}
+
+auto HttpSource::mpg123_lseek(void *handle, off_t offset, int whence)
+    -> off_t {
+  return static_cast<off_t>(
+      static_cast<HttpSource *>(handle)->seek(offset, whence));
+}
@@ -0,0 +1,167 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "http_client.hpp"
+
+/**
+ * @class HttpSource
+ * @brief Random-access reader over an http:// resource backed by a bounded
+ * on-disk cache.
+ *
+ * The resource is split into fixed-size chunks fetched with HTTP range
+ * requests. Fetched chunks are written into a sparse cache file at their
+ * natural offset, and a sidecar chunk map records which chunks are present, so
+ * a seek only fetches the chunks it lands on and a later run reuses
+ * everything already cached. The map keeps the server's ETag and
+ * Last-Modified, and reopening an entry revalidates it with a conditional
+ * probe; a changed resource is fetched afresh. Chunk bytes are synced to
+ * disk before the map marks them cached, so a crash never leaves the map
+ * pointing at a hole.
+ *
+ * A background thread prefetches the chunks following the read position.
+ * The cache directory is trimmed to a byte budget, least recently used
+ * entries first, whenever a source is opened.
+ */
+class HttpSource {
+public:
+  static constexpr size_t CHUNK_SIZE = 256U * 1024U; ///< Range request size
+  static constexpr size_t PREFETCH_CHUNKS = 8;        ///< Read-ahead depth
+  static constexpr uint64_t DEFAULT_CACHE_LIMIT =
+      512ULL * 1024ULL * 1024ULL; ///< Cache budget in bytes
+
+  /**
+   * @brief Opens a URL, reusing or creating its cache entry.
+   * @param url The http:// URL of the resource.
+   * @param cache_dir Directory holding cache entries.
+   * @param cache_limit Byte budget for the whole cache directory.
+   * @param prefetch_chunks Number of chunks to keep fetched ahead.
+   * @throws std::runtime_error if the resource cannot be reached.
+   */
+  HttpSource(const std::string &url, std::filesystem::path cache_dir,
+             uint64_t cache_limit = DEFAULT_CACHE_LIMIT,
+             size_t prefetch_chunks = PREFETCH_CHUNKS);
+
+  /**
+   * @brief Destructor.
+   * Stops prefetching and closes the cache entry.
+   */
+  ~HttpSource();
+
+  HttpSource(HttpSource &source) = delete;
+  HttpSource(HttpSource &&source) = delete;
+
+  auto operator=(HttpSource &source) -> HttpSource & = delete;
+  auto operator=(HttpSource &&source) -> HttpSource && = delete;
+
+  /**
+   * @brief Reads from the current position, fetching missing chunks.
+   * @param out Destination buffer.
+   * @return Bytes read, 0 at end of resource, -1 on fetch failure.
+   */
+  auto read(std::span<char> out) -> ssize_t;
+
+  /**
+   * @brief Moves the read position, lseek-style.
+   * @param offset Offset relative to @p whence.
+   * @param whence SEEK_SET, SEEK_CUR or SEEK_END.
+   * @return The new position, or -1 if it would be out of range.
+   */
+  auto seek(int64_t offset, int whence) -> int64_t;
+
+  /**
+   * @brief Gets the resource size.
+   * @return Size in bytes.
+   */
+  [[nodiscard]] auto size() const noexcept -> uint64_t;
+
+  /**
+   * @brief Gets the number of bytes downloaded by this instance.
+   * @return Network payload bytes, excluding cache hits.
+   */
+  [[nodiscard]] auto fetched_bytes() const noexcept -> uint64_t;
+
+  /**
+   * @brief Gets the default cache directory.
+   * @return `$XDG_CACHE_HOME/jpod_nano/http`, falling back to `~/.cache` and
+   * then the system temporary directory.
+   */
+  [[nodiscard]] static auto default_cache_dir() -> std::filesystem::path;
+
+  /**
+   * @brief Adapter for mpg123_replace_reader_handle().
+   * @param handle Pointer to an HttpSource.
+   */
+  static auto mpg123_read(void *handle, void *buffer, size_t size) -> ssize_t;
+
+  /**
+   * @brief Adapter for mpg123_replace_reader_handle().
+   * @param handle Pointer to an HttpSource.
+   */
+  static auto mpg123_lseek(void *handle, off_t offset, int whence) -> off_t;
+
+private:
+  /// Chunk presence in the cache file.
+  enum class ChunkState : uint8_t {
+    MISSING = 0,  ///< Not cached
+    CACHED = 1,   ///< Present in the cache file
+    FETCHING = 2, ///< Download in progress (never persisted)
+  };
+
+  /// Revalidates the cached entry, or probes the server to create it.
+  void open_entry(const HttpUrl &url);
+
+  /**
+   * @brief Makes a chunk available, fetching it or waiting for a fetch.
+   * @return false if the chunk could not be fetched.
+   */
+  auto ensure_chunk(size_t index) -> bool;
+
+  /// Downloads one chunk and writes it into the cache file.
+  auto fetch_chunk(size_t index) -> bool;
+
+  /**
+   * @brief Stores chunk bytes, updates the chunk map and wakes waiters.
+   * @return false if the bytes did not reach the disk; the chunk is left
+   * MISSING.
+   */
+  auto store_chunk(size_t index, std::span<const char> data) -> bool;
+
+  /// Background loop fetching chunks ahead of the read position.
+  void prefetch_loop(const std::stop_token &token);
+
+  /// Removes least recently used entries until the cache fits its budget.
+  void evict(uint64_t cache_limit) const;
+
+  HttpUrl url_;                        ///< Parsed resource URL
+  std::filesystem::path cache_dir_;    ///< Cache directory
+  std::filesystem::path data_path_;    ///< Sparse chunk file
+  std::filesystem::path map_path_;     ///< Chunk map sidecar
+  int data_fd_{-1};                    ///< Sparse chunk file descriptor
+  int map_fd_{-1};                     ///< Chunk map sidecar descriptor
+  uint64_t size_{0};                   ///< Resource size
+  size_t prefetch_chunks_;             ///< Read-ahead depth
+
+  std::mutex mutex_;                   ///< Protects chunks_ and position_
+  std::condition_variable_any chunk_ready_; ///< Signals fetch completion
+  std::vector<ChunkState> chunks_;     ///< Per-chunk state
+  uint64_t position_{0};               ///< Current read offset
+  std::atomic<uint64_t> fetched_bytes_{0}; ///< Network bytes downloaded
+  std::jthread prefetch_thread_;       ///< Read-ahead worker
+};
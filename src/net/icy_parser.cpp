@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "icy_parser.hpp"
+
+#include <algorithm>
+
+IcyParser::IcyParser(size_t metaint) : metaint_(metaint), remaining_(metaint) {}
+
+void IcyParser::feed(std::span<const char> data, const AudioCallback &on_audio,
+                     const MetadataCallback &on_metadata) {
+  if (metaint_ == 0) {
+    if (!data.empty()) {
+      on_audio(data);
+    }
+    return;
+  }
+
+  while (!data.empty()) {
+    switch (phase_) {
+    case Phase::AUDIO: {
+      const auto length = std::min(remaining_, data.size());
+      on_audio(data.first(length));
+      data = data.subspan(length);
+      remaining_ -= length;
+      if (remaining_ == 0) {
+        phase_ = Phase::LENGTH;
+      }
+      break;
+    }
+    case Phase::LENGTH: {
+      static constexpr size_t BLOCK_UNIT = 16;
+      remaining_ = static_cast<uint8_t>(data.front()) * BLOCK_UNIT;
+      data = data.subspan(1);
+      metadata_.clear();
+      if (remaining_ == 0) {
+        phase_ = Phase::AUDIO;
+        remaining_ = metaint_;
+      } else {
+        phase_ = Phase::METADATA;
+      }
+      break;
+    }
+    case Phase::METADATA: {
+      const auto length = std::min(remaining_, data.size());
+      metadata_.append(data.data(), length);
+      data = data.subspan(length);
+      remaining_ -= length;
+      if (remaining_ == 0) {
+        metadata_.erase(metadata_.find_last_not_of('\0') + 1);
+        if (!metadata_.empty()) {
+          on_metadata(metadata_);
+        }
+        phase_ = Phase::AUDIO;
+        remaining_ = metaint_;
+      }
+      break;
+    }
+    }
+  }
+}
+
+auto IcyParser::stream_title(std::string_view metadata)
+    -> std::optional<std::string> {
+  static constexpr std::string_view KEY = "StreamTitle='";
+  const auto start = metadata.find(KEY);
+  if (start == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const auto value = metadata.substr(start + KEY.size());
+  // Titles may contain quotes; the field ends at the quote before ';'
+  auto end = value.find("';");
+  if (end == std::string_view::npos) {
+    end = value.rfind('\'');
+  }
+  if (end == std::string_view::npos) {
+    return std::nullopt;
+  }
+  return std::string(value.substr(0, end));
+}
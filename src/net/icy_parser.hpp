@@ -0,0 +1,66 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+/**
+ * @class IcyParser
+ * @brief Splits an Icecast/SHOUTcast body into audio and ICY metadata.
+ *
+ * Servers interleave a metadata block after every `icy-metaint` audio bytes.
+ * The parser is fed raw socket reads of any size and hands the audio back as
+ * sub-spans of the very buffer it was given, so the payload is never copied
+ * or compacted; only the (rare, small) metadata text is accumulated.
+ */
+class IcyParser {
+public:
+  using AudioCallback = std::function<void(std::span<const char>)>;
+  using MetadataCallback = std::function<void(const std::string &)>;
+
+  /**
+   * @brief Constructs a parser for the given metadata interval.
+   * @param metaint Audio bytes between metadata blocks, 0 if the server sends
+   * no metadata.
+   */
+  explicit IcyParser(size_t metaint);
+
+  /**
+   * @brief Parses the next bytes of the body.
+   * @param data Bytes as received from the socket.
+   * @param on_audio Called with each audio run, pointing into @p data.
+   * @param on_metadata Called with each complete, non-empty metadata block.
+   */
+  void feed(std::span<const char> data, const AudioCallback &on_audio,
+            const MetadataCallback &on_metadata);
+
+  /**
+   * @brief Extracts `StreamTitle` from a metadata block.
+   * @param metadata Block text such as `StreamTitle='A - B';StreamUrl='';`.
+   * @return The title, or std::nullopt if the block has none.
+   */
+  [[nodiscard]] static auto stream_title(std::string_view metadata)
+      -> std::optional<std::string>;
+
+private:
+  /// Position within the audio/length/metadata cycle.
+  enum class Phase : uint8_t {
+    AUDIO = 0,    ///< Inside an audio run
+    LENGTH = 1,   ///< Expecting the metadata length byte
+    METADATA = 2, ///< Inside a metadata block
+  };
+
+  size_t metaint_;           ///< Audio bytes between metadata blocks
+  Phase phase_{Phase::AUDIO}; ///< Current phase
+  size_t remaining_;         ///< Bytes left in the current phase
+  std::string metadata_;     ///< Metadata block being accumulated
+};
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "icy_stream.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+constexpr int CONNECT_TIMEOUT_MS = 10000;
+constexpr size_t MAX_HEAD = 16U * 1024U;
+
+auto header_value(const HttpResponse &response, const std::string &name)
+    -> std::string {
+  auto found = response.headers.find(name);
+  return (found != response.headers.end()) ? found->second : std::string{};
+}
+
+auto byte_rate_hint(const HttpResponse &response) -> uint32_t {
+  // icy-br is in kbit/s
+  static constexpr uint32_t BYTES_PER_KBIT = 125;
+  const auto bitrate = header_value(response, "icy-br");
+  try {
+    return bitrate.empty() ? 0
+                           : static_cast<uint32_t>(std::stoul(bitrate)) *
+                                 BYTES_PER_KBIT;
+  } catch (const std::exception &) {
+    return 0;
+  }
+}
+
+auto metadata_interval(const HttpResponse &response) -> size_t {
+  const auto metaint = header_value(response, "icy-metaint");
+  if (metaint.empty()) {
+    return 0;
+  }
+  try {
+    if (metaint.find_first_not_of("0123456789") == std::string::npos) {
+      return std::stoul(metaint);
+    }
+  } catch (const std::out_of_range &) {
+  }
+  throw std::runtime_error("Invalid icy-metaint: " + metaint);
+}
+
+// The whole head must arrive within the timeout, not just each packet
+auto read_head(int fd, std::string &rest) -> HttpResponse {
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(CONNECT_TIMEOUT_MS);
+  std::string data;
+  std::array<char, 4096> chunk{};
+  size_t head_end = std::string::npos;
+  while (head_end == std::string::npos) {
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    pollfd pfd{fd, POLLIN, 0};
+    const int ready =
+        poll(&pfd, 1, static_cast<int>(std::max<int64_t>(0, left.count())));
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ready <= 0) {
+      throw std::runtime_error("No stream response headers in time");
+    }
+    const auto received = recv(fd, chunk.data(), chunk.size(), 0);
+    if (received <= 0 || data.size() > MAX_HEAD) {
+      throw std::runtime_error("No stream response headers");
+    }
+    data.append(chunk.data(), static_cast<size_t>(received));
+    head_end = data.find("\r\n\r\n");
+  }
+  rest = data.substr(head_end + 4);
+  return parse_http_head(data.substr(0, head_end));
+}
+
+} // namespace
+
+IcyStream::IcyStream(const std::string &url) {
+  const auto parsed = HttpUrl::parse(url);
+  fd_ = http_connect(parsed, CONNECT_TIMEOUT_MS);
+
+  HttpResponse response;
+  try {
+    const std::string request =
+        "GET " + parsed.path + " HTTP/1.0\r\nHost: " + parsed.host +
+        "\r\nUser-Agent: jpod_nano\r\nIcy-MetaData: 1\r\n\r\n";
+    if (send(fd_, request.data(), request.size(), 0) !=
+        static_cast<ssize_t>(request.size())) {
+      throw std::runtime_error("Cannot send stream request to " + url);
+    }
+    response = read_head(fd_, initial_body_);
+    if (response.status != 200) {
+      throw std::runtime_error("Stream " + url + " answered " +
+                               std::to_string(response.status));
+    }
+    parser_ = IcyParser(metadata_interval(response));
+  } catch (const std::exception &) {
+    close(fd_);
+    throw;
+  }
+
+  station_name_ = header_value(response, "icy-name");
+  buffer_.set_byte_rate(byte_rate_hint(response));
+
+  const int flags = fcntl(fd_, F_GETFL, 0);
+  fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+  receive_thread_ = std::jthread(
+      [this](const std::stop_token &token) { receive_loop(token); });
+}
+
+IcyStream::~IcyStream() {
+  receive_thread_.request_stop();
+  receive_thread_.join();
+  close(fd_);
+}
+
+auto IcyStream::read(std::span<char> out, std::chrono::milliseconds timeout)
+    -> size_t {
+  return buffer_.pop(out, timeout);
+}
+
+auto IcyStream::finished() const -> bool { return buffer_.finished(); }
+
+auto IcyStream::stream_title() const -> std::string {
+  std::lock_guard<std::mutex> lock(title_mutex_);
+  return stream_title_;
+}
+
+auto IcyStream::station_name() const -> const std::string & {
+  return station_name_;
+}
+
+auto IcyStream::jitter_buffer() const -> const JitterBuffer & {
+  return buffer_;
+}
+
+void IcyStream::receive_loop(const std::stop_token &token) {
+  const auto on_audio = [this](std::span<const char> audio) {
+    buffer_.push(audio);
+  };
+  const auto on_metadata = [this](const std::string &metadata) {
+    if (auto title = IcyParser::stream_title(metadata)) {
+      std::lock_guard<std::mutex> lock(title_mutex_);
+      stream_title_ = std::move(*title);
+    }
+  };
+
+  parser_.feed(initial_body_, on_audio, on_metadata);
+  initial_body_.clear();
+
+  std::array<char, 16U * 1024U> chunk{};
+  while (!token.stop_requested()) {
+    pollfd pfd{fd_, POLLIN, 0};
+    static constexpr int POLL_TIMEOUT_MS = 100;
+    const int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+    if (ready < 0 && errno != EINTR) {
+      break;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+    const auto received = recv(fd_, chunk.data(), chunk.size(), 0);
+    if (received == 0) {
+      break;
+    }
+    if (received < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    parser_.feed(std::span{chunk.data(), static_cast<size_t>(received)},
+                 on_audio, on_metadata);
+  }
+  buffer_.close();
+}
@@ -0,0 +1,96 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <chrono>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "http_client.hpp"
+#include "icy_parser.hpp"
+#include "jitter_buffer.hpp"
+
+/**
+ * @class IcyStream
+ * @brief Live Icecast/SHOUTcast MP3 stream client.
+ *
+ * The request is sent with `Icy-MetaData: 1`. The body is then received on
+ * a non-blocking socket by a dedicated thread, split by an IcyParser, and
+ * the audio is queued in an adaptive JitterBuffer for the decoder to pull
+ * with read().
+ */
+class IcyStream {
+public:
+  /**
+   * @brief Connects to the stream and reads the response headers.
+   * @param url The http:// URL of the mount point.
+   * @throws std::runtime_error if the server cannot be reached or does not
+   * answer with status 200.
+   */
+  explicit IcyStream(const std::string &url);
+
+  /**
+   * @brief Destructor.
+   * Stops the receive thread and closes the connection.
+   */
+  ~IcyStream();
+
+  IcyStream(IcyStream &stream) = delete;
+  IcyStream(IcyStream &&stream) = delete;
+
+  auto operator=(IcyStream &stream) -> IcyStream & = delete;
+  auto operator=(IcyStream &&stream) -> IcyStream && = delete;
+
+  /**
+   * @brief Reads buffered audio bytes.
+   * @param out Destination buffer.
+   * @param timeout Maximum time to wait while the jitter buffer fills.
+   * @return Bytes read, 0 on timeout or at the end of the stream.
+   */
+  auto read(std::span<char> out, std::chrono::milliseconds timeout) -> size_t;
+
+  /**
+   * @brief Checks whether the connection ended and all audio was read.
+   * @return true if nothing more will be read.
+   */
+  [[nodiscard]] auto finished() const -> bool;
+
+  /**
+   * @brief Gets the latest ICY `StreamTitle`.
+   * @return Title text, empty until the server sends one.
+   */
+  [[nodiscard]] auto stream_title() const -> std::string;
+
+  /**
+   * @brief Gets the station name from the `icy-name` header.
+   * @return Station name, empty if not provided.
+   */
+  [[nodiscard]] auto station_name() const -> const std::string &;
+
+  /**
+   * @brief Accesses the jitter buffer, e.g. for its target and underruns.
+   * @return The stream's jitter buffer.
+   */
+  [[nodiscard]] auto jitter_buffer() const -> const JitterBuffer &;
+
+private:
+  /// Receives the body and feeds the parser until EOF or stop.
+  void receive_loop(const std::stop_token &token);
+
+  int fd_{-1};                ///< Connected, non-blocking socket
+  std::string station_name_;  ///< icy-name header
+  std::string initial_body_;  ///< Body bytes read along with the headers
+  IcyParser parser_{0};       ///< ICY splitter, set from icy-metaint
+  JitterBuffer buffer_;       ///< Audio waiting for the decoder
+
+  mutable std::mutex title_mutex_; ///< Protects stream_title_
+  std::string stream_title_;       ///< Latest StreamTitle
+
+  std::jthread receive_thread_; ///< Network thread
+};
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "jitter_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <new>
+
+namespace {
+
+constexpr double GAP_WEIGHT = 1.0 / 16.0; ///< RFC 3550 style smoothing
+constexpr uint32_t MAX_BYTE_RATE = 40000; ///< 320 kbps
+constexpr double MS_PER_SECOND = 1000.0;
+
+} // namespace
+
+JitterBuffer::JitterBuffer(uint32_t byte_rate) : byte_rate_(byte_rate) {
+  set_byte_rate(byte_rate);
+}
+
+void JitterBuffer::set_byte_rate(uint32_t byte_rate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  byte_rate_ = byte_rate;
+  // Room for twice the largest target at the highest expected rate
+  const auto capacity = static_cast<size_t>(
+      2 * MAX_TARGET.count() * std::max(byte_rate, MAX_BYTE_RATE) /
+      static_cast<int64_t>(MS_PER_SECOND));
+  if (capacity <= ring_.size()) {
+    return;
+  }
+  try {
+    TaggedVector<char, MemoryTag::STREAM> ring(capacity);
+    for (size_t i = 0; i < size_; ++i) {
+      ring[i] = ring_[(head_ + i) % ring_.size()];
+    }
+    ring_ = std::move(ring);
+    head_ = 0;
+  } catch (const std::bad_alloc &) {
+    if (ring_.empty()) {
+      throw; // Nothing to fall back on: the stream fails to open
+    }
+    // Over the stream budget: keep the ring we have, with less headroom
+    std::cerr << "[WARN] Jitter buffer kept at " << ring_.size()
+              << " bytes by the stream memory budget\n";
+  }
+}
+
+void JitterBuffer::push(std::span<const char> data, Clock::time_point arrival) {
+  if (data.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (total_bytes_ == 0) {
+      first_arrival_ = arrival;
+    } else {
+      const double gap =
+          std::chrono::duration<double, std::milli>(arrival - last_arrival_)
+              .count();
+      const double deviation = gap - mean_gap_ms_;
+      mean_gap_ms_ += GAP_WEIGHT * deviation;
+      var_gap_ms_ += GAP_WEIGHT * ((deviation * deviation) - var_gap_ms_);
+    }
+    last_arrival_ = arrival;
+    total_bytes_ += data.size();
+
+    // Keep only the newest bytes if the reader fell behind
+    if (data.size() > ring_.size()) {
+      data = data.last(ring_.size());
+    }
+    const auto overflow = (size_ + data.size() > ring_.size())
+                              ? size_ + data.size() - ring_.size()
+                              : 0;
+    head_ = (head_ + overflow) % ring_.size();
+    size_ -= overflow;
+
+    auto tail = (head_ + size_) % ring_.size();
+    const auto first = std::min(data.size(), ring_.size() - tail);
+    std::copy_n(data.begin(), first, ring_.begin() + static_cast<long>(tail));
+    std::copy(data.begin() + static_cast<long>(first), data.end(),
+              ring_.begin());
+    size_ += data.size();
+
+    if (!playing_ && size_ >= target_bytes_locked()) {
+      playing_ = true;
+    }
+  }
+  ready_.notify_one();
+}
+
+auto JitterBuffer::pop(std::span<char> out, std::chrono::milliseconds timeout)
+    -> size_t {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const bool ready = ready_.wait_for(lock, timeout, [this] {
+    return (playing_ && size_ > 0) || (closed_ && size_ > 0) ||
+           (closed_ && size_ == 0);
+  });
+  if (size_ == 0) {
+    // Drained while playing: rebuffer to the (possibly larger) target
+    if (playing_ && !closed_) {
+      ++underruns_;
+    }
+    playing_ = false;
+    return 0;
+  }
+  if (!ready) {
+    return 0; // Still prebuffering
+  }
+
+  const auto length = std::min(out.size(), size_);
+  const auto first = std::min(length, ring_.size() - head_);
+  std::copy_n(ring_.begin() + static_cast<long>(head_), first, out.begin());
+  std::copy_n(ring_.begin(), length - first,
+              out.begin() + static_cast<long>(first));
+  head_ = (head_ + length) % ring_.size();
+  size_ -= length;
+  return length;
+}
+
+void JitterBuffer::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  ready_.notify_all();
+}
+
+auto JitterBuffer::finished() const -> bool {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return closed_ && size_ == 0;
+}
+
+auto JitterBuffer::target() const -> std::chrono::milliseconds {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_locked();
+}
+
+auto JitterBuffer::buffered_bytes() const -> size_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+auto JitterBuffer::underruns() const -> uint64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return underruns_;
+}
+
+auto JitterBuffer::target_locked() const -> std::chrono::milliseconds {
+  const double target =
+      mean_gap_ms_ + (JITTER_MULTIPLIER * std::sqrt(var_gap_ms_));
+  return std::clamp(std::chrono::milliseconds(std::llround(target)),
+                    std::chrono::milliseconds(MIN_TARGET),
+                    std::chrono::milliseconds(MAX_TARGET));
+}
+
+auto JitterBuffer::target_bytes_locked() const -> size_t {
+  double byte_rate = byte_rate_;
+  if (byte_rate == 0) {
+    // Until a second of history exists the default rate is a better guess
+    const double elapsed =
+        std::chrono::duration<double>(last_arrival_ - first_arrival_).count();
+    byte_rate = (elapsed >= 1.0) ? static_cast<double>(total_bytes_) / elapsed
+                                 : DEFAULT_BYTE_RATE;
+  }
+  const auto bytes = static_cast<size_t>(
+      byte_rate * static_cast<double>(target_locked().count()) /
+      MS_PER_SECOND);
+  return std::min(bytes, ring_.size());
+}
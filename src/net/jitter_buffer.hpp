@@ -0,0 +1,125 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "../util/memory_accounting.hpp"
+
+/**
+ * @class JitterBuffer
+ * @brief Adaptive byte buffer between a live network stream and the decoder.
+ *
+ * Every push records its arrival time. The mean and variance of the
+ * inter-arrival gaps are tracked with exponentially weighted averages, and
+ * the prebuffer target is `mean + JITTER_MULTIPLIER * stddev`, clamped to
+ * [MIN_TARGET, MAX_TARGET]. Reads are held back until the target is reached
+ * and again after every underrun, so a bursty network grows the buffer and
+ * a smooth one keeps latency low.
+ *
+ * @note All methods are thread-safe; one producer and one consumer expected.
+ */
+class JitterBuffer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr auto MIN_TARGET = std::chrono::milliseconds(250);
+  static constexpr auto MAX_TARGET = std::chrono::milliseconds(8000);
+  static constexpr double JITTER_MULTIPLIER = 4.0; ///< Stddevs of headroom
+  static constexpr uint32_t DEFAULT_BYTE_RATE = 16000; ///< 128 kbps
+
+  /**
+   * @brief Constructs an empty buffer.
+   * @param byte_rate Stream byte rate (e.g. from `icy-br`), 0 to estimate it
+   * from arrivals.
+   */
+  explicit JitterBuffer(uint32_t byte_rate = 0);
+
+  /**
+   * @brief Sets the stream byte rate once it is known.
+   *
+   * A ring too large for the stream memory budget is not grown; the
+   * current one is kept.
+   *
+   * @param byte_rate Bytes per second, 0 to estimate it from arrivals.
+   */
+  void set_byte_rate(uint32_t byte_rate);
+
+  /**
+   * @brief Appends received bytes and updates the arrival statistics.
+   *
+   * If the buffer is full the oldest bytes are dropped: for live audio
+   * falling behind is worse than skipping.
+   *
+   * @param data Received audio bytes.
+   * @param arrival Time the bytes arrived.
+   */
+  void push(std::span<const char> data, Clock::time_point arrival = Clock::now());
+
+  /**
+   * @brief Takes buffered bytes once the prebuffer target is met.
+   * @param out Destination buffer.
+   * @param timeout Maximum time to wait for data.
+   * @return Bytes copied, 0 on timeout, while prebuffering or at the end.
+   */
+  auto pop(std::span<char> out, std::chrono::milliseconds timeout) -> size_t;
+
+  /// Marks the end of the stream; remaining bytes drain without a target.
+  void close();
+
+  /**
+   * @brief Checks whether the stream ended and everything was consumed.
+   * @return true once close() was called and the buffer is empty.
+   */
+  [[nodiscard]] auto finished() const -> bool;
+
+  /**
+   * @brief Gets the current prebuffer target.
+   * @return Target depth in milliseconds of audio.
+   */
+  [[nodiscard]] auto target() const -> std::chrono::milliseconds;
+
+  /**
+   * @brief Gets the number of buffered bytes.
+   * @return Bytes waiting to be read.
+   */
+  [[nodiscard]] auto buffered_bytes() const -> size_t;
+
+  /**
+   * @brief Gets the number of times the reader drained the buffer.
+   * @return Underrun count.
+   */
+  [[nodiscard]] auto underruns() const -> uint64_t;
+
+private:
+  /// Recomputes the target from the gap statistics. Requires mutex_.
+  [[nodiscard]] auto target_locked() const -> std::chrono::milliseconds;
+
+  /// Converts the target to bytes at the current byte rate. Requires mutex_.
+  [[nodiscard]] auto target_bytes_locked() const -> size_t;
+
+  mutable std::mutex mutex_;        ///< Protects all state below
+  std::condition_variable ready_;   ///< Signals data or end of stream
+  TaggedVector<char, MemoryTag::STREAM> ring_; ///< Byte storage
+  size_t head_{0};                  ///< Read index into ring_
+  size_t size_{0};                  ///< Buffered bytes
+  bool playing_{false};             ///< Target reached since last underrun
+  bool closed_{false};              ///< Producer finished
+  uint64_t underruns_{0};           ///< Reader found the buffer empty
+
+  uint32_t byte_rate_;              ///< Known stream rate, 0 if unknown
+  uint64_t total_bytes_{0};         ///< Bytes ever pushed
+  Clock::time_point first_arrival_; ///< Time of the first push
+  Clock::time_point last_arrival_;  ///< Time of the latest push
+  double mean_gap_ms_{0.0};         ///< EWMA of inter-arrival gaps
+  double var_gap_ms_{0.0};          ///< EWMA of squared gap deviation
+};
@@ -0,0 +1,398 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "stream_server.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <stdexcept>
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+void set_non_blocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+void disable_sigpipe([[maybe_unused]] int fd) {
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+auto to_lower(std::string text) -> std::string {
+  std::ranges::transform(text, text.begin(), [](unsigned char chr) {
+    return static_cast<char>(std::tolower(chr));
+  });
+  return text;
+}
+
+} // namespace
+
+StreamServer::StreamServer(uint16_t port, size_t ring_size)
+    : ring_(std::bit_ceil(std::max<size_t>(ring_size, 2 * BURST_ON_CONNECT))),
+      ring_mask_(ring_.size() - 1), max_lag_(ring_.size() - ring_.size() / 4) {
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    throw std::runtime_error("StreamServer: socket() failed");
+  }
+  int one = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  static constexpr int BACKLOG = 1024;
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+          0 ||
+      listen(listen_fd_, BACKLOG) != 0) {
+    close(listen_fd_);
+    throw std::runtime_error("StreamServer: cannot listen on port " +
+                             std::to_string(port));
+  }
+  socklen_t len = sizeof(addr);
+  getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+  port_ = ntohs(addr.sin_port);
+  set_non_blocking(listen_fd_);
+
+  if (pipe(wake_pipe_.data()) != 0) {
+    close(listen_fd_);
+    throw std::runtime_error("StreamServer: pipe() failed");
+  }
+  set_non_blocking(wake_pipe_[0]);
+  set_non_blocking(wake_pipe_[1]);
+
+  server_thread_ =
+      std::jthread([this](const std::stop_token &token) { serve(token); });
+}
+
+StreamServer::~StreamServer() {
+  server_thread_.request_stop();
+  wake();
+  if (server_thread_.joinable()) {
+    server_thread_.join();
+  }
+  for (const auto &listener : listeners_) {
+    close(listener.fd);
+  }
+  close(wake_pipe_[0]);
+  close(wake_pipe_[1]);
+  close(listen_fd_);
+}
+
+void StreamServer::publish(std::span<const char> data) {
+  // Only the tail fits in the ring; older bytes would be overwritten anyway
+  uint64_t pos = write_pos_.load(std::memory_order_relaxed);
+  if (data.size() > ring_.size()) {
+    pos += data.size() - ring_.size();
+    data = data.last(ring_.size());
+  }
+  // Claim before copying: a send that overlaps the copy sees the claim
+  claim_pos_.store(pos + data.size(), std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  const size_t start = pos & ring_mask_;
+  const size_t first = std::min(data.size(), ring_.size() - start);
+  std::copy_n(data.begin(), first, ring_.begin() + start);
+  std::copy(data.begin() + first, data.end(), ring_.begin());
+  write_pos_.store(pos + data.size(), std::memory_order_release);
+  wake();
+}
+
+void StreamServer::set_metadata(const std::string &title) {
+  {
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    metadata_title_ = title;
+  }
+  metadata_version_.fetch_add(1);
+}
+
+auto StreamServer::port() const noexcept -> uint16_t { return port_; }
+
+auto StreamServer::listener_count() const noexcept -> size_t {
+  return listener_count_.load();
+}
+
+void StreamServer::wake() const {
+  const char byte = 0;
+  [[maybe_unused]] auto written = write(wake_pipe_[1], &byte, 1);
+}
+
+void StreamServer::serve(const std::stop_token &token) {
+  std::vector<pollfd> fds;
+  while (!token.stop_requested()) {
+    const uint64_t end = write_pos_.load(std::memory_order_acquire);
+
+    fds.clear();
+    fds.push_back({listen_fd_, POLLIN, 0});
+    fds.push_back({wake_pipe_[0], POLLIN, 0});
+    for (const auto &listener : listeners_) {
+      short events = POLLIN;
+      if (listener.streaming &&
+          (listener.offset < end || !listener.header.empty() ||
+           listener.metadata_sent < listener.metadata.size())) {
+        events = POLLIN | POLLOUT;
+      }
+      fds.push_back({listener.fd, events, 0});
+    }
+
+    static constexpr int POLL_TIMEOUT_MS = 100;
+    if (poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) < 0 && errno != EINTR) {
+      break;
+    }
+
+    if ((fds[1].revents & POLLIN) != 0) {
+      std::array<char, 256> drain{};
+      while (read(wake_pipe_[0], drain.data(), drain.size()) > 0) {
+      }
+    }
+
+    // Service existing listeners; fds[i + 2] matches listeners_[i]
+    size_t kept = 0;
+    for (size_t i = 0; i < listeners_.size(); ++i) {
+      auto &listener = listeners_[i];
+      const auto revents = fds[i + 2].revents;
+      bool alive = (revents & (POLLERR | POLLNVAL)) == 0;
+      if (alive && !listener.streaming && (revents & (POLLIN | POLLHUP)) != 0) {
+        alive = read_request(listener);
+      }
+      if (alive && listener.streaming && (revents & (POLLIN | POLLHUP)) != 0) {
+        alive = discard_input(listener);
+      }
+      if (alive && listener.streaming && (revents & POLLOUT) != 0) {
+        alive = flush(listener);
+      }
+      if (!alive) {
+        if (listener.streaming) {
+          listener_count_.fetch_sub(1);
+        }
+        close(listener.fd);
+        continue;
+      }
+      if (kept != i) {
+        listeners_[kept] = std::move(listener);
+      }
+      ++kept;
+    }
+    listeners_.resize(kept);
+
+    if ((fds[0].revents & POLLIN) != 0) {
+      accept_listeners();
+    }
+  }
+}
+
+void StreamServer::accept_listeners() {
+  while (true) {
+    const int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      return;
+    }
+    set_non_blocking(fd);
+    disable_sigpipe(fd);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    Listener listener;
+    listener.fd = fd;
+    listeners_.push_back(std::move(listener));
+  }
+}
+
+auto StreamServer::read_request(Listener &listener) -> bool {
+  static constexpr size_t MAX_REQUEST = 8192;
+  std::array<char, 1024> chunk{};
+  while (true) {
+    const auto received = recv(listener.fd, chunk.data(), chunk.size(), 0);
+    if (received == 0) {
+      return false;
+    }
+    if (received < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      return false;
+    }
+    listener.request.append(chunk.data(), static_cast<size_t>(received));
+    if (listener.request.size() > MAX_REQUEST) {
+      return false;
+    }
+  }
+
+  if (listener.request.find("\r\n\r\n") == std::string::npos) {
+    return true; // Wait for the rest of the headers
+  }
+  if (!listener.request.starts_with("GET ")) {
+    return false;
+  }
+
+  const auto headers = to_lower(listener.request);
+  listener.wants_metadata =
+      headers.find("\r\nicy-metadata: 1") != std::string::npos ||
+      headers.find("\r\nicy-metadata:1") != std::string::npos;
+  listener.request.clear();
+  listener.request.shrink_to_fit();
+
+  listener.header = "HTTP/1.0 200 OK\r\n"
+                    "Content-Type: audio/mpeg\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "icy-name: jpod_nano\r\n";
+  if (listener.wants_metadata) {
+    listener.header += "icy-metaint: " + std::to_string(ICY_METAINT) + "\r\n";
+  }
+  listener.header += "\r\n";
+
+  const uint64_t end = write_pos_.load(std::memory_order_acquire);
+  listener.offset = end - std::min<uint64_t>(end, BURST_ON_CONNECT);
+  listener.until_metadata = ICY_METAINT;
+  listener.streaming = true;
+  listener_count_.fetch_add(1);
+  return true;
+}
+
+auto StreamServer::discard_input(Listener &listener) -> bool {
+  std::array<char, 256> chunk{};
+  while (true) {
+    const auto received = recv(listener.fd, chunk.data(), chunk.size(), 0);
+    if (received == 0) {
+      return false;
+    }
+    if (received < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+  }
+}
+
+auto StreamServer::flush(Listener &listener) -> bool {
+  while (!listener.header.empty()) {
+    const auto sent = send(listener.fd, listener.header.data(),
+                           listener.header.size(), SEND_FLAGS);
+    if (sent < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    listener.header.erase(0, static_cast<size_t>(sent));
+  }
+
+  const uint64_t end = write_pos_.load(std::memory_order_acquire);
+  if (claim_pos_.load(std::memory_order_relaxed) - listener.offset >
+      max_lag_) {
+    return false; // Fell behind the ring; its bytes are gone or going
+  }
+
+  while (true) {
+    if (listener.metadata_sent < listener.metadata.size()) {
+      const auto sent =
+          send(listener.fd, listener.metadata.data() + listener.metadata_sent,
+               listener.metadata.size() - listener.metadata_sent, SEND_FLAGS);
+      if (sent < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      listener.metadata_sent += static_cast<size_t>(sent);
+      if (listener.metadata_sent < listener.metadata.size()) {
+        return true;
+      }
+      listener.metadata.clear();
+      listener.metadata_sent = 0;
+      listener.until_metadata = ICY_METAINT;
+    }
+
+    if (listener.offset >= end) {
+      return true;
+    }
+
+    uint64_t stop = end;
+    if (listener.wants_metadata) {
+      stop = std::min<uint64_t>(stop,
+                                listener.offset + listener.until_metadata);
+    }
+    const auto sent = send_ring(listener, stop);
+    if (sent < 0) {
+      return false;
+    }
+    if (sent == 0) {
+      return true;
+    }
+
+    // The writer may have lapped us while the kernel copied the bytes
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (claim_pos_.load(std::memory_order_relaxed) - listener.offset >
+        ring_.size()) {
+      return false;
+    }
+    listener.offset += static_cast<uint64_t>(sent);
+
+    if (listener.wants_metadata) {
+      listener.until_metadata -= static_cast<size_t>(sent);
+      if (listener.until_metadata == 0) {
+        listener.metadata = next_metadata_block(listener);
+      }
+    }
+  }
+}
+
+auto StreamServer::send_ring(Listener &listener, uint64_t end) -> ssize_t {
+  const size_t start = listener.offset & ring_mask_;
+  const auto length = static_cast<size_t>(end - listener.offset);
+  const size_t first = std::min(length, ring_.size() - start);
+
+  std::array<iovec, 2> iov{};
+  iov[0] = {ring_.data() + start, first};
+  iov[1] = {ring_.data(), length - first};
+
+  msghdr msg{};
+  msg.msg_iov = iov.data();
+  msg.msg_iovlen = (length > first) ? 2 : 1;
+
+  const auto sent = sendmsg(listener.fd, &msg, SEND_FLAGS);
+  if (sent < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+  return sent;
+}
+
+auto StreamServer::next_metadata_block(Listener &listener) -> std::string {
+  const auto version = metadata_version_.load();
+  if (version == listener.metadata_version) {
+    return std::string(1, '\0'); // Unchanged: empty block
+  }
+  listener.metadata_version = version;
+
+  std::string title;
+  {
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    title = metadata_title_;
+  }
+  std::ranges::replace(title, '\'', '`');
+
+  static constexpr size_t BLOCK_UNIT = 16;
+  static constexpr size_t MAX_PAYLOAD = 255 * BLOCK_UNIT;
+  std::string payload = "StreamTitle='" + title + "';";
+  if (payload.size() > MAX_PAYLOAD) {
+    payload.resize(MAX_PAYLOAD - 2);
+    payload += "';";
+  }
+  const size_t blocks = (payload.size() + BLOCK_UNIT - 1) / BLOCK_UNIT;
+  payload.resize(blocks * BLOCK_UNIT, '\0');
+  return static_cast<char>(blocks) + payload;
+}
@@ -0,0 +1,164 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <sys/types.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class StreamServer
+ * @brief Icecast-style HTTP server fanning out an MP3 byte stream to many
+ * listeners.
+ *
+ * Published bytes are appended once to a shared ring buffer; every listener
+ * only keeps its own absolute send offset into that ring, so adding a
+ * listener costs a socket and a few counters, never a copy of the audio. All
+ * sockets are non-blocking and served from a single thread.
+ *
+ * Listeners that request `Icy-MetaData: 1` receive ICY metadata blocks
+ * interleaved every `ICY_METAINT` audio bytes.
+ *
+ * publish() announces the bytes it is about to overwrite before copying,
+ * and a listener checks that announcement before and after each send, so
+ * audio overwritten under a send is never passed off as intact. Listeners
+ * that fall further behind than the ring capacity less a guard gap are
+ * dropped; the gap leaves room for a publish during a send.
+ */
+class StreamServer {
+public:
+  static constexpr size_t DEFAULT_RING_SIZE = 1U << 20U; ///< 1 MiB of MP3
+  static constexpr size_t ICY_METAINT = 16000;  ///< Audio bytes per metadata
+  static constexpr size_t BURST_ON_CONNECT = 64U * 1024U; ///< Initial backlog
+
+  /**
+   * @brief Binds the listening socket and starts the serving thread.
+   * @param port TCP port on the loopback/any interface, 0 for ephemeral.
+   * @param ring_size Capacity of the shared ring, rounded up to a power of 2
+   * and to at least twice BURST_ON_CONNECT.
+   * @throws std::runtime_error if the socket cannot be created or bound.
+   */
+  explicit StreamServer(uint16_t port, size_t ring_size = DEFAULT_RING_SIZE);
+
+  /**
+   * @brief Destructor.
+   * Stops the serving thread and closes all listener connections.
+   */
+  ~StreamServer();
+
+  StreamServer(StreamServer &server) = delete;
+  StreamServer(StreamServer &&server) = delete;
+
+  auto operator=(StreamServer &server) -> StreamServer & = delete;
+  auto operator=(StreamServer &&server) -> StreamServer && = delete;
+
+  /**
+   * @brief Appends MP3 bytes to the shared ring and wakes the server.
+   * @param data Raw MP3 frames, passed through untouched.
+   */
+  void publish(std::span<const char> data);
+
+  /**
+   * @brief Sets the ICY `StreamTitle` sent to metadata-capable listeners.
+   * @param title Title string, typically "Artist - Title".
+   */
+  void set_metadata(const std::string &title);
+
+  /**
+   * @brief Gets the bound TCP port.
+   * @return The port, useful when constructed with port 0.
+   */
+  [[nodiscard]] auto port() const noexcept -> uint16_t;
+
+  /**
+   * @brief Gets the number of listeners currently receiving audio.
+   * @return Count of connected, handshaken listeners.
+   */
+  [[nodiscard]] auto listener_count() const noexcept -> size_t;
+
+private:
+  /**
+   * @struct Listener
+   * @brief Per-connection send state.
+   */
+  struct Listener {
+    int fd{-1};                   ///< Non-blocking socket
+    bool streaming{false};        ///< HTTP response already sent
+    bool wants_metadata{false};   ///< Client sent Icy-MetaData: 1
+    std::string request;          ///< Partial HTTP request
+    std::string header;           ///< Pending HTTP response header
+    uint64_t offset{0};           ///< Absolute ring position of next byte
+    size_t until_metadata{0};     ///< Audio bytes before next ICY block
+    std::string metadata;         ///< ICY block being sent
+    size_t metadata_sent{0};      ///< Bytes of metadata already sent
+    uint64_t metadata_version{0}; ///< Last metadata version sent
+  };
+
+  /// Serving loop: accepts listeners and flushes the ring to them.
+  void serve(const std::stop_token &token);
+
+  /// Accepts all pending connections on the listening socket.
+  void accept_listeners();
+
+  /**
+   * @brief Reads and parses the HTTP request of a new listener.
+   * @return false if the connection must be closed.
+   */
+  auto read_request(Listener &listener) -> bool;
+
+  /**
+   * @brief Drains bytes a streaming listener sends after its request.
+   * @return false if the peer closed the connection.
+   */
+  auto discard_input(Listener &listener) -> bool;
+
+  /**
+   * @brief Sends as much pending data as the socket accepts.
+   * @return false if the connection must be closed.
+   */
+  auto flush(Listener &listener) -> bool;
+
+  /**
+   * @brief Sends ring bytes in [listener.offset, end) without copying.
+   * @return Bytes sent, or -1 on a fatal socket error.
+   */
+  auto send_ring(Listener &listener, uint64_t end) -> ssize_t;
+
+  /**
+   * @brief Builds the ICY metadata block due for a listener.
+   * @return Length byte followed by the padded `StreamTitle` payload.
+   */
+  auto next_metadata_block(Listener &listener) -> std::string;
+
+  /// Writes one byte to the wake pipe so the poll loop re-evaluates.
+  void wake() const;
+
+  int listen_fd_{-1};             ///< Listening socket
+  std::array<int, 2> wake_pipe_{-1, -1}; ///< Self-pipe for publish wakeups
+  uint16_t port_{0};              ///< Bound port
+
+  std::vector<char> ring_;               ///< Shared MP3 ring buffer
+  size_t ring_mask_{0};                  ///< ring_.size() - 1
+  size_t max_lag_{0};                    ///< Ring size less the guard gap
+  std::atomic<uint64_t> write_pos_{0};   ///< Absolute bytes ever published
+  std::atomic<uint64_t> claim_pos_{0};   ///< write_pos_ once the copy ends
+
+  std::mutex metadata_mutex_;            ///< Protects metadata_title_
+  std::string metadata_title_;           ///< Current StreamTitle
+  std::atomic<uint64_t> metadata_version_{0}; ///< Bumped on every change
+
+  std::vector<Listener> listeners_;      ///< Owned by the serving thread
+  std::atomic<size_t> listener_count_{0}; ///< Streaming listeners
+  std::jthread server_thread_;           ///< Serving thread
+};
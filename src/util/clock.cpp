@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "clock.hpp"
+
+#include <algorithm>
+#include <thread>
+
+auto Clock::steady() -> Clock & {
+  static SteadyClock clock;
+  return clock;
+}
+
+auto SteadyClock::now() const -> time_point {
+  return std::chrono::steady_clock::now();
+}
+
+void SteadyClock::sleep_until(time_point deadline) {
+  std::this_thread::sleep_until(deadline);
+}
+
+void SteadyClock::wait_until(std::condition_variable &condition,
+                             std::unique_lock<std::mutex> &lock,
+                             time_point deadline) {
+  condition.wait_until(lock, deadline);
+}
+
+VirtualClock::VirtualClock(Mode mode) : mode_(mode) {}
+
+auto VirtualClock::now() const -> time_point {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return now_;
+}
+
+void VirtualClock::sleep_until(time_point deadline) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (mode_ == Mode::AUTO_ADVANCE) {
+    now_ = std::max(now_, deadline);
+    lock.unlock();
+    // Let other threads run, as a real sleep would
+    std::this_thread::yield();
+    return;
+  }
+  const auto entry = deadlines_.insert(deadline);
+  changed_.notify_all();
+  changed_.wait(lock, [this, deadline] { return now_ >= deadline; });
+  deadlines_.erase(entry);
+  changed_.notify_all();
+}
+
+void VirtualClock::wait_until(std::condition_variable &condition,
+                              std::unique_lock<std::mutex> &lock,
+                              time_point deadline) {
+  if (mode_ == Mode::AUTO_ADVANCE) {
+    // Block for a notification first; returning at once would let a loop
+    // with nothing to do (e.g. a paused player) spin on a core
+    if (condition.wait_for(lock, POLL_INTERVAL) == std::cv_status::timeout) {
+      std::lock_guard<std::mutex> time_lock(mutex_);
+      now_ = std::max(now_, deadline);
+    }
+    return;
+  }
+  condition.wait_for(lock, POLL_INTERVAL);
+}
+
+void VirtualClock::advance(duration delay) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  now_ += delay;
+  changed_.notify_all();
+  changed_.wait(lock, [this] {
+    return deadlines_.empty() || *deadlines_.begin() > now_;
+  });
+}
+
+auto VirtualClock::elapsed() const -> duration {
+  return now() - time_point{EPOCH};
+}
+
+auto VirtualClock::sleepers() const -> unsigned {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<unsigned>(deadlines_.size());
+}
+
+auto VirtualClock::wait_for_sleepers(unsigned count,
+                                     std::chrono::milliseconds timeout)
+    -> bool {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return changed_.wait_for(lock, timeout,
+                           [this, count] { return deadlines_.size() >= count; });
+}
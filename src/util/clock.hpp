@@ -0,0 +1,181 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+
+/**
+ * @class Clock
+ * @brief Source of time and sleeps for playback timing.
+ *
+ * Everything that paces playback (fades, elapsed time, buffer waits, UI
+ * refresh) reads time and sleeps through a Clock, so tests can substitute a
+ * VirtualClock and run minutes of playback in milliseconds.
+ */
+class Clock {
+public:
+  using duration = std::chrono::steady_clock::duration;
+  using time_point = std::chrono::steady_clock::time_point;
+
+  Clock() = default;
+  virtual ~Clock() = default;
+
+  Clock(Clock &clock) = delete;
+  Clock(Clock &&clock) = delete;
+
+  auto operator=(Clock &clock) -> Clock & = delete;
+  auto operator=(Clock &&clock) -> Clock && = delete;
+
+  /**
+   * @brief Gets the current time.
+   * @return Monotonic time point.
+   */
+  [[nodiscard]] virtual auto now() const -> time_point = 0;
+
+  /**
+   * @brief Blocks the calling thread until a point in time.
+   * @param deadline Time to wake up at.
+   */
+  virtual void sleep_until(time_point deadline) = 0;
+
+  /**
+   * @brief Waits for a notification or a point in time.
+   *
+   * Like std::condition_variable::wait_until() it may return early, so
+   * callers loop on their condition and on now() < deadline.
+   *
+   * @param condition Condition variable notified by other threads.
+   * @param lock Held lock on the mutex guarding the condition.
+   * @param deadline Time to give up at.
+   */
+  virtual void wait_until(std::condition_variable &condition,
+                          std::unique_lock<std::mutex> &lock,
+                          time_point deadline) = 0;
+
+  /**
+   * @brief Blocks the calling thread for a duration.
+   * @param delay Time to sleep.
+   */
+  void sleep_for(duration delay) { sleep_until(now() + delay); }
+
+  /**
+   * @brief Accesses the process-wide real clock.
+   * @return A SteadyClock.
+   */
+  static auto steady() -> Clock &;
+};
+
+/**
+ * @class SteadyClock
+ * @brief Clock backed by std::chrono::steady_clock and real sleeps.
+ */
+class SteadyClock final : public Clock {
+public:
+  [[nodiscard]] auto now() const -> time_point override;
+  void sleep_until(time_point deadline) override;
+  void wait_until(std::condition_variable &condition,
+                  std::unique_lock<std::mutex> &lock,
+                  time_point deadline) override;
+};
+
+/**
+ * @class VirtualClock
+ * @brief Clock whose time only moves when the program says so.
+ *
+ * In AUTO_ADVANCE mode a sleep jumps time forward to its deadline and
+ * returns at once, so a single timing thread (e.g. a Player decoding into a
+ * clock-paced NullSink) runs as fast as the CPU allows while seeing
+ * consistent time. Several threads may share the clock: time stays monotonic
+ * and every sleep ends at or after its deadline, but any thread's sleep moves
+ * time for all of them. Tests that depend on how threads interleave in time
+ * (e.g. a fade superseded mid-step) use MANUAL mode instead.
+ *
+ * In MANUAL mode sleepers block until advance() moves time past their
+ * deadline, which lets a test step loops one tick at a time.
+ */
+class VirtualClock final : public Clock {
+public:
+  /**
+   * @enum Mode
+   * @brief How time moves.
+   */
+  enum class Mode : uint8_t {
+    AUTO_ADVANCE = 0, ///< Sleeps move time forward and never block
+    MANUAL = 1        ///< Only advance() moves time
+  };
+
+  /**
+   * @brief Constructs a clock starting at an arbitrary fixed epoch.
+   * @param mode How time moves.
+   */
+  explicit VirtualClock(Mode mode = Mode::AUTO_ADVANCE);
+
+  [[nodiscard]] auto now() const -> time_point override;
+  void sleep_until(time_point deadline) override;
+
+  /**
+   * @brief Waits for a notification or a point in time.
+   *
+   * AUTO_ADVANCE waits up to POLL_INTERVAL of real time for a notification
+   * and jumps to the deadline if none comes, so an idle waiter blocks rather
+   * than spins. MANUAL polls the condition in POLL_INTERVAL real-time steps,
+   * since advance() cannot notify it.
+   */
+  void wait_until(std::condition_variable &condition,
+                  std::unique_lock<std::mutex> &lock,
+                  time_point deadline) override;
+
+  /**
+   * @brief Moves time forward and wakes the sleepers that are due.
+   *
+   * Returns once every due sleeper has woken up, so a following
+   * wait_for_sleepers() sees them only after they sleep again.
+   *
+   * @param delay Time to add.
+   */
+  void advance(duration delay);
+
+  /**
+   * @brief Gets the time elapsed since construction.
+   * @return Virtual time elapsed.
+   */
+  [[nodiscard]] auto elapsed() const -> duration;
+
+  /**
+   * @brief Gets the number of threads blocked in sleep_until().
+   * @return Sleeper count, always 0 in AUTO_ADVANCE mode.
+   */
+  [[nodiscard]] auto sleepers() const -> unsigned;
+
+  /**
+   * @brief Waits in real time until enough threads are sleeping.
+   *
+   * Lets a MANUAL test know that the loops it drives reached their sleep
+   * before it advances time.
+   *
+   * @param count Sleepers to wait for.
+   * @param timeout Longest real wait.
+   * @return true if count threads are sleeping.
+   */
+  auto wait_for_sleepers(unsigned count, std::chrono::milliseconds timeout)
+      -> bool;
+
+private:
+  static constexpr auto EPOCH = std::chrono::hours(1); ///< Start time
+  static constexpr auto POLL_INTERVAL =
+      std::chrono::milliseconds(1); ///< wait_until() real-time step
+
+  const Mode mode_;                   ///< How time moves
+  mutable std::mutex mutex_;          ///< Protects now_ and deadlines_
+  std::condition_variable changed_;   ///< Time moved or sleepers changed
+  time_point now_{time_point{EPOCH}}; ///< Current virtual time
+  std::multiset<time_point> deadlines_; ///< One per blocked sleeper
+};
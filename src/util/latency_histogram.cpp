@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::record(std::chrono::nanoseconds value) {
+  const auto nanoseconds =
+      static_cast<uint64_t>(std::max<int64_t>(0, value.count()));
+  ++counts_[bucket_of(nanoseconds)];
+  ++count_;
+  max_ = std::max(max_, nanoseconds);
+  sum_ += static_cast<long double>(nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  max_ = std::max(max_, other.max_);
+  sum_ += other.sum_;
+}
+
+void LatencyHistogram::clear() { *this = LatencyHistogram{}; }
+
+auto LatencyHistogram::percentile(double percent) const
+    -> std::chrono::nanoseconds {
+  if (count_ == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  const auto rank = std::clamp<uint64_t>(
+      static_cast<uint64_t>(
+          std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 *
+                    static_cast<double>(count_))),
+      1, count_);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::chrono::nanoseconds(
+          static_cast<int64_t>(std::min(bucket_upper(i), max_)));
+    }
+  }
+  return std::chrono::nanoseconds(static_cast<int64_t>(max_));
+}
+
+auto LatencyHistogram::count() const -> uint64_t { return count_; }
+
+auto LatencyHistogram::max() const -> std::chrono::nanoseconds {
+  return std::chrono::nanoseconds(static_cast<int64_t>(max_));
+}
+
+auto LatencyHistogram::mean() const -> std::chrono::nanoseconds {
+  if (count_ == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::nanoseconds(
+      static_cast<int64_t>(sum_ / static_cast<long double>(count_)));
+}
+
+auto LatencyHistogram::bucket_of(uint64_t value) -> size_t {
+  if (value < SUB_BUCKETS) {
+    return static_cast<size_t>(value);
+  }
+  // Keep the top SUB_BUCKET_BITS + 1 bits: an octave and its sub-bucket
+  const auto exponent = static_cast<unsigned>(std::bit_width(value) - 1);
+  const auto shift = exponent - SUB_BUCKET_BITS;
+  const auto sub = static_cast<size_t>(value >> shift);
+  return ((shift + 1) * SUB_BUCKETS) + (sub - SUB_BUCKETS);
+}
+
+auto LatencyHistogram::bucket_upper(size_t bucket) -> uint64_t {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  const auto shift = static_cast<unsigned>((bucket / SUB_BUCKETS) - 1);
+  const auto sub = static_cast<uint64_t>((bucket % SUB_BUCKETS) + SUB_BUCKETS);
+  return (sub << shift) + ((uint64_t{1} << shift) - 1);
+}
@@ -0,0 +1,91 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size log-linear histogram of durations for tail percentiles.
+ *
+ * Values below 2^SUB_BUCKET_BITS ns are exact; above, each power of two is
+ * split into 2^SUB_BUCKET_BITS buckets, bounding the relative error of a
+ * reported percentile to about 1.6%. Recording is O(1) and never allocates,
+ * so one histogram per thread can be updated on hot paths and merged later.
+ *
+ * @note Not thread-safe; merge per-thread histograms instead of sharing.
+ */
+class LatencyHistogram {
+public:
+  static constexpr unsigned SUB_BUCKET_BITS = 6; ///< 64 buckets per octave
+  static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+  static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  /**
+   * @brief Records one sample.
+   * @param value Duration; negative values count as zero.
+   */
+  void record(std::chrono::nanoseconds value);
+
+  /**
+   * @brief Adds all samples of another histogram.
+   * @param other Histogram to merge in.
+   */
+  void merge(const LatencyHistogram &other);
+
+  /// Drops all samples.
+  void clear();
+
+  /**
+   * @brief Gets a percentile.
+   * @param percent Percentile in [0, 100], e.g. 99.9.
+   * @return Upper bound of the bucket holding it, 0 if empty.
+   */
+  [[nodiscard]] auto percentile(double percent) const
+      -> std::chrono::nanoseconds;
+
+  /**
+   * @brief Gets the number of samples.
+   * @return Sample count.
+   */
+  [[nodiscard]] auto count() const -> uint64_t;
+
+  /**
+   * @brief Gets the largest sample.
+   * @return Exact maximum, 0 if empty.
+   */
+  [[nodiscard]] auto max() const -> std::chrono::nanoseconds;
+
+  /**
+   * @brief Gets the mean of all samples.
+   * @return Exact mean, 0 if empty.
+   */
+  [[nodiscard]] auto mean() const -> std::chrono::nanoseconds;
+
+private:
+  /**
+   * @brief Maps a value to its bucket.
+   * @param value Nanoseconds.
+   * @return Bucket index.
+   */
+  [[nodiscard]] static auto bucket_of(uint64_t value) -> size_t;
+
+  /**
+   * @brief Gets the largest value a bucket holds.
+   * @param bucket Bucket index.
+   * @return Nanoseconds.
+   */
+  [[nodiscard]] static auto bucket_upper(size_t bucket) -> uint64_t;
+
+  std::array<uint64_t, BUCKETS> counts_{}; ///< Samples per bucket
+  uint64_t count_{0};                      ///< Total samples
+  uint64_t max_{0};                        ///< Largest sample
+  long double sum_{0};                     ///< Sum for the mean
+};
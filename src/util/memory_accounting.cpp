@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "memory_accounting.hpp"
+
+#include <atomic>
+
+namespace {
+
+constexpr std::array<std::string_view, MemoryAccounting::TAGS> TAG_NAMES{
+    "playlist", "shuffle", "pcm", "stream", "cache", "index"};
+
+struct Counters {
+  std::atomic<size_t> bytes{0};
+  std::atomic<size_t> peak{0};
+  std::atomic<uint64_t> refused{0};
+  std::atomic<size_t> budget{MemoryAccounting::UNLIMITED};
+};
+
+auto counters(MemoryTag tag) -> Counters & {
+  static std::array<Counters, MemoryAccounting::TAGS> all;
+  return all.at(static_cast<size_t>(tag));
+}
+
+} // namespace
+
+void MemoryAccounting::charge(MemoryTag tag, size_t bytes) {
+  auto &tag_counters = counters(tag);
+  const auto used =
+      tag_counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  if (used > tag_counters.budget.load(std::memory_order_relaxed)) {
+    tag_counters.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    tag_counters.refused.fetch_add(1, std::memory_order_relaxed);
+    throw std::bad_alloc();
+  }
+  auto peak = tag_counters.peak.load(std::memory_order_relaxed);
+  while (used > peak && !tag_counters.peak.compare_exchange_weak(
+                            peak, used, std::memory_order_relaxed)) {
+  }
+}
+
+void MemoryAccounting::release(MemoryTag tag, size_t bytes) noexcept {
+  counters(tag).bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryAccounting::set_budget(MemoryTag tag, size_t bytes) {
+  counters(tag).budget.store(bytes, std::memory_order_relaxed);
+}
+
+auto MemoryAccounting::usage(MemoryTag tag) -> Usage {
+  const auto &tag_counters = counters(tag);
+  return {.bytes = tag_counters.bytes.load(std::memory_order_relaxed),
+          .peak = tag_counters.peak.load(std::memory_order_relaxed),
+          .refused = tag_counters.refused.load(std::memory_order_relaxed),
+          .budget = tag_counters.budget.load(std::memory_order_relaxed)};
+}
+
+auto MemoryAccounting::report() -> std::array<Usage, TAGS> {
+  std::array<Usage, TAGS> all;
+  for (size_t tag = 0; tag < TAGS; ++tag) {
+    all.at(tag) = usage(static_cast<MemoryTag>(tag));
+  }
+  return all;
+}
+
+auto MemoryAccounting::name(MemoryTag tag) -> std::string_view {
+  return TAG_NAMES.at(static_cast<size_t>(tag));
+}
+
+auto MemoryAccounting::parse(std::string_view name)
+    -> std::optional<MemoryTag> {
+  for (size_t tag = 0; tag < TAGS; ++tag) {
+    if (TAG_NAMES.at(tag) == name) {
+      return static_cast<MemoryTag>(tag);
+    }
+  }
+  return std::nullopt;
+}
+
+MemoryCharge::MemoryCharge(MemoryTag tag) noexcept : tag_(tag) {}
+
+MemoryCharge::~MemoryCharge() { MemoryAccounting::release(tag_, bytes_); }
+
+void MemoryCharge::resize(size_t bytes) {
+  if (bytes > bytes_) {
+    MemoryAccounting::charge(tag_, bytes - bytes_);
+  } else {
+    MemoryAccounting::release(tag_, bytes_ - bytes);
+  }
+  bytes_ = bytes;
+}
+
+auto MemoryCharge::bytes() const noexcept -> size_t { return bytes_; }
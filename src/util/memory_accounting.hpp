@@ -0,0 +1,213 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/// Subsystems whose heap memory is accounted separately
+enum class MemoryTag : uint8_t {
+  PLAYLIST, ///< Song paths
+  SHUFFLE,  ///< Play orders and the radio ring
+  PCM,      ///< Decoded audio queued for the outputs
+  STREAM,   ///< Network receive buffers
+  CACHE,    ///< Lookup caches, e.g. songs known to be unplayable
+  INDEX,    ///< Listening history index and its write queue
+  COUNT,
+};
+
+/**
+ * @class MemoryAccounting
+ * @brief Process-wide byte counters and budgets per MemoryTag.
+ *
+ * Containers charge their tag through TaggedAllocator, and memory that no
+ * allocator hands out (mappings, strings behind a public std::string API)
+ * through a MemoryCharge. Counting is a few relaxed atomics per allocation.
+ * A charge that would exceed the tag's budget throws std::bad_alloc, so a
+ * constrained device fails the one oversized load instead of the process.
+ * Charges made on worker threads catch it and degrade, dropping a block or
+ * keeping a smaller buffer, and the refusal is counted.
+ */
+class MemoryAccounting {
+public:
+  static constexpr auto TAGS = static_cast<size_t>(MemoryTag::COUNT);
+  static constexpr size_t UNLIMITED = std::numeric_limits<size_t>::max();
+
+  /**
+   * @struct Usage
+   * @brief Counters of one tag.
+   */
+  struct Usage {
+    size_t bytes{0};          ///< Bytes in use
+    size_t peak{0};           ///< Most bytes in use at once
+    uint64_t refused{0};      ///< Charges refused by the budget
+    size_t budget{UNLIMITED}; ///< Most bytes allowed
+  };
+
+  /**
+   * @brief Counts bytes against a tag.
+   * @param tag Subsystem to charge.
+   * @param bytes Bytes about to be allocated.
+   * @throws std::bad_alloc if the tag's budget would be exceeded.
+   */
+  static void charge(MemoryTag tag, size_t bytes);
+
+  /**
+   * @brief Returns bytes counted by charge().
+   * @param tag Subsystem charged.
+   * @param bytes Bytes freed.
+   */
+  static void release(MemoryTag tag, size_t bytes) noexcept;
+
+  /**
+   * @brief Limits the bytes a tag may use; existing memory is kept.
+   * @param tag Subsystem to limit.
+   * @param bytes Budget, or UNLIMITED.
+   */
+  static void set_budget(MemoryTag tag, size_t bytes);
+
+  /**
+   * @brief Gets the counters of one tag.
+   * @param tag Subsystem.
+   * @return Its usage.
+   */
+  [[nodiscard]] static auto usage(MemoryTag tag) -> Usage;
+
+  /**
+   * @brief Gets the counters of every tag.
+   * @return Usage indexed by MemoryTag.
+   */
+  [[nodiscard]] static auto report() -> std::array<Usage, TAGS>;
+
+  /**
+   * @brief Gets the display name of a tag.
+   * @param tag Subsystem.
+   * @return Lowercase name, e.g. "pcm".
+   */
+  [[nodiscard]] static auto name(MemoryTag tag) -> std::string_view;
+
+  /**
+   * @brief Looks a tag up by its display name.
+   * @param name Name as returned by name().
+   * @return The tag, or std::nullopt if none has that name.
+   */
+  [[nodiscard]] static auto parse(std::string_view name)
+      -> std::optional<MemoryTag>;
+};
+
+/**
+ * @class TaggedAllocator
+ * @brief std::allocator that charges every allocation to a MemoryTag.
+ *
+ * Stateless, so containers using it keep the size and move semantics of
+ * their std::allocator counterparts.
+ *
+ * @tparam T Allocated type.
+ * @tparam Tag Subsystem charged.
+ */
+template <typename T, MemoryTag Tag> class TaggedAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = TaggedAllocator<U, Tag>;
+  };
+
+  TaggedAllocator() noexcept = default;
+
+  template <typename U>
+  TaggedAllocator(const TaggedAllocator<U, Tag> & /*other*/) noexcept {}
+
+  /**
+   * @brief Charges and allocates storage for count objects.
+   * @param count Number of objects.
+   * @return Uninitialized storage.
+   * @throws std::bad_alloc if over budget or out of memory.
+   */
+  auto allocate(size_t count) -> T * {
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    MemoryAccounting::charge(Tag, count * sizeof(T));
+    try {
+      return std::allocator<T>{}.allocate(count);
+    } catch (...) {
+      MemoryAccounting::release(Tag, count * sizeof(T));
+      throw;
+    }
+  }
+
+  /**
+   * @brief Frees storage from allocate() and returns its charge.
+   * @param pointer Storage to free.
+   * @param count Number of objects it was allocated for.
+   */
+  void deallocate(T *pointer, size_t count) noexcept {
+    std::allocator<T>{}.deallocate(pointer, count);
+    MemoryAccounting::release(Tag, count * sizeof(T));
+  }
+
+  template <typename U>
+  auto operator==(const TaggedAllocator<U, Tag> & /*other*/) const noexcept
+      -> bool {
+    return true;
+  }
+};
+
+/// std::vector charged to a tag
+template <typename T, MemoryTag Tag>
+using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+
+/**
+ * @class MemoryCharge
+ * @brief Scoped charge for memory no TaggedAllocator can see.
+ *
+ * Holds a byte count against a tag until it is resized or destroyed.
+ */
+class MemoryCharge {
+public:
+  /**
+   * @brief Starts with nothing charged.
+   * @param tag Subsystem to charge.
+   */
+  explicit MemoryCharge(MemoryTag tag) noexcept;
+
+  /**
+   * @brief Returns the charge.
+   */
+  ~MemoryCharge();
+
+  MemoryCharge(MemoryCharge &charge) = delete;
+  MemoryCharge(MemoryCharge &&charge) = delete;
+  auto operator=(MemoryCharge &charge) -> MemoryCharge & = delete;
+  auto operator=(MemoryCharge &&charge) -> MemoryCharge && = delete;
+
+  /**
+   * @brief Changes the bytes charged.
+   * @param bytes New total.
+   * @throws std::bad_alloc if growing exceeds the budget; the old charge is
+   * kept.
+   */
+  void resize(size_t bytes);
+
+  /**
+   * @brief Gets the bytes charged.
+   * @return Byte count.
+   */
+  [[nodiscard]] auto bytes() const noexcept -> size_t;
+
+private:
+  MemoryTag tag_;   ///< Subsystem charged
+  size_t bytes_{0}; ///< Bytes charged
+};
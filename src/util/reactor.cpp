@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "reactor.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1'000'000'000;
+
+auto to_timespec(std::chrono::nanoseconds value) -> timespec {
+  const auto count = std::max<int64_t>(1, value.count());
+  return {static_cast<time_t>(count / NS_PER_SECOND),
+          static_cast<long>(count % NS_PER_SECOND)};
+}
+
+} // namespace
+
+Reactor::Reactor() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    throw std::runtime_error("epoll_create1 failed");
+  }
+  wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wake_fd_ < 0) {
+    ::close(epoll_fd_);
+    throw std::runtime_error("eventfd failed");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = wake_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+Reactor::~Reactor() {
+  for (const int timer : timers_) {
+    ::close(timer);
+  }
+  ::close(wake_fd_);
+  ::close(epoll_fd_);
+}
+
+void Reactor::watch(int fd, Callback on_readable) {
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  const int operation =
+      handlers_.contains(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  if (epoll_ctl(epoll_fd_, operation, fd, &event) != 0) {
+    throw std::runtime_error("Cannot watch file descriptor " +
+                             std::to_string(fd));
+  }
+  handlers_[fd] = std::make_shared<Callback>(std::move(on_readable));
+}
+
+void Reactor::unwatch(int fd) {
+  if (handlers_.erase(fd) > 0) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  }
+}
+
+auto Reactor::add_timer(std::chrono::nanoseconds interval, Callback callback)
+    -> TimerId {
+  const int timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (timer < 0) {
+    throw std::runtime_error("timerfd_create failed");
+  }
+  timers_.insert(timer);
+  set_timer(timer, interval);
+  watch(timer, [timer, callback = std::move(callback)] {
+    uint64_t expirations = 0;
+    if (read(timer, &expirations, sizeof(expirations)) > 0) {
+      callback();
+    }
+  });
+  return timer;
+}
+
+void Reactor::set_timer(TimerId timer, std::chrono::nanoseconds interval) {
+  const auto period = to_timespec(interval);
+  const itimerspec spec{period, period};
+  timerfd_settime(timer, 0, &spec, nullptr);
+}
+
+void Reactor::cancel_timer(TimerId timer) {
+  if (timers_.erase(timer) > 0) {
+    unwatch(timer);
+    ::close(timer);
+  }
+}
+
+void Reactor::run() {
+  while (!stopped_.load()) {
+    run_once(std::chrono::milliseconds(-1));
+  }
+  stopped_.store(false);
+}
+
+auto Reactor::run_once(std::chrono::milliseconds timeout) -> size_t {
+  std::array<epoll_event, MAX_EVENTS> events{};
+  const int count = epoll_wait(epoll_fd_, events.data(), MAX_EVENTS,
+                               static_cast<int>(timeout.count()));
+  if (count <= 0) {
+    return 0;
+  }
+  wakeups_.fetch_add(1);
+  size_t handled = 0;
+  for (int i = 0; i < count; ++i) {
+    const int fd = events.at(i).data.fd;
+    if (fd == wake_fd_) {
+      uint64_t value = 0;
+      (void)!read(wake_fd_, &value, sizeof(value));
+      continue;
+    }
+    // Earlier handlers may have removed this one
+    const auto handler = handlers_.find(fd);
+    if (handler == handlers_.end()) {
+      continue;
+    }
+    const auto callback = handler->second;
+    (*callback)();
+    ++handled;
+  }
+  return handled;
+}
+
+void Reactor::stop() {
+  stopped_.store(true);
+  const uint64_t one = 1;
+  (void)!write(wake_fd_, &one, sizeof(one));
+}
+
+auto Reactor::wakeups() const -> uint64_t { return wakeups_.load(); }
@@ -0,0 +1,114 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @class Reactor
+ * @brief Single-threaded event loop over epoll, with timerfd timers.
+ *
+ * Runs file descriptor handlers and periodic timers on the thread calling
+ * run(). Handlers may watch, unwatch and cancel, including themselves, from
+ * inside a callback. Only stop() may be called from other threads.
+ */
+class Reactor {
+public:
+  using Callback = std::function<void()>;
+  using TimerId = int; ///< The timer's timerfd
+
+  /**
+   * @brief Creates the epoll instance and its wakeup eventfd.
+   * @throws std::runtime_error if either cannot be created.
+   */
+  Reactor();
+
+  /**
+   * @brief Destructor.
+   * Closes the epoll instance and all timers; watched fds stay open.
+   */
+  ~Reactor();
+
+  Reactor(Reactor &reactor) = delete;
+  Reactor(Reactor &&reactor) = delete;
+
+  auto operator=(Reactor &reactor) -> Reactor & = delete;
+  auto operator=(Reactor &&reactor) -> Reactor && = delete;
+
+  /**
+   * @brief Calls a handler whenever a file descriptor is readable.
+   * @param fd Descriptor to watch; the caller keeps ownership.
+   * @param on_readable Handler, run on the loop thread.
+   * @throws std::runtime_error if epoll rejects the descriptor.
+   */
+  void watch(int fd, Callback on_readable);
+
+  /**
+   * @brief Stops watching a file descriptor.
+   * @param fd A watched descriptor.
+   */
+  void unwatch(int fd);
+
+  /**
+   * @brief Starts a periodic timer.
+   * @param interval Period; the first expiry is one period from now.
+   * @param callback Handler, run once per wakeup even if several periods
+   * elapsed.
+   * @return Timer handle.
+   * @throws std::runtime_error if the timerfd cannot be created.
+   */
+  auto add_timer(std::chrono::nanoseconds interval, Callback callback)
+      -> TimerId;
+
+  /**
+   * @brief Changes the period of a timer, restarting it from now.
+   * @param timer Timer handle.
+   * @param interval New period.
+   */
+  void set_timer(TimerId timer, std::chrono::nanoseconds interval);
+
+  /**
+   * @brief Stops and releases a timer.
+   * @param timer Timer handle.
+   */
+  void cancel_timer(TimerId timer);
+
+  /// Runs handlers until stop() is called, then rearms for another run().
+  void run();
+
+  /**
+   * @brief Waits for events once and runs their handlers.
+   * @param timeout Longest wait; negative waits forever.
+   * @return Number of handlers run.
+   */
+  auto run_once(std::chrono::milliseconds timeout) -> size_t;
+
+  /// Makes run() return after the current handlers; thread-safe.
+  void stop();
+
+  /**
+   * @brief Gets how often the loop woke up with work to do.
+   * @return Wakeups since construction.
+   */
+  [[nodiscard]] auto wakeups() const -> uint64_t;
+
+private:
+  static constexpr int MAX_EVENTS = 16; ///< Events taken per wait
+
+  int epoll_fd_{-1};                 ///< epoll instance
+  int wake_fd_{-1};                  ///< eventfd written by stop()
+  std::atomic<bool> stopped_{false}; ///< stop() was called
+  std::atomic<uint64_t> wakeups_{0}; ///< epoll_wait calls with events
+  std::unordered_map<int, std::shared_ptr<Callback>> handlers_; ///< By fd
+  std::unordered_set<int> timers_;   ///< timerfds this loop owns
+};
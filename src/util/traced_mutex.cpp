@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include "traced_mutex.hpp"
+
+#include <algorithm>
+#include <functional>
+
+TracedMutex::Guard::Guard(TracedMutex &mutex, std::source_location site)
+    : mutex_(mutex) {
+  if (!mutex_.tracing_.load(std::memory_order_relaxed)) {
+    mutex_.mutex_.lock();
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  mutex_.mutex_.lock();
+  const auto locked = std::chrono::steady_clock::now();
+  site_ = &mutex_.site(site);
+  site_->wait.record(locked - start);
+  // The bookkeeping above is the tracer's time, not the caller's hold
+  acquired_ = std::chrono::steady_clock::now();
+}
+
+TracedMutex::Guard::~Guard() {
+  if (site_ != nullptr) {
+    site_->hold.record(std::chrono::steady_clock::now() - acquired_);
+  }
+  mutex_.mutex_.unlock();
+}
+
+void TracedMutex::set_tracing(bool enabled) {
+  tracing_.store(enabled, std::memory_order_relaxed);
+}
+
+auto TracedMutex::is_tracing() const -> bool {
+  return tracing_.load(std::memory_order_relaxed);
+}
+
+auto TracedMutex::report() const -> std::vector<SiteReport> {
+  std::vector<SiteReport> sites;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sites.reserve(sites_.size());
+    for (const auto &site : sites_) {
+      sites.push_back(*site.report);
+    }
+  }
+  std::ranges::sort(sites, std::greater{},
+                    [](const SiteReport &site) { return site.wait.max(); });
+  return sites;
+}
+
+void TracedMutex::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sites_.clear();
+}
+
+auto TracedMutex::site(const std::source_location &location) -> SiteReport & {
+  // Literal addresses and integers only; no string compare under the lock
+  const auto found = std::ranges::find_if(sites_, [&](const Site &site) {
+    return site.line == location.line() && site.file == location.file_name();
+  });
+  if (found != sites_.end()) {
+    return *found->report;
+  }
+  sites_.push_back(Site{location.file_name(), location.line(),
+                        std::make_unique<SiteReport>(SiteReport{
+                            .function = location.function_name(),
+                            .line = location.line(),
+                            .wait = {},
+                            .hold = {}})});
+  return *sites_.back().report;
+}
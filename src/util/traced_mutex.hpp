@@ -0,0 +1,121 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.hpp"
+
+/**
+ * @class TracedMutex
+ * @brief Mutex that can histogram wait and hold times per call site.
+ *
+ * Lock it through a Guard, which records the source line that took it.
+ * With tracing off a Guard is a plain lock and unlock plus one relaxed load.
+ * With tracing on it reads the steady clock before and after acquiring,
+ * once more after its own bookkeeping so that is not billed as hold time,
+ * and before releasing. Both records happen while the mutex is held, so the
+ * histograms need no locking of their own.
+ */
+class TracedMutex {
+public:
+  /**
+   * @struct SiteReport
+   * @brief Times of one call site.
+   */
+  struct SiteReport {
+    std::string function;  ///< Function that takes the lock
+    uint32_t line{0};      ///< Source line of the Guard
+    LatencyHistogram wait; ///< Time blocked before acquiring
+    LatencyHistogram hold; ///< Time between acquiring and releasing
+  };
+
+  /**
+   * @class Guard
+   * @brief Scoped lock that records its call site.
+   */
+  class Guard {
+  public:
+    /**
+     * @brief Locks the mutex.
+     * @param mutex Mutex to lock.
+     * @param site Where the guard is taken; leave defaulted.
+     */
+    explicit Guard(
+        TracedMutex &mutex,
+        std::source_location site = std::source_location::current());
+
+    /**
+     * @brief Unlocks the mutex.
+     */
+    ~Guard();
+
+    Guard(Guard &guard) = delete;
+    Guard(Guard &&guard) = delete;
+    auto operator=(Guard &guard) -> Guard & = delete;
+    auto operator=(Guard &&guard) -> Guard && = delete;
+
+  private:
+    TracedMutex &mutex_;                             ///< Locked mutex
+    SiteReport *site_{nullptr};                      ///< Site, if tracing
+    std::chrono::steady_clock::time_point acquired_; ///< Lock time
+  };
+
+  /**
+   * @brief Starts or stops recording; recorded times are kept.
+   * @param enabled true to record.
+   */
+  void set_tracing(bool enabled);
+
+  /**
+   * @brief Checks whether Guards record.
+   * @return true if tracing.
+   */
+  [[nodiscard]] auto is_tracing() const -> bool;
+
+  /**
+   * @brief Copies the times of every site seen while tracing.
+   *
+   * Takes the mutex, so it waits for the current holder.
+   *
+   * @return Sites, longest worst-case wait first.
+   */
+  [[nodiscard]] auto report() const -> std::vector<SiteReport>;
+
+  /**
+   * @brief Drops all recorded times.
+   */
+  void reset();
+
+private:
+  /**
+   * @struct Site
+   * @brief Key and times of one call site.
+   *
+   * Keyed by the address of the file name literal, which is stable for the
+   * life of the program, so lookups never compare strings.
+   */
+  struct Site {
+    const char *file{nullptr};          ///< source_location::file_name()
+    uint32_t line{0};                   ///< Source line
+    std::unique_ptr<SiteReport> report; ///< Stable address for Guards
+  };
+
+  /// Finds or adds the entry of a site. Requires mutex_.
+  auto site(const std::source_location &location) -> SiteReport &;
+
+  mutable std::mutex mutex_;         ///< The lock itself
+  std::atomic<bool> tracing_{false}; ///< Guards record
+  std::vector<Site> sites_;          ///< Guarded by mutex_
+};
@@ -0,0 +1,208 @@
+#pragma once
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * @class HttpTestServer
+ * @brief Minimal loopback HTTP/1.1 server standing in for the media web
+ * servers in tests.
+ *
+ * Serves in-memory bodies by path, honours single `Range: bytes=a-b`
+ * requests and `If-None-Match` against a per-body ETag, redirects paths,
+ * can emulate an Icecast mount with ICY metadata, and counts the payload bytes it sends so tests can assert how
+ * much was fetched over the network.
+ */
+class HttpTestServer {
+public:
+  HttpTestServer() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+            0 ||
+        listen(listen_fd_, SOMAXCONN) != 0) {
+      throw std::runtime_error("HttpTestServer: cannot listen");
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::jthread([this](const std::stop_token &token) {
+      while (!token.stop_requested()) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        static constexpr int POLL_MS = 20;
+        if (poll(&pfd, 1, POLL_MS) <= 0) {
+          continue;
+        }
+        const int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd >= 0) {
+          serve(fd);
+          close(fd);
+        }
+      }
+    });
+  }
+
+  ~HttpTestServer() {
+    thread_.request_stop();
+    thread_.join();
+    close(listen_fd_);
+  }
+
+  HttpTestServer(HttpTestServer &server) = delete;
+  HttpTestServer(HttpTestServer &&server) = delete;
+  auto operator=(HttpTestServer &server) -> HttpTestServer & = delete;
+  auto operator=(HttpTestServer &&server) -> HttpTestServer && = delete;
+
+  /// Serves @p body at @p path; replacing a body changes its ETag.
+  void add(const std::string &path, std::string body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bodies_[path] = std::move(body);
+    etags_[path] = "\"" + std::to_string(++version_) + "\"";
+  }
+
+  /// Answers @p from with a 302 to the host-relative @p to.
+  void redirect(const std::string &from, const std::string &to) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    redirects_[from] = to;
+  }
+
+  /// Serves @p audio as a live ICY stream with @p title every @p metaint.
+  void add_icy_stream(const std::string &path, const std::string &audio,
+                      size_t metaint, const std::string &title) {
+    std::string block = "StreamTitle='" + title + "';";
+    block.resize(((block.size() + 15) / 16) * 16, '\0');
+    std::string body;
+    for (size_t pos = 0; pos < audio.size(); pos += metaint) {
+      body += audio.substr(pos, metaint);
+      if (pos + metaint <= audio.size()) {
+        body += static_cast<char>(block.size() / 16);
+        body += block;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    icy_bodies_[path] = "ICY 200 OK\r\nicy-name: Test FM\r\nicy-br: 128\r\n"
+                        "icy-metaint: " +
+                        std::to_string(metaint) + "\r\n\r\n" + body;
+  }
+
+  /// Answers @p path with @p response verbatim, head included.
+  void add_raw(const std::string &path, std::string response) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    icy_bodies_[path] = std::move(response);
+  }
+
+  [[nodiscard]] auto url(const std::string &path) const -> std::string {
+    return "http://127.0.0.1:" + std::to_string(port_) + path;
+  }
+
+  [[nodiscard]] auto served_bytes() const -> uint64_t { return served_; }
+
+  [[nodiscard]] auto requests() const -> uint64_t { return requests_; }
+
+  void ignore_ranges(bool ignore) { ignore_ranges_ = ignore; }
+
+private:
+  void serve(int fd) {
+    std::string request;
+    char chr = 0;
+    while (!request.ends_with("\r\n\r\n") && recv(fd, &chr, 1, 0) == 1) {
+      request += chr;
+    }
+    ++requests_;
+
+    const auto path_start = request.find(' ') + 1;
+    const auto path =
+        request.substr(path_start, request.find(' ', path_start) - path_start);
+    std::string body;
+    std::string etag;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (auto moved = redirects_.find(path); moved != redirects_.end()) {
+        send_all(fd, "HTTP/1.1 302 Found\r\nLocation: " + moved->second +
+                         "\r\nContent-Length: 0\r\n\r\n");
+        return;
+      }
+      if (auto icy = icy_bodies_.find(path); icy != icy_bodies_.end()) {
+        send_all(fd, icy->second);
+        return;
+      }
+      auto found = bodies_.find(path);
+      if (found == bodies_.end()) {
+        send_all(fd, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        return;
+      }
+      body = found->second;
+      etag = etags_[path];
+    }
+
+    if (request.find("If-None-Match: " + etag + "\r\n") != std::string::npos) {
+      send_all(fd, "HTTP/1.1 304 Not Modified\r\nETag: " + etag + "\r\n\r\n");
+      return;
+    }
+
+    const auto range = request.find("Range: bytes=");
+    if (range == std::string::npos || ignore_ranges_) {
+      send_all(fd, "HTTP/1.1 200 OK\r\nETag: " + etag +
+                       "\r\nContent-Length: " + std::to_string(body.size()) +
+                       "\r\n\r\n" + body);
+      served_ += body.size();
+      return;
+    }
+    const auto spec = request.substr(range + 13);
+    const auto first = std::stoull(spec);
+    auto last = std::stoull(spec.substr(spec.find('-') + 1));
+    last = std::min<uint64_t>(last, body.size() - 1);
+    const auto part = body.substr(first, last - first + 1);
+    send_all(fd, "HTTP/1.1 206 Partial Content\r\nETag: " + etag +
+                     "\r\nContent-Length: " +
+                     std::to_string(part.size()) + "\r\nContent-Range: bytes " +
+                     std::to_string(first) + "-" + std::to_string(last) + "/" +
+                     std::to_string(body.size()) + "\r\n\r\n" + part);
+    served_ += part.size();
+  }
+
+  static void send_all(int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      const auto result = send(fd, data.data() + sent, data.size() - sent, 0);
+      if (result <= 0) {
+        return;
+      }
+      sent += static_cast<size_t>(result);
+    }
+  }
+
+  int listen_fd_{-1};
+  uint16_t port_{0};
+  std::mutex mutex_;
+  std::map<std::string, std::string> bodies_;
+  std::map<std::string, std::string> icy_bodies_;
+  std::map<std::string, std::string> etags_;
+  std::map<std::string, std::string> redirects_;
+  uint64_t version_{0};
+  std::atomic<uint64_t> served_{0};
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<bool> ignore_ranges_{false};
+  std::jthread thread_;
+};
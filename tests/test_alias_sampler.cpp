@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../src/audio/alias_sampler.hpp"
+
+namespace {
+
+/// Counts the picks of each item over many draws
+auto histogram(const AliasSampler &sampler, size_t draws)
+    -> std::vector<size_t> {
+  std::mt19937_64 random(42);
+  std::vector<size_t> counts(sampler.size(), 0);
+  for (size_t draw = 0; draw < draws; ++draw) {
+    ++counts.at(sampler.pick(random));
+  }
+  return counts;
+}
+
+} // namespace
+
+TEST(AliasSamplerTest, PicksInProportionToWeights) {
+  static constexpr size_t DRAWS = 200000;
+  const AliasSampler sampler({1.0, 2.0, 0.0, 5.0});
+  EXPECT_DOUBLE_EQ(sampler.total(), 8.0);
+
+  const auto counts = histogram(sampler, DRAWS);
+  EXPECT_EQ(counts[2], 0U);
+  EXPECT_NEAR(static_cast<double>(counts[0]) / DRAWS, 1.0 / 8, 0.01);
+  EXPECT_NEAR(static_cast<double>(counts[1]) / DRAWS, 2.0 / 8, 0.01);
+  EXPECT_NEAR(static_cast<double>(counts[3]) / DRAWS, 5.0 / 8, 0.01);
+}
+
+TEST(AliasSamplerTest, SpansBlocksAndUpdatesOneWeight) {
+  static constexpr size_t ITEMS = 1000; // Several blocks
+  static constexpr size_t DRAWS = 100000;
+  std::vector<double> weights(ITEMS, 1.0);
+  weights[ITEMS - 1] = ITEMS; // Half of the total, in the short last block
+  AliasSampler sampler(weights);
+
+  auto counts = histogram(sampler, DRAWS);
+  EXPECT_NEAR(static_cast<double>(counts[ITEMS - 1]) / DRAWS, 0.5, 0.01);
+
+  sampler.set_weight(ITEMS - 1, 0.0);
+  sampler.set_weight(7, -3.0); // Clamped to 0
+  EXPECT_DOUBLE_EQ(sampler.weight(7), 0.0);
+  EXPECT_DOUBLE_EQ(sampler.total(), ITEMS - 2);
+  counts = histogram(sampler, DRAWS);
+  EXPECT_EQ(counts[ITEMS - 1], 0U);
+  EXPECT_EQ(counts[7], 0U);
+}
+
+TEST(AliasSamplerTest, AllZeroWeightsPickUniformly) {
+  static constexpr size_t DRAWS = 40000;
+  const AliasSampler sampler({0.0, 0.0, 0.0, 0.0});
+  for (const auto count : histogram(sampler, DRAWS)) {
+    EXPECT_NEAR(static_cast<double>(count) / DRAWS, 0.25, 0.02);
+  }
+}
@@ -7,11 +7,17 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <string_view>
 
+#include "../src/audio/null_sink.hpp"
 #include "../src/cli/cli.hpp"
 
+using namespace std::chrono_literals;
+
 class CLITest : public ::testing::Test {
 protected:
   void SetUp() override {
@@ -22,15 +28,27 @@ protected:
 
   void handle_key(int chr) { cli.handle_key(chr); }
 
+  void handle_input(std::string_view input) {
+    cli.handle_input(std::span{input.data(), input.size()});
+  }
+
   [[nodiscard]] auto get_volume() const -> float { return player.get_volume(); }
 
   [[nodiscard]] static auto sigint_received() -> bool {
     return CLI::sigint_received_;
   }
 
+  void display_loop(const std::stop_token &token) { cli.display_loop(token); }
+
+  void stop() { cli.running_ = false; }
+
+  static void reset_sigint() { CLI::sigint_received_ = false; }
+
   std::string test_dir;
-  Player player;
-  CLI cli{player};
+  VirtualClock clock;
+  Player player{std::make_unique<NullSink>(clock), clock};
+  VirtualClock ui_clock{VirtualClock::Mode::MANUAL};
+  CLI cli{player, ui_clock};
 };
 
 TEST_F(CLITest, HandlesPlayPauseToggle) {
@@ -59,6 +77,13 @@ TEST_F(CLITest, HandlesNextAndPrev) {
   EXPECT_EQ(player.get_title(), original);
 }
 
+TEST_F(CLITest, HandlesRawInputWithArrowKeys) {
+  handle_input(" \x1b[C-");
+  EXPECT_TRUE(player.is_playing());
+  EXPECT_LT(get_volume(), 1.0F);
+  EXPECT_GE(player.get_progress().first, 0);
+}
+
 TEST_F(CLITest, HandlesShuffleWithPlaylist) {
   handle_key('s');
   SUCCEED(); // If no crash or throw, success
@@ -68,4 +93,44 @@ TEST_F(CLITest, HandlesQuitKey) {
   EXPECT_FALSE(sigint_received());
   handle_key('q');
   EXPECT_TRUE(sigint_received());
-}
\ No newline at end of file
+}
+TEST_F(CLITest, BrowsesFiltersAndPlaysASong) {
+  reset_sigint();
+  std::ostringstream output;
+  auto *previous = std::cout.rdbuf(output.rdbuf());
+  handle_key('b');
+  handle_input("SONG2q"); // Typed into the filter, not commands
+  EXPECT_FALSE(sigint_received());
+  handle_key(0x7f);
+  handle_input("\x1b[B"); // Clamped: one match
+  handle_key('\n');
+  std::cout.rdbuf(previous);
+
+  EXPECT_NE(output.str().find("> song2.mp3"), std::string::npos);
+  EXPECT_NE(player.get_playlist()->current().find("song2.mp3"),
+            std::string::npos);
+  EXPECT_TRUE(player.is_playing());
+  handle_key(' '); // Back to playback controls
+  EXPECT_FALSE(player.is_playing());
+}
+
+TEST_F(CLITest, DisplayRefreshesOncePerTick) {
+  reset_sigint();
+  std::ostringstream output;
+  auto *previous = std::cout.rdbuf(output.rdbuf());
+  {
+    std::jthread display(
+        [this](const std::stop_token &token) { display_loop(token); });
+    for (int tick = 0; tick < 3; ++tick) {
+      ASSERT_TRUE(ui_clock.wait_for_sleepers(1, 1s));
+      ui_clock.advance(100ms);
+    }
+    ASSERT_TRUE(ui_clock.wait_for_sleepers(1, 1s));
+    stop();
+    ui_clock.advance(100ms);
+  }
+  std::cout.rdbuf(previous);
+
+  const auto text = output.str();
+  EXPECT_EQ(std::count(text.begin(), text.end(), '\r'), 4);
+}
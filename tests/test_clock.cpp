@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/null_sink.hpp"
+#include "../src/util/clock.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(ClockTest, SteadyClockSleeps) {
+  auto &clock = Clock::steady();
+  const auto start = clock.now();
+  clock.sleep_for(5ms);
+  EXPECT_GE(clock.now() - start, 5ms);
+}
+
+TEST(VirtualClockTest, AutoAdvanceJumpsToDeadline) {
+  VirtualClock clock;
+  const auto start = clock.now();
+  const auto real_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 1000; ++i) {
+    clock.sleep_for(1s);
+  }
+  EXPECT_EQ(clock.now() - start, 1000s);
+  EXPECT_EQ(clock.elapsed(), 1000s);
+  EXPECT_LT(std::chrono::steady_clock::now() - real_start, 1s);
+
+  // Deadlines in the past never move time backwards
+  clock.sleep_until(start);
+  EXPECT_EQ(clock.elapsed(), 1000s);
+}
+
+TEST(VirtualClockTest, ManualSleepersWaitForAdvance) {
+  VirtualClock clock(VirtualClock::Mode::MANUAL);
+  std::atomic<int> ticks{0};
+  std::jthread loop([&](const std::stop_token &token) {
+    while (!token.stop_requested()) {
+      clock.sleep_for(100ms);
+      ticks.fetch_add(1);
+    }
+  });
+
+  ASSERT_TRUE(clock.wait_for_sleepers(1, 1s));
+  EXPECT_EQ(ticks.load(), 0);
+  clock.advance(50ms);
+  EXPECT_EQ(clock.sleepers(), 1U);
+  EXPECT_EQ(ticks.load(), 0);
+
+  clock.advance(50ms);
+  ASSERT_TRUE(clock.wait_for_sleepers(1, 1s));
+  EXPECT_EQ(ticks.load(), 1);
+
+  clock.advance(250ms);
+  ASSERT_TRUE(clock.wait_for_sleepers(1, 1s));
+  EXPECT_EQ(ticks.load(), 2);
+
+  loop.request_stop();
+  clock.advance(100ms);
+}
+
+TEST(VirtualClockTest, WaitUntilReturnsOnNotifyOrDeadline) {
+  VirtualClock automatic;
+  std::condition_variable condition;
+  std::mutex mutex;
+  std::unique_lock<std::mutex> lock(mutex);
+  const auto timeout = automatic.now() + 30s;
+  while (automatic.now() < timeout) {
+    automatic.wait_until(condition, lock, timeout);
+  }
+  EXPECT_EQ(automatic.elapsed(), 30s);
+
+  VirtualClock manual(VirtualClock::Mode::MANUAL);
+  const auto deadline = manual.now() + 1s;
+  bool woken = false;
+  std::jthread notifier([&] {
+    std::this_thread::sleep_for(5ms);
+    std::lock_guard<std::mutex> guard(mutex);
+    woken = true;
+    condition.notify_all();
+  });
+  while (!woken && manual.now() < deadline) {
+    manual.wait_until(condition, lock, deadline);
+  }
+  EXPECT_TRUE(woken);
+  EXPECT_EQ(manual.elapsed(), 0s);
+}
+
+TEST(VirtualClockTest, AutoWaitBlocksForANotificationBeforeJumping) {
+  VirtualClock clock;
+  std::condition_variable condition;
+  std::mutex mutex;
+  std::unique_lock<std::mutex> lock(mutex);
+  bool woken = false;
+  std::jthread notifier([&] {
+    std::lock_guard<std::mutex> guard(mutex);
+    woken = true;
+    condition.notify_all();
+  });
+  // The notifier needs the mutex, so it only gets in while we really wait;
+  // a wait that returned at once would burn through the limit instead
+  static constexpr auto LIMIT = 1000s;
+  while (!woken && clock.elapsed() < LIMIT) {
+    clock.wait_until(condition, lock, clock.now() + 1s);
+  }
+  lock.unlock(); // Lets a starved notifier finish
+  EXPECT_TRUE(woken);
+  EXPECT_LT(clock.elapsed(), LIMIT);
+}
+
+TEST(NullSinkClockTest, PlaysOutAtFormatRate) {
+  VirtualClock clock(VirtualClock::Mode::MANUAL);
+  NullSink sink(clock);
+  const AudioFormat format{1000, 2};
+  sink.open(format);
+  std::vector<int16_t> block(2000); // One second
+  sink.write(block);
+
+  // Paused sinks hold their audio
+  clock.advance(500ms);
+  EXPECT_EQ(sink.queued_bytes(), 4000U);
+
+  sink.resume();
+  clock.advance(250ms);
+  EXPECT_EQ(sink.queued_bytes(), 3000U);
+  EXPECT_EQ(sink.played_bytes(), 1000U);
+
+  sink.pause();
+  clock.advance(1s);
+  EXPECT_EQ(sink.queued_bytes(), 3000U);
+
+  sink.resume();
+  clock.advance(2s);
+  EXPECT_EQ(sink.queued_bytes(), 0U);
+  EXPECT_EQ(sink.played_bytes(), 4000U);
+
+  // An idle device starts the next block when it arrives
+  EXPECT_EQ(sink.underruns(), 0U);
+  sink.write(block);
+  EXPECT_EQ(sink.underruns(), 1U);
+  clock.advance(500ms);
+  EXPECT_EQ(sink.queued_bytes(), 2000U);
+  sink.clear();
+  EXPECT_EQ(sink.queued_bytes(), 0U);
+}
+
+TEST(NullSinkClockTest, CountsOnlyGapsAsUnderruns) {
+  VirtualClock clock(VirtualClock::Mode::MANUAL);
+  NullSink sink(clock);
+  sink.open({1000, 1});
+  sink.resume();
+  std::vector<int16_t> block(100); // 100 ms
+
+  // Topped up in time, including right as the queue runs out
+  sink.write(block);
+  clock.advance(50ms);
+  sink.write(block);
+  clock.advance(150ms);
+  sink.write(block);
+  EXPECT_EQ(sink.underruns(), 0U);
+
+  const auto dry_at = clock.now() + 100ms;
+  clock.advance(150ms);
+  sink.write(block);
+  EXPECT_EQ(sink.underruns(), 1U);
+  ASSERT_EQ(sink.glitches().size(), 1U);
+  EXPECT_EQ(sink.glitches()[0].at, dry_at);
+  EXPECT_EQ(sink.glitches()[0].gap, 50ms);
+
+  // Running dry before a pause or a new track is not a gap
+  clock.advance(150ms);
+  sink.pause();
+  sink.resume();
+  sink.write(block);
+  clock.advance(150ms);
+  sink.open({1000, 1});
+  sink.resume();
+  sink.write(block);
+  EXPECT_EQ(sink.underruns(), 1U);
+  EXPECT_EQ(sink.glitches().size(), 1U);
+}
+
+TEST(NullSinkClockTest, KeepsFractionalFrames) {
+  VirtualClock clock(VirtualClock::Mode::MANUAL);
+  NullSink sink(clock);
+  sink.open({44100, 2});
+  sink.resume();
+  std::vector<int16_t> block(88200);
+  sink.write(block);
+  for (int i = 0; i < 1000; ++i) {
+    clock.advance(1ms);
+    (void)sink.queued_bytes();
+  }
+  EXPECT_EQ(sink.queued_bytes(), 0U);
+}
+
+TEST(NullSinkClockTest, UnpacedWithoutClock) {
+  NullSink sink;
+  sink.open({44100, 2});
+  std::vector<int16_t> block(1000);
+  sink.write(block);
+  EXPECT_EQ(sink.queued_bytes(), 0U);
+  EXPECT_EQ(sink.played_bytes(), 2000U);
+  EXPECT_EQ(sink.samples_written(), 1000U);
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include "../src/net/clock_sync.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int64_t OFFSET_NS = 5'000'000'000; ///< Leader clock lead
+constexpr double DRIFT = 200e-6;             ///< Leader clock runs fast
+constexpr int64_t ONE_MS_NS = 1'000'000;
+
+/// Leader time base skewed against the local steady clock.
+auto skewed_now() -> int64_t {
+  const auto now = steady_now_ns();
+  return now + OFFSET_NS + static_cast<int64_t>(static_cast<double>(now) * DRIFT);
+}
+
+template <typename Predicate> auto eventually(Predicate predicate) -> bool {
+  for (int i = 0; i < 300; ++i) {
+    if (predicate()) {
+      return true;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  return predicate();
+}
+
+} // namespace
+
+TEST(ClockEstimatorTest, RecoversOffsetAndDriftDespiteQueuing) {
+  std::mt19937 random(42);
+  std::exponential_distribution<double> queuing(1.0 / 2e6);
+  ClockEstimator estimator;
+
+  static constexpr int64_t LOCAL_START = 1'000'000'000'000;
+  static constexpr int64_t ONE_WAY = 50'000;
+  for (int i = 0; i < 64; ++i) {
+    const int64_t t1 = LOCAL_START + (i * 100 * ONE_MS_NS);
+    // Every other exchange suffers up to milliseconds of queuing
+    const auto extra =
+        i % 2 == 0 ? 0 : static_cast<int64_t>(queuing(random));
+    const auto leader = [](int64_t local) {
+      return local + OFFSET_NS +
+             static_cast<int64_t>(static_cast<double>(local) * DRIFT);
+    };
+    const int64_t t2 = leader(t1 + ONE_WAY + extra);
+    const int64_t t3 = t2 + 10'000;
+    const int64_t t4 = t1 + (2 * ONE_WAY) + extra + 10'000;
+    estimator.add(t1, t2, t3, t4);
+  }
+
+  ASSERT_TRUE(estimator.synchronized());
+  const int64_t local = LOCAL_START + (7 * 1'000 * ONE_MS_NS);
+  const int64_t truth =
+      local + OFFSET_NS + static_cast<int64_t>(static_cast<double>(local) * DRIFT);
+  EXPECT_NEAR(static_cast<double>(estimator.to_leader(local)),
+              static_cast<double>(truth), 50'000.0);
+  EXPECT_NEAR(estimator.drift_ppm(), DRIFT * 1e6, 5.0);
+  EXPECT_EQ(estimator.round_trip_ns(), 2 * ONE_WAY);
+}
+
+TEST(ClockEstimatorTest, NeedsSeveralExchanges) {
+  ClockEstimator estimator;
+  estimator.add(0, 10, 20, 30);
+  EXPECT_FALSE(estimator.synchronized());
+}
+
+TEST(MediaClockTest, ExtrapolatesOnlyWhilePlaying) {
+  MediaClock clock{1'000'000'000, 44100, 44100, true, "a.mp3"};
+  EXPECT_EQ(clock.frame_at(1'500'000'000), 44100 + 22050);
+  clock.playing = false;
+  EXPECT_EQ(clock.frame_at(1'500'000'000), 44100);
+}
+
+TEST(ClockSyncTest, FollowerTracksLeaderInAnotherProcess) {
+  int ready[2];
+  ASSERT_EQ(pipe(ready), 0);
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    // Leader zone: skewed clock, publishes a playing media clock
+    close(ready[0]);
+    {
+      ClockLeader leader(0, skewed_now);
+      leader.publish({leader.now(), 0, 48000, true, "/music/song.mp3"});
+      const uint16_t port = leader.port();
+      (void)!write(ready[1], &port, sizeof(port));
+      std::this_thread::sleep_for(3s);
+    }
+    _exit(0);
+  }
+  close(ready[1]);
+  uint16_t port = 0;
+  ASSERT_EQ(read(ready[0], &port, sizeof(port)),
+            static_cast<ssize_t>(sizeof(port)));
+  close(ready[0]);
+
+  {
+    ClockFollower follower("127.0.0.1", port, 20ms);
+    ASSERT_TRUE(eventually([&] { return follower.synchronized(); }));
+    std::this_thread::sleep_for(500ms);
+
+    const auto local = steady_now_ns();
+    const auto error = follower.to_leader(local) - skewed_now();
+    EXPECT_LT(std::abs(error), ONE_MS_NS);
+    EXPECT_LT(follower.round_trip_ns(), 10 * ONE_MS_NS);
+
+    const auto clock = follower.media_clock();
+    ASSERT_TRUE(clock);
+    EXPECT_TRUE(clock->playing);
+    EXPECT_EQ(clock->sample_rate, 48000);
+    EXPECT_EQ(clock->path, "/music/song.mp3");
+    // One second on the leader is one second of media
+    EXPECT_NEAR(static_cast<double>(
+                    clock->frame_at(follower.leader_now()) -
+                    clock->frame_at(follower.leader_now() - 1'000'000'000)),
+                48000.0, 1.0);
+  }
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status));
+}
+
+TEST(ClockSyncTest, LeaderServesSeveralFollowers) {
+  ClockLeader leader(0);
+  ClockFollower first("127.0.0.1", leader.port(), 20ms);
+  ClockFollower second("localhost", leader.port(), 20ms);
+  ASSERT_TRUE(eventually(
+      [&] { return first.synchronized() && second.synchronized(); }));
+  const auto now = steady_now_ns();
+  EXPECT_LT(std::abs(first.to_leader(now) - second.to_leader(now)), ONE_MS_NS);
+  EXPECT_GE(leader.requests_served(), 2 * ClockEstimator::MIN_SAMPLES);
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "../src/audio/decoder_calibration.hpp"
+#include "../src/audio/null_sink.hpp"
+#include "../src/audio/player.hpp"
+
+namespace fs = std::filesystem;
+
+class DecoderCalibrationTest : public ::testing::Test {
+protected:
+  void TearDown() override { fs::remove_all(directory); }
+
+  fs::path directory = fs::temp_directory_path() / "jpod_nano_decoder_test";
+  fs::path cache = directory / "decoder";
+};
+
+TEST_F(DecoderCalibrationTest, FrameSetIsBackToBackFrames) {
+  const auto frames = DecoderCalibration::frame_set();
+  ASSERT_EQ(frames.size() % DecoderCalibration::FRAMES, 0U);
+  const auto frame_bytes = frames.size() / DecoderCalibration::FRAMES;
+  for (size_t offset = 0; offset < frames.size(); offset += frame_bytes) {
+    ASSERT_EQ(frames[offset], 0xFF);
+    ASSERT_EQ(frames[offset + 1], 0xFB);
+  }
+}
+
+TEST_F(DecoderCalibrationTest, MeasuresSupportedDecodersFastestFirst) {
+  const auto timings = DecoderCalibration::measure();
+  ASSERT_FALSE(timings.empty());
+  for (size_t i = 1; i < timings.size(); ++i) {
+    EXPECT_LE(timings[i - 1].time, timings[i].time);
+  }
+  EXPECT_GT(timings.front().time.count(), 0);
+}
+
+TEST_F(DecoderCalibrationTest, PersistsTheChoice) {
+  DecoderCalibration calibration(cache);
+  EXPECT_FALSE(calibration.cached());
+  const auto decoder = calibration.select();
+  ASSERT_FALSE(decoder.empty());
+  EXPECT_EQ(calibration.cached(), decoder);
+  EXPECT_EQ(DecoderCalibration(cache).select(), decoder);
+}
+
+TEST_F(DecoderCalibrationTest, IgnoresCacheFromAnotherMachine) {
+  fs::create_directories(directory);
+  std::ofstream(cache) << "cpu=elsewhere decoders=generic,\ngeneric\n";
+  EXPECT_FALSE(DecoderCalibration(cache).cached());
+}
+
+TEST_F(DecoderCalibrationTest, PlayerReportsTheSelectedDecoder) {
+  const auto decoder = DecoderCalibration(cache).select();
+  Player player(std::make_unique<NullSink>());
+  player.set_decoder(decoder);
+  player.load_song("../tests/resources/song1.mp3");
+  EXPECT_EQ(player.stats().decoder, decoder);
+  EXPECT_THROW(player.set_decoder("no-such-decoder"), std::runtime_error);
+}
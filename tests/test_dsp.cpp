@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../src/audio/dsp.hpp"
+
+namespace {
+
+// Odd length, so the vector kernels also run their tails
+constexpr size_t SAMPLES = 4099;
+
+auto noise(size_t size) -> std::vector<int16_t> {
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> sample(
+      std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
+  std::vector<int16_t> samples(size);
+  for (auto &value : samples) {
+    value = static_cast<int16_t>(sample(random));
+  }
+  return samples;
+}
+
+} // namespace
+
+class DspTest : public ::testing::TestWithParam<const DspKernels *> {};
+
+TEST_P(DspTest, GainMatchesScalar) {
+  for (const float gain : {0.0F, 0.37F, 1.0F}) {
+    auto expected = noise(SAMPLES);
+    auto actual = expected;
+    dsp_scalar().apply_gain(expected, gain);
+    GetParam()->apply_gain(actual, gain);
+    EXPECT_EQ(actual, expected) << "gain " << gain;
+  }
+}
+
+TEST_P(DspTest, GainSaturates) {
+  std::vector<int16_t> samples{20000, -20000, 100};
+  GetParam()->apply_gain(samples, 2.0F);
+  EXPECT_EQ(samples, (std::vector<int16_t>{32767, -32768, 200}));
+}
+
+TEST_P(DspTest, RampMatchesScalarAndEndsAtTarget) {
+  for (const int channels : {1, 2, 3}) {
+    auto expected = noise(SAMPLES - (SAMPLES % channels));
+    auto actual = expected;
+    dsp_scalar().apply_ramp(expected, channels, 1.0F, 0.25F);
+    GetParam()->apply_ramp(actual, channels, 1.0F, 0.25F);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_LE(std::abs(actual[i] - expected[i]), 1)
+          << channels << " channels, sample " << i;
+    }
+  }
+
+  // Each frame shares one gain, and the last one is the target
+  std::vector<int16_t> samples(8, 1000);
+  GetParam()->apply_ramp(samples, 2, 0.0F, 1.0F);
+  EXPECT_EQ(samples,
+            (std::vector<int16_t>{250, 250, 500, 500, 750, 750, 1000, 1000}));
+}
+
+TEST_P(DspTest, ConvertsToFloatExactly) {
+  const auto input = noise(SAMPLES);
+  std::vector<float> output(input.size());
+  GetParam()->to_float(input, output.data());
+  for (size_t i = 0; i < input.size(); ++i) {
+    ASSERT_EQ(output[i], static_cast<float>(input[i]));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, DspTest,
+                         ::testing::ValuesIn(dsp_available()),
+                         [](const auto &info) {
+                           return std::string(info.param->name);
+                         });
+
+TEST(DspSelectionTest, UsesTheFastestAvailable) {
+  if (std::getenv("JPOD_NANO_DSP") == nullptr) {
+    EXPECT_EQ(&dsp_kernels(), dsp_available().back());
+  }
+  EXPECT_EQ(dsp_available().front(), &dsp_scalar());
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/fan_out_sink.hpp"
+#include "../src/audio/null_sink.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/// Sink keeping everything it receives, optionally slowly.
+class CaptureSink : public NullSink {
+public:
+  explicit CaptureSink(std::chrono::milliseconds delay = 0ms)
+      : delay_(delay) {}
+
+  void write(std::span<const int16_t> samples) override {
+    std::this_thread::sleep_for(delay_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.insert(samples_.end(), samples.begin(), samples.end());
+  }
+
+  auto samples() -> std::vector<int16_t> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return samples_;
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+  std::mutex mutex_;
+  std::vector<int16_t> samples_;
+};
+
+template <typename Predicate> auto eventually(Predicate predicate) -> bool {
+  for (int i = 0; i < 400; ++i) {
+    if (predicate()) {
+      return true;
+    }
+    std::this_thread::sleep_for(5ms);
+  }
+  return predicate();
+}
+
+} // namespace
+
+class FanOutSinkTest : public ::testing::Test {
+protected:
+  static constexpr AudioFormat FORMAT{44100, 2};
+
+  void SetUp() override {
+    auto owned = std::make_unique<NullSink>();
+    primary = owned.get();
+    fan_out = std::make_unique<FanOutSink>(std::move(owned));
+  }
+
+  static auto block(int16_t start, size_t size) -> std::vector<int16_t> {
+    std::vector<int16_t> samples(size);
+    for (size_t i = 0; i < size; ++i) {
+      samples[i] = static_cast<int16_t>(start + static_cast<int16_t>(i));
+    }
+    return samples;
+  }
+
+  NullSink *primary{nullptr};
+  std::unique_ptr<FanOutSink> fan_out;
+};
+
+TEST_F(FanOutSinkTest, WritesPrimarySynchronously) {
+  fan_out->open(FORMAT);
+  fan_out->write(block(0, 512));
+  EXPECT_EQ(primary->samples_written(), 512U);
+  EXPECT_TRUE(fan_out->is_open());
+  EXPECT_EQ(fan_out->queued_bytes(), 0U);
+}
+
+TEST_F(FanOutSinkTest, FeedsEveryOutputTheSameStream) {
+  auto first = std::make_unique<CaptureSink>();
+  auto second = std::make_unique<CaptureSink>();
+  auto *first_ptr = first.get();
+  auto *second_ptr = second.get();
+  fan_out->add_output(std::move(first));
+  fan_out->open(FORMAT);
+  fan_out->add_output(std::move(second));
+  EXPECT_EQ(fan_out->output_count(), 2U);
+
+  std::vector<int16_t> expected;
+  for (int16_t i = 0; i < 10; ++i) {
+    auto samples = block(static_cast<int16_t>(i * 100), 100);
+    fan_out->write(samples);
+    expected.insert(expected.end(), samples.begin(), samples.end());
+  }
+
+  EXPECT_TRUE(eventually([&] { return first_ptr->samples() == expected; }));
+  EXPECT_TRUE(eventually([&] { return second_ptr->samples() == expected; }));
+  EXPECT_EQ(first_ptr->format(), FORMAT);
+}
+
+TEST_F(FanOutSinkTest, SlowOutputDropsInsteadOfBlocking) {
+  auto slow = std::make_unique<CaptureSink>(50ms);
+  auto fast = std::make_unique<CaptureSink>();
+  auto *fast_ptr = fast.get();
+  const auto slow_index = fan_out->add_output(std::move(slow), 10ms);
+  fan_out->add_output(std::move(fast), 2000ms);
+  fan_out->open(FORMAT);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 50; ++i) {
+    fan_out->write(block(0, 441)); // 5 ms each
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 200ms);
+
+  EXPECT_GT(fan_out->dropped_samples(slow_index), 0U);
+  EXPECT_TRUE(
+      eventually([&] { return fast_ptr->samples().size() == 50U * 441U; }));
+}
+
+TEST_F(FanOutSinkTest, ForwardsPauseAndResumeToOutputs) {
+  auto output = std::make_unique<CaptureSink>();
+  auto *output_ptr = output.get();
+  fan_out->add_output(std::move(output));
+  fan_out->open(FORMAT);
+  EXPECT_TRUE(eventually([&] { return output_ptr->is_open(); }));
+
+  fan_out->resume();
+  EXPECT_FALSE(primary->is_paused());
+  EXPECT_TRUE(eventually([&] { return !output_ptr->is_paused(); }));
+
+  fan_out->pause();
+  EXPECT_TRUE(eventually([&] { return output_ptr->is_paused(); }));
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/audio/history_log.hpp"
+
+using namespace std::chrono_literals;
+
+class HistoryLogTest : public ::testing::Test {
+protected:
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  /// Records plays of `track` starting at `minute` past the epoch
+  static void play(HistoryLog &log, const std::string &track, int minute,
+                   bool skipped = false) {
+    log.record(HistoryLog::track_id(track),
+               std::chrono::system_clock::time_point(
+                   std::chrono::minutes(minute)),
+               skipped ? 10s : 180s, skipped);
+  }
+
+  const std::filesystem::path directory = "history_dir";
+};
+
+TEST_F(HistoryLogTest, AggregatesPlaysAndSkips) {
+  HistoryLog log(directory);
+  play(log, "a.mp3", 1);
+  play(log, "a.mp3", 2, true);
+  play(log, "b.mp3", 3);
+  log.flush();
+
+  const auto a = log.stats(HistoryLog::track_id("a.mp3"));
+  ASSERT_TRUE(a.has_value());
+  EXPECT_EQ(a->plays, 2U);
+  EXPECT_EQ(a->skips, 1U);
+  EXPECT_DOUBLE_EQ(a->skip_rate(), 0.5);
+  EXPECT_EQ(a->listened_ms, 190'000U);
+  EXPECT_EQ(a->last_played_ms, 2 * 60'000);
+  EXPECT_EQ(log.stats(HistoryLog::track_id("c.mp3")), std::nullopt);
+  EXPECT_EQ(log.total_plays(), 3U);
+}
+
+TEST_F(HistoryLogTest, AnswersTopAndRecentQueries) {
+  HistoryLog log(directory);
+  play(log, "a.mp3", 1);
+  play(log, "b.mp3", 2);
+  play(log, "b.mp3", 3);
+  play(log, "c.mp3", 4);
+  log.flush();
+
+  const auto top = log.top_tracks(2);
+  ASSERT_EQ(top.size(), 2U);
+  EXPECT_EQ(top[0].track, HistoryLog::track_id("b.mp3"));
+  EXPECT_EQ(top[1].track, HistoryLog::track_id("c.mp3")); // Newer tie wins
+
+  const auto recent = log.recently_played(10);
+  ASSERT_EQ(recent.size(), 4U);
+  EXPECT_EQ(recent.front().track, HistoryLog::track_id("c.mp3"));
+  EXPECT_EQ(recent.back().track, HistoryLog::track_id("a.mp3"));
+}
+
+TEST_F(HistoryLogTest, PromotesTracksIntoTheBoundedTop) {
+  HistoryLog log(directory);
+  const auto tracks = static_cast<int>(HistoryLog::TOP_TRACKS) + 8;
+  for (int track = 0; track < tracks; ++track) {
+    play(log, std::to_string(track) + ".mp3", track);
+  }
+  // The oldest track has dropped out of the top, then plays its way back in
+  play(log, "0.mp3", tracks);
+  play(log, "0.mp3", tracks + 1);
+  log.flush();
+
+  EXPECT_EQ(log.top_tracks(tracks).size(), HistoryLog::TOP_TRACKS);
+  const auto top = log.top_tracks(2);
+  ASSERT_EQ(top.size(), 2U);
+  EXPECT_EQ(top[0].track, HistoryLog::track_id("0.mp3"));
+  EXPECT_EQ(top[0].plays, 3U);
+  EXPECT_EQ(top[1].track,
+            HistoryLog::track_id(std::to_string(tracks - 1) + ".mp3"));
+}
+
+TEST_F(HistoryLogTest, KeepsAggregatesAcrossRestarts) {
+  {
+    HistoryLog log(directory);
+    play(log, "a.mp3", 1);
+    play(log, "a.mp3", 2);
+  } // Destruction writes out queued plays
+  HistoryLog log(directory);
+  EXPECT_EQ(log.stats(HistoryLog::track_id("a.mp3"))->plays, 2U);
+  EXPECT_EQ(log.recently_played(1).size(), 1U);
+}
+
+TEST_F(HistoryLogTest, RebuildsIndexFromLog) {
+  {
+    HistoryLog log(directory);
+    play(log, "a.mp3", 1);
+    play(log, "b.mp3", 2, true);
+  }
+  std::filesystem::remove(directory / "history.idx");
+  // Half a record left by a crash mid-append
+  std::ofstream(directory / "history.log", std::ios::app | std::ios::binary)
+      << "torn";
+
+  HistoryLog log(directory);
+  EXPECT_EQ(log.total_plays(), 2U);
+  EXPECT_EQ(log.stats(HistoryLog::track_id("b.mp3"))->skips, 1U);
+  EXPECT_EQ(std::filesystem::file_size(directory / "history.log"),
+            2 * sizeof(PlayRecord));
+}
+
+TEST_F(HistoryLogTest, GrowsPastInitialCapacity) {
+  const auto tracks = static_cast<int>(HistoryLog::MIN_CAPACITY * 2);
+  {
+    HistoryLog log(directory);
+    for (int track = 0; track < tracks; ++track) {
+      play(log, std::to_string(track) + ".mp3", track);
+    }
+    play(log, "7.mp3", tracks);
+    log.flush();
+    EXPECT_EQ(log.stats(HistoryLog::track_id("7.mp3"))->plays, 2U);
+  }
+  HistoryLog log(directory);
+  EXPECT_EQ(log.total_plays(), static_cast<uint64_t>(tracks) + 1);
+  EXPECT_EQ(log.top_tracks(1).front().track, HistoryLog::track_id("7.mp3"));
+  EXPECT_EQ(log.stats(HistoryLog::track_id("0.mp3"))->plays, 1U);
+}
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+#include "../src/net/http_source.hpp"
+#include "http_test_server.hpp"
+
+namespace fs = std::filesystem;
+
+class HttpSourceTest : public ::testing::Test {
+protected:
+  static constexpr size_t BODY_SIZE = (HttpSource::CHUNK_SIZE * 5) + 1234;
+
+  void SetUp() override {
+    cache_dir = fs::temp_directory_path() / "jpod_nano_http_source_test";
+    fs::remove_all(cache_dir);
+    body.resize(BODY_SIZE);
+    std::mt19937 rng{42};
+    for (auto &chr : body) {
+      chr = static_cast<char>(rng());
+    }
+    server.add("/song.mp3", body);
+  }
+
+  void TearDown() override { fs::remove_all(cache_dir); }
+
+  static auto read_all(HttpSource &source) -> std::string {
+    std::string data;
+    std::vector<char> buffer(100000);
+    ssize_t got = 0;
+    while ((got = source.read(buffer)) > 0) {
+      data.append(buffer.data(), static_cast<size_t>(got));
+    }
+    return data;
+  }
+
+  fs::path cache_dir;
+  std::string body;
+  HttpTestServer server;
+};
+
+TEST_F(HttpSourceTest, ParsesUrls) {
+  const auto url = HttpUrl::parse("http://media.local:8080/a/b.mp3?x=1");
+  EXPECT_EQ(url.host, "media.local");
+  EXPECT_EQ(url.port, 8080);
+  EXPECT_EQ(url.path, "/a/b.mp3?x=1");
+  EXPECT_TRUE(HttpUrl::is_url("http://host"));
+  EXPECT_FALSE(HttpUrl::is_url("/music/song.mp3"));
+  EXPECT_THROW(HttpUrl::parse("ftp://host/x"), std::runtime_error);
+  EXPECT_THROW(HttpUrl::parse("http://host:70000/x"), std::runtime_error);
+  EXPECT_THROW(HttpUrl::parse("http://host:abc/x"), std::runtime_error);
+  EXPECT_EQ(HttpUrl::parse_port("65535"), 65535);
+  EXPECT_FALSE(HttpUrl::parse_port("-1"));
+}
+
+TEST_F(HttpSourceTest, ReadsWholeResourceThroughRanges) {
+  HttpSource source(server.url("/song.mp3"), cache_dir);
+  EXPECT_EQ(source.size(), BODY_SIZE);
+  EXPECT_EQ(read_all(source), body);
+}
+
+TEST_F(HttpSourceTest, SeekFetchesOnlyNeededChunks) {
+  HttpSource source(server.url("/song.mp3"), cache_dir,
+                    HttpSource::DEFAULT_CACHE_LIMIT, 0);
+  const auto offset = static_cast<int64_t>(HttpSource::CHUNK_SIZE * 3) + 10;
+  ASSERT_EQ(source.seek(offset, SEEK_SET), offset);
+
+  std::vector<char> buffer(1000);
+  ASSERT_EQ(source.read(buffer), 1000);
+  EXPECT_EQ(std::string(buffer.begin(), buffer.end()),
+            body.substr(static_cast<size_t>(offset), 1000));
+
+  // The size probe fetched chunk 0, the read fetched chunk 3 only
+  EXPECT_EQ(source.fetched_bytes(), 2 * HttpSource::CHUNK_SIZE);
+  EXPECT_EQ(source.seek(0, SEEK_END), static_cast<int64_t>(BODY_SIZE));
+  EXPECT_EQ(source.seek(1, SEEK_END), -1);
+}
+
+TEST_F(HttpSourceTest, PrefetchesAheadOfReadPosition) {
+  HttpSource source(server.url("/song.mp3"), cache_dir,
+                    HttpSource::DEFAULT_CACHE_LIMIT, 2);
+  std::vector<char> buffer(10);
+  ASSERT_EQ(source.read(buffer), 10);
+  for (int i = 0; i < 200 && source.fetched_bytes() < 2 * HttpSource::CHUNK_SIZE;
+       ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_GE(source.fetched_bytes(), 2 * HttpSource::CHUNK_SIZE);
+}
+
+TEST_F(HttpSourceTest, ReusesCacheAcrossInstances) {
+  {
+    HttpSource source(server.url("/song.mp3"), cache_dir);
+    EXPECT_EQ(read_all(source), body);
+  }
+  const auto requests = server.requests();
+  HttpSource cached(server.url("/song.mp3"), cache_dir);
+  EXPECT_EQ(read_all(cached), body);
+  EXPECT_EQ(cached.fetched_bytes(), 0U);
+  // Only the conditional probe, answered 304
+  EXPECT_EQ(server.requests(), requests + 1);
+}
+
+TEST_F(HttpSourceTest, RefetchesChangedResource) {
+  {
+    HttpSource source(server.url("/song.mp3"), cache_dir);
+    EXPECT_EQ(read_all(source), body);
+  }
+  std::ranges::reverse(body);
+  body.resize(BODY_SIZE - HttpSource::CHUNK_SIZE);
+  server.add("/song.mp3", body);
+  HttpSource changed(server.url("/song.mp3"), cache_dir);
+  EXPECT_EQ(changed.size(), body.size());
+  EXPECT_EQ(read_all(changed), body);
+}
+
+TEST_F(HttpSourceTest, FollowsRedirects) {
+  server.redirect("/moved.mp3", "/song.mp3");
+  HttpSource source(server.url("/moved.mp3"), cache_dir);
+  EXPECT_EQ(read_all(source), body);
+}
+
+TEST_F(HttpSourceTest, FallsBackWhenServerIgnoresRanges) {
+  server.ignore_ranges(true);
+  HttpSource source(server.url("/song.mp3"), cache_dir);
+  EXPECT_EQ(read_all(source), body);
+}
+
+TEST_F(HttpSourceTest, EvictsLeastRecentlyUsedEntries) {
+  server.add("/other.mp3", body);
+  {
+    HttpSource source(server.url("/song.mp3"), cache_dir);
+    read_all(source);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  HttpSource other(server.url("/other.mp3"), cache_dir, BODY_SIZE + 65536);
+  read_all(other);
+
+  size_t maps = 0;
+  for (const auto &entry : fs::directory_iterator(cache_dir)) {
+    maps += (entry.path().extension() == ".map") ? 1 : 0;
+  }
+  EXPECT_EQ(maps, 1U);
+}
+
+TEST_F(HttpSourceTest, ThrowsForMissingResource) {
+  EXPECT_THROW(HttpSource(server.url("/missing.mp3"), cache_dir),
+               std::runtime_error);
+}
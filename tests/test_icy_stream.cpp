@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "../src/net/icy_parser.hpp"
+#include "../src/net/icy_stream.hpp"
+#include "http_test_server.hpp"
+
+namespace {
+
+auto make_audio(size_t size) -> std::string {
+  std::string audio(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    audio[i] = static_cast<char>(i % 251);
+  }
+  return audio;
+}
+
+} // namespace
+
+TEST(IcyParserTest, SplitsAudioAndMetadataAcrossAnyChunking) {
+  static constexpr size_t METAINT = 8;
+  const std::string title = "StreamTitle='A - B';";
+  std::string block = title;
+  block.resize(32, '\0');
+  const std::string body = "01234567" + std::string(1, '\x02') + block +
+                           "89abcdef" + std::string(1, '\0') + "ghij";
+
+  for (size_t step = 1; step <= body.size(); ++step) {
+    IcyParser parser(METAINT);
+    std::string audio;
+    std::vector<std::string> metadata;
+    for (size_t pos = 0; pos < body.size(); pos += step) {
+      const std::span<const char> chunk{body.data() + pos,
+                                        std::min(step, body.size() - pos)};
+      parser.feed(
+          chunk,
+          [&](std::span<const char> run) {
+            // Audio must point into the fed buffer, never a copy
+            EXPECT_GE(run.data(), chunk.data());
+            EXPECT_LE(run.data() + run.size(), chunk.data() + chunk.size());
+            audio.append(run.data(), run.size());
+          },
+          [&](const std::string &text) { metadata.push_back(text); });
+    }
+    EXPECT_EQ(audio, "0123456789abcdefghij") << "step " << step;
+    ASSERT_EQ(metadata.size(), 1U) << "step " << step;
+    EXPECT_EQ(metadata[0], title);
+  }
+}
+
+TEST(IcyParserTest, PassesEverythingThroughWithoutMetaint) {
+  IcyParser parser(0);
+  std::string audio;
+  parser.feed(
+      std::string_view{"abc"},
+      [&](std::span<const char> run) { audio.append(run.data(), run.size()); },
+      [](const std::string &) { FAIL(); });
+  EXPECT_EQ(audio, "abc");
+}
+
+TEST(IcyParserTest, ExtractsStreamTitle) {
+  EXPECT_EQ(IcyParser::stream_title("StreamTitle='It's - Me';StreamUrl='';"),
+            "It's - Me");
+  EXPECT_EQ(IcyParser::stream_title("StreamUrl='x';"), std::nullopt);
+}
+
+TEST(IcyStreamTest, ReceivesAudioAndTitleFromStandInServer) {
+  HttpTestServer server;
+  const auto audio = make_audio(100000);
+  server.add_icy_stream("/live", audio, 16000, "Artist - Song");
+
+  IcyStream stream(server.url("/live"));
+  EXPECT_EQ(stream.station_name(), "Test FM");
+
+  std::string received;
+  std::vector<char> buffer(4096);
+  for (int tries = 0; tries < 1000 && !stream.finished(); ++tries) {
+    const auto got = stream.read(buffer, std::chrono::milliseconds(10));
+    received.append(buffer.data(), got);
+  }
+  EXPECT_EQ(received, audio);
+  EXPECT_EQ(stream.stream_title(), "Artist - Song");
+}
+
+TEST(IcyStreamTest, ThrowsForMissingMount) {
+  HttpTestServer server;
+  EXPECT_THROW(IcyStream(server.url("/nothing")), std::runtime_error);
+}
+
+TEST(IcyStreamTest, ThrowsRuntimeErrorForBadMetaint) {
+  HttpTestServer server;
+  server.add_raw("/junk", "ICY 200 OK\r\nicy-metaint: lots\r\n\r\nxx");
+  server.add_raw("/huge", "ICY 200 OK\r\nicy-metaint: "
+                          "99999999999999999999999\r\n\r\nxx");
+  EXPECT_THROW(IcyStream(server.url("/junk")), std::runtime_error);
+  EXPECT_THROW(IcyStream(server.url("/huge")), std::runtime_error);
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../src/net/jitter_buffer.hpp"
+
+using namespace std::chrono_literals;
+
+class JitterBufferTest : public ::testing::Test {
+protected:
+  static constexpr uint32_t BYTE_RATE = 16000;
+  static constexpr size_t PACKET = 320; // 20 ms at BYTE_RATE
+
+  void push_packets(int count, std::chrono::milliseconds gap,
+                    std::chrono::milliseconds spike = 0ms, int every = 0) {
+    for (int i = 0; i < count; ++i) {
+      now += gap;
+      if (every > 0 && i % every == 0) {
+        now += spike;
+      }
+      buffer.push(packet, now);
+    }
+  }
+
+  JitterBuffer buffer{BYTE_RATE};
+  std::vector<char> packet = std::vector<char>(PACKET, 'x');
+  JitterBuffer::Clock::time_point now = JitterBuffer::Clock::now();
+};
+
+TEST_F(JitterBufferTest, SmoothArrivalKeepsMinimumTarget) {
+  push_packets(200, 20ms);
+  EXPECT_EQ(buffer.target(), JitterBuffer::MIN_TARGET);
+}
+
+TEST_F(JitterBufferTest, BurstyArrivalGrowsTarget) {
+  push_packets(200, 20ms, 900ms, 10);
+  EXPECT_GT(buffer.target(), JitterBuffer::MIN_TARGET);
+  EXPECT_LE(buffer.target(), JitterBuffer::MAX_TARGET);
+}
+
+TEST_F(JitterBufferTest, HoldsReadsUntilTargetIsBuffered) {
+  std::vector<char> out(PACKET);
+  buffer.push(packet, now);
+  EXPECT_EQ(buffer.pop(out, 0ms), 0U); // 20 ms < 250 ms target
+
+  push_packets(12, 20ms); // 260 ms buffered
+  EXPECT_EQ(buffer.pop(out, 0ms), PACKET);
+}
+
+TEST_F(JitterBufferTest, CountsUnderrunAndRebuffers) {
+  push_packets(13, 20ms);
+  std::vector<char> out(64U * 1024U);
+  EXPECT_GT(buffer.pop(out, 0ms), 0U);
+  EXPECT_EQ(buffer.pop(out, 0ms), 0U);
+  EXPECT_EQ(buffer.underruns(), 1U);
+
+  buffer.push(packet, now);
+  EXPECT_EQ(buffer.pop(out, 0ms), 0U); // Prebuffering again
+}
+
+TEST_F(JitterBufferTest, DrainsBelowTargetAfterClose) {
+  std::vector<char> out(PACKET);
+  buffer.push(packet, now);
+  buffer.close();
+  EXPECT_FALSE(buffer.finished());
+  EXPECT_EQ(buffer.pop(out, 0ms), PACKET);
+  EXPECT_TRUE(buffer.finished());
+  EXPECT_EQ(buffer.underruns(), 0U);
+}
+
+TEST_F(JitterBufferTest, DropsOldestBytesWhenFull) {
+  const std::vector<char> huge(10U * 1024U * 1024U, 'y');
+  buffer.push(huge, now);
+  EXPECT_LT(buffer.buffered_bytes(), huge.size());
+}
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../src/util/latency_histogram.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(LatencyHistogramTest, EmptyReportsZero) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0U);
+  EXPECT_EQ(histogram.percentile(99), 0ns);
+  EXPECT_EQ(histogram.max(), 0ns);
+  EXPECT_EQ(histogram.mean(), 0ns);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 50; ++i) {
+    histogram.record(std::chrono::nanoseconds(i));
+  }
+  EXPECT_EQ(histogram.percentile(50), 25ns);
+  EXPECT_EQ(histogram.percentile(100), 50ns);
+  EXPECT_EQ(histogram.percentile(0), 1ns);
+  EXPECT_EQ(histogram.mean(), 25ns);
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinRelativeError) {
+  LatencyHistogram histogram;
+  std::mt19937_64 random(7);
+  std::uniform_int_distribution<int64_t> microseconds(1, 1'000'000);
+  std::vector<int64_t> values(100'000);
+  for (auto &value : values) {
+    value = microseconds(random) * 1000;
+    histogram.record(std::chrono::nanoseconds(value));
+  }
+  std::sort(values.begin(), values.end());
+  for (const double percent : {50.0, 99.0, 99.9}) {
+    const auto exact = static_cast<double>(
+        values[static_cast<size_t>(percent / 100.0 * values.size()) - 1]);
+    const auto reported =
+        static_cast<double>(histogram.percentile(percent).count());
+    EXPECT_GE(reported, exact);
+    EXPECT_NEAR(reported, exact, exact / LatencyHistogram::SUB_BUCKETS);
+  }
+  EXPECT_EQ(histogram.max().count(), values.back());
+}
+
+TEST(LatencyHistogramTest, MergeAddsSamples) {
+  LatencyHistogram fast;
+  LatencyHistogram slow;
+  for (int i = 0; i < 990; ++i) {
+    fast.record(1ms);
+  }
+  for (int i = 0; i < 10; ++i) {
+    slow.record(300ms);
+  }
+  fast.merge(slow);
+  EXPECT_EQ(fast.count(), 1000U);
+  EXPECT_LE(fast.percentile(99), 1ms + 16us);
+  EXPECT_EQ(fast.percentile(99.9), 300ms);
+  EXPECT_EQ(fast.max(), 300ms);
+
+  fast.clear();
+  EXPECT_EQ(fast.count(), 0U);
+}
+
+TEST(LatencyHistogramTest, ClampsNegativeAndHugeValues) {
+  LatencyHistogram histogram;
+  histogram.record(-5ns);
+  histogram.record(std::chrono::nanoseconds::max());
+  EXPECT_EQ(histogram.percentile(50), 0ns);
+  EXPECT_EQ(histogram.percentile(100), std::chrono::nanoseconds::max());
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../src/cli/library_browser.hpp"
+
+namespace {
+
+auto library(size_t count) -> std::vector<std::string> {
+  std::vector<std::string> songs;
+  songs.reserve(count);
+  for (size_t song = 0; song < count; ++song) {
+    songs.push_back("/music/Track " + std::to_string(song) + ".mp3");
+  }
+  return songs;
+}
+
+/// Filters to the end
+void settle(LibraryBrowser &browser) {
+  while (browser.step()) {
+  }
+}
+
+} // namespace
+
+TEST(LibraryBrowserTest, FiltersIncrementallyAndErases) {
+  LibraryBrowser browser(library(1000));
+  EXPECT_EQ(browser.rows(), 1000U);
+
+  browser.type('T');
+  browser.type('9');
+  settle(browser);
+  EXPECT_EQ(browser.query(), "t9");
+  EXPECT_EQ(browser.rows(), 0U);
+  EXPECT_EQ(browser.selected(), std::nullopt);
+
+  browser.erase();
+  browser.erase();
+  browser.type('9');
+  browser.type('9');
+  settle(browser);
+  EXPECT_EQ(browser.rows(), 19U); // 99, 199, ..., 990-999
+  EXPECT_EQ(browser.selected(), 99U);
+
+  browser.type('5');
+  settle(browser);
+  EXPECT_EQ(browser.rows(), 1U);
+  browser.erase(); // Back to the kept matches of "99"
+  EXPECT_FALSE(browser.filtering());
+  EXPECT_EQ(browser.rows(), 19U);
+  browser.erase();
+  browser.erase();
+  EXPECT_EQ(browser.rows(), 1000U);
+}
+
+TEST(LibraryBrowserTest, ScrollsAViewportOverTheList) {
+  LibraryBrowser browser(library(100));
+  browser.resize(10);
+  browser.move(15);
+  EXPECT_EQ(browser.selected(), 15U);
+  browser.page(-5);
+  EXPECT_EQ(browser.selected(), 0U);
+  browser.page(20);
+  EXPECT_EQ(browser.selected(), 99U);
+
+  const auto frame = browser.render(40);
+  // Header plus exactly the visible rows, the last one selected
+  EXPECT_EQ(std::ranges::count(frame, '\n'), 11);
+  EXPECT_NE(frame.find("> Track 99.mp3"), std::string::npos);
+  EXPECT_NE(frame.find("  Track 90.mp3"), std::string::npos);
+  EXPECT_EQ(frame.find("Track 89.mp3"), std::string::npos);
+}
+
+TEST(LibraryBrowserTest, ClipsRowsWithoutSplittingCharacters) {
+  LibraryBrowser browser({"/music/\xC3\xA9t\xC3\xA9.mp3"}); // "été.mp3"
+  const auto frame = browser.render(5);
+  EXPECT_NE(frame.find("> \xC3\xA9t\x1b"), std::string::npos);
+}
+
+TEST(LibraryBrowserTest, FiltersAMillionSongsInBoundedSteps) {
+  static constexpr size_t SONGS = 1000000;
+  LibraryBrowser browser(library(SONGS));
+  browser.resize(20);
+  browser.type('7');
+  EXPECT_TRUE(browser.filtering());
+  EXPECT_LE(browser.rows(), LibraryBrowser::FILTER_BATCH);
+  size_t steps = 1;
+  while (browser.step()) {
+    ++steps;
+  }
+  EXPECT_EQ(steps, (SONGS + LibraryBrowser::FILTER_BATCH - 1) /
+                       LibraryBrowser::FILTER_BATCH);
+  const auto matches = browser.rows();
+  EXPECT_GT(matches, SONGS / 3);
+
+  // Narrowing only searches the previous matches
+  browser.type('7');
+  size_t narrow_steps = 1;
+  while (browser.step()) {
+    ++narrow_steps;
+  }
+  EXPECT_EQ(narrow_steps, (matches + LibraryBrowser::FILTER_BATCH - 1) /
+                              LibraryBrowser::FILTER_BATCH);
+  browser.move(static_cast<std::ptrdiff_t>(SONGS));
+  EXPECT_EQ(std::ranges::count(browser.render(80), '\n'), 21);
+}
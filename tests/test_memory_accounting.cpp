@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <new>
+#include <vector>
+
+#include "../src/util/memory_accounting.hpp"
+
+// Counters are process-wide, so every check is relative to a baseline
+
+TEST(MemoryAccountingTest, TaggedVectorChargesItsTag) {
+  const auto before = MemoryAccounting::usage(MemoryTag::CACHE).bytes;
+  {
+    TaggedVector<int32_t, MemoryTag::CACHE> values;
+    values.reserve(1000);
+    EXPECT_EQ(MemoryAccounting::usage(MemoryTag::CACHE).bytes,
+              before + (1000 * sizeof(int32_t)));
+    EXPECT_GE(MemoryAccounting::usage(MemoryTag::CACHE).peak,
+              before + (1000 * sizeof(int32_t)));
+
+    // Moving hands the storage over without a new charge
+    auto moved = std::move(values);
+    EXPECT_EQ(MemoryAccounting::usage(MemoryTag::CACHE).bytes,
+              before + (1000 * sizeof(int32_t)));
+  }
+  EXPECT_EQ(MemoryAccounting::usage(MemoryTag::CACHE).bytes, before);
+}
+
+TEST(MemoryAccountingTest, BudgetRefusesOnlyWhatDoesNotFit) {
+  const auto before = MemoryAccounting::usage(MemoryTag::STREAM);
+  MemoryAccounting::set_budget(MemoryTag::STREAM, before.bytes + 1024);
+
+  TaggedVector<char, MemoryTag::STREAM> bytes(512);
+  EXPECT_THROW(bytes.reserve(4096), std::bad_alloc);
+  EXPECT_EQ(bytes.capacity(), 512U);
+  const auto after = MemoryAccounting::usage(MemoryTag::STREAM);
+  EXPECT_EQ(after.bytes, before.bytes + 512);
+  EXPECT_EQ(after.refused, before.refused + 1);
+  EXPECT_EQ(after.budget, before.bytes + 1024);
+
+  MemoryAccounting::set_budget(MemoryTag::STREAM, MemoryAccounting::UNLIMITED);
+  bytes.reserve(4096);
+  EXPECT_EQ(MemoryAccounting::usage(MemoryTag::STREAM).bytes,
+            before.bytes + 4096);
+}
+
+TEST(MemoryAccountingTest, ChargeFollowsResizes) {
+  const auto before = MemoryAccounting::usage(MemoryTag::INDEX).bytes;
+  {
+    MemoryCharge charge(MemoryTag::INDEX);
+    charge.resize(10000);
+    charge.resize(4000);
+    EXPECT_EQ(charge.bytes(), 4000U);
+    EXPECT_EQ(MemoryAccounting::usage(MemoryTag::INDEX).bytes, before + 4000);
+    EXPECT_GE(MemoryAccounting::usage(MemoryTag::INDEX).peak, before + 10000);
+
+    // A refused growth keeps the old charge
+    MemoryAccounting::set_budget(MemoryTag::INDEX, before + 5000);
+    EXPECT_THROW(charge.resize(6000), std::bad_alloc);
+    EXPECT_EQ(charge.bytes(), 4000U);
+    MemoryAccounting::set_budget(MemoryTag::INDEX,
+                                 MemoryAccounting::UNLIMITED);
+  }
+  EXPECT_EQ(MemoryAccounting::usage(MemoryTag::INDEX).bytes, before);
+}
+
+TEST(MemoryAccountingTest, NamesRoundTrip) {
+  const auto report = MemoryAccounting::report();
+  EXPECT_EQ(report.size(), MemoryAccounting::TAGS);
+  for (size_t tag = 0; tag < MemoryAccounting::TAGS; ++tag) {
+    const auto name = MemoryAccounting::name(static_cast<MemoryTag>(tag));
+    EXPECT_EQ(MemoryAccounting::parse(name), static_cast<MemoryTag>(tag));
+  }
+  EXPECT_EQ(MemoryAccounting::name(MemoryTag::PCM), "pcm");
+  EXPECT_FALSE(MemoryAccounting::parse("decoder").has_value());
+}
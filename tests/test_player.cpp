@@ -5,14 +5,85 @@
 // License. See the LICENSE file in the project root for full license
 // information.
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
+#include <array>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <thread>
 
+#include "../src/audio/history_log.hpp"
+#include "../src/audio/null_sink.hpp"
 #include "../src/audio/player.hpp"
 #include "../src/audio/playlist.hpp"
+#include "../src/audio/resume_state.hpp"
+#include "http_test_server.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/// NullSink counting open() calls, i.e. loaded tracks, and clears
+class TrackSink : public NullSink {
+public:
+  using NullSink::NullSink;
+
+  void open(const AudioFormat &format) override {
+    NullSink::open(format);
+    opens.fetch_add(1);
+  }
+
+  void clear() override {
+    NullSink::clear();
+    clears.fetch_add(1);
+  }
+
+  std::atomic<int> opens{0};
+  std::atomic<int> clears{0};
+};
+
+/// Polls in real time; virtual-clock playback finishes long before timeout
+auto eventually(const std::function<bool()> &condition,
+                std::chrono::milliseconds timeout = 10s) -> bool {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+/// Decoded length of a song, scanning it rather than trusting its header
+auto track_seconds(const std::string &path) -> double {
+  auto *handle = mpg123_new(nullptr, nullptr);
+  if (handle == nullptr) {
+    return 0.0;
+  }
+  double seconds = 0.0;
+  long rate = 0;
+  int channels = 0;
+  int encoding = 0;
+  if (mpg123_open(handle, path.c_str()) == MPG123_OK &&
+      mpg123_getformat(handle, &rate, &channels, &encoding) == MPG123_OK &&
+      rate > 0 && mpg123_scan(handle) == MPG123_OK) {
+    seconds = static_cast<double>(mpg123_length(handle)) /
+              static_cast<double>(rate);
+  }
+  mpg123_delete(handle);
+  return seconds;
+}
+
+} // namespace
 
 class PlayerTest : public ::testing::Test {
 protected:
@@ -29,7 +100,35 @@ protected:
     return player.fade_to(value);
   }
 
-  Player player;
+  auto decode_block(size_t &bytes) -> int {
+    return player.decode_block(bytes);
+  }
+
+  auto apply_quality(QualityController::Level level) -> bool {
+    return player.apply_quality(level);
+  }
+
+  auto decoded(size_t bytes) -> std::span<int16_t> {
+    return {reinterpret_cast<int16_t *>(player.buffer_.data()),
+            bytes / sizeof(int16_t)};
+  }
+
+  auto expand_degraded(std::span<int16_t> samples) -> std::span<int16_t> {
+    return player.expand_degraded(samples);
+  }
+
+  auto handle() -> mpg123_handle * { return player.mpg_handler_; }
+
+  auto make_sink() -> std::unique_ptr<AudioSink> {
+    auto owned = std::make_unique<TrackSink>(clock);
+    sink = owned.get();
+    return owned;
+  }
+
+  // Playback runs on virtual time into a sink that "plays" on that time
+  VirtualClock clock;
+  TrackSink *sink{nullptr};
+  Player player{make_sink(), clock};
   std::unique_ptr<Playlist> playlist;
 };
 
@@ -70,8 +169,6 @@ TEST_F(PlayerTest, CanAdjustVolume) {
 
 TEST_F(PlayerTest, CanGetTitleAndArtist) {
   player.resume();
-  static constexpr auto WAIT_MS = 50U;
-  std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS));
   EXPECT_NO_THROW({
     auto title = player.get_title();
     auto artist = player.get_artist();
@@ -100,6 +197,108 @@ TEST_F(PlayerTest, CanUseNextAndPrev) {
   EXPECT_NO_THROW(player.prev_song());
 }
 
+TEST_F(PlayerTest, PausingTwiceKeepsThePosition) {
+  player.resume();
+  ASSERT_TRUE(eventually([&] { return player.get_progress().first >= 2; }));
+  player.pause();
+  const auto paused_at = player.get_progress().first;
+  clock.advance(5s);
+  player.pause();
+  EXPECT_EQ(player.get_progress().first, paused_at);
+  EXPECT_FALSE(player.is_playing());
+}
+
+TEST_F(PlayerTest, DegradedLevelsReopenAtTheFrameAndExpandToTheSink) {
+  using Level = QualityController::Level;
+  // Levels change only when the test says so
+  player.set_adaptive_quality(false);
+  size_t bytes = 0;
+  for (int block = 0; block < 4; ++block) {
+    ASSERT_EQ(decode_block(bytes), MPG123_OK);
+  }
+
+  // A DSP-only level keeps the decoder where it is, even mid-frame
+  const auto sample = mpg123_tell(handle());
+  apply_quality(Level::LEAN_DSP);
+  EXPECT_EQ(mpg123_tell(handle()), sample);
+
+  // Reopened at the frame being decoded, so no audio is skipped
+  const auto frame = mpg123_tellframe(handle());
+  apply_quality(Level::HALF_RATE);
+  EXPECT_EQ(mpg123_tellframe(handle()), frame);
+  ASSERT_EQ(decode_block(bytes), MPG123_OK);
+
+  // Half the rate held for two sink frames: twice the samples, in pairs
+  static constexpr size_t CHANNELS = 2;
+  const auto in = decoded(bytes);
+  const std::vector<int16_t> kept(in.begin(), in.end());
+  const auto out = expand_degraded(in);
+  ASSERT_EQ(out.size(), kept.size() * 2);
+  for (size_t frame_index = 0; frame_index < kept.size() / CHANNELS;
+       ++frame_index) {
+    for (size_t channel = 0; channel < CHANNELS; ++channel) {
+      const auto source = kept[(frame_index * CHANNELS) + channel];
+      EXPECT_EQ(out[(frame_index * 2 * CHANNELS) + channel], source);
+      EXPECT_EQ(out[(frame_index * 2 * CHANNELS) + CHANNELS + channel],
+                source);
+    }
+  }
+}
+
+TEST_F(PlayerTest, DegradedLevelsReopenHttpSongsThroughTheirSource) {
+  using Level = QualityController::Level;
+  std::ifstream file("../tests/resources/song1.mp3", std::ios::binary);
+  HttpTestServer server;
+  server.add("/song1.mp3", std::string(std::istreambuf_iterator<char>(file),
+                                       std::istreambuf_iterator<char>()));
+  player.set_adaptive_quality(false);
+  player.load_song(server.url("/song1.mp3"));
+  size_t bytes = 0;
+  for (int block = 0; block < 4; ++block) {
+    ASSERT_EQ(decode_block(bytes), MPG123_OK);
+  }
+  const auto frame = mpg123_tellframe(handle());
+  EXPECT_TRUE(apply_quality(Level::HALF_RATE));
+  EXPECT_EQ(mpg123_tellframe(handle()), frame);
+  EXPECT_EQ(decode_block(bytes), MPG123_OK);
+}
+
+TEST_F(PlayerTest, FailedReopenEndsTheTrack) {
+  using Level = QualityController::Level;
+  std::filesystem::create_directories("test_dir");
+  const auto path = std::filesystem::path("test_dir") / "gone.mp3";
+  std::filesystem::copy_file("../tests/resources/song1.mp3", path);
+  player.set_adaptive_quality(false);
+  player.load_song(path.string());
+  size_t bytes = 0;
+  ASSERT_EQ(decode_block(bytes), MPG123_OK);
+
+  // Neither the new level nor the old one can reopen a deleted file
+  std::filesystem::remove(path);
+  EXPECT_FALSE(apply_quality(Level::HALF_RATE));
+  EXPECT_THROW(player.load_song(path.string()), std::runtime_error);
+}
+
+TEST_F(PlayerTest, PlaysOnWhenThePcmBudgetRefusesAnExpansion) {
+  using Level = QualityController::Level;
+  player.set_adaptive_quality(false);
+  size_t bytes = 0;
+  ASSERT_EQ(decode_block(bytes), MPG123_OK);
+  apply_quality(Level::HALF_RATE);
+
+  // Expanding half-rate blocks needs PCM memory the budget no longer allows
+  const auto before = MemoryAccounting::usage(MemoryTag::PCM);
+  MemoryAccounting::set_budget(MemoryTag::PCM, before.bytes);
+  player.resume();
+  const bool played =
+      eventually([&] { return player.get_progress().first >= 2; });
+  const auto after = MemoryAccounting::usage(MemoryTag::PCM);
+  MemoryAccounting::set_budget(MemoryTag::PCM, MemoryAccounting::UNLIMITED);
+  EXPECT_TRUE(played);
+  EXPECT_TRUE(player.is_playing());
+  EXPECT_GT(after.refused, before.refused);
+}
+
 TEST_F(PlayerTest, FadeToDoesNotCrash) {
   static constexpr auto FADE_VALUE = 0.5F;
   auto fade = fade_to(FADE_VALUE);
@@ -109,46 +308,483 @@ TEST_F(PlayerTest, FadeToDoesNotCrash) {
 
 TEST_F(PlayerTest, PlaySong) {
   player.resume();
+  const auto start = clock.now();
   auto [elapsed_init, total_init] = player.get_progress();
-  static constexpr auto SLEEP_TIME_S = 1;
-  std::this_thread::sleep_for(std::chrono::seconds(SLEEP_TIME_S));
+  ASSERT_TRUE(eventually([&] { return player.get_progress().first >= 3; }));
+  const auto played = clock.now() - start;
   auto [elapsed_end, total_end] = player.get_progress();
 
-  EXPECT_NEAR(elapsed_end - elapsed_init, SLEEP_TIME_S, 0.1F);
+  EXPECT_NEAR(elapsed_end - elapsed_init,
+              std::chrono::duration<double>(played).count(), 1.0);
 }
 
 TEST_F(PlayerTest, GoesToNextSongAtEndOfTrack) {
-  // Start playing the current song
+  const auto first = player.get_playlist()->current();
+  const auto opens = sink->opens.load();
   player.resume();
 
-  // Let the track play for a bit to simulate progress
-  std::this_thread::sleep_for(std::chrono::seconds(3));
-
-  // Seek very close to the end of the track
+  // Seek close to the end of the track, then let it finish
   auto [elapsed, total] = player.get_progress();
-  int remaining = total - elapsed - 1;
-  if (remaining > 0) {
-    player.seek_relative(remaining);
+  player.seek_relative(total - elapsed - 1);
+  ASSERT_TRUE(eventually([&] { return sink->opens.load() > opens; }));
+
+  EXPECT_NE(player.get_playlist()->current(), first);
+}
+
+TEST_F(PlayerTest, PlaysWholePlaylistInVirtualTime) {
+  double total = 0.0;
+  for (const auto &song : player.get_playlist()->songs()) {
+    total += track_seconds(song);
   }
+  ASSERT_GT(total, 0.0);
+  const auto opens = sink->opens.load();
+  const auto real_start = std::chrono::steady_clock::now();
+  player.resume();
+
+  // Every track, then the playlist wraps around to the first one
+  const auto tracks = static_cast<int>(player.get_playlist()->size());
+  ASSERT_TRUE(
+      eventually([&] { return sink->opens.load() >= opens + tracks; }));
+  const auto real_time = std::chrono::steady_clock::now() - real_start;
+
+  EXPECT_GE(clock.elapsed(), std::chrono::duration<double>(total));
+  EXPECT_LT(real_time, clock.elapsed());
+  // The songs share one format; allow a frame of rounding per track
+  static constexpr auto FRAME_SECONDS = 0.05;
+  EXPECT_GE(static_cast<double>(sink->played_bytes()),
+            (total - (tracks * FRAME_SECONDS)) *
+                static_cast<double>(sink->format().bytes_per_second()));
+  // Track starts and seeks empty the output, but that is not overload
+  EXPECT_EQ(player.stats().quality.degradations, 0U);
+}
+
+TEST_F(PlayerTest, DeepBufferWakesRarelyAndAppliesVolumePromptly) {
+  player.set_deep_buffer(20s);
+  const auto opens = sink->opens.load();
+  player.resume();
 
-  // Wait for the track to finish and the player to transition
-  static constexpr auto SLEEP_TO_FINISH_S = 3U;
-  std::this_thread::sleep_for(std::chrono::seconds(SLEEP_TO_FINISH_S));
+  ASSERT_TRUE(eventually([&] { return player.stats().buffered > 5s; }));
+  EXPECT_TRUE(player.stats().deep_buffer);
+  const auto clears = sink->clears.load();
+  player.set_volume(0.5F);
+  EXPECT_TRUE(eventually([&] { return sink->clears.load() > clears; }));
 
-  // We expect the player to have moved to the next song
-  const auto &current_track = player.get_playlist()->current();
-  EXPECT_FALSE(current_track.empty());
+  // The whole playlist in a few wakeups per second of audio
+  ASSERT_TRUE(eventually([&] { return sink->opens.load() >= opens + 3; }));
+  const auto stats = player.stats();
+  const auto seconds =
+      std::chrono::duration_cast<std::chrono::seconds>(clock.elapsed());
+  EXPECT_LT(stats.wakeups, static_cast<uint64_t>(seconds.count()) * 2);
+  EXPECT_GT(stats.wakeups_per_second, 0.0);
+  EXPECT_LT(stats.wakeups_per_second, 2.0);
+
+  Reactor reactor;
+  EXPECT_THROW(player.attach(reactor), std::runtime_error);
+}
+
+/// Player on a MANUAL clock, so every fade step waits for the test
+class PlayerManualClockTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    player.set_playlist(std::make_unique<Playlist>("../tests/resources"));
+    // The idle player thread
+    ASSERT_TRUE(clock.wait_for_sleepers(1, 1s));
+  }
+
+  void TearDown() override {
+    // Keep time moving so the player thread can see the switch off
+    ticker = std::jthread([this](const std::stop_token &token) {
+      while (!token.stop_requested()) {
+        clock.advance(10ms);
+        std::this_thread::sleep_for(1ms);
+      }
+    });
+  }
+
+  auto get_volume() -> float { return player.get_volume(); }
+
+  VirtualClock clock{VirtualClock::Mode::MANUAL};
+  std::jthread ticker; ///< Outlives the player
+  NullSink *sink{nullptr};
+  Player player{[this] {
+                  auto owned = std::make_unique<NullSink>(clock);
+                  sink = owned.get();
+                  return owned;
+                }(),
+                clock};
+};
+
+TEST_F(PlayerManualClockTest, LaterCommandSupersedesAFade) {
+  static constexpr auto VOLUME = 0.6F;
+  static constexpr auto FADE_STEP = 30ms;
+  player.set_volume(VOLUME);
+
+  std::atomic<bool> paused{false};
+  std::jthread pausing([&] {
+    player.pause();
+    paused = true;
+  });
+  // The pause fade took its first step and sleeps before the next
+  ASSERT_TRUE(clock.wait_for_sleepers(2, 1s));
+  const auto mid_fade = get_volume();
+  EXPECT_LT(mid_fade, VOLUME);
+  EXPECT_GT(mid_fade, 0.0F);
+
+  std::atomic<bool> resumed{false};
+  std::jthread resuming([&] {
+    player.resume();
+    resumed = true;
+  });
+  ASSERT_TRUE(clock.wait_for_sleepers(3, 1s));
+  while (!paused || !resumed) {
+    clock.advance(FADE_STEP);
+    std::this_thread::sleep_for(1ms);
+  }
+
+  // The pause gave up at its next step and left the device alone
+  EXPECT_TRUE(player.is_playing());
+  EXPECT_FLOAT_EQ(get_volume(), VOLUME);
+  EXPECT_FALSE(sink->is_paused());
 }
 
 TEST(PlayerNoPlaylistTest, StopsWhenNoPlaylistAtEnd) {
-  Player player;
+  VirtualClock clock;
+  Player player(std::make_unique<NullSink>(clock), clock);
   player.set_playlist(nullptr); // simulate no playlist
   player.load_song("../tests/resources/song2.mp3");
   player.resume();
 
   // Let it run and finish
-  std::this_thread::sleep_for(std::chrono::seconds(3));
-  auto [elapsed, total] = player.get_progress();
-  player.seek_relative(total - elapsed - 1);
-  std::this_thread::sleep_for(std::chrono::seconds(2));
+  EXPECT_TRUE(eventually([&] { return !player.is_playing(); }));
+}
+
+TEST(PlayerUnplayableTest, SkipsCorruptTracksWithoutStopping) {
+  const std::filesystem::path dir = "unplayable_dir";
+  std::filesystem::create_directories(dir);
+  std::filesystem::copy_file("../tests/resources/song1.mp3",
+                             dir / "1_song.mp3");
+  std::ofstream(dir / "2_bad.mp3") << std::string(64 * 1024, 'x');
+  std::filesystem::copy_file("../tests/resources/song3.mp3",
+                             dir / "3_song.mp3");
+
+  VirtualClock clock;
+  auto owned = std::make_unique<TrackSink>(clock);
+  auto *sink = owned.get();
+  Player player(std::move(owned), clock);
+  player.set_playlist(std::make_unique<Playlist>(dir.string()));
+  const auto opens = sink->opens.load();
+  player.resume();
+
+  // The bad entry was found ahead of time and passed over
+  ASSERT_TRUE(eventually([&] { return sink->opens.load() >= opens + 2; }));
+  EXPECT_TRUE(player.is_playing());
+  EXPECT_GE(player.stats().skipped_tracks, 1U);
+  EXPECT_THROW(player.load_song((dir / "2_bad.mp3").string()),
+               std::runtime_error);
+
+  player.pause();
+  std::filesystem::remove_all(dir);
+}
+
+TEST(PlayerUnplayableTest, SkipsCorruptTracksOverTheCacheBudget) {
+  const std::filesystem::path dir = "unplayable_budget_dir";
+  std::filesystem::create_directories(dir);
+  std::filesystem::copy_file("../tests/resources/song1.mp3",
+                             dir / "1_song.mp3");
+  std::ofstream(dir / "2_bad.mp3") << std::string(64 * 1024, 'x');
+  std::filesystem::copy_file("../tests/resources/song3.mp3",
+                             dir / "3_song.mp3");
+
+  VirtualClock clock;
+  auto owned = std::make_unique<TrackSink>(clock);
+  auto *sink = owned.get();
+  Player player(std::move(owned), clock);
+  // No room to remember the bad entry
+  const auto before = MemoryAccounting::usage(MemoryTag::CACHE);
+  MemoryAccounting::set_budget(MemoryTag::CACHE, before.bytes);
+  player.set_playlist(std::make_unique<Playlist>(dir.string()));
+  const auto opens = sink->opens.load();
+  player.resume();
+
+  const bool passed =
+      eventually([&] { return sink->opens.load() >= opens + 2; });
+  const auto after = MemoryAccounting::usage(MemoryTag::CACHE);
+  player.pause();
+  MemoryAccounting::set_budget(MemoryTag::CACHE, MemoryAccounting::UNLIMITED);
+  EXPECT_TRUE(passed);
+  EXPECT_GE(player.stats().skipped_tracks, 1U);
+  EXPECT_GT(after.refused, before.refused);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(PlayerUnplayableTest, ResyncsPastCorruptFrames) {
+  const std::filesystem::path dir = "corrupt_dir";
+  std::filesystem::create_directories(dir);
+  const auto path = dir / "song.mp3";
+  std::filesystem::copy_file("../tests/resources/song2.mp3", path);
+  {
+    // Garbage in the middle of the stream, frame headers included
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(
+        std::filesystem::file_size(path) / 2));
+    file << std::string(16 * 1024, '\xff');
+  }
+
+  VirtualClock clock;
+  Player player(std::make_unique<NullSink>(clock), clock);
+  player.set_playlist(nullptr);
+  player.load_song(path.string());
+  const auto total = player.get_progress().second;
+  player.resume();
+
+  // The track plays through to its end instead of stopping at the damage
+  EXPECT_TRUE(eventually([&] { return !player.is_playing(); }));
+  EXPECT_GE(clock.elapsed(), std::chrono::seconds(total - 1));
+  std::filesystem::remove_all(dir);
+}
+
+TEST(PlayerResumeTest, RestartContinuesAtSavedPosition) {
+  const std::filesystem::path file = "resume_test_dir/resume";
+  const std::string folder = "../tests/resources";
+  std::string song;
+  {
+    VirtualClock clock;
+    Player player(std::make_unique<NullSink>(clock), clock);
+    player.set_resume_state(std::make_unique<ResumeState>(file));
+    auto playlist = std::make_unique<Playlist>(folder);
+    playlist->reshuffle(7);
+    player.set_playlist(std::move(playlist));
+    player.set_volume(0.4F);
+    player.next_song();
+    ASSERT_TRUE(eventually([&] { return player.get_progress().first >= 4; }));
+    song = player.get_playlist()->current();
+  } // No pause first: the last periodic save is all there is
+
+  const auto saved = ResumeState(file).load();
+  ASSERT_TRUE(saved.has_value());
+  EXPECT_TRUE(saved->playing);
+  EXPECT_FLOAT_EQ(saved->volume, 0.4F);
+  EXPECT_GT(saved->anchor_frame, 0);
+
+  VirtualClock clock;
+  Player player(std::make_unique<NullSink>(clock), clock);
+  player.set_resume_state(std::make_unique<ResumeState>(file));
+  player.set_playlist(std::make_unique<Playlist>(folder));
+  EXPECT_EQ(player.get_playlist()->shuffle_seed(), 7U);
+  EXPECT_EQ(player.get_playlist()->current(), song);
+  EXPECT_NEAR(player.get_progress().first,
+              static_cast<int>(saved->sample / 44100), 1);
+  EXPECT_TRUE(player.is_playing());
+  player.pause();
+  std::filesystem::remove_all(file.parent_path());
+}
+
+TEST(PlayerResumeTest, OtherPlaylistStartsFresh) {
+  const std::filesystem::path file = "resume_other_dir/resume";
+  ResumeState(file).save({ResumeState::hash("elsewhere"), 0, 1, std::nullopt,
+                          true, 1.0F, 44100, 0, 0, 0});
+
+  VirtualClock clock;
+  Player player(std::make_unique<NullSink>(clock), clock);
+  player.set_resume_state(std::make_unique<ResumeState>(file));
+  player.set_playlist(std::make_unique<Playlist>("../tests/resources"));
+  EXPECT_EQ(player.get_playlist()->position(), 0U);
+  EXPECT_EQ(player.get_progress().first, 0);
+  EXPECT_FALSE(player.is_playing());
+  std::filesystem::remove_all(file.parent_path());
+}
+
+TEST(PlayerHistoryTest, RecordsPlaysAndSkips) {
+  const std::filesystem::path directory = "player_history_dir";
+  {
+    VirtualClock clock;
+    auto owned = std::make_unique<TrackSink>(clock);
+    auto *sink = owned.get();
+    Player player(std::move(owned), clock);
+    auto owned_history = std::make_unique<HistoryLog>(directory);
+    auto *history = owned_history.get();
+    player.set_history(std::move(owned_history));
+    player.set_playlist(std::make_unique<Playlist>("../tests/resources"));
+    const auto first = player.get_playlist()->current();
+    player.resume();
+    player.next_song(); // Skips the first song
+
+    // The second plays to its end
+    const auto second = player.get_playlist()->current();
+    const auto opens = sink->opens.load();
+    ASSERT_TRUE(eventually(
+        [&] { return sink->opens.load() > opens && player.is_playing(); }));
+    player.pause();
+
+    history->flush();
+    EXPECT_EQ(history->stats(HistoryLog::track_id(first))->skips, 1U);
+    const auto played = history->stats(HistoryLog::track_id(second));
+    ASSERT_TRUE(played.has_value());
+    EXPECT_EQ(played->skips, 0U);
+    EXPECT_GT(played->listened_ms, 10'000U);
+    EXPECT_EQ(history->recently_played(1).front().track,
+              HistoryLog::track_id(second));
+  } // The third is recorded on the way out, not as a skip
+  EXPECT_EQ(HistoryLog(directory).total_plays(), 3U);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(PlayerReactorTest, PlaysPlaylistOnTheLoopThread) {
+  VirtualClock clock;
+  auto owned = std::make_unique<TrackSink>();
+  auto *sink = owned.get();
+  Player player(std::move(owned), clock);
+  Reactor reactor;
+  player.attach(reactor);
+  player.set_playlist(std::make_unique<Playlist>("../tests/resources"));
+  const auto opens = sink->opens.load();
+  player.resume();
+
+  // Nothing decodes until the loop runs
+  EXPECT_EQ(sink->samples_written(), 0U);
+  const auto deadline = std::chrono::steady_clock::now() + 10s;
+  while (sink->opens.load() < opens + 3 &&
+         std::chrono::steady_clock::now() < deadline) {
+    reactor.run_once(100ms);
+  }
+  EXPECT_GE(sink->opens.load(), opens + 3);
+  EXPECT_THROW(player.start_stream_server(0), std::runtime_error);
+}
+
+TEST(PlayerReactorTest, FadesOnLoopTimers) {
+  VirtualClock clock;
+  Player player(std::make_unique<TrackSink>(), clock);
+  Reactor reactor;
+  player.attach(reactor);
+  player.set_playlist(std::make_unique<Playlist>("../tests/resources"));
+
+  // Returns before the fade; the loop completes the resume
+  const auto start = std::chrono::steady_clock::now();
+  player.resume();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 300ms); // A fade
+  EXPECT_FALSE(player.is_playing());
+  const auto run_until = [&reactor](const std::function<bool()> &done) {
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+      reactor.run_once(10ms);
+    }
+    return done();
+  };
+  EXPECT_TRUE(run_until([&player] { return player.is_playing(); }));
+
+  player.pause();
+  EXPECT_TRUE(player.is_playing());
+  EXPECT_TRUE(run_until([&player] { return !player.is_playing(); }));
+}
+
+TEST_F(PlayerTest, CanStartStreamServer) {
+  EXPECT_EQ(player.get_stream_server(), nullptr);
+  player.start_stream_server(0);
+  ASSERT_NE(player.get_stream_server(), nullptr);
+  EXPECT_NE(player.get_stream_server()->port(), 0);
+  EXPECT_EQ(player.get_stream_server()->listener_count(), 0U);
+}
+
+TEST_F(PlayerTest, StreamsHttpSongsThroughTheirSource) {
+  std::ifstream file("../tests/resources/song1.mp3", std::ios::binary);
+  const std::string mp3((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+  HttpTestServer server;
+  server.add("/song1.mp3", mp3);
+  player.start_stream_server(0);
+  player.load_song(server.url("/song1.mp3"));
+
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(player.get_stream_server()->port());
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+  const std::string request = "GET / HTTP/1.0\r\n\r\n";
+  ASSERT_EQ(send(fd, request.data(), request.size(), 0),
+            static_cast<ssize_t>(request.size()));
+  ASSERT_TRUE(eventually(
+      [&] { return player.get_stream_server()->listener_count() == 1; }));
+  player.resume();
+
+  // The first second of the song arrives at once, straight from the source
+  static constexpr size_t PREFIX = 1000;
+  static constexpr int TIMEOUT_MS = 5000;
+  std::string received;
+  std::array<char, 4096> chunk{};
+  pollfd pfd{fd, POLLIN, 0};
+  while (received.find("\r\n\r\n") == std::string::npos ||
+         received.size() < received.find("\r\n\r\n") + 4 + PREFIX) {
+    ssize_t got = 0;
+    if (poll(&pfd, 1, TIMEOUT_MS) <= 0 ||
+        (got = recv(fd, chunk.data(), chunk.size(), 0)) <= 0) {
+      break;
+    }
+    received.append(chunk.data(), static_cast<size_t>(got));
+  }
+  close(fd);
+  const auto head_end = received.find("\r\n\r\n");
+  ASSERT_NE(head_end, std::string::npos);
+  EXPECT_EQ(received.substr(head_end + 4, PREFIX), mp3.substr(0, PREFIX));
+}
+
+TEST(PlayerStreamTest, PlaysLiveStreamWithIcyTitle) {
+  std::ifstream file("../tests/resources/song1.mp3", std::ios::binary);
+  const std::string mp3((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+  HttpTestServer server;
+  server.add_icy_stream("/live", mp3, 16000, "Artist - Song");
+
+  Player player;
+  player.load_stream(server.url("/live"));
+  EXPECT_EQ(player.get_title(), "Test FM");
+  player.resume();
+  EXPECT_TRUE(player.is_playing());
+
+  static constexpr auto WAIT_MS = 500U;
+  std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS));
+  EXPECT_EQ(player.get_title(), "Song");
+  EXPECT_EQ(player.get_artist(), "Artist");
+  EXPECT_EQ(player.get_progress().second, 0);
+}
+
+TEST(PlayerSinkTest, FeedsExtraOutputsFromOneDecode) {
+  auto primary = std::make_unique<NullSink>();
+  auto output = std::make_unique<NullSink>();
+  auto *primary_ptr = primary.get();
+  auto *output_ptr = output.get();
+
+  Player player(std::move(primary));
+  player.add_output(std::move(output));
+  EXPECT_EQ(player.get_sink().output_count(), 1U);
+  player.load_song("../tests/resources/song1.mp3");
+  player.resume();
+
+  static constexpr auto WAIT_MS = 500U;
+  std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS));
+  EXPECT_GT(primary_ptr->samples_written(), 0U);
+  EXPECT_GT(output_ptr->samples_written(), 0U);
+  EXPECT_EQ(output_ptr->format(), primary_ptr->format());
+}
+
+TEST(PlayerSyncTest, FollowerJoinsLeaderTrackAndState) {
+  Player leader;
+  leader.start_sync_leader(0);
+  ASSERT_NE(leader.get_sync_leader(), nullptr);
+  leader.load_song("../tests/resources/song1.mp3");
+  leader.resume();
+
+  Player follower;
+  follower.follow_leader("127.0.0.1", leader.get_sync_leader()->port());
+  ASSERT_NE(follower.get_sync_follower(), nullptr);
+
+  static constexpr auto WAIT_MS = 2000U;
+  std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS));
+  EXPECT_TRUE(follower.get_sync_follower()->synchronized());
+  EXPECT_TRUE(follower.is_playing());
+  EXPECT_EQ(follower.get_title(), leader.get_title());
+
+  leader.pause();
+  std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS / 2));
+  EXPECT_FALSE(follower.is_playing());
 }
@@ -7,8 +7,11 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 #include "../src/audio/playlist.hpp"
 
@@ -51,6 +54,18 @@ TEST_F(PlaylistTest, PrevCyclesBackwards) {
   EXPECT_FALSE(wrap_back.empty());
 }
 
+TEST_F(PlaylistTest, PeekLooksAheadWithoutMoving) {
+  Playlist playlist(test_dir);
+  ASSERT_EQ(playlist.size(), 3U);
+  const auto current = playlist.current();
+  const auto after_next = playlist.peek(2);
+  EXPECT_EQ(playlist.peek(0), current);
+  EXPECT_EQ(playlist.peek(3), current);
+  EXPECT_EQ(playlist.current(), current);
+  playlist.next();
+  EXPECT_EQ(playlist.next(), after_next);
+}
+
 TEST_F(PlaylistTest, HasNextAndHasPrevWorks) {
   Playlist playlist(test_dir);
   EXPECT_TRUE(playlist.has_next());
@@ -75,4 +90,191 @@ TEST_F(PlaylistTest, ReshuffleChangesOrder) {
   // Since index resets to 0, just verify it doesn't throw and returns a valid
   // path
   EXPECT_FALSE(reshuffled.empty());
-}
\ No newline at end of file
+}
+
+TEST_F(PlaylistTest, SeededReshuffleAndPositionRestoreTheSameSong) {
+  Playlist playlist(test_dir);
+  EXPECT_EQ(playlist.shuffle_seed(), std::nullopt);
+  playlist.reshuffle();
+  ASSERT_TRUE(playlist.shuffle_seed().has_value());
+  playlist.next();
+  playlist.next();
+
+  Playlist restored(test_dir);
+  restored.reshuffle(*playlist.shuffle_seed());
+  EXPECT_TRUE(restored.jump_to(playlist.position()));
+  EXPECT_EQ(restored.current(), playlist.current());
+  EXPECT_EQ(restored.songs(), playlist.songs());
+  EXPECT_FALSE(restored.jump_to(restored.size()));
+}
+
+TEST_F(PlaylistTest, LoadsM3uWithUrlsAndRelativePaths) {
+  const auto dir = fs::temp_directory_path() / "jpod_nano_m3u_test";
+  fs::create_directories(dir);
+  {
+    std::ofstream m3u(dir / "list.m3u");
+    m3u << "#EXTM3U\r\n"
+        << "http://media.local/one.mp3\r\n"
+        << "\n"
+        << "#EXTINF:123,Artist - Two\n"
+        << "two.mp3\n"
+        << "/abs/three.mp3\n";
+  }
+
+  Playlist playlist((dir / "list.m3u").string());
+  EXPECT_EQ(playlist.current(), "http://media.local/one.mp3");
+  EXPECT_EQ(playlist.next(), (dir / "two.mp3").string());
+  EXPECT_EQ(playlist.next(), "/abs/three.mp3");
+  EXPECT_FALSE(playlist.has_next());
+  fs::remove_all(dir);
+}
+
+TEST_F(PlaylistTest, RadioPeeksWhatPlaysNextAndStopsInPlace) {
+  Playlist playlist(test_dir);
+  playlist.next();
+  const auto playing = playlist.current();
+  playlist.start_radio({1.0, 1.0, 1.0}, 11);
+  ASSERT_TRUE(playlist.is_radio());
+  EXPECT_EQ(playlist.current(), playing);
+  EXPECT_FALSE(playlist.has_prev());
+
+  // Endless, drawn ahead, never the same song twice in a row
+  for (int step = 0; step < 200; ++step) {
+    const auto upcoming = playlist.peek(1);
+    const auto previous = playlist.current();
+    EXPECT_TRUE(playlist.has_next());
+    EXPECT_EQ(playlist.next(), upcoming);
+    EXPECT_NE(playlist.current(), previous);
+  }
+
+  // Back through the ring, then forward again over the same picks
+  const auto last = playlist.current();
+  const auto before = playlist.prev();
+  EXPECT_EQ(playlist.next(), last);
+  EXPECT_NE(before, last);
+
+  ASSERT_TRUE(playlist.find(last).has_value());
+  EXPECT_EQ(playlist.songs()[*playlist.find(last)], last);
+  EXPECT_EQ(playlist.current_song(), *playlist.find(last));
+  EXPECT_FALSE(playlist.find("missing.mp3").has_value());
+
+  playlist.stop_radio();
+  EXPECT_FALSE(playlist.is_radio());
+  EXPECT_EQ(playlist.current(), last);
+}
+
+TEST_F(PlaylistTest, ReshufflesInBackground) {
+  Playlist playlist(test_dir);
+  playlist.next();
+  playlist.reshuffle_async();
+  playlist.wait_for_reshuffle();
+  ASSERT_TRUE(playlist.shuffle_seed().has_value());
+  EXPECT_EQ(playlist.position(), 0U);
+
+  Playlist same(test_dir);
+  same.reshuffle(*playlist.shuffle_seed());
+  EXPECT_EQ(same.current(), playlist.current());
+}
+
+TEST_F(PlaylistTest, NewerReshuffleDoesNotWaitForTheOneItSupersedes) {
+  static constexpr int SONGS = 2'000'000;
+  const auto dir = fs::temp_directory_path() / "jpod_nano_big_m3u_test";
+  fs::create_directories(dir);
+  {
+    std::ofstream m3u(dir / "list.m3u");
+    for (int song = 0; song < SONGS; ++song) {
+      m3u << '/' << song << ".mp3\n";
+    }
+  }
+  Playlist playlist((dir / "list.m3u").string());
+  fs::remove_all(dir);
+
+  auto start = std::chrono::steady_clock::now();
+  playlist.reshuffle(1);
+  const auto full = std::chrono::steady_clock::now() - start;
+
+  playlist.reshuffle_async();
+  start = std::chrono::steady_clock::now();
+  playlist.reshuffle_async();
+  const auto superseding = std::chrono::steady_clock::now() - start;
+  EXPECT_LT(superseding, full / 2);
+
+  playlist.wait_for_reshuffle();
+  EXPECT_NE(playlist.shuffle_seed(), std::optional<uint64_t>{1});
+}
+
+TEST_F(PlaylistTest, ReadersAndWritersRunConcurrently) {
+  Playlist playlist(test_dir);
+  std::atomic<bool> done{false};
+  std::jthread player([&] {
+    while (!done) {
+      playlist.next();
+      EXPECT_FALSE(playlist.peek(1).empty());
+      EXPECT_LT(playlist.find(playlist.current()).value_or(3), 3U);
+    }
+  });
+  for (int round = 0; round < 200; ++round) {
+    playlist.reshuffle_async();
+    if (round % 10 == 0) {
+      playlist.start_radio({1.0, 2.0, 3.0}, round);
+      playlist.set_weight(0, 0.5);
+      playlist.prev();
+      playlist.stop_radio();
+    }
+  }
+  playlist.wait_for_reshuffle();
+  done = true;
+}
+
+TEST_F(PlaylistTest, SelectsASongInAnyOrder) {
+  Playlist playlist(test_dir);
+  playlist.reshuffle(5);
+  EXPECT_TRUE(playlist.select(2));
+  EXPECT_EQ(playlist.current(), playlist.songs()[2]);
+  EXPECT_FALSE(playlist.select(3));
+
+  playlist.start_radio({1.0, 1.0, 1.0}, 5);
+  EXPECT_TRUE(playlist.select(0));
+  EXPECT_EQ(playlist.current(), playlist.songs()[0]);
+  EXPECT_TRUE(playlist.is_radio());
+}
+
+TEST_F(PlaylistTest, ChargesPathsAndOrdersToTheirSubsystems) {
+  const auto paths = MemoryAccounting::usage(MemoryTag::PLAYLIST).bytes;
+  const auto orders = MemoryAccounting::usage(MemoryTag::SHUFFLE).bytes;
+  {
+    Playlist playlist(test_dir);
+    EXPECT_GE(MemoryAccounting::usage(MemoryTag::PLAYLIST).bytes,
+              paths + (playlist.size() * sizeof(std::string)));
+    EXPECT_GE(MemoryAccounting::usage(MemoryTag::SHUFFLE).bytes,
+              orders + (playlist.size() * sizeof(size_t)));
+
+    // A budget too small for the paths fails the load, not the process
+    MemoryAccounting::set_budget(MemoryTag::PLAYLIST, paths);
+    EXPECT_THROW(Playlist{test_dir}, std::bad_alloc);
+    MemoryAccounting::set_budget(MemoryTag::PLAYLIST,
+                                 MemoryAccounting::UNLIMITED);
+  }
+  EXPECT_EQ(MemoryAccounting::usage(MemoryTag::PLAYLIST).bytes, paths);
+  EXPECT_EQ(MemoryAccounting::usage(MemoryTag::SHUFFLE).bytes, orders);
+}
+
+TEST_F(PlaylistTest, RadioReplaysDrawnPicksOverTheShuffleBudget) {
+  Playlist playlist(test_dir);
+  playlist.start_radio({1.0, 1.0, 1.0}, 5);
+  const auto before = MemoryAccounting::usage(MemoryTag::SHUFFLE);
+  MemoryAccounting::set_budget(MemoryTag::SHUFFLE, before.bytes);
+
+  // No ring copy fits, so next() walks the ring as drawn
+  const auto drawn = playlist.peek(1);
+  EXPECT_EQ(playlist.next(), drawn);
+  for (size_t step = 0; step < Playlist::RADIO_LOOKAHEAD * 2; ++step) {
+    EXPECT_FALSE(playlist.next().empty());
+  }
+  MemoryAccounting::set_budget(MemoryTag::SHUFFLE,
+                               MemoryAccounting::UNLIMITED);
+  EXPECT_GT(MemoryAccounting::usage(MemoryTag::SHUFFLE).refused,
+            before.refused);
+  EXPECT_TRUE(playlist.has_prev());
+  EXPECT_TRUE(playlist.is_radio());
+}
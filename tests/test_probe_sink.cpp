@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "../src/audio/probe_sink.hpp"
+
+using namespace std::chrono_literals;
+
+class ProbeSinkTest : public ::testing::Test {
+protected:
+  static constexpr AudioFormat FORMAT{1000, 1};
+  static constexpr size_t BLOCK = 100; // 100 ms
+
+  void SetUp() override {
+    reference.resize(10 * FORMAT.sample_rate);
+    for (size_t i = 0; i < reference.size(); ++i) {
+      reference[i] = static_cast<int16_t>(
+          10000 * std::sin(2 * std::numbers::pi * 7 * static_cast<double>(i) /
+                           FORMAT.sample_rate));
+    }
+    sink.open(FORMAT);
+    sink.resume();
+  }
+
+  /// Writes the next block of the reference at a gain
+  void write(float gain) {
+    std::vector<int16_t> block(BLOCK);
+    for (size_t i = 0; i < BLOCK; ++i) {
+      block[i] = static_cast<int16_t>(reference[position + i] * gain);
+    }
+    position += BLOCK;
+    sink.write(block);
+  }
+
+  /// Writes the block of the reference at an offset, like after a seek
+  void write_from(size_t offset) {
+    sink.write(std::span{reference}.subspan(offset, BLOCK));
+    position += BLOCK;
+  }
+
+  VirtualClock clock{VirtualClock::Mode::MANUAL};
+  ProbeSink sink{clock};
+  std::vector<int16_t> reference;
+  size_t position{0};
+};
+
+TEST_F(ProbeSinkTest, GainChangeIsHeardBehindTheQueue) {
+  for (int i = 0; i < 5; ++i) {
+    write(1.0F);
+  }
+  clock.advance(300ms);
+  const auto command = clock.now();
+  write(0.5F); // Queued behind the 200 ms still pending
+
+  const auto change = sink.first_change(reference, command);
+  ASSERT_TRUE(change);
+  // The first sample is at a zero crossing; the change shows right after
+  EXPECT_GE(*change - command, 200ms);
+  EXPECT_LE(*change - command, 205ms);
+}
+
+TEST_F(ProbeSinkTest, UnchangedStreamHasNoChange) {
+  for (int i = 0; i < 5; ++i) {
+    write(0.8F);
+  }
+  clock.advance(300ms);
+  EXPECT_FALSE(sink.first_change(reference, clock.now()));
+}
+
+TEST_F(ProbeSinkTest, ClearedAudioIsNeverHeard) {
+  for (int i = 0; i < 5; ++i) {
+    write(1.0F);
+  }
+  clock.advance(300ms);
+  const auto command = clock.now();
+  clock.advance(20ms);
+  sink.clear();
+  write_from(5000);
+
+  const auto change = sink.first_change(reference, command);
+  ASSERT_TRUE(change);
+  EXPECT_GE(*change - command, 20ms);
+  EXPECT_LE(*change - command, 22ms);
+}
+
+TEST_F(ProbeSinkTest, PauseStopsTheOutput) {
+  for (int i = 0; i < 5; ++i) {
+    write(1.0F);
+  }
+  clock.advance(300ms);
+  const auto command = clock.now();
+  write(0.5F); // A fade that never gets heard
+  clock.advance(50ms);
+  sink.pause();
+
+  const auto change = sink.first_change(reference, command);
+  ASSERT_TRUE(change);
+  EXPECT_EQ(*change - command, 50ms);
+}
+
+TEST_F(ProbeSinkTest, NeedsBaselineAudio) {
+  const auto command = clock.now();
+  write(0.5F);
+  EXPECT_FALSE(sink.first_change(reference, command));
+}
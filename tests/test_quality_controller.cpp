@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "../src/audio/quality_controller.hpp"
+
+using namespace std::chrono_literals;
+using Level = QualityController::Level;
+
+class QualityControllerTest : public ::testing::Test {
+protected:
+  static constexpr auto BLOCK = 50ms; ///< Audio per decoded block
+
+  /// Feeds blocks for `duration` at a fixed load and buffer level
+  void run(std::chrono::milliseconds duration, double load,
+           std::chrono::milliseconds buffered) {
+    for (auto end = now + duration; now < end; now += BLOCK) {
+      const auto decode_time =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(BLOCK * load);
+      controller.observe(now, decode_time, BLOCK, buffered);
+    }
+  }
+
+  QualityController controller;
+  Clock::time_point now{};
+};
+
+TEST_F(QualityControllerTest, StaysFullWithHeadroom) {
+  run(60s, 0.05, 1500ms);
+  EXPECT_EQ(controller.level(), Level::FULL);
+  EXPECT_EQ(controller.counters().degradations, 0U);
+}
+
+TEST_F(QualityControllerTest, DegradesOneStepPerHoldUnderLoad) {
+  run(500ms, 0.9, 1500ms);
+  EXPECT_EQ(controller.level(), Level::LEAN_DSP);
+  run(1s, 0.9, 1500ms);
+  EXPECT_EQ(controller.level(), Level::MONO);
+  run(10s, 0.9, 1500ms);
+  EXPECT_EQ(controller.level(), Level::QUARTER_RATE);
+  EXPECT_EQ(controller.counters().degradations, 4U);
+}
+
+TEST_F(QualityControllerTest, DegradesWhenOutputRunsLow) {
+  // An empty buffer at startup is not a sign of overload
+  run(2s, 0.05, 100ms);
+  EXPECT_EQ(controller.level(), Level::FULL);
+
+  run(1s, 0.05, 1500ms);
+  run(100ms, 0.05, 100ms);
+  EXPECT_EQ(controller.level(), Level::LEAN_DSP);
+}
+
+TEST_F(QualityControllerTest, RecoversAfterSustainedHeadroomOnly) {
+  run(3s, 0.9, 1500ms);
+  run(1s, 0.4, 1500ms); // Lets the smoothed load settle
+  const auto degraded = controller.level();
+  ASSERT_NE(degraded, Level::FULL);
+
+  // Between the thresholds: hold the level
+  run(30s, 0.4, 1500ms);
+  EXPECT_EQ(controller.level(), degraded);
+
+  // Headroom interrupted before RECOVER_HOLD does not count
+  run(8s, 0.05, 1500ms);
+  run(100ms, 0.05, 500ms);
+  run(8s, 0.05, 1500ms);
+  EXPECT_EQ(controller.level(), degraded);
+
+  run(60s, 0.05, 1500ms);
+  EXPECT_EQ(controller.level(), Level::FULL);
+  EXPECT_EQ(controller.counters().recoveries,
+            controller.counters().degradations);
+}
+
+TEST_F(QualityControllerTest, ResetReturnsToFullWithoutCountingRecovery) {
+  run(2s, 0.9, 1500ms);
+  controller.reset(now);
+  EXPECT_EQ(controller.level(), Level::FULL);
+  EXPECT_EQ(controller.counters().recoveries, 0U);
+  EXPECT_STREQ(QualityController::name(Level::HALF_RATE), "half-rate");
+}
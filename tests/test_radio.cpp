@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "../src/audio/radio.hpp"
+
+TEST(RadioTest, DoesNotRepeatRecentSongs) {
+  static constexpr size_t SONGS = 200;
+  Radio radio(std::vector<double>(SONGS, 1.0), 7);
+  std::deque<size_t> recent;
+  for (int pick = 0; pick < 2000; ++pick) {
+    const auto song = radio.next();
+    ASSERT_LT(song, SONGS);
+    EXPECT_EQ(std::ranges::count(recent, song), 0) << "pick " << pick;
+    recent.push_back(song);
+    if (recent.size() == Radio::EXCLUDE_WINDOW) {
+      recent.pop_front();
+    }
+  }
+}
+
+TEST(RadioTest, FollowsWeightChanges) {
+  Radio radio({1.0, 1.0, 1.0, 1.0}, 3);
+  radio.set_weight(1, 0.0);
+  for (int pick = 0; pick < 500; ++pick) {
+    EXPECT_NE(radio.next(), 1U);
+  }
+}
+
+TEST(RadioTest, WeighsByHistory) {
+  using std::chrono::hours;
+  using std::chrono::milliseconds;
+  const int64_t now =
+      std::chrono::duration_cast<milliseconds>(hours(24 * 365)).count();
+  const int64_t week_ago =
+      now - std::chrono::duration_cast<milliseconds>(hours(24 * 7)).count();
+
+  const auto unplayed = Radio::weight(std::nullopt, now);
+  const auto loved = Radio::weight(TrackStats{1, 10, 0, week_ago, 0}, now);
+  const auto skipped = Radio::weight(TrackStats{1, 10, 10, week_ago, 0}, now);
+  const auto just_played = Radio::weight(TrackStats{1, 10, 0, now, 0}, now);
+
+  EXPECT_DOUBLE_EQ(unplayed, 1.0);
+  EXPECT_GT(loved, unplayed);
+  EXPECT_LT(skipped, unplayed);
+  EXPECT_GT(skipped, 0.0);
+  EXPECT_DOUBLE_EQ(just_played, loved * Radio::MIN_RECENCY);
+}
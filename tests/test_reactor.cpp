@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <thread>
+
+#include "../src/util/reactor.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(ReactorTest, RunsReadableHandlers) {
+  Reactor reactor;
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  int reads = 0;
+  reactor.watch(fds[0], [&] {
+    char byte = 0;
+    (void)!read(fds[0], &byte, 1);
+    ++reads;
+  });
+
+  EXPECT_EQ(reactor.run_once(0ms), 0U);
+  (void)!write(fds[1], "x", 1);
+  EXPECT_EQ(reactor.run_once(100ms), 1U);
+  EXPECT_EQ(reads, 1);
+
+  reactor.unwatch(fds[0]);
+  (void)!write(fds[1], "x", 1);
+  EXPECT_EQ(reactor.run_once(10ms), 0U);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(ReactorTest, PeriodicTimerFiresUntilCancelled) {
+  Reactor reactor;
+  int ticks = 0;
+  Reactor::TimerId timer = -1;
+  timer = reactor.add_timer(5ms, [&] {
+    if (++ticks == 3) {
+      reactor.cancel_timer(timer); // From inside its own callback
+      reactor.stop();
+    }
+  });
+  const auto start = std::chrono::steady_clock::now();
+  reactor.run();
+  EXPECT_EQ(ticks, 3);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 15ms);
+  EXPECT_EQ(reactor.run_once(20ms), 0U);
+}
+
+TEST(ReactorTest, SetTimerChangesPeriod) {
+  Reactor reactor;
+  int ticks = 0;
+  const auto timer = reactor.add_timer(1h, [&] { ++ticks; });
+  EXPECT_EQ(reactor.run_once(20ms), 0U);
+  reactor.set_timer(timer, 1ms);
+  EXPECT_EQ(reactor.run_once(100ms), 1U);
+  EXPECT_EQ(ticks, 1);
+}
+
+TEST(ReactorTest, StopsFromAnotherThread) {
+  Reactor reactor;
+  std::jthread stopper([&] {
+    std::this_thread::sleep_for(20ms);
+    reactor.stop();
+  });
+  reactor.run();
+  EXPECT_GE(reactor.wakeups(), 1U);
+
+  // A stop before run() is not lost
+  reactor.stop();
+  reactor.run();
+}
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "../src/audio/recording_sink.hpp"
+
+namespace fs = std::filesystem;
+
+class RecordingSinkTest : public ::testing::Test {
+protected:
+  static constexpr AudioFormat FORMAT{8000, 2};
+
+  void SetUp() override {
+    options.directory = fs::temp_directory_path() / "jpod_nano_recording_test";
+    fs::remove_all(options.directory);
+  }
+
+  void TearDown() override { fs::remove_all(options.directory); }
+
+  static auto ramp(size_t size) -> std::vector<int16_t> {
+    std::vector<int16_t> samples(size);
+    for (size_t i = 0; i < size; ++i) {
+      samples[i] = static_cast<int16_t>(i * 7);
+    }
+    return samples;
+  }
+
+  static auto read_file(const fs::path &path) -> std::vector<char> {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+  }
+
+  static auto le32(const std::vector<char> &bytes, size_t offset)
+      -> uint32_t {
+    uint32_t value = 0;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+  }
+
+  static auto payload(const std::vector<char> &bytes, size_t header)
+      -> std::vector<int16_t> {
+    std::vector<int16_t> samples((bytes.size() - header) / sizeof(int16_t));
+    std::memcpy(samples.data(), bytes.data() + header,
+                samples.size() * sizeof(int16_t));
+    return samples;
+  }
+
+  RecordingSink::Options options;
+};
+
+TEST_F(RecordingSinkTest, WritesValidWavFile) {
+  const auto samples = ramp(300000); // Spans several write blocks
+  RecordingSink sink(options);
+  sink.open(FORMAT);
+  sink.write(samples);
+  sink.flush();
+
+  const auto files = sink.files();
+  ASSERT_EQ(files.size(), 1U);
+  EXPECT_EQ(files[0].extension(), ".wav");
+  const auto bytes = read_file(files[0]);
+  ASSERT_EQ(bytes.size(),
+            RecordingSink::WAV_HEADER_SIZE + samples.size() * sizeof(int16_t));
+  EXPECT_EQ(std::string(bytes.data(), 4), "RIFF");
+  EXPECT_EQ(std::string(bytes.data() + 8, 4), "WAVE");
+  EXPECT_EQ(le32(bytes, 24), 8000U);
+  EXPECT_EQ(le32(bytes, 40), samples.size() * sizeof(int16_t));
+  EXPECT_EQ(le32(bytes, 4), bytes.size() - 8);
+  EXPECT_EQ(payload(bytes, RecordingSink::WAV_HEADER_SIZE), samples);
+  EXPECT_EQ(sink.recorded_bytes(), samples.size() * sizeof(int16_t));
+}
+
+TEST_F(RecordingSinkTest, RawFilesHaveNoHeader) {
+  options.container = RecordingSink::Container::RAW;
+  const auto samples = ramp(1000);
+  {
+    RecordingSink sink(options);
+    sink.open(FORMAT);
+    sink.write(samples);
+  }
+  const auto files = std::vector<fs::path>(
+      fs::directory_iterator(options.directory), fs::directory_iterator());
+  ASSERT_EQ(files.size(), 1U);
+  EXPECT_EQ(files[0].extension(), ".raw");
+  EXPECT_EQ(payload(read_file(files[0]), 0), samples);
+}
+
+TEST_F(RecordingSinkTest, RotatesAfterConfiguredLength) {
+  options.rotate_after = std::chrono::seconds(1);
+  RecordingSink sink(options);
+  sink.open(FORMAT);
+  sink.write(ramp(40000)); // 2.5 s
+  sink.flush();
+
+  const auto files = sink.files();
+  ASSERT_EQ(files.size(), 3U);
+  EXPECT_EQ(fs::file_size(files[0]), RecordingSink::WAV_HEADER_SIZE + 32000);
+  EXPECT_EQ(fs::file_size(files[1]), RecordingSink::WAV_HEADER_SIZE + 32000);
+  EXPECT_EQ(fs::file_size(files[2]), RecordingSink::WAV_HEADER_SIZE + 16000);
+}
+
+TEST_F(RecordingSinkTest, StartsNewFileOnFormatChange) {
+  RecordingSink sink(options);
+  sink.open(FORMAT);
+  sink.write(ramp(100));
+  sink.open({16000, 1});
+  sink.write(ramp(50));
+  sink.flush();
+
+  const auto files = sink.files();
+  ASSERT_EQ(files.size(), 2U);
+  const auto second = read_file(files[1]);
+  EXPECT_EQ(le32(second, 24), 16000U);
+  EXPECT_EQ(payload(second, RecordingSink::WAV_HEADER_SIZE), ramp(50));
+}
+
+TEST_F(RecordingSinkTest, DirectIoRecordsSameAudio) {
+  options.direct_io = true;
+  const auto samples = ramp(200000);
+  RecordingSink sink(options);
+  sink.open(FORMAT);
+  sink.write(samples);
+  sink.flush();
+  sink.write(samples);
+  sink.flush();
+
+  const auto bytes = read_file(sink.files().at(0));
+  auto expected = samples;
+  expected.insert(expected.end(), samples.begin(), samples.end());
+  EXPECT_EQ(le32(bytes, 40), expected.size() * sizeof(int16_t));
+  EXPECT_EQ(payload(bytes, RecordingSink::WAV_HEADER_SIZE), expected);
+}
+
+TEST_F(RecordingSinkTest, DropsInsteadOfBlockingWhenBufferIsFull) {
+  options.buffer = std::chrono::seconds(1);
+  RecordingSink sink(options);
+  sink.open(FORMAT);
+  const auto too_large = ramp(1U << 20U);
+  sink.write(too_large);
+  EXPECT_EQ(sink.dropped_samples(), too_large.size());
+}
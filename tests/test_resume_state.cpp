@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/audio/resume_state.hpp"
+
+namespace {
+
+auto make_point(int64_t sample) -> ResumePoint {
+  return {ResumeState::hash("playlist"),
+          ResumeState::hash("song.mp3"),
+          2,
+          42,
+          true,
+          0.5F,
+          sample,
+          417,
+          1000,
+          417000};
+}
+
+} // namespace
+
+class ResumeStateTest : public ::testing::Test {
+protected:
+  void TearDown() override { std::filesystem::remove_all("resume_dir"); }
+
+  const std::filesystem::path file = "resume_dir/resume";
+};
+
+TEST_F(ResumeStateTest, StartsEmptyAndRoundTrips) {
+  ResumeState state(file);
+  EXPECT_EQ(state.load(), std::nullopt);
+
+  state.save(make_point(123456));
+  const auto point = state.load();
+  ASSERT_TRUE(point.has_value());
+  EXPECT_EQ(point->sample, 123456);
+  EXPECT_EQ(point->shuffle_seed, 42U);
+  EXPECT_EQ(point->anchor_offset, 417000);
+  EXPECT_TRUE(point->playing);
+}
+
+TEST_F(ResumeStateTest, SurvivesReopeningAndKeepsNewestPoint) {
+  {
+    ResumeState state(file);
+    for (int64_t sample = 1; sample <= 5; ++sample) {
+      state.save(make_point(sample));
+    }
+  }
+  ResumeState restarted(file);
+  ASSERT_TRUE(restarted.load().has_value());
+  EXPECT_EQ(restarted.load()->sample, 5);
+
+  // Generations carry on, so the next save still wins
+  restarted.save(make_point(6));
+  EXPECT_EQ(ResumeState(file).load()->sample, 6);
+}
+
+TEST_F(ResumeStateTest, TornSaveFallsBackToPreviousPoint) {
+  {
+    ResumeState state(file);
+    state.save(make_point(1)); // Generation 1, slot 1
+    state.save(make_point(2)); // Generation 2, slot 0
+  }
+  // A crash in the middle of saving generation 3 leaves slot 1 odd
+  const uint64_t torn = 5;
+  const int fd = ::open(file.c_str(), O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(pwrite(fd, &torn, sizeof(torn),
+                   offsetof(ResumeStateFile, slots) + sizeof(ResumeSlot)),
+            static_cast<ssize_t>(sizeof(torn)));
+  ::close(fd);
+
+  ResumeState restarted(file);
+  ASSERT_TRUE(restarted.load().has_value());
+  EXPECT_EQ(restarted.load()->sample, 2);
+
+  // The next save reuses the torn slot and keeps the good point intact
+  restarted.save(make_point(3));
+  EXPECT_EQ(restarted.load()->sample, 3);
+  uint64_t kept = 0;
+  const int reader = ::open(file.c_str(), O_RDONLY);
+  ASSERT_GE(reader, 0);
+  ASSERT_EQ(
+      pread(reader, &kept, sizeof(kept), offsetof(ResumeStateFile, slots)),
+      static_cast<ssize_t>(sizeof(kept)));
+  ::close(reader);
+  EXPECT_EQ(kept, 4U);
+}
+
+TEST_F(ResumeStateTest, ResetsForeignFile) {
+  std::filesystem::create_directories(file.parent_path());
+  std::ofstream(file) << "not a state file";
+  ResumeState state(file);
+  EXPECT_EQ(state.load(), std::nullopt);
+}
+
+TEST(ResumeStateHashTest, IsStableFnv1a) {
+  EXPECT_EQ(ResumeState::hash(""), ResumeState::HASH_BASIS);
+  EXPECT_EQ(ResumeState::hash("a"), 0xaf63dc4c8601ec8cULL);
+  EXPECT_EQ(ResumeState::hash("b", ResumeState::hash("a")),
+            ResumeState::hash("ab"));
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/ring_buffer.hpp"
+
+TEST(RingBufferTest, RoundsCapacityUpToPowerOfTwo) {
+  RingBuffer<int16_t> ring(100);
+  EXPECT_EQ(ring.capacity(), 128U);
+  EXPECT_EQ(ring.size(), 0U);
+}
+
+TEST(RingBufferTest, PushIsAllOrNothing) {
+  RingBuffer<int16_t> ring(4);
+  const std::array<int16_t, 3> three{1, 2, 3};
+  EXPECT_TRUE(ring.push(three));
+  EXPECT_FALSE(ring.push(three));
+  EXPECT_EQ(ring.size(), 3U);
+}
+
+TEST(RingBufferTest, PopsAcrossTheWrap) {
+  RingBuffer<int16_t> ring(4);
+  std::array<int16_t, 4> out{};
+  ASSERT_TRUE(ring.push(std::array<int16_t, 3>{1, 2, 3}));
+  EXPECT_EQ(ring.pop(std::span{out}.first(2)), 2U);
+  ASSERT_TRUE(ring.push(std::array<int16_t, 3>{4, 5, 6}));
+  EXPECT_EQ(ring.pop(out), 4U);
+  EXPECT_EQ(out, (std::array<int16_t, 4>{3, 4, 5, 6}));
+}
+
+TEST(RingBufferTest, PeekExposesWrappedRegionsWithoutCopying) {
+  RingBuffer<int16_t> ring(4);
+  std::array<int16_t, 3> out{};
+  ASSERT_TRUE(ring.push(std::array<int16_t, 3>{1, 2, 3}));
+  ring.pop(out);
+  ASSERT_TRUE(ring.push(std::array<int16_t, 3>{4, 5, 6}));
+
+  auto [first, second] = ring.peek();
+  ASSERT_EQ(first.size(), 1U);
+  ASSERT_EQ(second.size(), 2U);
+  EXPECT_EQ(first[0], 4);
+  EXPECT_EQ(second[1], 6);
+  ring.consume(3);
+  EXPECT_EQ(ring.size(), 0U);
+  EXPECT_EQ(ring.read_position(), ring.write_position());
+}
+
+TEST(RingBufferTest, TransfersInOrderBetweenThreads) {
+  static constexpr int16_t COUNT = 30000;
+  RingBuffer<int16_t> ring(256);
+  std::vector<int16_t> received;
+  received.reserve(COUNT);
+
+  std::jthread consumer([&] {
+    std::array<int16_t, 64> out{};
+    while (received.size() < COUNT) {
+      const auto got = ring.pop(out);
+      received.insert(received.end(), out.begin(), out.begin() + got);
+    }
+  });
+  for (int16_t value = 0; value < COUNT;) {
+    if (ring.push(std::span{&value, 1})) {
+      ++value;
+    }
+  }
+  consumer.join();
+
+  std::vector<int16_t> expected(COUNT);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(received, expected);
+}
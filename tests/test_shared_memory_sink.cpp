@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/shared_memory_sink.hpp"
+#include "../src/audio/shared_ring.hpp"
+
+using namespace std::chrono_literals;
+
+class SharedMemorySinkTest : public ::testing::Test {
+protected:
+  static constexpr AudioFormat FORMAT{48000, 2};
+  static constexpr size_t CAPACITY = 64 * 1024;
+
+  void SetUp() override { sink.open(FORMAT); }
+
+  static auto ramp(int16_t start, size_t size) -> std::vector<int16_t> {
+    std::vector<int16_t> samples(size);
+    for (size_t i = 0; i < size; ++i) {
+      samples[i] = static_cast<int16_t>(start + static_cast<int16_t>(i));
+    }
+    return samples;
+  }
+
+  static auto read_all(SharedRingReader &reader) -> std::vector<int16_t> {
+    const auto view = reader.peek();
+    std::vector<int16_t> samples(view.begin(), view.end());
+    EXPECT_TRUE(reader.consume(view.size()));
+    return samples;
+  }
+
+  SharedMemorySink sink{CAPACITY};
+};
+
+TEST_F(SharedMemorySinkTest, ReaderSeesFormatAndSamples) {
+  SharedRingReader reader(sink.path());
+  EXPECT_EQ(reader.format(), FORMAT);
+  EXPECT_TRUE(reader.peek().empty());
+
+  const auto samples = ramp(0, 1000);
+  sink.write(samples);
+  EXPECT_EQ(read_all(reader), samples);
+  EXPECT_TRUE(reader.peek().empty());
+}
+
+TEST_F(SharedMemorySinkTest, ReadersAreIndependent) {
+  SharedRingReader first(sink.path());
+  SharedRingReader second(sink.path());
+  sink.write(ramp(0, 100));
+  EXPECT_EQ(read_all(first), ramp(0, 100));
+  sink.write(ramp(100, 100));
+
+  EXPECT_EQ(read_all(first), ramp(100, 100));
+  EXPECT_EQ(read_all(second).size(), 200U);
+}
+
+TEST_F(SharedMemorySinkTest, WrappedAudioIsContiguous) {
+  SharedRingReader reader(sink.path());
+  const auto block = CAPACITY / sizeof(int16_t) / 3;
+  for (int16_t i = 0; i < 5; ++i) {
+    const auto samples = ramp(static_cast<int16_t>(i * 1000), block);
+    sink.write(samples);
+    const auto view = reader.peek();
+    ASSERT_EQ(view.size(), block);
+    EXPECT_TRUE(std::equal(view.begin(), view.end(), samples.begin()));
+    EXPECT_TRUE(reader.consume(view.size()));
+  }
+}
+
+TEST_F(SharedMemorySinkTest, LappedReaderSkipsAheadWithoutBlockingWriter) {
+  SharedRingReader reader(sink.path());
+  for (int i = 0; i < 4; ++i) {
+    sink.write(ramp(0, CAPACITY / sizeof(int16_t) / 2));
+  }
+  const auto view = reader.peek();
+  EXPECT_EQ(reader.overruns(), 1U);
+  EXPECT_EQ(view.size(), CAPACITY / sizeof(int16_t) / 2);
+
+  // A view the writer overwrites while held is reported as torn
+  sink.write(ramp(0, CAPACITY / sizeof(int16_t)));
+  EXPECT_FALSE(reader.consume(view.size()));
+}
+
+TEST_F(SharedMemorySinkTest, FormatChangeSplitsReads) {
+  SharedRingReader reader(sink.path());
+  sink.write(ramp(0, 100));
+  sink.open({22050, 1});
+  sink.write(ramp(0, 50));
+
+  EXPECT_EQ(reader.format(), FORMAT);
+  EXPECT_EQ(read_all(reader).size(), 100U);
+  EXPECT_EQ(reader.format(), (AudioFormat{22050, 1}));
+  EXPECT_EQ(read_all(reader).size(), 50U);
+}
+
+TEST_F(SharedMemorySinkTest, ClearDropsUnreadAudio) {
+  SharedRingReader reader(sink.path());
+  sink.write(ramp(0, 100));
+  sink.clear();
+  sink.write(ramp(500, 10));
+  EXPECT_EQ(read_all(reader), ramp(500, 10));
+}
+
+TEST_F(SharedMemorySinkTest, PauseStateIsPublished) {
+  SharedRingReader reader(sink.path());
+  EXPECT_TRUE(reader.is_paused());
+  sink.resume();
+  EXPECT_FALSE(reader.is_paused());
+}
+
+TEST_F(SharedMemorySinkTest, ReaderInAnotherProcessWaitsForAudio) {
+  int ready[2];
+  ASSERT_EQ(pipe(ready), 0);
+  const auto path = sink.path();
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    close(ready[0]);
+    int status = 1;
+    {
+      SharedRingReader reader(path);
+      (void)!write(ready[1], "r", 1);
+      if (reader.wait(5s) && reader.format() == FORMAT) {
+        const auto view = reader.peek();
+        status = (view.size() == 256 && view[255] == 255 &&
+                  reader.consume(view.size()))
+                     ? 0
+                     : 2;
+      }
+    }
+    _exit(status);
+  }
+  close(ready[1]);
+  char byte = 0;
+  ASSERT_EQ(read(ready[0], &byte, 1), 1);
+  close(ready[0]);
+  std::this_thread::sleep_for(50ms);
+  sink.write(ramp(0, 256));
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(SharedRingReaderTest, RejectsOtherFiles) {
+  EXPECT_THROW(SharedRingReader("/proc/self/status"), std::runtime_error);
+  EXPECT_THROW(SharedRingReader("/nonexistent"), std::runtime_error);
+}
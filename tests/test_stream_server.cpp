@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/net/stream_server.hpp"
+
+class StreamServerTest : public ::testing::Test {
+protected:
+  static constexpr auto TIMEOUT_MS = 2000;
+
+  void TearDown() override {
+    for (const int fd : clients) {
+      close(fd);
+    }
+  }
+
+  auto connect_listener(bool metadata) -> int {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(server.port());
+    EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+              0);
+    std::string request = "GET / HTTP/1.0\r\n";
+    if (metadata) {
+      request += "Icy-MetaData: 1\r\n";
+    }
+    request += "\r\n";
+    EXPECT_EQ(send(fd, request.data(), request.size(), 0),
+              static_cast<ssize_t>(request.size()));
+    clients.push_back(fd);
+    return fd;
+  }
+
+  void wait_for_listeners(size_t count) {
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(TIMEOUT_MS);
+    while (server.listener_count() != count &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(server.listener_count(), count);
+  }
+
+  static auto read_exactly(int fd, size_t size) -> std::string {
+    std::string data;
+    while (data.size() < size) {
+      pollfd pfd{fd, POLLIN, 0};
+      if (poll(&pfd, 1, TIMEOUT_MS) <= 0) {
+        break;
+      }
+      std::vector<char> chunk(size - data.size());
+      const auto received = recv(fd, chunk.data(), chunk.size(), 0);
+      if (received <= 0) {
+        break;
+      }
+      data.append(chunk.data(), static_cast<size_t>(received));
+    }
+    return data;
+  }
+
+  static auto read_header(int fd) -> std::string {
+    std::string header;
+    while (!header.ends_with("\r\n\r\n")) {
+      auto chr = read_exactly(fd, 1);
+      if (chr.empty()) {
+        break;
+      }
+      header += chr;
+    }
+    return header;
+  }
+
+  static auto make_payload(size_t size) -> std::string {
+    std::string payload(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+      payload[i] = static_cast<char>('a' + (i % 26));
+    }
+    return payload;
+  }
+
+  StreamServer server{0};
+  std::vector<int> clients;
+};
+
+TEST_F(StreamServerTest, BindsEphemeralPort) { EXPECT_NE(server.port(), 0); }
+
+TEST_F(StreamServerTest, PassesBytesThroughUntouched) {
+  const int fd = connect_listener(false);
+  wait_for_listeners(1);
+
+  const auto payload = make_payload(5000);
+  server.publish(payload);
+
+  const auto header = read_header(fd);
+  EXPECT_TRUE(header.starts_with("HTTP/1.0 200 OK"));
+  EXPECT_EQ(header.find("icy-metaint"), std::string::npos);
+  EXPECT_EQ(read_exactly(fd, payload.size()), payload);
+}
+
+TEST_F(StreamServerTest, InterleavesIcyMetadata) {
+  server.set_metadata("Artist - Title");
+  const int fd = connect_listener(true);
+  wait_for_listeners(1);
+
+  const auto payload = make_payload(StreamServer::ICY_METAINT + 1000);
+  server.publish(payload);
+
+  const auto header = read_header(fd);
+  EXPECT_NE(header.find("icy-metaint: 16000"), std::string::npos);
+  EXPECT_EQ(read_exactly(fd, StreamServer::ICY_METAINT),
+            payload.substr(0, StreamServer::ICY_METAINT));
+
+  const auto length = read_exactly(fd, 1);
+  ASSERT_EQ(length.size(), 1U);
+  const auto block = read_exactly(fd, static_cast<size_t>(length[0]) * 16);
+  EXPECT_TRUE(block.starts_with("StreamTitle='Artist - Title';"));
+
+  EXPECT_EQ(read_exactly(fd, 1000), payload.substr(StreamServer::ICY_METAINT));
+}
+
+TEST_F(StreamServerTest, FansOutToManyListeners) {
+  // Each listener costs a descriptor on both ends of the connection
+  static constexpr size_t WANTED = 2000;
+  static constexpr rlim_t SPARE_FDS = 64;
+  rlimit limit{};
+  ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &limit), 0);
+  limit.rlim_cur = std::max(limit.rlim_cur,
+                            std::min<rlim_t>(limit.rlim_max,
+                                             (2 * WANTED) + SPARE_FDS));
+  setrlimit(RLIMIT_NOFILE, &limit);
+  getrlimit(RLIMIT_NOFILE, &limit);
+  const auto listeners = std::min<size_t>(
+      WANTED, (std::max(limit.rlim_cur, 2 * SPARE_FDS) - SPARE_FDS) / 2);
+  for (size_t i = 0; i < listeners; ++i) {
+    connect_listener(false);
+  }
+  wait_for_listeners(listeners);
+
+  const auto payload = make_payload(20000);
+  server.publish(payload);
+
+  for (const int fd : clients) {
+    read_header(fd);
+    EXPECT_EQ(read_exactly(fd, payload.size()), payload);
+  }
+}
+
+TEST_F(StreamServerTest, ForgetsClosedListeners) {
+  const int fd = connect_listener(false);
+  wait_for_listeners(1);
+  close(fd);
+  clients.clear();
+  wait_for_listeners(0);
+}
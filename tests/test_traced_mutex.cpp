@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "../src/util/traced_mutex.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+void take(TracedMutex &mutex, std::chrono::milliseconds hold) {
+  TracedMutex::Guard lock(mutex);
+  std::this_thread::sleep_for(hold);
+}
+
+} // namespace
+
+TEST(TracedMutexTest, RecordsNothingUntilTracing) {
+  TracedMutex mutex;
+  take(mutex, 0ms);
+  EXPECT_FALSE(mutex.is_tracing());
+  EXPECT_TRUE(mutex.report().empty());
+}
+
+TEST(TracedMutexTest, SeparatesCallSites) {
+  TracedMutex mutex;
+  mutex.set_tracing(true);
+  for (int i = 0; i < 3; ++i) {
+    take(mutex, 0ms);
+  }
+  { TracedMutex::Guard lock(mutex); }
+
+  const auto sites = mutex.report();
+  ASSERT_EQ(sites.size(), 2U);
+  uint64_t total = 0;
+  for (const auto &site : sites) {
+    EXPECT_GT(site.line, 0U);
+    EXPECT_EQ(site.wait.count(), site.hold.count());
+    total += site.wait.count();
+  }
+  EXPECT_EQ(total, 4U);
+
+  mutex.reset();
+  EXPECT_TRUE(mutex.report().empty());
+}
+
+TEST(TracedMutexTest, BlamesTheWaiterAndTheHolder) {
+  TracedMutex mutex;
+  mutex.set_tracing(true);
+  std::atomic<bool> held{false};
+  std::jthread holder([&] {
+    TracedMutex::Guard lock(mutex);
+    held = true;
+    std::this_thread::sleep_for(50ms);
+  });
+  while (!held) {
+    std::this_thread::yield();
+  }
+  { TracedMutex::Guard lock(mutex); }
+  holder.join();
+
+  // Worst wait first: the waiter, then the holder that never waited
+  const auto sites = mutex.report();
+  ASSERT_EQ(sites.size(), 2U);
+  EXPECT_GE(sites[0].wait.max(), 20ms);
+  EXPECT_LT(sites[0].hold.max(), 20ms);
+  EXPECT_GE(sites[1].hold.max(), 50ms);
+  EXPECT_LT(sites[1].wait.max(), 20ms);
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "../src/audio/track_validator.hpp"
+
+class TrackValidatorTest : public ::testing::Test {
+protected:
+  void SetUp() override { std::filesystem::create_directories("test_dir"); }
+  void TearDown() override { std::filesystem::remove_all("test_dir"); }
+
+  TrackValidator validator;
+};
+
+TEST_F(TrackValidatorTest, AcceptsPlayableFile) {
+  EXPECT_EQ(validator.validate("../tests/resources/song1.mp3"), std::nullopt);
+}
+
+TEST_F(TrackValidatorTest, RejectsFileWithoutAudio) {
+  std::ofstream("test_dir/notes.mp3") << "Not an MP3 file at all\n";
+  const auto error = validator.validate("test_dir/notes.mp3");
+  ASSERT_TRUE(error.has_value());
+  EXPECT_NE(error->find("notes.mp3"), std::string::npos);
+}
+
+TEST_F(TrackValidatorTest, RejectsMissingFile) {
+  EXPECT_TRUE(validator.validate("test_dir/missing.mp3").has_value());
+  // The handle is reusable after a failure
+  EXPECT_EQ(validator.validate("../tests/resources/song2.mp3"), std::nullopt);
+}
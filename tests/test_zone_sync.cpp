@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Jose Pardeiro
+//
+// This file is part of the jpod-nano project and is licensed under the MIT
+// License. See the LICENSE file in the project root for full license
+// information.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "../src/audio/audio_sink.hpp"
+#include "../src/audio/resampler.hpp"
+#include "../src/audio/zone_sync.hpp"
+
+namespace {
+
+constexpr int32_t RATE = 44100;
+constexpr int64_t NS_PER_SECOND = 1'000'000'000;
+constexpr int64_t ONE_MS_FRAMES = RATE / 1000;
+
+/**
+ * Mono sink playing at its own (drifting) crystal rate in simulated leader
+ * time, timestamping every frame it outputs.
+ */
+class TimestampSink : public AudioSink {
+public:
+  struct Played {
+    int64_t leader_ns;
+    int16_t value;
+  };
+
+  explicit TimestampSink(double drift_ppm) : drift_(drift_ppm * 1e-6) {}
+
+  void open(const AudioFormat & /*format*/) override {}
+  void write(std::span<const int16_t> samples) override {
+    queue_.insert(queue_.end(), samples.begin(), samples.end());
+  }
+  [[nodiscard]] auto queued_bytes() const -> uint32_t override {
+    return static_cast<uint32_t>(queue_.size() * sizeof(int16_t));
+  }
+  void clear() override { queue_.clear(); }
+  void pause() override {}
+  void resume() override {}
+  [[nodiscard]] auto is_open() const -> bool override { return true; }
+
+  /// Plays every frame due up to the given leader time.
+  void advance_to(int64_t leader_ns) {
+    const double rate = RATE * (1.0 + drift_);
+    const auto due = static_cast<int64_t>(
+        static_cast<double>(leader_ns) * rate / NS_PER_SECOND);
+    for (; clock_frames_ < due; ++clock_frames_) {
+      if (queue_.empty()) {
+        ++underruns_;
+        continue;
+      }
+      const auto at = static_cast<int64_t>(
+          static_cast<double>(clock_frames_) * NS_PER_SECOND / rate);
+      played_.push_back({at, queue_.front()});
+      queue_.pop_front();
+    }
+  }
+
+  [[nodiscard]] auto played() const -> const std::vector<Played> & {
+    return played_;
+  }
+
+private:
+  double drift_;
+  std::deque<int16_t> queue_;
+  int64_t clock_frames_{0};
+  uint64_t underruns_{0};
+  std::vector<Played> played_;
+};
+
+/// Largest misalignment, in frames, of audio played after `from_ns`.
+auto worst_error(const TimestampSink &sink, int64_t from_ns) -> int64_t {
+  int64_t worst = 0;
+  for (const auto &played : sink.played()) {
+    const auto expected = played.leader_ns * RATE / NS_PER_SECOND;
+    // The int16 ramp jumps from 32767 to -32768; skip interpolation there
+    const auto phase = expected & 0xFFFF;
+    if (played.leader_ns < from_ns || std::abs(phase - 0x8000) < 64) {
+      continue;
+    }
+    const auto diff = static_cast<int16_t>(
+        static_cast<uint16_t>(played.value) -
+        static_cast<uint16_t>(expected & 0xFFFF));
+    worst = std::max<int64_t>(worst, std::abs(diff));
+  }
+  return worst;
+}
+
+/// Runs a follower zone whose media frame n carries the sample value n.
+void simulate_follower(TimestampSink &sink, int64_t start_frame, int seconds) {
+  static constexpr int64_t TICK_NS = 5'000'000;
+  static constexpr size_t BLOCK = 1024;
+  static constexpr uint32_t QUEUE_TARGET = 4 * BLOCK * sizeof(int16_t);
+
+  Resampler resampler(1);
+  ZoneSync sync;
+  int64_t decoded = start_frame;
+  std::vector<int16_t> block(BLOCK);
+  std::vector<int16_t> output;
+
+  for (int64_t now = 0; now < seconds * NS_PER_SECOND; now += TICK_NS) {
+    sink.advance_to(now);
+    while (sink.queued_bytes() < QUEUE_TARGET) {
+      for (size_t i = 0; i < BLOCK; ++i) {
+        block[i] = static_cast<int16_t>(decoded + static_cast<int64_t>(i));
+      }
+      decoded += BLOCK;
+      resampler.process(block, output);
+      sink.write(output);
+
+      const auto audible =
+          decoded - (sink.queued_bytes() / static_cast<int64_t>(sizeof(int16_t)));
+      const auto correction =
+          sync.update(now, now * RATE / NS_PER_SECOND, audible, RATE);
+      resampler.set_ratio(correction.ratio);
+      if (correction.seek_frame) {
+        decoded = *correction.seek_frame;
+        sink.clear();
+        resampler.reset(1);
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST(ResamplerTest, UnitRatioPassesSamplesThrough) {
+  Resampler resampler(2);
+  std::vector<int16_t> input(400);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<int16_t>(i * 3);
+  }
+  std::vector<int16_t> output;
+  resampler.process(input, output);
+  ASSERT_GE(output.size(), input.size() - 8);
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_EQ(output[i], input[i]);
+  }
+}
+
+TEST(ResamplerTest, RatioScalesOutputLength) {
+  Resampler resampler(1);
+  resampler.set_ratio(1.01);
+  std::vector<int16_t> input(10000, 1000);
+  std::vector<int16_t> output;
+  size_t total = 0;
+  for (int i = 0; i < 10; ++i) {
+    resampler.process(input, output);
+    total += output.size();
+  }
+  EXPECT_NEAR(static_cast<double>(total), 101000.0, 10.0);
+  EXPECT_EQ(output.back(), 1000);
+}
+
+TEST(ZoneSyncTest, LargeErrorRequestsSeek) {
+  ZoneSync sync;
+  const auto correction = sync.update(0, RATE * 10, RATE * 9, RATE);
+  ASSERT_TRUE(correction.seek_frame);
+  EXPECT_EQ(*correction.seek_frame, RATE * 10);
+}
+
+TEST(ZoneSyncTest, ZoneAheadIsStretched) {
+  ZoneSync sync;
+  const auto correction = sync.update(0, RATE, RATE + ONE_MS_FRAMES * 10, RATE);
+  EXPECT_FALSE(correction.seek_frame);
+  EXPECT_GT(correction.ratio, 1.0);
+  EXPECT_LE(correction.ratio, 1.0 + ZoneSync::MAX_ADJUST);
+}
+
+TEST(ZoneSyncTest, DriftingZoneStaysWithinOneMillisecond) {
+  for (const double drift : {-300.0, 0.0, 250.0}) {
+    TimestampSink sink(drift);
+    simulate_follower(sink, RATE / 3, 20);
+    EXPECT_LE(worst_error(sink, 5 * NS_PER_SECOND), ONE_MS_FRAMES)
+        << "drift " << drift << " ppm";
+  }
+}